@@ -0,0 +1,346 @@
+/**************************************************
+ * scライブラリの処理速度を測るためのコードです
+ * このファイルは，bench.hppに名前だけ書かれている関数の中身と，ベンチマークを実行するmain関数です
+ *
+ * 各ベンチマークは，1回の測定(サンプル)がSampleTimeを超えるまで繰り返す回数を2倍ずつ増やしてから，
+ * 同じ回数でSampleNum回測定し，1回あたりの時間の最小値・中央値・最大値を
+ * Google Benchmarkと同じ形式のJSONで出力します．
+ * picoで実行したときは，SysTickで数えたCPUのサイクル数も出力します．
+ * ベンチマークがState::set_counterで設定した値(割り込みの遅れなど)は，測定のうち最大の値を出力します．
+ *
+ * ホスト(PC)
+ *     ./BENCH                      すべて実行し，JSONを標準出力に出力
+ *     ./BENCH Vector3              名前に"Vector3"を含むものだけ実行
+ *     ./BENCH --json=result.json   JSONをファイルに出力
+ * pico
+ *     USBで接続すると実行し，JSONを"BENCH_JSON_BEGIN"と"BENCH_JSON_END"の行で挟んで出力
+**************************************************/
+
+//! @file bench.cpp
+//! @brief ベンチマークの登録と実行
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#if PICO_ON_DEVICE
+    #include "hardware/clocks.h"
+    #include "hardware/structs/systick.h"
+#else
+    #include <chrono>
+#endif
+
+namespace sc::bench
+{
+
+namespace
+{
+
+//! @brief 登録したベンチマーク
+struct Entry
+{
+    const char* name;
+    Function function;
+};
+
+//! @brief 登録したベンチマークの一覧 (静的変数の初期化順に依存しないよう，関数の中に置く)
+std::vector<Entry>& entries()
+{
+    static std::vector<Entry> list;
+    return list;
+}
+
+//! @brief 1回の測定の結果
+struct Sample
+{
+    double real_ns;  // 経過時間 (ns)
+    double cpu_ns;  // CPU時間 (ns)  picoでは経過時間と同じ
+    uint32_t cycles;  // CPUのサイクル数  ホストでは0
+    std::vector<State::Counter> counters;  // ベンチマークが設定した値
+};
+
+//! @brief 1つのベンチマークの結果 (時間とサイクル数は1回あたり)
+struct Report
+{
+    std::string name;
+    uint64_t iterations;  // 1回の測定で繰り返した回数
+    double real_ns[3];  // 経過時間の最小値・中央値・最大値 (ns)
+    double cpu_ns;  // CPU時間の中央値 (ns)
+    double cycles[3];  // サイクル数の最小値・中央値・最大値
+    std::vector<State::Counter> counters;  // ベンチマークが設定した値の最大値
+};
+
+constexpr std::size_t SampleNum = 15;  // 1つのベンチマークで測定する回数
+constexpr uint64_t MaxIterations = 1'000'000'000;  // 繰り返す回数の上限
+#if PICO_ON_DEVICE
+    constexpr double SampleTime = 0.02;  // 1回の測定の時間 (s)  SysTickは24bitなので，133MHzでも0.12s以内にする
+    constexpr uint32_t SysTickMask = 0x00FFFFFF;  // SysTickのカウンタのビット数
+#else
+    constexpr double SampleTime = 0.03;  // 1回の測定の時間 (s)
+#endif
+
+//! @brief ベンチマークが設定した値を取り出す
+std::vector<State::Counter> counters(const State& state)
+{
+    std::vector<State::Counter> list;
+    for (std::size_t i = 0; i < state.counter_num(); ++i)
+    {
+        list.push_back(state.counter(i));
+    }
+    return list;
+}
+
+//! @brief 決められた回数だけ繰り返して測定
+Sample run(const Entry& entry, uint64_t iterations)
+{
+    State state(iterations);
+    #if PICO_ON_DEVICE
+        const uint64_t start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+        const uint32_t start_cycles = systick_hw->cvr;  // SysTickは減っていくカウンタ
+        entry.function(state);
+        const uint32_t end_cycles = systick_hw->cvr;
+        const uint64_t end_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+        const double real_ns = double(end_us - start_us) * 1e3;
+        return Sample{real_ns, real_ns, (start_cycles - end_cycles) & SysTickMask, counters(state)};
+    #else
+        const auto real_start = std::chrono::steady_clock::now();
+        const std::clock_t cpu_start = std::clock();
+        entry.function(state);
+        const std::clock_t cpu_end = std::clock();
+        const auto real_end = std::chrono::steady_clock::now();
+        return Sample{std::chrono::duration<double, std::nano>(real_end - real_start).count(), double(cpu_end - cpu_start) * 1e9 / CLOCKS_PER_SEC, 0, counters(state)};
+    #endif
+}
+
+//! @brief 最小値・中央値・最大値
+template<class T>
+void min_median_max(std::vector<T> values, double result[3])
+{
+    std::sort(values.begin(), values.end());
+    result[0] = double(values.front());
+    result[1] = double(values[values.size() / 2]);
+    result[2] = double(values.back());
+}
+
+//! @brief 繰り返す回数を決めてから，SampleNum回測定
+Report measure(const Entry& entry)
+{
+    // 1回の測定がSampleTimeを超えるまで，繰り返す回数を増やす
+    uint64_t iterations = 1;
+    while (run(entry, iterations).real_ns * 1e-9 < SampleTime && iterations < MaxIterations)
+    {
+        iterations *= 2;
+    }
+
+    std::vector<double> real_ns, cpu_ns, cycles;
+    std::vector<State::Counter> counter_max;
+    for (std::size_t i = 0; i < SampleNum; ++i)
+    {
+        const Sample sample = run(entry, iterations);
+        real_ns.push_back(sample.real_ns / iterations);
+        cpu_ns.push_back(sample.cpu_ns / iterations);
+        cycles.push_back(double(sample.cycles) / iterations);
+        for (const State::Counter& counter : sample.counters)
+        {
+            const auto found = std::find_if(counter_max.begin(), counter_max.end(), [&](const State::Counter& c){return std::strcmp(c.name, counter.name) == 0;});
+            if (found == counter_max.end())
+            {
+                counter_max.push_back(counter);
+            } else {
+                found->value = std::max(found->value, counter.value);
+            }
+        }
+    }
+
+    Report report{entry.name, iterations, {}, 0, {}, counter_max};
+    min_median_max(real_ns, report.real_ns);
+    min_median_max(cycles, report.cycles);
+    double cpu[3];
+    min_median_max(cpu_ns, cpu);
+    report.cpu_ns = cpu[1];
+    return report;
+}
+
+//! @brief 文字列をJSONの文字列として出力できるようにする
+std::string escape(const std::string& str)
+{
+    std::string escaped;
+    for (const char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+//! @brief Google Benchmarkと同じ形式のJSONを出力
+//! @note 1行に1つの値を書くので，bench_diffは行ごとに読み取れます
+void write_json(std::FILE* file, const char* executable, const std::vector<Report>& reports)
+{
+    std::fprintf(file, "{\n  \"context\": {\n");
+    #if PICO_ON_DEVICE
+        std::fprintf(file, "    \"executable\": \"%s\",\n", escape(executable).c_str());
+        std::fprintf(file, "    \"platform\": \"rp2040\",\n");
+        std::fprintf(file, "    \"mhz_per_cpu\": %lu,\n", static_cast<unsigned long>(::clock_get_hz(clk_sys) / 1000000));  // pico-SDKの関数  クロックの周波数を取得
+    #else
+        char date[32] = {};
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        std::fprintf(file, "    \"date\": \"%s\",\n", date);
+        std::fprintf(file, "    \"executable\": \"%s\",\n", escape(executable).c_str());
+        std::fprintf(file, "    \"platform\": \"host\",\n");
+    #endif
+    std::fprintf(file, "    \"placement\": \"%s\",\n",
+        #ifdef SC_BENCH_IN_RAM
+            "ram"
+        #else
+            "flash"
+        #endif
+        );
+    std::fprintf(file, "    \"library_build_type\": \"%s\"\n",
+        #ifdef NDEBUG
+            "release"
+        #else
+            "debug"
+        #endif
+        );
+    std::fprintf(file, "  },\n  \"benchmarks\": [\n");
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        const Report& report = reports[i];
+        std::fprintf(file, "    {\n");
+        std::fprintf(file, "      \"name\": \"%s\",\n", escape(report.name).c_str());
+        std::fprintf(file, "      \"run_name\": \"%s\",\n", escape(report.name).c_str());
+        std::fprintf(file, "      \"run_type\": \"iteration\",\n");
+        std::fprintf(file, "      \"repetitions\": %u,\n", static_cast<unsigned>(SampleNum));
+        std::fprintf(file, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(report.iterations));
+        std::fprintf(file, "      \"real_time\": %.3f,\n", report.real_ns[1]);
+        std::fprintf(file, "      \"cpu_time\": %.3f,\n", report.cpu_ns);
+        std::fprintf(file, "      \"min_time\": %.3f,\n", report.real_ns[0]);
+        std::fprintf(file, "      \"max_time\": %.3f,\n", report.real_ns[2]);
+        #if PICO_ON_DEVICE
+            std::fprintf(file, "      \"min_cycles\": %.1f,\n", report.cycles[0]);
+            std::fprintf(file, "      \"median_cycles\": %.1f,\n", report.cycles[1]);
+            std::fprintf(file, "      \"max_cycles\": %.1f,\n", report.cycles[2]);
+        #endif
+        for (const State::Counter& counter : report.counters)
+        {
+            std::fprintf(file, "      \"%s\": %.1f,\n", escape(counter.name).c_str(), counter.value);
+        }
+        std::fprintf(file, "      \"time_unit\": \"ns\"\n");
+        std::fprintf(file, "    }%s\n", (i + 1 < reports.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+//! @brief 名前にfilterを含むベンチマークをすべて測定
+std::vector<Report> measure_all(const std::string& filter)
+{
+    std::vector<Report> reports;
+    for (const Entry& entry : entries())
+    {
+        if (!filter.empty() && std::string(entry.name).find(filter) == std::string::npos)
+            continue;
+        const Report report = measure(entry);
+        #if PICO_ON_DEVICE
+            std::printf("# %-32s %12.1f cycles %12.1f ns\n", entry.name, report.cycles[1], report.real_ns[1]);
+        #else
+            std::fprintf(stderr, "%-32s %12.1f ns %12llu\n", entry.name, report.real_ns[1], static_cast<unsigned long long>(report.iterations));
+        #endif
+        reports.push_back(report);
+    }
+    return reports;
+}
+
+}
+
+bool add(const char* name, Function function)
+{
+    entries().push_back(Entry{name, function});
+    return true;
+}
+
+}
+
+
+#if PICO_ON_DEVICE
+
+int main()
+{
+    using namespace sc::bench;
+
+    ::stdio_init_all();  // pico-SDKの関数  USBでの出力を有効にする
+    // SysTickをCPUのクロックで動かす (割り込みは使わない)
+    systick_hw->csr = 0;
+    systick_hw->rvr = SysTickMask;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0b101;  // ENABLE | CLKSOURCE(CPUのクロック)
+
+    while (true)
+    {
+        // USBで接続されるのを待ってから実行する
+        while (!::stdio_usb_connected())  // pico-SDKの関数  USBで接続されているか
+        {
+            ::sleep_ms(100);  // pico-SDKの関数
+        }
+        ::sleep_ms(1000);  // ターミナルが開くのを待つ
+
+        const std::vector<Report> reports = measure_all("");
+        std::printf("BENCH_JSON_BEGIN\n");
+        write_json(stdout, "BENCH", reports);
+        std::printf("BENCH_JSON_END\n");
+        std::fflush(stdout);
+
+        // 接続し直したら，もう一度実行する
+        while (::stdio_usb_connected())  // pico-SDKの関数  USBで接続されているか
+        {
+            ::sleep_ms(100);  // pico-SDKの関数
+        }
+    }
+}
+
+#else
+
+int main(int argc, char* argv[])
+{
+    using namespace sc::bench;
+
+    std::string filter;
+    std::string json_path;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.rfind("--json=", 0) == 0)
+        {
+            json_path = arg.substr(7);
+        } else {
+            filter = arg;
+        }
+    }
+
+    const std::vector<Report> reports = measure_all(filter);
+    if (json_path.empty())
+    {
+        write_json(stdout, argv[0], reports);
+    } else {
+        std::FILE* file = std::fopen(json_path.c_str(), "w");
+        if (file == nullptr)
+        {
+            std::fprintf(stderr, "Cannot open %s\n", json_path.c_str());  // ファイルを開けません
+            return 1;
+        }
+        write_json(file, argv[0], reports);
+        std::fclose(file);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef SC19_PICO_BENCH_BENCH_HPP_
+#define SC19_PICO_BENCH_BENCH_HPP_
+
+/**************************************************
+ * scライブラリの処理速度を測るためのコードです
+ * このファイルは，bench.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，測定する関数(ベンチマーク)の登録と，繰り返し回数を管理するクラスが宣言されています．
+ * Google Benchmarkに似た書き方で，結果も同じ形式のJSONで出力するので，
+ * 以前の結果と比べて遅くなっていないかを確かめられます．
+ *
+ *     void SC_BENCH_FUNC(BM_example)(sc::bench::State& state)
+ *     {
+ *         while (state.keep_running())
+ *         {
+ *             sc::bench::do_not_optimize(測定する処理);
+ *         }
+ *     }
+ *     SC_BENCHMARK(BM_example);
+**************************************************/
+
+//! @file bench.hpp
+//! @brief ベンチマークの登録と実行
+
+#include "pico/stdlib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace sc::bench
+{
+
+//! @brief 1回の測定で，決められた回数だけ処理を繰り返させるクラス
+class State
+{
+public:
+    //! @brief 時間のほかに出力する値 (割り込みの遅れの最大値など)
+    struct Counter
+    {
+        const char* name = nullptr;
+        double value = 0;
+    };
+    static constexpr std::size_t MaxCounters = 4;  // 1つのベンチマークで出力できる値の数
+
+private:
+    const uint64_t _iterations;  // 繰り返す回数
+    uint64_t _count = 0;  // 繰り返した回数
+    Counter _counters[MaxCounters];
+    std::size_t _counter_num = 0;
+
+public:
+    explicit State(uint64_t iterations):
+        _iterations(iterations) {}
+
+    //! @brief まだ繰り返すか (whileの条件に書く)
+    bool keep_running()
+        {return _count++ < _iterations;}
+
+    //! @brief 繰り返す回数
+    uint64_t iterations() const
+        {return _iterations;}
+
+    //! @brief 時間のほかに出力する値を設定 (測定の最後に1回呼ぶ)
+    //! @note JSONには，SampleNum回の測定のうち最大の値を "name": value の形で出力します
+    //! @param name 値の名前 (文字列リテラル)
+    //! @param value 値
+    void set_counter(const char* name, double value)
+    {
+        for (std::size_t i = 0; i < _counter_num; ++i)
+        {
+            if (std::strcmp(_counters[i].name, name) == 0)
+            {
+                _counters[i].value = value;
+                return;
+            }
+        }
+        if (_counter_num < MaxCounters)
+        {
+            _counters[_counter_num++] = Counter{name, value};
+        }
+    }
+
+    //! @brief 設定した値の数
+    std::size_t counter_num() const
+        {return _counter_num;}
+
+    //! @brief 設定した値
+    const Counter& counter(std::size_t i) const
+        {return _counters[i];}
+};
+
+using Function = void (*)(State& state);  // ベンチマークの関数
+
+//! @brief ベンチマークを登録 (SC_BENCHMARKから呼ばれる)
+//! @param name ベンチマークの名前
+//! @param function ベンチマークの関数
+//! @return 常にtrue (静的変数の初期化で呼ぶため)
+bool add(const char* name, Function function);
+
+//! @brief 値を使ったことにして，最適化で処理が消されないようにする
+template<class T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}
+
+#define SC_BENCH_CONCAT_IMPL(a, b) a##b
+#define SC_BENCH_CONCAT(a, b) SC_BENCH_CONCAT_IMPL(a, b)
+
+//! @brief ベンチマークの関数を定義するときに，関数名をこれで囲む
+//! @note SC_BENCH_IN_RAMを定義すると，picoではフラッシュ(XIP)ではなくSRAMに置いて実行する
+#ifdef SC_BENCH_IN_RAM
+    #define SC_BENCH_FUNC(name) __not_in_flash_func(name)
+#else
+    #define SC_BENCH_FUNC(name) name
+#endif
+
+//! @brief ベンチマークを登録
+//! @param function ベンチマークの関数 (関数名がそのまま名前になる)
+#define SC_BENCHMARK(function) \
+    static const bool SC_BENCH_CONCAT(sc_bench_registered_, __LINE__) = ::sc::bench::add(#function, function)
+
+#endif  // SC19_PICO_BENCH_BENCH_HPP_
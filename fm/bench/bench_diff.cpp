@@ -0,0 +1,165 @@
+/**************************************************
+ * ベンチマークの結果を比べるためのコードです
+ *
+ * BENCHが出力したJSON(picoのUSB出力をそのまま保存したものでもよい)を2つ読み込み，
+ * 同じ名前のベンチマークごとに時間を比べて表にします．
+ * 両方にサイクル数があるとき(picoどうし)はサイクル数の中央値を，それ以外は経過時間の中央値を比べます．
+ *
+ *     ./BENCH_DIFF base.json new.json                 比べた結果を表示
+ *     ./BENCH_DIFF base.json new.json --threshold=5   5%以上遅くなったものがあれば終了コード1
+**************************************************/
+
+//! @file bench_diff.cpp
+//! @brief ベンチマークの結果の比較
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//! @brief 1つのベンチマークの結果
+struct Result
+{
+    double real_time = -1;  // 経過時間の中央値 (ns)  なければ負
+    double median_cycles = -1;  // サイクル数の中央値  なければ負
+};
+
+//! @brief 1つのJSONファイルの内容
+struct Report
+{
+    std::string platform = "?";  // host か rp2040
+    std::string placement = "?";  // flash か ram
+    std::vector<std::string> names;  // 出てきた順のベンチマークの名前
+    std::map<std::string, Result> results;  // 名前ごとの結果
+};
+
+//! @brief "key": value の行から，keyとvalueを取り出す
+bool split_line(const std::string& line, std::string& key, std::string& value)
+{
+    const std::size_t key_begin = line.find('"');
+    if (key_begin == std::string::npos)
+        return false;
+    const std::size_t key_end = line.find('"', key_begin + 1);
+    const std::size_t colon = (key_end == std::string::npos) ? std::string::npos : line.find(':', key_end);
+    if (colon == std::string::npos)
+        return false;
+    key = line.substr(key_begin + 1, key_end - key_begin - 1);
+    value = line.substr(colon + 1);
+    // 前後の空白と，末尾の","と，文字列の"を取り除く
+    const std::size_t begin = value.find_first_not_of(" \t\"");
+    const std::size_t end = value.find_last_not_of(" \t\r\n,\"");
+    value = (begin == std::string::npos || end < begin) ? "" : value.substr(begin, end - begin + 1);
+    return true;
+}
+
+//! @brief JSONファイルを1行ずつ読み込む (BENCHの出力形式のみ対応)
+bool load(const char* path, Report& report)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return false;
+    }
+    std::string line, key, value, current;
+    while (std::getline(file, line))
+    {
+        if (!split_line(line, key, value))
+            continue;
+        if (key == "platform")
+        {
+            report.platform = value;
+        } else if (key == "placement") {
+            report.placement = value;
+        } else if (key == "name") {
+            current = value;
+            if (report.results.count(current) == 0)
+            {
+                report.names.push_back(current);
+            }
+            report.results[current] = Result{};
+        } else if (key == "real_time" && !current.empty()) {
+            report.results[current].real_time = std::atof(value.c_str());
+        } else if (key == "median_cycles" && !current.empty()) {
+            report.results[current].median_cycles = std::atof(value.c_str());
+        }
+    }
+    return true;
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<const char*> paths;
+    double threshold = -1;  // この割合(%)以上遅くなったら終了コード1  負なら判定しない
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.rfind("--threshold=", 0) == 0)
+        {
+            threshold = std::atof(arg.substr(12).c_str());
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 2)
+    {
+        std::fprintf(stderr, "usage: %s base.json new.json [--threshold=percent]\n", argv[0]);
+        return 2;
+    }
+
+    Report base, target;
+    if (!load(paths[0], base) || !load(paths[1], target))
+        return 2;
+
+    const bool use_cycles = (base.platform == "rp2040" && target.platform == "rp2040");
+    std::printf("base: %s (%s, %s)\n", paths[0], base.platform.c_str(), base.placement.c_str());
+    std::printf("new : %s (%s, %s)\n", paths[1], target.platform.c_str(), target.placement.c_str());
+    std::printf("%-32s %14s %14s %8s %9s\n", "name", use_cycles ? "base[cycles]" : "base[ns]", use_cycles ? "new[cycles]" : "new[ns]", "ratio", "change");
+
+    int regressions = 0;
+    for (const std::string& name : base.names)
+    {
+        const auto found = target.results.find(name);
+        if (found == target.results.end())
+        {
+            std::printf("%-32s %14s\n", name.c_str(), "(removed)");
+            continue;
+        }
+        const Result& old_result = base.results.at(name);
+        const Result& new_result = found->second;
+        const double old_value = use_cycles ? old_result.median_cycles : old_result.real_time;
+        const double new_value = use_cycles ? new_result.median_cycles : new_result.real_time;
+        if (old_value <= 0 || new_value < 0)
+        {
+            std::printf("%-32s %14s\n", name.c_str(), "(no data)");
+            continue;
+        }
+        const double ratio = new_value / old_value;
+        const double change = (ratio - 1.0) * 100.0;
+        const bool regressed = (threshold >= 0 && change > threshold);
+        regressions += regressed;
+        std::printf("%-32s %14.1f %14.1f %8.3f %+8.1f%%%s\n", name.c_str(), old_value, new_value, ratio, change, regressed ? "  <-- slower" : "");
+    }
+    for (const std::string& name : target.names)
+    {
+        if (base.results.count(name) == 0)
+        {
+            std::printf("%-32s %14s\n", name.c_str(), "(added)");
+        }
+    }
+
+    if (regressions > 0)
+    {
+        std::printf("%d benchmark(s) became slower than the threshold\n", regressions);  // しきい値より遅くなったベンチマークがあります
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,605 @@
+/**************************************************
+ * scライブラリの処理速度を測るためのコードです
+ *
+ * このファイルでは，ハードウェアを使わないscライブラリの機能(文字列のフォーマットと数値の変換，ログの選別，単位，
+ * ベクトル，バイト列，エラー処理，航法計算，高度の推定，ログの圧縮，測定値の差分の記録)と，
+ * センサや無線機のドライバのうち通信を使わない部分(BME280の補正，TWELITEの書式，Spresenseの文字列の解析)のベンチマークが定義されています．
+ * ホストとpicoで同じものを実行するので，結果をbench_diffで比べられます．
+**************************************************/
+
+//! @file bench_sc.cpp
+//! @brief scライブラリのベンチマーク
+
+#include "bench.hpp"
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sc_basic.hpp"
+#include "altitude_filter.hpp"
+#include "bme280_compensation.hpp"
+#include "binary.hpp"
+#include "log.hpp"
+#include "lzss.hpp"
+#include "navigation.hpp"
+#include "result.hpp"
+#include "series.hpp"
+#include "spresense_message.hpp"
+#include "text_format.hpp"
+#include "twelite_frame.hpp"
+#include "unit.hpp"
+
+namespace
+{
+
+using namespace sc;
+using sc::bench::State;
+using sc::bench::do_not_optimize;
+
+/***** 文字列のフォーマットと出力 *****/
+
+void SC_BENCH_FUNC(BM_format_str)(State& state)
+{
+    while (state.keep_running())
+    {
+        do_not_optimize(format_str("gps:%f,%f\n", 35.681236, 139.767125));
+    }
+}
+SC_BENCHMARK(BM_format_str);
+
+void SC_BENCH_FUNC(BM_print)(State& state)
+{
+    // 出力先は何もしない関数にして，フォーマットと呼び出しだけを測る
+    const auto old_print = set_print;
+    set_print = [](const std::string& message) {do_not_optimize(message.size());};
+    while (state.keep_running())
+    {
+        print("altitude:%f\n", 12.5);
+    }
+    set_print = old_print;
+}
+SC_BENCHMARK(BM_print);
+
+void SC_BENCH_FUNC(BM_print_disabled)(State& state)
+{
+    // 出力しない出力元のprintは，比較1回で戻る (BM_printとの差がフォーマットと出力にかかる時間)
+    Log::set_level(LogModule::BNO055, LogLevel::Off);
+    while (state.keep_running())
+    {
+        print(LogLevel::Data, LogModule::BNO055, "accel:%f,%f,%f\n", 0.1, -0.2, 9.8);
+    }
+    Log::set_level(LogModule::BNO055, LogLevel::Data);
+}
+SC_BENCHMARK(BM_print_disabled);
+
+
+/***** 数値の文字列への変換 *****/
+
+//! @brief fm.cppなどで毎ループ出力する行 (BME280，BNO055，GPS，プロファイラ)
+template<typename Write>
+std::size_t write_lines(char* buffer, std::size_t size, Write write)
+{
+    std::size_t length = 0;
+    length += write(buffer, size, "pres:%f\nhumi:%f\nbme_temp%f\n", 101325.12, 45.67, 23.45);
+    length += write(buffer, size, "accel:%f,%f,%f\ngrv:%f,%f,%f\nmag:%f,%f,%f\ngyro:%f,%f,%f\n",
+                    0.012, -0.034, 0.005, 0.31, -0.19, 9.79, 0.0301, -0.0102, 0.0403, 0.0012, -0.0021, 0.0007);
+    length += write(buffer, size, "gps:%.7f,%.7f\n", 35.6812362, 139.7671248);
+    length += write(buffer, size, "%s:%lu,%llu\n", "navigation", 1234UL, 5678901ULL);
+    return length;
+}
+
+void SC_BENCH_FUNC(BM_snprintf_lines)(State& state)
+{
+    std::array<char, 256> buffer{};  // 加速度などの行が入る大きさ
+    while (state.keep_running())
+    {
+        do_not_optimize(write_lines(buffer.data(), buffer.size(), [](char* b, std::size_t n, const char* f, auto... args){return std::size_t(snprintf(b, n, f, args...));}));
+    }
+}
+SC_BENCHMARK(BM_snprintf_lines);
+
+void SC_BENCH_FUNC(BM_format_to_lines)(State& state)
+{
+    std::array<char, 256> buffer{};  // 加速度などの行が入る大きさ
+    while (state.keep_running())
+    {
+        do_not_optimize(write_lines(buffer.data(), buffer.size(), [](char* b, std::size_t n, const char* f, auto... args){return format_to(b, n, f, args...);}));
+    }
+
+    // snprintfと違う文字列になった行の数 (0になるはず)
+    std::array<char, 256> expected{};
+    std::size_t mismatches = 0;
+    const auto compare = [&](const char* format, auto... args)
+    {
+        snprintf(expected.data(), expected.size(), format, args...);
+        format_to(buffer.data(), buffer.size(), format, args...);
+        mismatches += (std::string(expected.data()) != buffer.data());
+    };
+    uint32_t seed = 1;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        const double value = (double(seed) - 2147483648.0) / 4096.0;
+        compare("%f", value);
+        compare("%.3f", value / 1000.0);
+        compare("%.7f,%d", value / 1e6, int(seed));
+    }
+    state.set_counter("mismatches", double(mismatches));
+}
+SC_BENCHMARK(BM_format_to_lines);
+
+
+/***** 単位 *****/
+
+void SC_BENCH_FUNC(BM_unit_literal)(State& state)
+{
+    while (state.keep_running())
+    {
+        do_not_optimize(double(12.5_m));  // 文字列からstodで変換される
+    }
+}
+SC_BENCHMARK(BM_unit_literal);
+
+void SC_BENCH_FUNC(BM_unit_arithmetic)(State& state)
+{
+    Pressure<Unit::Pa> pressure(101325.0);
+    const Pressure<Unit::Pa> pressure0(100000.0);
+    while (state.keep_running())
+    {
+        do_not_optimize(pressure);
+        do_not_optimize(double(pressure / pressure0));
+    }
+}
+SC_BENCHMARK(BM_unit_arithmetic);
+
+
+/***** ベクトル *****/
+
+void SC_BENCH_FUNC(BM_Vector3_add)(State& state)
+{
+    Acceleration<Unit::m_s2> line_acce(0.1_m_s2, -0.2_m_s2, 0.3_m_s2);
+    const Acceleration<Unit::m_s2> gravity(0.0_m_s2, 0.0_m_s2, 9.8_m_s2);
+    while (state.keep_running())
+    {
+        do_not_optimize(line_acce);
+        do_not_optimize((line_acce + gravity).magnitude());
+    }
+}
+SC_BENCHMARK(BM_Vector3_add);
+
+void SC_BENCH_FUNC(BM_Vector3_cross)(State& state)
+{
+    Vector3<double> vector1(1.0, 2.0, 3.0);
+    const Vector3<double> vector2(-3.0, 0.5, 2.0);
+    while (state.keep_running())
+    {
+        do_not_optimize(vector1);
+        const Vector3<double> cross = vector1 % vector2;
+        do_not_optimize(cross * vector2);
+    }
+}
+SC_BENCHMARK(BM_Vector3_cross);
+
+void SC_BENCH_FUNC(BM_Vector3_normalize)(State& state)
+{
+    Vector3<double> vector(1.0, 2.0, 3.0);
+    while (state.keep_running())
+    {
+        do_not_optimize(vector);
+        const Vector3<double> normalized = vector / vector.magnitude();
+        do_not_optimize(normalized);
+    }
+}
+SC_BENCHMARK(BM_Vector3_normalize);
+
+
+/***** バイト列 *****/
+
+void SC_BENCH_FUNC(BM_Binary_construct)(State& state)
+{
+    const uint8_t data[] = {0x3F, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    while (state.keep_running())
+    {
+        const Binary binary(data, sizeof(data));
+        do_not_optimize(binary.size());
+    }
+}
+SC_BENCHMARK(BM_Binary_construct);
+
+void SC_BENCH_FUNC(BM_Binary_concat)(State& state)
+{
+    const Binary payload(std::string(80, 'a'));  // TWELITEで1回に送る最大の長さ
+    while (state.keep_running())
+    {
+        // TWELITEの送信と同じく，宛先とコマンドを先頭に，チェックサムを末尾に付ける
+        const Binary frame = (uint8_t(0x78) + (uint8_t(0x01) + payload)) + uint8_t(0xAB);
+        do_not_optimize(frame.size());
+    }
+}
+SC_BENCHMARK(BM_Binary_concat);
+
+void SC_BENCH_FUNC(BM_StaticBinary_fill)(State& state)
+{
+    while (state.keep_running())
+    {
+        StaticBinary<38> binary(38);  // BNO055の一括受信と同じ大きさ
+        binary.data()[0] = 0x01;
+        do_not_optimize(BinaryView(binary).size());
+    }
+}
+SC_BENCHMARK(BM_StaticBinary_fill);
+
+
+/***** エラー処理 *****/
+
+//! @brief 通信の関数と同じく，Resultで値かエラーを返す
+//! @note 呼び出しを消されないように，失敗するかは引数で決める
+Result<std::size_t> SC_BENCH_FUNC(read_result)(bool fail)
+{
+    if (fail)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);
+    return std::size_t(6);
+}
+
+void SC_BENCH_FUNC(BM_Result_success)(State& state)
+{
+    volatile bool fail = false;  // 定数として最適化されないように
+    while (state.keep_running())
+    {
+        const Result<std::size_t> result = read_result(fail);
+        do_not_optimize(result.has_value());
+    }
+}
+SC_BENCHMARK(BM_Result_success);
+
+void SC_BENCH_FUNC(BM_Result_failure)(State& state)
+{
+    // エラーを作るたびに，割り込みを無効にしてErrorCounterの回数を増やす
+    volatile bool fail = true;  // 定数として最適化されないように
+    while (state.keep_running())
+    {
+        const Result<std::size_t> result = read_result(fail);
+        do_not_optimize(result.has_value());
+    }
+    ErrorCounter::reset();
+}
+SC_BENCHMARK(BM_Result_failure);
+
+void SC_BENCH_FUNC(BM_Result_failure_message)(State& state)
+{
+    // 失敗をログに残すときは，メッセージのフォーマットも加わる
+    volatile bool fail = true;  // 定数として最適化されないように
+    while (state.keep_running())
+    {
+        const Result<std::size_t> result = read_result(fail);
+        const std::string message = result.error().message();
+        do_not_optimize(message.size());
+    }
+    ErrorCounter::reset();
+}
+SC_BENCHMARK(BM_Result_failure_message);
+
+//! @brief Resultを使う前と同じく，失敗したらf_errでメッセージを作って例外を投げる
+std::size_t SC_BENCH_FUNC(read_throw)(bool fail)
+{
+    if (fail)
+throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal. accel:%f, %f, %f", 51.0, 0.0, 9.8));
+    return std::size_t(6);
+}
+
+void SC_BENCH_FUNC(BM_throw_failure)(State& state)
+{
+    // 失敗するたびにメッセージの作成，ヒープの確保，スタックの巻き戻しが起きる (BM_Result_failureと比べる)
+    volatile bool fail = true;  // 定数として最適化されないように
+    while (state.keep_running())
+    {
+        try
+        {
+            do_not_optimize(read_throw(fail));
+        }
+        catch (const std::exception& e)
+        {
+            do_not_optimize(e.what()[0]);
+        }
+    }
+}
+SC_BENCHMARK(BM_throw_failure);
+
+void SC_BENCH_FUNC(BM_Result_failure_values)(State& state)
+{
+    // 異常な測定値を持たせても，数値をコピーするだけでフォーマットはしない
+    volatile float x = 51.0f;  // 定数として最適化されないように
+    while (state.keep_running())
+    {
+        const Error error(ErrorSource::BNO055, ErrorCode::InvalidValue, __FILE__, __LINE__, "accel", x, 0.0f, 9.8f);
+        do_not_optimize(error.values()[0]);
+    }
+    ErrorCounter::reset();
+}
+SC_BENCHMARK(BM_Result_failure_values);
+
+
+/***** 航法計算 *****/
+
+void SC_BENCH_FUNC(BM_LocalNavigator_set_goal)(State& state)
+{
+    LocalNavigator navigator(Latitude<Unit::deg>(35.0), Longitude<Unit::deg>(139.0));
+    while (state.keep_running())
+    {
+        navigator.set_goal(Latitude<Unit::deg>(35.681236), Longitude<Unit::deg>(139.767125));
+        do_not_optimize(navigator);
+    }
+}
+SC_BENCHMARK(BM_LocalNavigator_set_goal);
+
+void SC_BENCH_FUNC(BM_LocalNavigator_to_goal)(State& state)
+{
+    const LocalNavigator navigator(Latitude<Unit::deg>(35.681236), Longitude<Unit::deg>(139.767125));
+    Latitude<Unit::rad> lat = Latitude<Unit::deg>(35.680000);
+    Longitude<Unit::rad> lon = Longitude<Unit::deg>(139.765000);
+    while (state.keep_running())
+    {
+        do_not_optimize(lat);
+        do_not_optimize(lon);
+        do_not_optimize(navigator.to_goal(lat, lon));
+    }
+}
+SC_BENCHMARK(BM_LocalNavigator_to_goal);
+
+void SC_BENCH_FUNC(BM_distance_sphere)(State& state)
+{
+    // fm_long.cppと同じく，ゴールまでの距離を求める (引数はラジアン)
+    double t_lon = 139.767125 * M_PI / 180, t_lat = 35.681236 * M_PI / 180;
+    const double m_lon = 139.765000 * M_PI / 180, m_lat = 35.680000 * M_PI / 180;
+    while (state.keep_running())
+    {
+        do_not_optimize(t_lon);
+        do_not_optimize(t_lat);
+        do_not_optimize(distance_sphere(t_lon, t_lat, m_lon, m_lat));
+    }
+}
+SC_BENCHMARK(BM_distance_sphere);
+
+
+/***** 高度の推定 *****/
+
+void SC_BENCH_FUNC(BM_AltitudeFilter_step)(State& state)
+{
+    // 毎ループの処理と同じく，IMUで予測してからBME280の高度で更新する
+    AltitudeFilter filter;
+    filter.reset(Altitude<Unit::m>(0.0));
+    float altitude = 0.0F;
+    while (state.keep_running())
+    {
+        do_not_optimize(altitude);
+        filter.predict(dimension::m_s2(0.1), Time<Unit::s>(0.01));
+        filter.update(Altitude<Unit::m>(altitude));
+        do_not_optimize(filter);
+    }
+}
+SC_BENCHMARK(BM_AltitudeFilter_step);
+
+
+/***** センサの測定値の補正 *****/
+
+void SC_BENCH_FUNC(BM_BME280_compensate)(State& state)
+{
+    // BoschのBME280のデータシートの例の補正値 (decodeと同じく，気温，気圧，湿度の順に補正する)
+    BME280Compensation compensation;
+    compensation.dig_T1 = 27504; compensation.dig_T2 = 26435; compensation.dig_T3 = -1000;
+    compensation.dig_P1 = 36477; compensation.dig_P2 = -10685; compensation.dig_P3 = 3024;
+    compensation.dig_P4 = 2855; compensation.dig_P5 = 140; compensation.dig_P6 = -7;
+    compensation.dig_P7 = 15500; compensation.dig_P8 = -14600; compensation.dig_P9 = 6000;
+    compensation.dig_H1 = 75; compensation.dig_H2 = 369; compensation.dig_H3 = 0;
+    compensation.dig_H4 = 302; compensation.dig_H5 = 480; compensation.dig_H6 = -103;
+    int32_t adc_T = 519888, adc_P = 415148, adc_H = 30000;
+    while (state.keep_running())
+    {
+        do_not_optimize(adc_T);
+        do_not_optimize(adc_P);
+        do_not_optimize(adc_H);
+        do_not_optimize(compensation.temperature(adc_T));
+        do_not_optimize(compensation.pressure(adc_P));
+        do_not_optimize(compensation.humidity(adc_H));
+    }
+}
+SC_BENCHMARK(BM_BME280_compensate);
+
+
+/***** 無線機とカメラの文字列 *****/
+
+//! @brief 送信する機体の状態に似た32バイトのデータ
+Binary sample_twelite_data()
+{
+    std::basic_string<uint8_t> data(32, 0);
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    return Binary(data);
+}
+
+void SC_BENCH_FUNC(BM_Twelite_encode)(State& state)
+{
+    const Binary data = sample_twelite_data();
+    while (state.keep_running())
+    {
+        do_not_optimize(TweliteFrame::encode(0x00, data));
+    }
+}
+SC_BENCHMARK(BM_Twelite_encode);
+
+void SC_BENCH_FUNC(BM_Twelite_decode)(State& state)
+{
+    // 受信した文字列は書式を変換したものと同じ (2行分)
+    const std::string frames = TweliteFrame::encode(0x78, sample_twelite_data()) + TweliteFrame::encode(0x78, sample_twelite_data());
+    const Binary received(std::basic_string<uint8_t>(frames.begin(), frames.end()));
+    while (state.keep_running())
+    {
+        do_not_optimize(TweliteFrame::decode(received));
+    }
+}
+SC_BENCHMARK(BM_Twelite_decode);
+
+void SC_BENCH_FUNC(BM_Spresense_parse)(State& state)
+{
+    // Spresense::readの1回分 (緯度，経度，カメラの結果，時刻を1行ずつ)
+    const char lines[] = ":Lat35.6812360\r\n:Lon139.7671250\r\n:Cam2\r\n:Tim20241019123456\r\n";
+    const std::basic_string<uint8_t> received(lines, lines + sizeof(lines) - 1);
+    SpresenseMessage message;
+    while (state.keep_running())
+    {
+        std::size_t index = 0;
+        while ((index = SpresenseMessage::parse(received, index, message)) != std::string::npos)
+        {
+            do_not_optimize(message);
+        }
+    }
+}
+SC_BENCHMARK(BM_Spresense_parse);
+
+
+
+/***** ログの圧縮 *****/
+
+constexpr std::size_t SampleLogSize = 16 * 1024;  // 圧縮の範囲(2KB)より長くして，同じ文字列のくり返しで縮みすぎないようにする
+
+//! @brief 飛行中のログに似た16KBの文字列 (値は毎回同じ)
+const std::string& sample_log()
+{
+    static const std::string text = []
+    {
+        std::string log;
+        uint32_t seed = 1;
+        const auto noise = [&seed](){seed = seed * 1664525 + 1013904223; return double(seed >> 16) / 65536.0;};
+        while (log.size() < SampleLogSize)
+        {
+            log += format_str("bme:%f,%f,%f\n", 101325.0 + noise() * 20, 21.5 + noise() * 0.1, 45.0 + noise());
+            log += format_str("bno:%f,%f,%f\n", noise() - 0.5, noise() - 0.5, 9.8 + noise() * 0.1);
+            log += format_str("gps:%f,%f\n", 35.681236 + noise() * 1e-5, 139.767125 + noise() * 1e-5);
+        }
+        return log.substr(0, SampleLogSize);
+    }();
+    return text;
+}
+
+void SC_BENCH_FUNC(BM_Lzss_encode_1KB)(State& state)
+{
+    static LzssEncoder encoder;  // 約8KBあるのでスタックに置かない
+    const uint8_t* text = reinterpret_cast<const uint8_t*>(sample_log().data());
+    const uint64_t input = encoder.input_bytes(), output = encoder.output_bytes();
+    std::size_t offset = 0;
+    while (state.keep_running())
+    {
+        encoder.write(text + offset, 1024);  // 1回に1KBずつ，続きを圧縮する
+        offset = (offset + 1024) % SampleLogSize;
+    }
+    encoder.finish();
+    state.set_counter("compressed_percent", 100.0 * double(encoder.output_bytes() - output) / double(encoder.input_bytes() - input));
+}
+SC_BENCHMARK(BM_Lzss_encode_1KB);
+
+void SC_BENCH_FUNC(BM_Lzss_decode_1KB)(State& state)
+{
+    static std::vector<uint8_t> blocks;
+    if (blocks.empty())
+    {
+        static LzssEncoder encoder;
+        encoder.set_sink([](const uint8_t* block){blocks.insert(blocks.end(), block, block + LzssBlockSize);});
+        encoder.write(reinterpret_cast<const uint8_t*>(sample_log().data()), 1024);
+        encoder.finish();
+    }
+    static LzssDecoder decoder;
+    std::string text;
+    text.reserve(1024);
+    while (state.keep_running())
+    {
+        text.clear();
+        for (std::size_t i = 0; i < blocks.size(); i += LzssBlockSize)
+        {
+            decoder.decode_block(&blocks[i], text);
+        }
+        do_not_optimize(text.data());
+    }
+}
+SC_BENCHMARK(BM_Lzss_decode_1KB);
+
+
+
+/***** センサの測定値の差分の記録 *****/
+
+constexpr std::size_t SampleImuNum = 256;  // 用意するBNO055の測定の回数 (1ブロック(32回)より多くする)
+
+//! @brief 静止中のBNO055に似た測定値 (加速度，重力加速度，地磁気，角速度のxyz)
+const std::vector<std::array<float, 12>>& sample_imu()
+{
+    static const std::vector<std::array<float, 12>> samples = []
+    {
+        std::vector<std::array<float, 12>> imu(SampleImuNum);
+        uint32_t seed = 1;
+        const auto noise = [&seed](){seed = seed * 1664525 + 1013904223; return float(seed >> 16) / 65536.0f - 0.5f;};
+        for (auto& values : imu)
+        {
+            values = {0.05f * noise(), 0.05f * noise(), 0.05f * noise(), 0.3f + 0.02f * noise(), -0.2f + 0.02f * noise(), 9.79f + 0.02f * noise(),
+                      0.03f + 1e-4f * noise(), -0.01f + 1e-4f * noise(), 0.04f + 1e-4f * noise(), 0.004f * noise(), 0.004f * noise(), 0.004f * noise()};
+        }
+        return imu;
+    }();
+    return samples;
+}
+
+void SC_BENCH_FUNC(BM_Series_encode_BNO055)(State& state)
+{
+    static std::size_t output = 0;
+    static SeriesEncoder encoder(SeriesStream::BNO055, {-2, -2, -2, -2, -2, -2, -5, -5, -5, -3, -3, -3}, 32, [](const uint8_t*, std::size_t size){output += size;});
+    const auto& imu = sample_imu();
+    const uint64_t samples = encoder.samples(), bytes = encoder.output_bytes();
+    uint32_t time_ms = 0;
+    std::size_t index = 0;
+    while (state.keep_running())
+    {
+        encoder.add(time_ms, imu[index].data());  // 1回分(12チャンネル)を記録する
+        time_ms += 10;
+        index = (index + 1) % SampleImuNum;
+    }
+    encoder.flush();
+    state.set_counter("bytes_per_sample", double(encoder.output_bytes() - bytes) / double(encoder.samples() - samples));
+
+    // 同じ測定値をprintの文字列で記録したときのバイト数
+    std::size_t text = 0;
+    for (const auto& v : imu)
+    {
+        text += format_str("accel:%f,%f,%f\ngrv:%f,%f,%f\nmag:%f,%f,%f\ngyro:%f,%f,%f\n", v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10], v[11]).size();
+    }
+    state.set_counter("text_bytes_per_sample", double(text) / double(SampleImuNum));
+}
+SC_BENCHMARK(BM_Series_encode_BNO055);
+
+void SC_BENCH_FUNC(BM_Series_decode_BNO055)(State& state)
+{
+    static std::vector<uint8_t> blocks;
+    if (blocks.empty())
+    {
+        SeriesEncoder encoder(SeriesStream::BNO055, {-2, -2, -2, -2, -2, -2, -5, -5, -5, -3, -3, -3}, 32, [](const uint8_t* data, std::size_t size){blocks.insert(blocks.end(), data, data + size);});
+        for (std::size_t i = 0; i < SampleImuNum; ++i)
+        {
+            encoder.add(uint32_t(i * 10), sample_imu()[i].data());
+        }
+        encoder.flush();
+    }
+    std::vector<SeriesSample> samples;
+    samples.reserve(SampleImuNum);
+    while (state.keep_running())
+    {
+        samples.clear();
+        SeriesDecoder decoder;
+        decoder.decode(blocks.data(), blocks.size(), samples);  // 256回分を元に戻す
+        do_not_optimize(samples.data());
+    }
+}
+SC_BENCHMARK(BM_Series_decode_BNO055);
+
+}
@@ -0,0 +1,140 @@
+/**************************************************
+ * フラッシュ(XIP)のキャッシュが処理時間と割り込みの遅れに与える影響を測るためのコードです
+ *
+ * このファイルでは，XIPのキャッシュを空にした直後(ミッション中に別の処理がキャッシュを
+ * 追い出したときと同じ状態)に，毎ループの計算と割り込みハンドラを実行するベンチマークが定義されています．
+ * picoでしか実行できません．SC_BENCH_IN_RAMをON/OFFにした2つの結果をbench_diffで比べると，
+ * SRAMに置いたときにどれだけ速く，ばらつきが小さくなるかが分かります．
+ *   割り込みの遅れ : 割り込みを発生させてから，ハンドラの最初の命令を実行するまでのサイクル数
+ *                    isr_latency_max_cycles(最大値)とisr_jitter_cycles(最大値と最小値の差)も出力します
+**************************************************/
+
+//! @file bench_xip.cpp
+//! @brief XIPのキャッシュの影響のベンチマーク
+
+#include "bench.hpp"
+
+#include <algorithm>
+
+#include "hardware/irq.h"
+#include "hardware/regs/m0plus.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/xip_ctrl.h"
+
+#include "sc_basic.hpp"
+#include "altitude_filter.hpp"
+
+namespace
+{
+
+using namespace sc;
+using sc::bench::State;
+using sc::bench::do_not_optimize;
+
+constexpr uint32_t SysTickMask = 0x00FFFFFF;  // SysTickのカウンタのビット数
+
+volatile uint32_t IsrCycles = 0;  // ハンドラに入ったときのSysTickの値
+volatile bool IsrFired = false;  // ハンドラが呼ばれたか
+
+//! @brief XIPのキャッシュを空にする (次にフラッシュのコードを実行するとき，フラッシュから読み直す)
+void SC_BENCH_FUNC(flush_xip_cache)()
+{
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush;  // 読むと空になるまで待つ
+}
+
+//! @brief 割り込みハンドラ (SC_BENCH_IN_RAMのときはSRAMに置かれる)
+void SC_BENCH_FUNC(isr_handler)()
+{
+    IsrCycles = systick_hw->cvr;
+    IsrFired = true;
+}
+
+//! @brief ソフトウェアで発生させる割り込み (RP2040で使われていない26~31番)
+uint isr_irq()
+{
+    static int irq = -1;
+    if (irq < 0)
+    {
+        irq = ::user_irq_claim_unused(true);  // pico-SDKの関数  使われていない割り込み番号を確保
+        ::irq_set_exclusive_handler(irq, &isr_handler);  // pico-SDKの関数  割り込みハンドラを設定
+        ::irq_set_enabled(irq, true);  // pico-SDKの関数  割り込みを有効にする
+    }
+    return static_cast<uint>(irq);
+}
+
+//! @brief 割り込みを発生させ，ハンドラに入るまでのサイクル数を測る
+//! @param cold trueならXIPのキャッシュを空にしてから発生させる
+//! @note 測る区間でフラッシュのコードを実行しないように，irq_set_pendingではなくレジスタに直接書く
+void SC_BENCH_FUNC(isr_latency)(State& state, bool cold)
+{
+    const uint32_t pending = 1u << isr_irq();
+    io_rw_32* const ispr = reinterpret_cast<io_rw_32*>(PPB_BASE + M0PLUS_NVIC_ISPR_OFFSET);  // 割り込みを発生させるレジスタ
+    uint32_t min_cycles = SysTickMask;
+    uint32_t max_cycles = 0;
+    while (state.keep_running())
+    {
+        IsrFired = false;
+        if (cold)
+        {
+            flush_xip_cache();
+        }
+        const uint32_t start = systick_hw->cvr;  // SysTickは減っていくカウンタ
+        *ispr = pending;
+        while (!IsrFired)
+        {
+        }
+        const uint32_t cycles = (start - IsrCycles) & SysTickMask;
+        min_cycles = std::min(min_cycles, cycles);
+        max_cycles = std::max(max_cycles, cycles);
+    }
+    state.set_counter("isr_latency_max_cycles", max_cycles);
+    state.set_counter("isr_jitter_cycles", max_cycles - min_cycles);
+}
+
+
+/***** 毎ループの計算 *****/
+
+void SC_BENCH_FUNC(BM_AltitudeFilter_step_cold)(State& state)
+{
+    // BM_AltitudeFilter_stepと同じ計算を，毎回XIPのキャッシュを空にしてから行う
+    AltitudeFilter filter;
+    filter.reset(Altitude<Unit::m>(0.0));
+    float altitude = 0.0F;
+    while (state.keep_running())
+    {
+        flush_xip_cache();
+        do_not_optimize(altitude);
+        filter.predict(dimension::m_s2(0.1), Time<Unit::s>(0.01));
+        filter.update(Altitude<Unit::m>(altitude));
+        do_not_optimize(filter);
+    }
+}
+SC_BENCHMARK(BM_AltitudeFilter_step_cold);
+
+void SC_BENCH_FUNC(BM_xip_flush)(State& state)
+{
+    // BM_AltitudeFilter_step_coldから引くための，キャッシュを空にするだけの時間
+    while (state.keep_running())
+    {
+        flush_xip_cache();
+    }
+}
+SC_BENCHMARK(BM_xip_flush);
+
+
+/***** 割り込みの遅れ *****/
+
+void SC_BENCH_FUNC(BM_isr_latency)(State& state)
+{
+    isr_latency(state, false);
+}
+SC_BENCHMARK(BM_isr_latency);
+
+void SC_BENCH_FUNC(BM_isr_latency_cold)(State& state)
+{
+    isr_latency(state, true);
+}
+SC_BENCHMARK(BM_isr_latency_cold);
+
+}
@@ -0,0 +1,378 @@
+/**************************************************
+ * ファームウェアのどの関数がフラッシュ(XIP)とSRAMのどちらに置かれたかを調べるためのコードです
+ *
+ * picoのビルドで出力されるマップファイル(FM.elf.mapなど)を読み込み，
+ * メモリの領域(FLASH・RAM・SCRATCH_X・SCRATCH_Y)ごとにコードとデータの大きさを集計します．
+ * また，SRAMに置かれた関数(SC_ISR_FUNC・SC_HOT_FUNC・pico-SDKの__not_in_flash_funcで囲んだもの)を
+ * 大きい順に表示し，割り込みハンドラがSRAMに置かれているかを確かめます．
+ * 逆アセンブルの結果(arm-none-eabi-objdump -d -C FM.elf > FM.dis)も渡すと，割り込みハンドラから呼ばれる関数を
+ * たどり(blとbの行き先，フラッシュへの呼び出しはveneerの先まで)，フラッシュに置かれた関数を呼んでいないかも確かめます．
+ * 関数ポインタでの呼び出し(blx rNなど)は行き先が分からないので，どの関数にあるかだけを表示します．
+ *
+ *     ./MAP_REPORT FM.elf.map                         集計を表示
+ *     ./MAP_REPORT FM.elf.map --check                 割り込みハンドラがSRAMになければ終了コード1
+ *     ./MAP_REPORT FM.elf.map --check --isr=名前      確かめる関数を追加する (何回でも指定できる)
+ *     ./MAP_REPORT FM.elf.map --check --disasm=FM.dis 割り込みハンドラから呼ばれる関数がフラッシュにあっても終了コード1
+ *     ./MAP_REPORT FM.elf.map --check --disasm=FM.dis --allow=名前
+ *                                                     フラッシュにあってもよい関数を指定する (何回でも指定できる)
+**************************************************/
+
+//! @file map_report.cpp
+//! @brief マップファイルからコードの置き場所を集計
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//! @brief RP2040のメモリの領域 (pico-SDKのmemmap_default.ldと同じ)
+struct Region
+{
+    const char* name;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t code = 0;  // コードの大きさ (byte)
+    uint32_t data = 0;  // データの大きさ (byte)
+};
+
+//! @brief マップファイルの1つの入力セクション
+struct Section
+{
+    std::string name;  // .text.関数名 や .time_critical.関数名 など
+    uint32_t address;
+    uint32_t size;
+    std::string object;  // どのファイルから来たか
+};
+
+// SC_ISR_FUNCで囲んだ割り込みハンドラ (割り込みから最初に呼ばれる関数)
+const std::vector<std::string> DefaultIsrs = {
+    "AdcSampler::dma_handler",
+    "EdgeInput::gpio_callback",
+    "I2CAsync::irq_handler_0",
+    "I2CAsync::irq_handler_1",
+    "MotorActuator::timer_callback",
+    "Speaker::alarm_callback",
+    "UART::uart0_handler",
+    "UART::uart1_handler",
+};
+
+//! @brief 逆アセンブルの結果の1つの関数
+struct Function
+{
+    std::string name;  // C++の名前 (objdump -Cで戻したもの)
+    uint32_t address;
+    std::vector<uint32_t> calls;  // bl・bで呼ぶ関数の先頭のアドレス (他の関数の途中へのbは含めない)
+    std::vector<uint32_t> words;  // 関数の中のデータ (veneerの行き先)
+    int indirect = 0;  // 関数ポインタでの呼び出しの数
+};
+
+constexpr uint32_t FlashBegin = 0x10000000;  // XIPの領域
+constexpr uint32_t FlashEnd = 0x15000000;
+
+//! @brief 文字列がprefixで始まるか
+bool starts_with(const std::string& text, const std::string& prefix)
+{
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+//! @brief コードのセクションか (それ以外はデータとみなす)
+bool is_code(const std::string& name)
+{
+    return starts_with(name, ".text") || starts_with(name, ".time_critical") || starts_with(name, ".scratch_x") || starts_with(name, ".scratch_y")
+        || starts_with(name, ".boot2") || starts_with(name, ".vectors") || starts_with(name, ".init") || starts_with(name, ".fini");
+}
+
+//! @brief 入力セクションの行 " .name 0xaddress 0xsize object" を読む (名前が長いときは次の行に続く)
+bool parse_section(const std::string& line, std::istream& file, Section& section)
+{
+    if (line.size() < 2 || line[0] != ' ' || line[1] != '.')
+        return false;
+    std::istringstream head(line);
+    head >> section.name;
+    std::string address, size;
+    if (!(head >> address))
+    {
+        // 名前だけの行なので，アドレスと大きさは次の行
+        std::string next;
+        if (!std::getline(file, next))
+            return false;
+        std::istringstream tail(next);
+        if (!(tail >> address >> size))
+            return false;
+        std::getline(tail >> std::ws, section.object);
+    } else {
+        if (!(head >> size))
+            return false;
+        std::getline(head >> std::ws, section.object);
+    }
+    if (!starts_with(address, "0x") || !starts_with(size, "0x"))
+        return false;
+    section.address = static_cast<uint32_t>(std::strtoul(address.c_str(), nullptr, 16));
+    section.size = static_cast<uint32_t>(std::strtoul(size.c_str(), nullptr, 16));
+    return section.size > 0;
+}
+
+//! @brief objdump -d -Cの出力を読み，関数ごとの呼び出し先を集める
+//! @note "10001234 <name>:"が関数の始まり，"  10001236:\tf000 f801 \tbl\t10001240 <callee>"が命令の行
+std::map<uint32_t, Function> parse_disasm(std::istream& file)
+{
+    std::map<uint32_t, Function> functions;
+    Function* current = nullptr;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.size() > 11 && line[8] == ' ' && line[9] == '<' && line.compare(line.size() - 2, 2, ">:") == 0)
+        {
+            const uint32_t address = static_cast<uint32_t>(std::strtoul(line.substr(0, 8).c_str(), nullptr, 16));
+            current = &functions[address];
+            current->name = line.substr(10, line.size() - 12);
+            current->address = address;
+            continue;
+        }
+        if (current == nullptr)
+            continue;
+        // タブで区切られた 命令のアドレス，機械語，命令，オペランド
+        std::vector<std::string> fields;
+        std::istringstream columns(line);
+        for (std::string field; std::getline(columns, field, '\t');)
+            fields.push_back(field);
+        if (fields.size() < 3 || fields[0].empty() || fields[0].back() != ':')
+            continue;
+        std::string mnemonic = fields[2];
+        mnemonic.erase(mnemonic.find_last_not_of(' ') + 1);
+        const std::string operand = fields.size() > 3 ? fields[3] : "";
+        if (mnemonic == ".word")
+        {
+            current->words.push_back(static_cast<uint32_t>(std::strtoul(operand.c_str(), nullptr, 16)));
+        } else if (mnemonic == "bl" || mnemonic == "b" || mnemonic == "b.n" || mnemonic == "b.w" || mnemonic == "blx") {
+            if (!operand.empty() && operand[0] == 'r')
+            {
+                ++current->indirect;  // blx r3 など
+            } else {
+                current->calls.push_back(static_cast<uint32_t>(std::strtoul(operand.c_str(), nullptr, 16)));
+            }
+        } else if (mnemonic == "bx" && operand != "lr") {
+            ++current->indirect;  // bx r3 (関数ポインタへのジャンプ)
+        }
+    }
+    // bとbの行き先のうち，関数の先頭でないもの(関数の中の分岐)は除く
+    for (auto& [address, function] : functions)
+    {
+        std::vector<uint32_t> calls;
+        for (const uint32_t call : function.calls)
+        {
+            if (call != address && functions.count(call & ~1u) > 0)
+                calls.push_back(call & ~1u);
+        }
+        function.calls = calls;
+    }
+    return functions;
+}
+
+//! @brief 関数の置き場所 (フラッシュに置かれているか)
+bool in_flash(uint32_t address)
+{
+    return FlashBegin <= address && address < FlashEnd;
+}
+
+//! @brief 割り込みハンドラから呼ばれる関数をたどり，フラッシュに置かれた関数の呼び出しを表示する
+//! @return 許されていないフラッシュの関数の呼び出しの数 (割り込みハンドラが見つからなければそれも数える)
+int check_call_chain(const std::map<uint32_t, Function>& functions, const std::vector<std::string>& isrs, const std::vector<std::string>& allowed)
+{
+    const auto is_allowed = [&](const std::string& name)
+        {return std::any_of(allowed.begin(), allowed.end(), [&](const std::string& allow){return name.find(allow) != std::string::npos;});};
+
+    int errors = 0;
+    std::vector<uint32_t> queue;
+    std::set<uint32_t> visited;
+    std::printf("\nfunctions called from interrupt handlers\n");
+    for (const std::string& isr : isrs)
+    {
+        const auto found = std::find_if(functions.begin(), functions.end(), [&](const auto& entry){return entry.second.name.find(isr) != std::string::npos;});
+        if (found == functions.end())
+        {
+            std::printf("  %-6s %s\n", "none", isr.c_str());  // 逆アセンブルの結果にない
+            ++errors;
+            continue;
+        }
+        if (visited.insert(found->first).second)
+            queue.push_back(found->first);
+    }
+    while (!queue.empty())
+    {
+        const Function& caller = functions.at(queue.back());
+        queue.pop_back();
+        if (caller.indirect > 0)
+        {
+            std::printf("  %-6s %s (%d indirect call(s), not followed)\n", "ptr", caller.name.c_str(), caller.indirect);  // 関数ポインタの先はたどれない
+        }
+        for (uint32_t callee_address : caller.calls)
+        {
+            const Function* callee = &functions.at(callee_address);
+            // リンカが作るveneer(SRAMからフラッシュへの遠い呼び出し)は，データに書かれた行き先まで進める
+            if (callee->name.find("_veneer") != std::string::npos && !callee->words.empty())
+            {
+                const auto target = functions.find(callee->words.front() & ~1u);
+                if (target == functions.end())
+                {
+                    std::printf("  %-6s %s -> 0x%08lx\n", in_flash(callee->words.front()) ? "flash" : "rom", caller.name.c_str(), static_cast<unsigned long>(callee->words.front()));
+                    errors += in_flash(callee->words.front());
+                    continue;
+                }
+                callee = &target->second;
+            }
+            if (in_flash(callee->address))
+            {
+                const bool ok = is_allowed(callee->name);
+                std::printf("  %-6s %s -> %s\n", ok ? "allow" : "flash", caller.name.c_str(), callee->name.c_str());
+                errors += !ok;
+                continue;  // フラッシュの関数の先はたどらない
+            }
+            if (visited.insert(callee->address).second)
+                queue.push_back(callee->address);
+        }
+    }
+    std::printf("  %zu function(s) in SRAM reached\n", visited.size());
+    return errors;
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    const char* disasm_path = nullptr;
+    bool check = false;
+    std::vector<std::string> isrs = DefaultIsrs;
+    std::vector<std::string> allowed;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--check")
+        {
+            check = true;
+        } else if (starts_with(arg, "--isr=")) {
+            isrs.push_back(arg.substr(6));
+        } else if (starts_with(arg, "--disasm=")) {
+            disasm_path = argv[i] + 9;
+        } else if (starts_with(arg, "--allow=")) {
+            allowed.push_back(arg.substr(8));
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s FM.elf.map [--check] [--isr=name]... [--disasm=FM.dis [--allow=name]...]\n", argv[0]);
+        return 2;
+    }
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return 2;
+    }
+
+    std::vector<Region> regions = {
+        {"FLASH", 0x10000000, 0x10200000},
+        {"RAM", 0x20000000, 0x20040000},
+        {"SCRATCH_X", 0x20040000, 0x20041000},
+        {"SCRATCH_Y", 0x20041000, 0x20042000},
+    };
+    std::vector<Section> ram_code;  // SRAMに置かれたコード
+
+    // "Linker script and memory map" より前は，使われずに捨てられたセクションの一覧なので読み飛ばす
+    std::string line;
+    bool in_map = false;
+    while (std::getline(file, line))
+    {
+        if (!in_map)
+        {
+            in_map = starts_with(line, "Linker script and memory map");
+            continue;
+        }
+        Section section;
+        if (!parse_section(line, file, section))
+            continue;
+        const bool code = is_code(section.name);
+        for (Region& region : regions)
+        {
+            if (section.address < region.begin || section.address >= region.end)
+                continue;
+            (code ? region.code : region.data) += section.size;
+            if (code && region.begin != 0x10000000)
+            {
+                ram_code.push_back(section);
+            }
+        }
+    }
+    if (!in_map)
+    {
+        std::fprintf(stderr, "%s is not a GNU ld map file\n", path);  // マップファイルではありません
+        return 2;
+    }
+
+    std::printf("%-10s %10s %10s\n", "region", "code[B]", "data[B]");
+    for (const Region& region : regions)
+    {
+        std::printf("%-10s %10lu %10lu\n", region.name, static_cast<unsigned long>(region.code), static_cast<unsigned long>(region.data));
+    }
+
+    std::sort(ram_code.begin(), ram_code.end(), [](const Section& a, const Section& b){return a.size > b.size;});
+    std::printf("\ncode in SRAM (%zu sections)\n", ram_code.size());
+    for (const Section& section : ram_code)
+    {
+        std::printf("  0x%08lx %6lu  %s\n", static_cast<unsigned long>(section.address), static_cast<unsigned long>(section.size), section.name.c_str());
+    }
+
+    // 割り込みハンドラの名前がSRAMのセクション名(.time_critical.名前)に含まれているか
+    int missing = 0;
+    std::printf("\ninterrupt handlers\n");
+    for (const std::string& isr : isrs)
+    {
+        const bool in_ram = std::any_of(ram_code.begin(), ram_code.end(), [&](const Section& section){return section.name.find(isr) != std::string::npos;});
+        missing += !in_ram;
+        std::printf("  %-6s %s\n", in_ram ? "SRAM" : "flash", isr.c_str());
+    }
+
+    // 割り込みハンドラから呼ばれる関数もSRAMにあるか
+    int flash_calls = 0;
+    if (disasm_path != nullptr)
+    {
+        std::ifstream disasm(disasm_path);
+        if (!disasm)
+        {
+            std::fprintf(stderr, "Cannot open %s\n", disasm_path);  // ファイルを開けません
+            return 2;
+        }
+        const std::map<uint32_t, Function> functions = parse_disasm(disasm);
+        if (functions.empty())
+        {
+            std::fprintf(stderr, "%s is not an objdump -d output\n", disasm_path);  // 逆アセンブルの結果ではありません
+            return 2;
+        }
+        flash_calls = check_call_chain(functions, isrs, allowed);
+    }
+
+    if (check && missing > 0)
+    {
+        std::printf("%d interrupt handler(s) are still in flash (build with -DSC_HOT_IN_RAM=ON)\n", missing);  // フラッシュに残っている割り込みハンドラがあります
+        return 1;
+    }
+    if (check && flash_calls > 0)
+    {
+        std::printf("%d call(s) from interrupt handlers reach flash (wrap the callee with SC_ISR_FUNC or pass --allow=name)\n", flash_calls);  // 割り込みハンドラからフラッシュの関数を呼んでいます
+        return 1;
+    }
+    return 0;
+}
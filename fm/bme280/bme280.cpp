@@ -21,7 +21,8 @@ BME280::BME280(const I2C& i2c) try :
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
 
-    bme_init();
+    _init_deadline = get_absolute_time();
+    poll_init();  // リセットを送るだけで，起動は待たない
 }
 catch (const std::exception& e)
 {
@@ -29,39 +30,66 @@ catch (const std::exception& e)
 }
 
 void BME280::bme_init()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    _init_state = InitState::Reset;
+    _init_deadline = get_absolute_time();
+    wait_init();
+}
+
+void BME280::wait_init()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    while (!poll_init())
+    {
+        sleep_us(100);
+    }
+}
+
+bool BME280::poll_init()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (_init_state == InitState::Ready)
+        return true;
+    if (absolute_time_diff_us(get_absolute_time(), _init_deadline) > 0)
+        return false;  // まだ待つ
+
+    if (_init_state == InitState::Reset)
+    {
+        // 手動でリセットを実行 (応答がなくても，起動を待ってから設定を試す)
+        const uint8_t reset = 0xb6;
+        static_cast<void>(_i2c.try_write_memory(BinaryView(&reset, 1), SlaveAddr(_addr), MemoryAddr(0xe0)));
+        _init_state = InitState::Startup;
+        _init_deadline = make_timeout_time_us(StartupTime_us);
+        _startup_polls = 0;
+        return false;
+    }
+
+    // NVMから補正値をコピーしている間(statusのim_updateが1)は待つ (読めないときや，長く続くときは先に進む)
+    uint8_t status = 0;
+    if (try_read_registers(0xf3, &status, 1) && (status & 0x01) && ++_startup_polls < 20)
+    {
+        _init_deadline = make_timeout_time_us(200);
+        return false;
+    }
+    configure();
+    _init_state = InitState::Ready;
+    return true;
+}
+
+void BME280::configure()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     try 
     {
-        sleep_ms(5);
-
-        write_register(0xe0, 0xb6);  // 手動でリセットを実行
-        sleep_ms(5);
-
-        // this->i2c_no            = i2c_no;
-        // this->sda_pin           = sda_pin;
-        // this->scl_pin           = scl_pin;
-        // this->_addr           = addr;
-        // this->freq              = freq;
-        // measurement_reg.mode    = mode;
-        
-        // switch (i2c_no) {
-        //     case 0: i2c_hw = i2c0;
-        //             break;
-        //     case 1: i2c_hw = i2c1;
-        //             break;
-        //     default: return;
-        // }
-        // // initialize I2C access
-        // i2c_init(i2c_hw, freq);
-
-        //  // set all I2C GPIOs
-        // gpio_set_function(scl_pin, GPIO_FUNC_I2C);
-        // gpio_set_function(sda_pin, GPIO_FUNC_I2C);
-        // gpio_pull_up(scl_pin);
-        // gpio_pull_up(sda_pin);
         // See if SPI is working - interrograte the device for its I2C ID number, should be 0x60
         try
         {
@@ -73,12 +101,12 @@ void BME280::bme_init()
             print(e.what());
             chip_id = 0x60;
         }
-        
+    
         // // 標高を計算する基準点をセット
         // pressure0    = 1013.25; //hPa
         // temperature0 = 20; //`C
         // altitude0    = 0; //m
-    
+
         // read compensation params once
         read_compensation_parameters();
 
@@ -98,7 +126,7 @@ void BME280::bme_init()
             print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n\n********************\n", __FILE__, __LINE__);
             print(e.what());
         }
-    
+
     }
     catch(const std::exception& e)
     {
@@ -119,34 +147,128 @@ std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>> B
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    if (measurement_reg.mode == BME280::MODE::MODE_FORCED) {
-        write_register(0xf4, measurement_reg.get());
-        int count = 0;
-        uint8_t buffer;
-        do {
-            read_registers(0xf3, &buffer, 1);
-            sleep_ms(1);
-            if (++count > 100) break;
-        } while (buffer & 0x08); // loop until measurement completed
-    }
+    return try_read().value();  // 失敗したら例外を投げる
+}
+
+Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> BME280::try_read() {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("bme280_read");  // 処理時間を計測
+    wait_init();  // 初期化が終わっていなければ待つ
+    if (!try_trigger())
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);
     
     int32_t pressure[3], humidity[3], temperature[3];
 
     // 3回測定
     for (int i=0; i<3; ++i)
     {
-        bme280_read_raw(&(humidity[i]), &(pressure[i]), &(temperature[i]));
+        if (!try_read_raw(&(humidity[i]), &(pressure[i]), &(temperature[i])))
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);
         sleep_ms(10);
     }
 
+    return decode(pressure, humidity, temperature);
+}
+
+Result<void> BME280::request(I2CAsync& i2c_async) {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (_i2c_async != nullptr && !ready())
+return Error(ErrorSource::BME280, ErrorCode::Busy, __FILE__, __LINE__);  // 前回予約した受信がまだ終わっていません
+    wait_init();  // 初期化が終わっていなければ待つ
+    if (!try_trigger())
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);
+
+    for (std::size_t i=0; i<_raw_data.size(); ++i)
+    {
+        _raw_data[i].resize(RawSize);
+        const Result<void> result = i2c_async.read_memory(_transfers[i], _raw_data[i], SlaveAddr(_addr), MemoryAddr(0xF7));
+        if (!result)
+        {
+            while (!ready())  // 予約できた分は，受信が終わるのを待ってから取り消す
+            {
+                i2c_async.update();
+            }
+            _i2c_async = nullptr;
+return result;
+        }
+    }
+    _i2c_async = &i2c_async;
+    return {};
+}
+
+bool BME280::ready() const {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    for (const I2CAsync::Transfer& transfer : _transfers)
+    {
+        if (transfer.status() == I2CAsync::Status::Queued || transfer.status() == I2CAsync::Status::Running)
+return false;
+    }
+    return true;
+}
+
+Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> BME280::try_collect() {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("bme280_collect");  // 処理時間を計測
+    if (_i2c_async == nullptr)
+return Error(ErrorSource::BME280, ErrorCode::NoData, __FILE__, __LINE__);  // 受信が予約されていません
+
+    while (!ready())
+    {
+        _i2c_async->update();  // タイムアウトを確認しながら待つ
+    }
+    _i2c_async = nullptr;
+
+    int32_t pressure[3], humidity[3], temperature[3];
+    for (std::size_t i=0; i<_raw_data.size(); ++i)
+    {
+        if (_transfers[i].status() != I2CAsync::Status::Done || _transfers[i].size() != RawSize)
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);  // BME280からの受信に失敗しました
+        parse_raw(_raw_data[i].data(), &(humidity[i]), &(pressure[i]), &(temperature[i]));
+    }
+    return decode(pressure, humidity, temperature);
+}
+
+Result<void> BME280::try_trigger() {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (measurement_reg.mode == BME280::MODE::MODE_FORCED) {
+        const uint8_t ctrl_meas = measurement_reg.get();
+        if (!_i2c.try_write_memory(BinaryView(&ctrl_meas, 1), SlaveAddr(_addr), MemoryAddr(0xf4)))
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);  // BME280との通信に失敗しました
+        int count = 0;
+        uint8_t buffer;
+        do {
+            if (!try_read_registers(0xf3, &buffer, 1))
+return Error(ErrorSource::BME280, ErrorCode::BusFailed, __FILE__, __LINE__);  // BME280との通信に失敗しました
+            sleep_ms(1);
+            if (++count > 100) break;
+        } while (buffer & 0x08); // loop until measurement completed
+    }
+    return {};
+}
+
+Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> BME280::decode(const int32_t pressure[3], const int32_t humidity[3], const int32_t temperature[3]) {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
     // 中央値を求める
     int32_t pressure_m = median(pressure[0], pressure[1], pressure[2]);
     int32_t humidity_m = median(humidity[0], humidity[1], humidity[2]);
     int32_t temperature_m = median(temperature[0], temperature[1], temperature[2]);
 
-    pressure_m = compensate_pressure(pressure_m);
-    humidity_m = compensate_humidity(humidity_m);
-    temperature_m = compensate_temp(temperature_m);
+    // 気圧と湿度の補正には気温の補正で求めたt_fineを使うので，気温を先に補正する
+    temperature_m = _compensation.temperature(temperature_m);
+    pressure_m = _compensation.pressure(pressure_m);
+    humidity_m = _compensation.humidity(humidity_m);
 
     Pressure<Unit::Pa>pressure_Pa(pressure_m);
     Humidity<Unit::percent>humidity_percent(humidity_m/1024.0);
@@ -166,7 +288,7 @@ std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>> B
     static double last_temp;
     if (last_pres==double(pressure_Pa) && last_hum==double(humidity_percent) && last_temp==double(temperature_degC))
     {
-        print("!!reinitialize BME!!\n");  // BMEを再び初期化します
+        print(LogLevel::Error, LogModule::BME280, "!!reinitialize BME!!\n");  // BMEを再び初期化します
         bme_init();  // 再度初期化
         sleep_ms(100);
     }
@@ -176,11 +298,16 @@ std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>> B
 
     if (double(pressure_Pa) < 900*100 || 1100*100 < double(pressure_Pa) || double(humidity_percent) <= 0 || 100 <= double(humidity_percent) || double(temperature_degC) < -20 || 50 < double(temperature_degC))
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "BME280 measurement value is abnormal:%f,%f,%f", double(pressure_Pa), double(humidity_percent), double(temperature_degC)));  // BME280の測定値が異常です
+return Error(ErrorSource::BME280, ErrorCode::InvalidValue, __FILE__, __LINE__, "pres,humi,temp", float(double(pressure_Pa)), float(double(humidity_percent)), float(double(temperature_degC)));  // BME280の測定値が異常です
+    }
+    if (series)
+    {
+        series->add(to_ms_since_boot(get_absolute_time()), {float(double(pressure_Pa)), float(double(humidity_percent)), float(double(temperature_degC))});
+    } else {
+        print(LogLevel::Data, LogModule::BME280, "pres:%f\nhumi:%f\nbme_temp%f\n", double(pressure_Pa), double(humidity_percent), double(temperature_degC));
     }
-    print("pres:%f\nhumi:%f\nbme_temp%f\n", double(pressure_Pa), double(humidity_percent), double(temperature_degC));
 
-    return {pressure_Pa,humidity_percent,temperature_degC};
+    return std::tuple(pressure_Pa,humidity_percent,temperature_degC);
 
 }
 
@@ -188,67 +315,6 @@ uint8_t BME280::get_chipID() {
     return chip_id;
 }
 
-// for the compensate_functions read the Bosch information on the BME280
-int32_t BME280::compensate_temp(int32_t adc_T) {
-    #ifndef NODEBUG
-        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
-    #endif
-    int32_t var1, var2, T;
-    var1 = ((((adc_T >> 3) - ((int32_t) dig_T1 << 1))) * ((int32_t) dig_T2)) >> 11;
-    var2 = (((((adc_T >> 4) - ((int32_t) dig_T1)) * ((adc_T >> 4) - ((int32_t) dig_T1))) >> 12) * ((int32_t) dig_T3))
-            >> 14;
-
-    t_fine = var1 + var2;
-    T = (t_fine * 5 + 128) >> 8;
-    return T;
-}
-
-uint32_t BME280::compensate_pressure(int32_t adc_P) {
-    #ifndef NODEBUG
-        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
-    #endif
-    int32_t var1, var2;
-    uint32_t p;
-    var1 = (((int32_t) t_fine) >> 1) - (int32_t) 64000;
-    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t) dig_P6);
-    var2 = var2 + ((var1 * ((int32_t) dig_P5)) << 1);
-    var2 = (var2 >> 2) + (((int32_t) dig_P4) << 16);
-    var1 = (((dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t) dig_P2) * var1) >> 1)) >> 18;
-    var1 = ((((32768 + var1)) * ((int32_t) dig_P1)) >> 15);
-    if (var1 == 0)
-        return 0;
-
-    p = (((uint32_t) (((int32_t) 1048576) - adc_P) - (var2 >> 12))) * 3125;
-    if (p < 0x80000000)
-        p = (p << 1) / ((uint32_t) var1);
-    else
-        p = (p / (uint32_t) var1) * 2;
-
-    var1 = (((int32_t) dig_P9) * ((int32_t) (((p >> 3) * (p >> 3)) >> 13))) >> 12;
-    var2 = (((int32_t) (p >> 2)) * ((int32_t) dig_P8)) >> 13;
-    p = (uint32_t) ((int32_t) p + ((var1 + var2 + dig_P7) >> 4));
-
-    return p;
-}
-
-uint32_t BME280::compensate_humidity(int32_t adc_H) {
-    #ifndef NODEBUG
-        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
-    #endif
-    int32_t v_x1_u32r;
-    v_x1_u32r = (t_fine - ((int32_t) 76800));
-    v_x1_u32r = (((((adc_H << 14) - (((int32_t) dig_H4) << 20) - (((int32_t) dig_H5) * v_x1_u32r)) +
-                   ((int32_t) 16384)) >> 15) * (((((((v_x1_u32r * ((int32_t) dig_H6)) >> 10) * (((v_x1_u32r *
-                                                                                                  ((int32_t) dig_H3))
-            >> 11) + ((int32_t) 32768))) >> 10) + ((int32_t) 2097152)) *
-                                                 ((int32_t) dig_H2) + 8192) >> 14));
-    v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t) dig_H1)) >> 4));
-    v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-    v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
-
-    return (uint32_t) (v_x1_u32r >> 12);
-}
-
 void BME280::write_register(uint8_t reg, uint8_t data) {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -259,7 +325,7 @@ void BME280::write_register(uint8_t reg, uint8_t data) {
     buf[1] = data;
     // i2c_write_blocking(i2c_hw, _addr, buf, 2, true);
     // sleep_ms(10);
-    _i2c.write_memory(Binary(buf[1]),SlaveAddr(_addr),MemoryAddr(buf[0]));
+    _i2c.write_memory(BinaryView(&buf[1], 1),SlaveAddr(_addr),MemoryAddr(buf[0]));
 }
 
 void BME280::read_registers(uint8_t reg, uint8_t *buf, uint16_t len) {
@@ -274,8 +340,19 @@ void BME280::read_registers(uint8_t reg, uint8_t *buf, uint16_t len) {
     // sleep_ms(10);
     // i2c_read_blocking(i2c_hw, _addr, buf, len, false);
     // sleep_ms(10);
-    Binary b = _i2c.read_memory(size_t(len),SlaveAddr(_addr),MemoryAddr(reg));
-    b.to_assign(buf);
+    _i2c.read_memory(buf, size_t(len), SlaveAddr(_addr), MemoryAddr(reg));  // bufに直接受信する
+}
+
+Result<void> BME280::try_read_registers(uint8_t reg, uint8_t *buf, uint16_t len) {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    const Result<std::size_t> input_size = _i2c.try_read_memory(buf, size_t(len), SlaveAddr(_addr), MemoryAddr(reg));  // bufに直接受信する
+    if (!input_size)
+return input_size.error();
+    if (*input_size != len)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // 足りない分は古い値のままになるので失敗とする
+    return {};
 }
 
 
@@ -289,52 +366,52 @@ void BME280::read_compensation_parameters() {
     {
         read_registers(0x88, buffer, 26);
 
-        dig_T1 = buffer[0] | (buffer[1] << 8);
-        dig_T2 = buffer[2] | (buffer[3] << 8);
-        dig_T3 = buffer[4] | (buffer[5] << 8);
+        _compensation.dig_T1 = buffer[0] | (buffer[1] << 8);
+        _compensation.dig_T2 = buffer[2] | (buffer[3] << 8);
+        _compensation.dig_T3 = buffer[4] | (buffer[5] << 8);
 
-        dig_P1 = buffer[6] | (buffer[7] << 8);
-        dig_P2 = buffer[8] | (buffer[9] << 8);
-        dig_P3 = buffer[10] | (buffer[11] << 8);
-        dig_P4 = buffer[12] | (buffer[13] << 8);
-        dig_P5 = buffer[14] | (buffer[15] << 8);
-        dig_P6 = buffer[16] | (buffer[17] << 8);
-        dig_P7 = buffer[18] | (buffer[19] << 8);
-        dig_P8 = buffer[20] | (buffer[21] << 8);
-        dig_P9 = buffer[22] | (buffer[23] << 8);
+        _compensation.dig_P1 = buffer[6] | (buffer[7] << 8);
+        _compensation.dig_P2 = buffer[8] | (buffer[9] << 8);
+        _compensation.dig_P3 = buffer[10] | (buffer[11] << 8);
+        _compensation.dig_P4 = buffer[12] | (buffer[13] << 8);
+        _compensation.dig_P5 = buffer[14] | (buffer[15] << 8);
+        _compensation.dig_P6 = buffer[16] | (buffer[17] << 8);
+        _compensation.dig_P7 = buffer[18] | (buffer[19] << 8);
+        _compensation.dig_P8 = buffer[20] | (buffer[21] << 8);
+        _compensation.dig_P9 = buffer[22] | (buffer[23] << 8);
 
-        dig_H1 = buffer[25];
+        _compensation.dig_H1 = buffer[25];
 
         read_registers(0xE1, buffer, 8);
 
-        dig_H2 = buffer[0] | (buffer[1] << 8);
-        dig_H3 = (int8_t) buffer[2];
-        dig_H4 = buffer[3] << 4 | (buffer[4] & 0xf);
-        dig_H5 = (buffer[5] >> 4) | (buffer[6] << 4);
-        dig_H6 = (int8_t) buffer[7];
+        _compensation.dig_H2 = buffer[0] | (buffer[1] << 8);
+        _compensation.dig_H3 = (int8_t) buffer[2];
+        _compensation.dig_H4 = buffer[3] << 4 | (buffer[4] & 0xf);
+        _compensation.dig_H5 = (buffer[5] >> 4) | (buffer[6] << 4);
+        _compensation.dig_H6 = (int8_t) buffer[7];
     }
     catch(const std::exception& e)
     {
         print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n\n********************\n", __FILE__, __LINE__);
         print(e.what());
-        dig_T1 = 28129;
-        dig_T2 = 26436;
-        dig_T3 = 50;
-        dig_P1 = 38299;
-        dig_P2 = -10600;
-        dig_P3 = 3024;
-        dig_P4 = 10670;
-        dig_P5 = -305;
-        dig_P6 = -7;
-        dig_P7 = 9900;
-        dig_P8 = -10230;
-        dig_P9 = 4285;
-        dig_H1 = 75;
-        dig_H2 = 369;
-        dig_H3 = 0;
-        dig_H4 = 302;
-        dig_H5 = 480;
-        dig_H6 = -103;
+        _compensation.dig_T1 = 28129;
+        _compensation.dig_T2 = 26436;
+        _compensation.dig_T3 = 50;
+        _compensation.dig_P1 = 38299;
+        _compensation.dig_P2 = -10600;
+        _compensation.dig_P3 = 3024;
+        _compensation.dig_P4 = 10670;
+        _compensation.dig_P5 = -305;
+        _compensation.dig_P6 = -7;
+        _compensation.dig_P7 = 9900;
+        _compensation.dig_P8 = -10230;
+        _compensation.dig_P9 = 4285;
+        _compensation.dig_H1 = 75;
+        _compensation.dig_H2 = 369;
+        _compensation.dig_H3 = 0;
+        _compensation.dig_H4 = 302;
+        _compensation.dig_H5 = 480;
+        _compensation.dig_H6 = -103;
     }
 }
 
@@ -343,10 +420,24 @@ void BME280::bme280_read_raw(int32_t *humidity, int32_t *pressure, int32_t *temp
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    uint8_t readBuffer[8];
-    read_registers(0xF7, readBuffer, 8);
-    *pressure = ((uint32_t) readBuffer[0] << 12) | ((uint32_t) readBuffer[1] << 4) | (readBuffer[2] >> 4);
-    *temperature = ((uint32_t) readBuffer[3] << 12) | ((uint32_t) readBuffer[4] << 4) | (readBuffer[5] >> 4);
-    *humidity = (uint32_t) readBuffer[6] << 8 | readBuffer[7];
+    try_read_raw(humidity, pressure, temperature).value();
+}
+
+Result<void> BME280::try_read_raw(int32_t *humidity, int32_t *pressure, int32_t *temperature) {
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    uint8_t readBuffer[RawSize];
+    const Result<void> result = try_read_registers(0xF7, readBuffer, RawSize);
+    if (!result)
+return result;
+    parse_raw(readBuffer, humidity, pressure, temperature);
+    return {};
+}
+
+void BME280::parse_raw(const uint8_t *buf, int32_t *humidity, int32_t *pressure, int32_t *temperature) {
+    *pressure = ((uint32_t) buf[0] << 12) | ((uint32_t) buf[1] << 4) | (buf[2] >> 4);
+    *temperature = ((uint32_t) buf[3] << 12) | ((uint32_t) buf[4] << 4) | (buf[5] >> 4);
+    *humidity = (uint32_t) buf[6] << 8 | buf[7];
 }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <array>
 #include <cmath>
 #include <tuple>
 #include "pico/stdlib.h"
@@ -9,6 +10,8 @@
 #include "hardware/i2c.h"
 #include "sc.hpp"
 
+#include "bme280_compensation.hpp"
+
 
 
 /* The following compensation functions are required to convert from the raw ADC
@@ -26,17 +29,7 @@ public:
                 MODE_NORMAL = 0b11};
 private:
     const uint READ_BIT = 0x80;
-    int32_t     t_fine;
-    //T1-T3は温度用
-    uint16_t    dig_T1;
-    int16_t     dig_T2, dig_T3;
-    //P1-P9は気圧用
-    uint16_t    dig_P1;
-    int16_t     dig_P2, dig_P3, dig_P4, dig_P5, dig_P6, dig_P7, dig_P8, dig_P9;
-    //H1-H6は湿度用
-    uint8_t     dig_H1, dig_H3;
-    int8_t      dig_H6;
-    int16_t     dig_H2, dig_H4, dig_H5;
+    BME280Compensation _compensation;  // 補正値と補正の計算 (ホストでもコンパイルできるよう，bme280_compensation.hppに分けてある)
     int32_t     adc_T, adc_P, adc_H;
 
     float       pressure0;
@@ -53,6 +46,23 @@ private:
     uint8_t chip_id;
     MODE mode;
 
+    static constexpr std::size_t RawSize = 8;  // 気圧，気温，湿度のレジスタ(0xF7～0xFE)のバイト数
+    std::array<StaticBinary<RawSize>, 3> _raw_data;  // 予約した受信のデータを書き込む場所
+    std::array<I2CAsync::Transfer, 3> _transfers;  // 予約した受信
+    I2CAsync* _i2c_async = nullptr;  // 受信を予約したI2CAsync (予約していないときはnullptr)
+
+    //! @brief 初期化の進み具合
+    enum class InitState
+    {
+        Reset,  // リセットを送る
+        Startup,  // リセット後の起動(NVMからの補正値のコピー)を待つ
+        Ready  // 測定できる
+    };
+    static constexpr uint32_t StartupTime_us = 2000;  // リセットしてから起動するまでの時間 (データシートでは2ms)
+    InitState _init_state = InitState::Reset;
+    absolute_time_t _init_deadline;  // この時刻になったら初期化を次に進める
+    int _startup_polls = 0;  // 起動を待つために状態を確かめた回数
+
 struct MeasurementControl_t {
     // temperature oversampling
     // 000 = skipped
@@ -95,6 +105,22 @@ public:
 
     std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>> read();
 
+    //! @brief 気圧，湿度，気温を測定 (失敗しても例外を投げない)
+    //! @return 測定値か，エラー
+    Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> try_read();
+
+    //! @brief 測定値の受信を予約 (待機しない)
+    //! @param i2c_async 受信に使うI2CAsync (このBME280と同じI2Cのもの)
+    //! @return 予約できたか，エラー
+    Result<void> request(I2CAsync& i2c_async);
+
+    //! @brief 予約した受信が終わったか
+    bool ready() const;
+
+    //! @brief 予約した受信が終わるのを待ち，測定値に変換 (失敗しても例外を投げない)
+    //! @return 測定値か，エラー
+    Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> try_collect();
+
     // float temperature;
     // float pressure;
     // float humidity;
@@ -115,6 +141,16 @@ public:
     */
     BME280(const I2C& i2c);
 
+    //! @brief 初期化を進める (待機しない)
+    //! @note コンストラクタはリセットを送るだけで戻るので，ほかのデバイスの初期化と並行して，準備ができるまでこれを繰り返し呼ぶ
+    //! @note 準備ができる前にread()などを呼んだときは，そこで準備ができるまで待ちます
+    //! @return 測定できる状態になったか
+    bool poll_init();
+
+
+    //! @brief 測定値の記録先 (気圧 0.1Pa，湿度 0.01%，気温 0.01°Cの3チャンネル)
+    //! @note 設定すると，測定値を文字列でprintせずにここに記録します (nullptrなら今まで通りprint)
+    static inline SeriesEncoder* series = nullptr;
 
     // get sensor values from BME280
     // Measurement_t measure();
@@ -125,16 +161,20 @@ public:
 
 private:
     // auxilliary functions
-    int32_t     compensate_temp(int32_t adc_T);
-    uint32_t    compensate_pressure(int32_t adc_P); 
-    uint32_t    compensate_humidity(int32_t adc_H);
     void        bme280_read_raw(int32_t *humidity, int32_t *pressure, int32_t *temperature);
     void        write_register(uint8_t reg, uint8_t data);
     void        read_registers(uint8_t reg, uint8_t *buf, uint16_t len);
+    Result<void> try_read_raw(int32_t *humidity, int32_t *pressure, int32_t *temperature);
+    Result<void> try_read_registers(uint8_t reg, uint8_t *buf, uint16_t len);
+    Result<void> try_trigger();  // forcedモードのときは測定を開始して終わるまで待つ
+    static void  parse_raw(const uint8_t *buf, int32_t *humidity, int32_t *pressure, int32_t *temperature);
+    Result<std::tuple<Pressure<Unit::Pa>,Humidity<Unit::percent>,Temperature<Unit::degC>>> decode(const int32_t pressure[3], const int32_t humidity[3], const int32_t temperature[3]);
     /* This function reads the manufacturing assigned compensation parameters from the device */
     void        read_compensation_parameters(); 
 
-    void bme_init();
+    void bme_init();  // リセットして，準備ができるまで待つ
+    void wait_init();  // 準備ができるまで待つ
+    void configure();  // 補正値を読み，測定の設定を書き込む
 };
 
 }
\ No newline at end of file
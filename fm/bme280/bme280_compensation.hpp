@@ -0,0 +1,55 @@
+#ifndef SC19_PICO_BME280_COMPENSATION_HPP_
+#define SC19_PICO_BME280_COMPENSATION_HPP_
+
+/**************************************************
+ * BME280の測定値を補正するためのコードです
+ * このファイルは，bme280_compensation.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，BME280のADCの値を，チップごとの補正値を使って気温，気圧，湿度に変換するクラスが宣言されています．
+ * 通信を使わない計算だけなので，PC(ベンチマークなど)でもコンパイルできます．
+**************************************************/
+
+//! @file bme280_compensation.hpp
+//! @brief BME280の測定値の補正
+
+#include "sc_basic.hpp"
+
+namespace sc
+{
+
+//! @brief BME280の補正値と，補正の計算 (BoschのBME280のデータシートの32ビット整数版)
+//! @note 気圧と湿度の補正には気温の補正で求めたt_fineを使うので，先にtemperatureを呼んでください
+struct BME280Compensation
+{
+    //T1-T3は気温用
+    uint16_t    dig_T1 = 0;
+    int16_t     dig_T2 = 0, dig_T3 = 0;
+    //P1-P9は気圧用
+    uint16_t    dig_P1 = 0;
+    int16_t     dig_P2 = 0, dig_P3 = 0, dig_P4 = 0, dig_P5 = 0, dig_P6 = 0, dig_P7 = 0, dig_P8 = 0, dig_P9 = 0;
+    //H1-H6は湿度用
+    uint8_t     dig_H1 = 0, dig_H3 = 0;
+    int8_t      dig_H6 = 0;
+    int16_t     dig_H2 = 0, dig_H4 = 0, dig_H5 = 0;
+
+    int32_t     t_fine = 0;  // 気温の補正の途中の値 (気圧と湿度の補正に使う)
+
+    //! @brief 気温を補正する (t_fineも更新する)
+    //! @param adc_T 気温のADCの値
+    //! @return 気温 (0.01°C)
+    int32_t temperature(int32_t adc_T);
+
+    //! @brief 気圧を補正する
+    //! @param adc_P 気圧のADCの値
+    //! @return 気圧 (Pa)
+    uint32_t pressure(int32_t adc_P) const;
+
+    //! @brief 湿度を補正する
+    //! @param adc_H 湿度のADCの値
+    //! @return 湿度 (1/1024 %)
+    uint32_t humidity(int32_t adc_H) const;
+};
+
+}
+
+#endif  // SC19_PICO_BME280_COMPENSATION_HPP_
@@ -64,8 +64,9 @@ BNO055::BNO055(const I2C& i2c) try :
         // gpio_pull_up(6);
         // gpio_pull_up(7);
 
-        // Call accelerometer initialisation function
-        accel_init();
+        // 起動を待たずに戻る (初期化はpoll_initで進める)
+        _init_deadline = get_absolute_time();
+        poll_init();
 
     }
     catch(const std::exception& e)
@@ -82,58 +83,131 @@ std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
+    return try_read().value();  // 失敗したら例外を投げる
+}
 
-    int16_t magX[3], magY[3], magZ[3];  // 磁気
-    int16_t gyroX[3], gyroY[3], gyroZ[3];  // ジャイロ
-    int16_t grvX[3], grvY[3], grvZ[3];  // 重力加速度
-    int16_t accelX[3], accelY[3], accelZ[3];  // 線形加速度
-    
-    constexpr uint8_t accel_val = 0x28; // 線形加速度のメモリアドレス
+Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> BNO055::try_read(){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("bno055_read");  // 処理時間を計測
+    wait_init();  // 初期化が終わっていなければ待つ
 
-    //線形加速度を読み取る
-    for (int i=0; i<3; ++i)
+    // 地磁気から重力加速度までを1回の通信でまとめて読む
+    std::array<Sample, SampleNum> samples;  // スタック上に受信する (動的メモリを使わない)
+    for (Sample& sample : samples)
     {
-        Binary accel = _i2c.read_memory(size_t(6), SlaveAddr(addr), MemoryAddr(accel_val));
-
-        accelX[i] = ((accel[1]<<8) | accel[0]);
-        accelY[i] = ((accel[3]<<8) | accel[2]);
-        accelZ[i] = ((accel[5]<<8) | accel[4]);
+        if (!_i2c.try_read_memory(sample, SlaveAddr(addr), MemoryAddr(BurstAddr)) || sample.size() != BurstSize)
+return Error(ErrorSource::BNO055, ErrorCode::BusFailed, __FILE__, __LINE__);  // BNO055からの受信に失敗しました
 
         sleep_ms(1);
     }
 
-    double d_accelX = median(accelX[0], accelX[1], accelX[2]) / 100.00;
-    double d_accelY = median(accelY[0], accelY[1], accelY[2]) / 100.00;
-    double d_accelZ = median(accelZ[0], accelZ[1], accelZ[2]) / 100.00;
+    return decode(samples);
+}
 
-    if (std::abs(d_accelX) > 50 || std::abs(d_accelY) > 50 || std::abs(d_accelZ) > 50)
+Result<void> BNO055::request(I2CAsync& i2c_async){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (_i2c_async != nullptr && !ready())
+return Error(ErrorSource::BNO055, ErrorCode::Busy, __FILE__, __LINE__);  // 前回予約した受信がまだ終わっていません
+    wait_init();  // 初期化が終わっていなければ待つ
+
+    for (std::size_t i=0; i<SampleNum; ++i)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal. accel:%f, %f, %f", d_accelX, d_accelY, d_accelZ));  // BNO055の測定値が異常です
+        _samples[i].resize(BurstSize);
+        const Result<void> result = i2c_async.read_memory(_transfers[i], _samples[i], SlaveAddr(addr), MemoryAddr(BurstAddr));
+        if (!result)
+        {
+            while (!ready())  // 予約できた分は，受信が終わるのを待ってから取り消す
+            {
+                i2c_async.update();
+            }
+            _i2c_async = nullptr;
+return result;
+        }
     }
+    _i2c_async = &i2c_async;
+    return {};
+}
 
-    Acceleration<Unit::m_s2>accel_vector{dimension::m_s2(d_accelX),dimension::m_s2(d_accelY),dimension::m_s2(d_accelZ)};
+bool BNO055::ready() const{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    for (const I2CAsync::Transfer& transfer : _transfers)
+    {
+        if (transfer.status() == I2CAsync::Status::Queued || transfer.status() == I2CAsync::Status::Running)
+return false;
+    }
+    return true;
+}
 
-    constexpr uint8_t grv_val = 0x2E; // 重力加速度のメモリアドレス
+Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> BNO055::try_collect(){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("bno055_collect");  // 処理時間を計測
+    if (_i2c_async == nullptr)
+return Error(ErrorSource::BNO055, ErrorCode::NoData, __FILE__, __LINE__);  // 受信が予約されていません
 
-    //重力加速度
-    for (int i=0; i<3; ++i)
+    while (!ready())
     {
-        Binary grv = _i2c.read_memory(size_t(6), SlaveAddr(addr), MemoryAddr(grv_val));
+        _i2c_async->update();  // タイムアウトを確認しながら待つ
+    }
+    _i2c_async = nullptr;
 
-        grvX[i] = ((grv[1]<<8) | grv[0]);
-        grvY[i] = ((grv[3]<<8) | grv[2]);
-        grvZ[i] = ((grv[5]<<8) | grv[4]);
+    for (const I2CAsync::Transfer& transfer : _transfers)
+    {
+        if (transfer.status() != I2CAsync::Status::Done || transfer.size() != BurstSize)
+return Error(ErrorSource::BNO055, ErrorCode::BusFailed, __FILE__, __LINE__);  // BNO055からの受信に失敗しました
+    }
 
-        sleep_ms(1);
+    return decode(_samples);
+}
+
+Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> BNO055::decode(const std::array<Sample, SampleNum>& samples){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+
+    // 3回分の測定値の中央値 (各軸2バイトで，下位バイトが先)
+    auto median_of = [&](uint8_t memory_addr, std::size_t axis) -> int16_t
+    {
+        const std::size_t index = memory_addr - BurstAddr + 2*axis;
+        int16_t values[SampleNum];
+        for (std::size_t i=0; i<SampleNum; ++i)
+        {
+            values[i] = static_cast<int16_t>((samples[i][index+1] << 8) | samples[i][index]);
+        }
+        return median(values[0], values[1], values[2]);
+    };
+
+    constexpr uint8_t accel_val = 0x28; // 線形加速度のメモリアドレス
+
+    //線形加速度
+    double d_accelX = median_of(accel_val, 0) / 100.00;
+    double d_accelY = median_of(accel_val, 1) / 100.00;
+    double d_accelZ = median_of(accel_val, 2) / 100.00;
+
+    if (std::abs(d_accelX) > 50 || std::abs(d_accelY) > 50 || std::abs(d_accelZ) > 50)
+    {
+return Error(ErrorSource::BNO055, ErrorCode::InvalidValue, __FILE__, __LINE__, "accel", float(d_accelX), float(d_accelY), float(d_accelZ));  // BNO055の測定値が異常です
     }
 
-    double d_grvX = median(grvX[0], grvX[1], grvX[2]) / 100.00;
-    double d_grvY = median(grvY[0], grvY[1], grvY[2]) / 100.00;
-    double d_grvZ = median(grvZ[0], grvZ[1], grvZ[2]) / 100.00;
+    Acceleration<Unit::m_s2>accel_vector{dimension::m_s2(d_accelX),dimension::m_s2(d_accelY),dimension::m_s2(d_accelZ)};
+
+    constexpr uint8_t grv_val = 0x2E; // 重力加速度のメモリアドレス
+
+    //重力加速度
+    double d_grvX = median_of(grv_val, 0) / 100.00;
+    double d_grvY = median_of(grv_val, 1) / 100.00;
+    double d_grvZ = median_of(grv_val, 2) / 100.00;
 
     if (std::abs(9.8 - std::sqrt(d_grvX*d_grvX + d_grvY*d_grvY + d_grvZ*d_grvZ)) > 0.5)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal. grv:%f, %f, %f", d_grvX, d_grvY, d_grvZ));  // BNO055の測定値が異常です
+return Error(ErrorSource::BNO055, ErrorCode::InvalidValue, __FILE__, __LINE__, "grv", float(d_grvX), float(d_grvY), float(d_grvZ));  // BNO055の測定値が異常です
     }
 
     Acceleration<Unit::m_s2>grav_vector{dimension::m_s2(d_grvX),dimension::m_s2(d_grvY),dimension::m_s2(d_grvZ)};
@@ -141,25 +215,14 @@ throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is
     constexpr uint8_t mag_val = 0x0E;  // 磁気のメモリアドレス
 
     //地磁気
-    for (int i=0; i<3; ++i)
-    {
-        Binary mag = _i2c.read_memory(size_t(6), SlaveAddr(addr), MemoryAddr(mag_val));
-
-        magX[i] = ((mag[1] << 8) | mag[0]);
-        magY[i] = ((mag[3] << 8) | mag[2]);
-        magZ[i] = ((mag[5] << 8) | mag[4]);
-
-        sleep_ms(1);
-    }
-
-    double d_magX = milli * median(magX[0], magX[1], magX[2]) / 16.00;
-    double d_magY = milli * median(magY[0], magY[1], magY[2]) / 16.00;
-    double d_magZ = milli * median(magZ[0], magZ[1], magZ[2]) / 16.00;
+    double d_magX = milli * median_of(mag_val, 0) / 16.00;
+    double d_magY = milli * median_of(mag_val, 1) / 16.00;
+    double d_magZ = milli * median_of(mag_val, 2) / 16.00;
 
     double all_mag =std::sqrt(d_magX*d_magX + d_magY*d_magY + d_magZ*d_magZ);    
     if (0.5 < std::abs(all_mag))  // 日本は47mT～50mTくらい
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal. mag:%f, %f, %f", d_magX, d_magY, d_magZ));  // BNO055の測定値が異常です
+return Error(ErrorSource::BNO055, ErrorCode::InvalidValue, __FILE__, __LINE__, "mag", float(d_magX), float(d_magY), float(d_magZ));  // BNO055の測定値が異常です
     }
     
     MagneticFluxDensity<Unit::T>Mag_vector{dimension::T(d_magX),dimension::T(d_magY),dimension::T(d_magZ)};
@@ -167,24 +230,13 @@ throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is
     constexpr uint8_t gyro_val = 0x14;  // ジャイロのメモリアドレス
 
     //ジャイロ
-    for (int i=0; i<3; ++i)
-    {
-        Binary gyro = _i2c.read_memory(size_t(6), SlaveAddr(addr), MemoryAddr(gyro_val));
-
-        gyroX[i] = ((gyro[1] << 8) | gyro[0]);
-        gyroY[i] = ((gyro[3] << 8) | gyro[2]);
-        gyroZ[i] = ((gyro[5] << 8) | gyro[4]);
-
-        sleep_ms(1);
-    }
-
-    double d_gyroX = median(gyroX[0], gyroX[1], gyroX[2]) / 900.00;
-    double d_gyroY = median(gyroY[0], gyroY[1], gyroY[2]) / 900.00;
-    double d_gyroZ = median(gyroZ[0], gyroZ[1], gyroZ[2]) / 900.00;
+    double d_gyroX = median_of(gyro_val, 0) / 900.00;
+    double d_gyroY = median_of(gyro_val, 1) / 900.00;
+    double d_gyroZ = median_of(gyro_val, 2) / 900.00;
 
     if (d_gyroX > 20 || d_gyroY > 20 || d_gyroZ > 20)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal. gyro:%f, %f, %f", d_gyroX, d_gyroY, d_gyroZ));  // BNO055の測定値が異常です
+return Error(ErrorSource::BNO055, ErrorCode::InvalidValue, __FILE__, __LINE__, "gyro", float(d_gyroX), float(d_gyroY), float(d_gyroZ));  // BNO055の測定値が異常です
     }
 
     AngularVelocity<Unit::rad_s>gyro_vector{dimension::rad_s(d_gyroX),dimension::rad_s(d_gyroY),dimension::rad_s(d_gyroZ)};
@@ -192,99 +244,122 @@ throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is
     // 測定値がおかしくなったら再び初期化
     if (d_accelX==0 && d_accelY==0 && d_accelZ==0 && d_grvX==0 && d_grvY==0 && d_grvZ==0 && d_magX==0 && d_magY==0 && d_magZ==0 && d_gyroX==0 && d_gyroY==0 && d_gyroZ==0)
     {
-        print("!!reinitialize BNO!!\n");  // BNOを再び初期化します
-        accel_init();
+        print(LogLevel::Error, LogModule::BNO055, "!!reinitialize BNO!!\n");  // BNOを再び初期化します
+        _init_state = InitState::PowerOn;  // チップIDの確認から設定をやり直す
+        _init_deadline = get_absolute_time();
+        wait_init();
         sleep(100_ms);
-        throw std::runtime_error(f_err(__FILE__, __LINE__, "BNO055 measurement value is abnormal"));  // BNO055の測定値が異常です
+return Error(ErrorSource::BNO055, ErrorCode::Stuck, __FILE__, __LINE__);  // BNO055の測定値が異常です
     }
 
-    print("accel:%f,%f,%f\ngrv:%f,%f,%f\nmag:%f,%f,%f\ngyro:%f,%f,%f\n", d_accelX, d_accelY, d_accelZ, d_grvX, d_grvY, d_grvZ, d_magX, d_magY, d_magZ, d_gyroX, d_gyroY, d_gyroZ);
+    if (series)
+    {
+        series->add(to_ms_since_boot(get_absolute_time()), {float(d_accelX), float(d_accelY), float(d_accelZ), float(d_grvX), float(d_grvY), float(d_grvZ), float(d_magX), float(d_magY), float(d_magZ), float(d_gyroX), float(d_gyroY), float(d_gyroZ)});
+    } else {
+        print(LogLevel::Data, LogModule::BNO055, "accel:%f,%f,%f\ngrv:%f,%f,%f\nmag:%f,%f,%f\ngyro:%f,%f,%f\n", d_accelX, d_accelY, d_accelZ, d_grvX, d_grvY, d_grvZ, d_magX, d_magY, d_magZ, d_gyroX, d_gyroY, d_gyroZ);
+    }
 
-    return {accel_vector,grav_vector,Mag_vector,gyro_vector};
+    return std::tuple(accel_vector,grav_vector,Mag_vector,gyro_vector);
 }
 
 
 //最初に定義した関数とかの中身
 
 // Initialise Accelerometer Function
-void BNO055::accel_init(void){
+void BNO055::wait_init(){
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    // Check to see if connection is correct
-    sleep_ms(1000); // Add a short delay to help BNO005 boot up
-    uint8_t reg = 0x00;
-    uint8_t chipID[1];
-    // i2c_write_blocking(i2c1, addr, &reg, 1, true);
-    // i2c_read_blocking(i2c1, addr, chipID, 1, false);
-    try
+    while (!poll_init())
     {
-        chipID[0] = _i2c.read_memory(size_t(1), SlaveAddr(addr), MemoryAddr(reg)).at(0);
-        if(chipID[0] != 0xA0)
-        {
-            printf("Chip ID Not Correct - Check Connection!");
-        }
-    }
-    catch(const std::exception& e)
-    {
-        print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n\n********************\n", __FILE__, __LINE__);
-        print(e.what());
-        chipID[0] = 0xA0;
+        sleep_ms(1);
     }
-    
+}
+
+bool BNO055::poll_init(){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (_init_state == InitState::Ready)
+        return true;
+    if (absolute_time_diff_us(get_absolute_time(), _init_deadline) > 0)
+        return false;  // まだ待つ
+
+    uint8_t data[2];
     try
     {
-        // Use internal oscillator
-        uint8_t data[2];
-        data[0] = 0x3F;
-        data[1] = 0x40;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-
-        // Reset all interrupt status bits
-        data[0] = 0x3F;
-        data[1] = 0x01;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-
-        // Configure Power Mode
-        data[0] = 0x3E;
-        data[1] = 0x00;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-        sleep_ms(50);
-
-        // Defaul Axis Configuration
-        data[0] = 0x41;
-        data[1] = 0x24;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-
-        // Default Axis Signs
-        data[0] = 0x42;
-        data[1] = 0x00;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-
-        // Set units to m/s^2
-        data[0] = 0x3B;
-        data[1] = 0b0001000;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-        sleep_ms(30);
-
-        // Set operation to AMG(Accel Mag Gyro)
-        data[0] = 0x3D;
-        data[1] = 0b1100;
-        // i2c_write_blocking(I2C_PORT, addr, data, 2, true);
-        _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
-        sleep_ms(100);    
+        switch (_init_state)
+        {
+            case InitState::PowerOn:
+            {
+                // Check to see if connection is correct
+                // 起動が終わるとチップIDが読めるようになる (データシートでは電源を入れてから最大650ms)  1秒待つ代わりに10msごとに確かめる
+                uint8_t chipID = 0;
+                const Result<std::size_t> input_size = _i2c.try_read_memory(&chipID, size_t(1), SlaveAddr(addr), MemoryAddr(0x00));
+                if (!input_size || *input_size != 1 || chipID != 0xA0)
+                {
+                    if (to_ms_since_boot(get_absolute_time()) < PowerOnTimeout_ms)
+                    {
+                        _init_deadline = make_timeout_time_ms(10);
+                        return false;
+                    }
+                    printf("Chip ID Not Correct - Check Connection!");
+                }
+
+                // Use internal oscillator
+                data[0] = 0x3F;
+                data[1] = 0x40;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+
+                // Reset all interrupt status bits
+                data[0] = 0x3F;
+                data[1] = 0x01;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+
+                // Configure Power Mode
+                data[0] = 0x3E;
+                data[1] = 0x00;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+                _init_state = InitState::Configure;
+                _init_deadline = make_timeout_time_ms(10);
+                return false;
+            }
+            case InitState::Configure:
+            {
+                // Defaul Axis Configuration
+                data[0] = 0x41;
+                data[1] = 0x24;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+
+                // Default Axis Signs
+                data[0] = 0x42;
+                data[1] = 0x00;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+
+                // Set units to m/s^2
+                data[0] = 0x3B;
+                data[1] = 0b0001000;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+
+                // Set operation to AMG(Accel Mag Gyro)
+                data[0] = 0x3D;
+                data[1] = 0b1100;
+                _i2c.write_memory(Binary(data[1]), SlaveAddr(addr), MemoryAddr(data[0]));
+                _init_state = InitState::Switching;
+                _init_deadline = make_timeout_time_ms(20);  // 設定モードから切り替わるまで (データシートでは7ms)
+                return false;
+            }
+            default:
+                break;
+        }
     }
     catch(const std::exception& e)
     {
         print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n\n********************\n", __FILE__, __LINE__);
         print(e.what());
     }
+    _init_state = InitState::Ready;  // 失敗したときも，これまでと同じく測定を試せるようにする
+    return true;
 }
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef SC19_PICO_BNO055_HPP_
 #define SC19_PICO_BNO055_HPP_
 
+#include <array>
 #include <cmath>
 #include <cstdio>
 #include <tuple>
@@ -12,10 +13,61 @@ namespace sc
 // Class declaration
 class BNO055 {
     const I2C& _i2c;
-    void accel_init(void);
+
+    static constexpr uint8_t BurstAddr = 0x0E;  // 地磁気のX軸の下位バイトのメモリアドレス (ここから重力加速度までをまとめて読む)
+    static constexpr std::size_t BurstSize = 0x34 - BurstAddr;  // 地磁気から重力加速度までの連続したレジスタのバイト数
+    static constexpr std::size_t SampleNum = 3;  // 中央値を求めるために測定する回数
+    using Sample = StaticBinary<BurstSize>;  // 1回分の測定値のレジスタ
+
+    std::array<Sample, SampleNum> _samples;  // 予約した受信のデータを書き込む場所
+    std::array<I2CAsync::Transfer, SampleNum> _transfers;  // 予約した受信
+    I2CAsync* _i2c_async = nullptr;  // 受信を予約したI2CAsync (予約していないときはnullptr)
+
+    //! @brief 初期化の進み具合
+    enum class InitState
+    {
+        PowerOn,  // 電源を入れてからの起動を待つ (チップIDが読めるまで)
+        Configure,  // 電源モードを書き込んだあとの待ち
+        Switching,  // 動作モードを切り替えたあとの待ち
+        Ready  // 測定できる
+    };
+    static constexpr uint32_t PowerOnTimeout_ms = 1000;  // 電源を入れてからこれだけ待ってもチップIDが読めなければ，あきらめて設定を書き込む
+    InitState _init_state = InitState::PowerOn;
+    absolute_time_t _init_deadline;  // この時刻になったら初期化を次に進める
+
+    void wait_init();  // 準備ができるまで待つ
+
+    //! @brief レジスタの値を測定値に変換
+    Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> decode(const std::array<Sample, SampleNum>& samples);
 public:
     BNO055(const I2C& i2c);
+
+    //! @brief 初期化を進める (待機しない)
+    //! @note コンストラクタは何も待たずに戻るので，ほかのデバイスの初期化と並行して，準備ができるまでこれを繰り返し呼ぶ
+    //! @note 準備ができる前にread()などを呼んだときは，そこで準備ができるまで待ちます
+    //! @return 測定できる状態になったか
+    bool poll_init();
     std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>> read();          
+
+    //! @brief 線形加速度，重力加速度，地磁気，角速度を測定 (失敗しても例外を投げない)
+    //! @return 測定値か，エラー
+    Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> try_read();
+
+    //! @brief 測定値の受信を予約 (待機しない)
+    //! @param i2c_async 受信に使うI2CAsync (このBNO055と同じI2Cのもの)
+    //! @return 予約できたか，エラー
+    Result<void> request(I2CAsync& i2c_async);
+
+    //! @brief 予約した受信が終わったか
+    bool ready() const;
+
+    //! @brief 予約した受信が終わるのを待ち，測定値に変換 (失敗しても例外を投げない)
+    //! @return 測定値か，エラー
+    Result<std::tuple<Acceleration<Unit::m_s2>,Acceleration<Unit::m_s2>,MagneticFluxDensity<Unit::T>,AngularVelocity<Unit::rad_s>>> try_collect();
+
+    //! @brief 測定値の記録先 (加速度，重力加速度，地磁気，角速度のxyzの12チャンネル)
+    //! @note 設定すると，測定値を文字列でprintせずにここに記録します (nullptrなら今まで通りprint)
+    static inline SeriesEncoder* series = nullptr;
 };
 
 }
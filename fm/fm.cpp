@@ -3,13 +3,252 @@
 namespace sc
 {
 
-enum class Fase 
+namespace
 {
-    Wait,//待機
-    Fall,//落下
-    Ldistance,//遠距離
-    Sdistance,//近距離
-} fase;
+
+// センサの測定値を差分で記録する (1つ約0.5KBなので，mainのスタックには置かない)
+SeriesEncoder BmeSeries(SeriesStream::BME280, {-1, -2, -2});  // 気圧 0.1Pa，湿度 0.01%，気温 0.01°C
+SeriesEncoder BnoSeries(SeriesStream::BNO055, {-2, -2, -2, -2, -2, -2, -5, -5, -5, -3, -3, -3});  // 加速度と重力加速度 0.01m/s²，地磁気 1e-5T，角速度 0.001rad/s (BNO055の分解能)
+SeriesEncoder LuxSeries(SeriesStream::Lux, {0});  // 照度 1lx
+SeriesEncoder VsysSeries(SeriesStream::Vsys, {-3});  // 電圧 1mV
+
+//! @brief fm.cppのセンサとモーターを，フェーズを進める処理(MissionLoop)から使うためのクラス
+//! @note センサが読めなかったときは，ここでエラーを出力してstd::nulloptを返す (エラーの回数はMissionLoopが数える)
+struct FmIo
+{
+    using Imu = std::tuple<Acceleration<Unit::m_s2>, Acceleration<Unit::m_s2>, MagneticFluxDensity<Unit::T>, AngularVelocity<Unit::rad_s>>;  // BNO055の測定値
+
+    LED& led_pico;  // pico内蔵LED  エラーが出たら消す
+    LED& led_red;
+    LED& led_green;
+    BME280& bme280;
+    BNO055& bno055;
+    I2CAsync& i2c_async;
+    NJL5513R& njl5513r;
+    Spresense& spresense;
+    HCSR04& hcsr04;
+    EdgeInput& para_separate;
+    Speaker& speaker;
+    MotorActuator& motor_actuator;
+    Checkpoint& checkpoint;
+    MissionState& mission_state;  // GPSの位置を保存する
+    Flush& flush;
+    SD& sd;
+
+    uint64_t now_us() const
+        {return to_us_since_boot(get_absolute_time());}
+
+    void sleep_until_us(uint64_t time_us) const
+        {sleep_until(from_us_since_boot(time_us));}
+
+    void set_leds(bool red, bool green)
+    {
+        if (red) {led_red.on();} else {led_red.off();}
+        if (green) {led_green.on();} else {led_green.off();}
+    }
+
+    template<typename... Args>
+    void event(const char* format, Args... args)
+        {print(LogLevel::Event, LogModule::Main, format, args...);}
+
+    template<typename... Args>
+    void data(const char* format, Args... args)
+        {print(format, args...);}
+
+    // センサの読み取りの失敗は例外ではなくErrorで受け取り，ここで初めてメッセージを作って出力する
+    void report_error(const Error& error)
+    {
+        print(LogLevel::Error, LogModule::Main, f_err(error.file(), error.line(), "%s: %s", to_str(error.source()), to_str(error.code())));  // 回数を含めないので，くり返しはまとめられる (回数はErrorCounter::print)
+        led_pico.off();
+    }
+
+    void report_exception(const std::exception& e)
+    {
+        print(LogLevel::Error, LogModule::Main, e.what());
+        led_pico.off();
+    }
+
+    std::optional<Altitude<Unit::m>> read_altitude()
+    {
+        const auto bme_result = bme280.try_read();  // BME280(温湿圧)から受信
+        if (!bme_result)
+        {
+            report_error(bme_result.error());
+            return std::nullopt;
+        }
+        const auto& bme_data = *bme_result;
+        Pressure<Unit::Pa> pressure = std::get<0>(bme_data);  // 気圧
+        Temperature<Unit::degC> temperature = std::get<2>(bme_data);  // 気温
+        Altitude<Unit::m> altitude(pressure, temperature);
+        print("altitude:%f\n", double(altitude));
+        return altitude;
+    }
+
+    Illuminance<Unit::lx> read_lux()
+        {return njl5513r.read();}
+
+    std::optional<Imu> read_imu()
+    {
+        auto bno_result = bno055.try_read();  // BNO055(9軸)から受信
+        if (!bno_result)
+        {
+            report_error(bno_result.error());
+            return std::nullopt;
+        }
+        return *bno_result;
+    }
+
+    bool request_imu()
+    {
+        const Result<void> bno_request = bno055.request(i2c_async);
+        if (!bno_request)
+        {
+            report_error(bno_request.error());
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<Imu> collect_imu()
+    {
+        auto bno_result = bno055.try_collect();
+        if (!bno_result)
+        {
+            report_error(bno_result.error());
+            return std::nullopt;
+        }
+        return *bno_result;
+    }
+
+    std::optional<std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg>>> read_gps()
+    {
+        auto gps_result = spresense.try_gps();
+        if (!gps_result)
+        {
+            report_error(gps_result.error());
+            return std::nullopt;
+        }
+        const auto& gps_data = *gps_result;
+        mission_state.has_fix = true;  // リセットされても最後の位置を引き継ぐ
+        mission_state.latitude = double(std::get<0>(gps_data));
+        mission_state.longitude = double(std::get<1>(gps_data));
+        return gps_data;
+    }
+
+    //! @brief 機体の正面から反時計回りに測ったゴールの方向 (rad)
+    double goal_direction(const Imu& bno_data, const GoalVector& to_goal)
+    {
+        MagneticFluxDensity<sc::Unit::T> magnetic = std::get<2>(bno_data);
+
+        //機体の正面のベクトルを作る.ただし、bnoの都合上、後ろがxの正の向きで左がyの正の向き、下がzの正の向きとなっている
+        // Vector3<double> front_vetor_basic = (-1.0, 0.0, 0.0);//機体正面の単位ベクトル
+
+        //北を見つける
+        Vector3<double> North_vector(double(magnetic.x()),double(magnetic.y()),0);//磁気センサから求める北の向き
+        // Vector3<double> North_vector_basic = Normalization(North_vector);//正規化
+        double North_angle_rad;//後で使う北の角度
+
+        // 北がBnoの座標軸において何度回転した位置にあるか求める
+        // 但しθは[0,2Pi)とした
+        North_angle_rad = atan2(double(magnetic.y()),double(magnetic.x()));
+        if(North_angle_rad < 0)
+        {
+            North_angle_rad += 2 * PI;
+        }
+
+        printf("%f\n",North_angle_rad);
+
+        //自分からゴールまでのベクトルを求める
+        double distance = to_goal.distance;//ゴールと自分の距離
+        double distance_vertical = to_goal.north;//縦の距離(北が正)
+        double distance_horizontal = -to_goal.east;//横の距離(西が正)
+
+        print("%f\n",distance);
+        printf("%f\n",distance_vertical);
+        printf("%f\n",distance_horizontal);
+
+        Vector3<double> direction(distance_vertical,distance_horizontal,0);
+        //----------------------------
+        Vector3<double> direction_vector_1(direction.x(),direction.y(),0);//東西南北を基底としたベクトルでベクトルを表現(北がx軸,西がy軸)
+
+        //ベクトルのprintわかんなかったからChatGPTさんに出力してもらったよ。間違ってたら直してほしい
+        std::cout << "(" << direction_vector_1.x() << ", " << direction_vector_1.y() << ", " << direction_vector_1.z() << ")" << std::endl;
+
+        Vector3<double> direction_vector_2 = Rotation_clockwise_xy(direction_vector_1,Latitude<sc::Unit::rad>(North_angle_rad));//東西南北の基底から機体のxyを基底とした座標に回転.
+        double direction_angle_rad;
+
+        //ここも
+        std::cout << "(" << direction_vector_2.x() << ", " << direction_vector_2.y() << ", " << direction_vector_2.z() << ")" << std::endl;
+
+        direction_angle_rad = atan2(direction_vector_2[1],direction_vector_2[0]);
+
+        printf("%f\n",direction_angle_rad);
+
+        //front_vectorと呼べるものが(1,0,0)の場合
+        if(direction_angle_rad < 0)
+        {
+            direction_angle_rad += 2 * PI;
+        }
+
+        //front_vectorと呼べるものが(-1,0,0)の場合
+        // direction_angle_rad = direction_angle_rad + PI;//正面がxの負の向きなので180°回転
+
+        double direction_angle_degree = rad_to_deg(direction_angle_rad);
+        print("%f\n",direction_angle_degree);
+        return direction_angle_rad;
+    }
+
+    GoalSight read_camera()
+    {
+        switch (spresense.camera())
+        {
+            case Cam::Center: return GoalSight::Center;
+            case Cam::Right: return GoalSight::Right;
+            case Cam::Left: return GoalSight::Left;
+            default: return GoalSight::NotFound;
+        }
+    }
+
+    Length<Unit::m> read_sonar()
+        {return hcsr04.read();}
+
+    bool parachute_tangled()
+        {return para_separate.read() == false;}
+
+    MotorActuator& motor()
+        {return motor_actuator;}
+
+    void play_landing()
+    {
+        checkpoint.pause_watchdog();  // 曲はウォッチドッグの時間(8秒)より長い
+        speaker.play_hogwarts();
+        checkpoint.start_watchdog();
+    }
+
+    void play_near_goal()
+    {
+        checkpoint.pause_watchdog();  // 曲はウォッチドッグの時間(8秒)より長い
+        speaker.play_starwars();
+        checkpoint.start_watchdog();
+    }
+
+    //! @brief ゴールしたときに，ログを書き終えて曲を鳴らす
+    void goal()
+    {
+        checkpoint.pause_watchdog();  // ミッションが終わったので，リセットせずに止まる
+        checkpoint.clear();  // 次に起動したときに，終わったミッションの続きから始めない
+        speaker.play_mario();
+        Log::flush();  // まとめている途中のくり返しを出力する
+        flush.sync();  // 圧縮の途中のログを書き込む
+        for (SeriesEncoder* series : {&BmeSeries, &BnoSeries, &LuxSeries, &VsysSeries})
+        {
+            series->flush();  // 途中のブロックの測定値を書き込む
+        }
+        sd.sync();
+    }
+};
+
+}
 
 int main()
 {
@@ -29,71 +268,141 @@ int main()
         Motor1 motor_left(PWM(11), PWM(10));  // 左のモーター
         // GPIO 12~15 はSDカード
         // GPIO16は未使用
-        GPIO<In> para_separate(Pin(17), Pull::Up);  // パラシュート分離の検知用ピン (分離したらHigh(1))
+        EdgeInput para_separate(Pin(17), Pull::Up);  // パラシュート分離の検知用ピン (分離したらHigh(1))  分離した時刻を割り込みで記録する
         // GPIO18は未使用
         HCSR04 hcsr04(Pin(28), Pin(19));  // 超音波センサHCSR04
         Motor1 motor_right(PWM(20), PWM(21));  // 右のモーター
         Speaker speaker(Pin(22));  // スピーカー
-        GPIO<In> usb_conect(Pin(24));  // USBの接続を確認
+        EdgeInput usb_conect(Pin(24));  // USBの接続を確認  抜き差しした時刻を割り込みで記録する
         LED led_pico(Pin(25));  // pico内蔵LED
         LED led_red(Pin(27));    // 照度センサ搭載の赤色LED
         NJL5513R njl5513r(ADC(26), led_red, led_green);  // 照度センサnjl5513r
         PicoTemp pico_temp;
         VsysVoltage vsys;
+        AdcSampler adc_sampler;  // 照度，VSYS，温度をDMAで連続測定し，read()は平均値を返す
         BME280 bme280(i2c_bme_bno);  // 温湿度気圧センサのBME280
         BNO055 bno055(i2c_bme_bno);  // 9軸センサのBNO055;
+        I2CAsync i2c_async(i2c_bme_bno);  // BMEとBNOからの受信を待機せずに行う
         Motor2 motor(motor_left, motor_right);  // 左右のモーター
+        MotorActuator motor_actuator(motor);  // 左右のモーターを待機せずに動かす (これ以降はmotorを直接使わない)
         SD sd;  // SDカード
         Flush flush;
         Spresense spresense(uart_spresense);
         Twelite twelite(uart_twelite);
+        Checkpoint checkpoint;  // リセットされても続きから再開するために，フェーズなどを保存する
+        PowerManager power(i2c_bme_bno);  // 待機フェーズと落下フェーズではクロックを下げる
+        BootTimeline::mark("construct");  // BME280とBNO055はリセットを送っただけで，起動は待っていない
+
+        // 前回リセットされたときの状態を読み出す (電源を入れて最初の起動ならstd::nullopt)
+        // 電源を入れたときは，フラッシュメモリに残った前回の飛行の状態を使わずに消す (USBをつながずに起動しても古いフェーズから始めない)
+        std::optional<MissionState> resumed = checkpoint.restore();
 
         // USBでの接続時はフラッシュメモリのデータを出力
         if (usb_conect.read() == true)
         {
+            // 地上でつないでいるので，前回の飛行の状態は使わない (飛行前に一度USBをつないで起動し，消しておく)
+            checkpoint.clear();
+            resumed.reset();
+            // PCがシリアルポートを開くのを少しだけ待つ (飛行中はUSBがつながっていないので待たない)
+            for (int i=0; i<100 && !::stdio_usb_connected(); ++i)  // pico-SDKの関数  USBのシリアルがつながっているか
+            {
+                sleep_ms(10);
+            }
             flush.print();
             #ifndef NODEBUG
                 flush.clear();
             #endif
+        } else if (resumed) {
+            flush.resume();  // リセットから再開したときは，ログを消さずに続きから書き込む
         } else {
-            flush.clear();  // フラッシュメモリを削除(削除しないと書き込めない)
+            flush.clear();  // フラッシュメモリを削除(削除しないと書き込めない)  実際の消去は書き込みに合わせて少しずつ行う
         }
+        BootTimeline::mark("flush");
+
+        // print関数の出力先を設定 (SDカードにはすべて，TWELITEにはフェーズの移行とエラーだけを送る)
+        Log::add_sink(LogLevel::Data, [](const std::string& message){SC_PROFILE_SCOPE("print_usb"); std::cout << message << std::flush;});
+        Log::add_sink(LogLevel::Data, [&](const std::string& message){SC_PROFILE_SCOPE("print_flush"); flush.write(message);});
+        Log::add_sink(LogLevel::Data, [&](const std::string& message){SC_PROFILE_SCOPE("print_sd"); sd.write(message);});
+        Log::add_sink(LogLevel::Event, [&](const std::string& message){SC_PROFILE_SCOPE("print_twelite"); twelite.write(0x78, message);});
+        set_print = [](const std::string& message){Log::write(LogLevel::Info, LogModule::Main, message);};  // 重要度を付けないprint
+
+        // センサや通信から受け取った生のデータを，SDカードの別のファイルにバイナリで記録する (fm/traceのツールで読む)
+        TraceRecorder::start([&](const uint8_t* data, std::size_t size){sd.write_trace(data, size);});
 
-        // print関数を設定
-        set_print = [&](const std::string & message)
+        // SDカードが使えるときは，センサの測定値を"%f"の文字列でなく差分で記録する (fm/traceのSERIES_DECODEで読む)
+        if (SD::save)
         {
-            try {std::cout << message << std::flush;} catch(const std::exception& e){printf(e.what());}
-            try {flush.write(message);} catch(const std::exception& e){printf(e.what());}
-            try {sd.write(message);} catch(const std::exception& e){printf(e.what());}
-            try {twelite.write(0x78, message);} catch(const std::exception& e){printf(e.what());}
-        };
-        
+            for (SeriesEncoder* series : {&BmeSeries, &BnoSeries, &LuxSeries, &VsysSeries})
+            {
+                series->set_sink([&](const uint8_t* data, std::size_t size){sd.write_series(data, size);});
+            }
+            BME280::series = &BmeSeries;
+            BNO055::series = &BnoSeries;
+            NJL5513R::series = &LuxSeries;
+            VsysVoltage::series = &VsysSeries;
+        }
+
+        // 起動音は待たずに鳴らし，鳴っている間にセンサの起動を待つ
+        try {speaker.start_windows7();} catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
+
+        // BME280とBNO055の起動を並行して待つ (1つずつ待つと，BNO055の起動の約0.65秒にBME280の分が足される)
+        {
+            bool bme_ready = false, bno_ready = false;
+            while (!(bme_ready && bno_ready))
+            {
+                try {bme_ready = bme_ready || bme280.poll_init();} catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what()); bme_ready = true;}
+                try {bno_ready = bno_ready || bno055.poll_init();} catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what()); bno_ready = true;}
+                sleep_us(200);
+            }
+        }
+        BootTimeline::mark("sensor_init");
+
         // 標高の基準となる気圧を設定
-        try
+        MissionState mission_state;  // リセットされても引き継ぐ状態
+        if (resumed)
         {
-            try {bme280.read(); bme280.read();} catch(...) {}
-            auto b0 = bme280.read();
-            sleep(1_ms);
-            auto b1 = bme280.read();
-            sleep(1_ms);
-            auto b2 = bme280.read();
-            const auto ave_pres = average(std::get<0>(b0), std::get<0>(b1), std::get<0>(b2));
-            const auto ave_temp = average(std::get<2>(b0), std::get<2>(b1), std::get<2>(b2));
-            Altitude<Unit::m>::set_origin(ave_pres, ave_temp);
-            print("set_origin:%f,%f\n", ave_pres, ave_temp);
+            // リセットから再開したときは，地上で測った基準をそのまま使う (今の高度で測り直すと，高度が0になってしまう)
+            mission_state = *resumed;
+            Altitude<Unit::m>::set_origin(Pressure<Unit::Pa>(mission_state.origin_pressure), Temperature<Unit::degC>(mission_state.origin_temperature));
+            print(LogLevel::Event, LogModule::Main, "resume:%d,%lu,%d\n", int(mission_state.phase), static_cast<unsigned long>(mission_state.elapsed_ms), int(checkpoint.source()));
+        } else {
+            try
+            {
+                try {bme280.read();} catch(...) {}  // 最初の測定は誤差が大きいので捨てる
+                const auto b0 = bme280.read();  // read()は3回測定した中央値なので，1回で基準にする
+                Altitude<Unit::m>::set_origin(std::get<0>(b0), std::get<2>(b0));
+                mission_state.origin_pressure = float(double(std::get<0>(b0)));
+                mission_state.origin_temperature = float(double(std::get<2>(b0)));
+                print(LogLevel::Event, LogModule::Main, "set_origin:%f,%f\n", double(std::get<0>(b0)), double(std::get<2>(b0)));
+            }
+            catch(const std::exception& e){printf(e.what());}
         }
-        catch(const std::exception& e){printf(e.what());}
+        BootTimeline::mark("origin");  // ここで最初のセンサの値がそろう
+
+        // ゴールの緯度経度 (自分たちで決めて書き換えてね)  投影の係数はここで一度だけ計算する
+        // LocalNavigator navigator(Latitude<Unit::deg>(30.3742469), Longitude<Unit::deg>(130.9600102));  // (google)
+        LocalNavigator navigator(Latitude<Unit::deg>(30.37427937), Longitude<Unit::deg>(130.95994488));
 
-        fase = Fase::Wait;
+        // フェーズを移行する条件のしきい値 (fm/simのシミュレータで調整したものをここに書く)
+        const Mission mission;
 
-        absolute_time_t recent_successful = get_absolute_time();  // エラーが出続けている時間を測るために使う．
-        bool is_success = true;  // エラーが出ずに成功したか
+        // フェーズを進める処理(高度の推定・方位制御・スタックの検知を含む)は，fm/simのシミュレータと同じMissionLoopで行う
+        FmIo io{led_pico, led_red, led_green, bme280, bno055, i2c_async, njl5513r, spresense, hcsr04, para_separate, speaker, motor_actuator, checkpoint, mission_state, flush, sd};
+        // 開始時刻  再開したときは，保存した経過時間の分だけ前にする (起動前の時刻になるが，差を取るときに桁あふれで正しく戻る)
+        const uint64_t start_us = to_us_since_boot(get_absolute_time()) - uint64_t(mission_state.elapsed_ms) * 1000;
+        MissionLoop<FmIo> loop(io, mission, navigator, Phase(mission_state.phase), start_us);  // リセットから再開したときは，保存したフェーズから
+        Phase traced_phase = Phase::Wait;  // 前回トレースに目印を付けたときのフェーズ
+        TraceRecorder::marker(format_str("fase:%d", int(loop.phase())));
+
+        absolute_time_t stats_time = get_absolute_time();  // 前回I2Cの記録とエラーの回数を表示した時刻
 
-        const absolute_time_t start_time = get_absolute_time();//開始時刻
         led_pico.on();
         led_red.off();
         led_green.off();
-        speaker.play_windows7();
+        BootTimeline::mark("loop_start");
+        BootTimeline::print();  // 起動の段階ごとの時間を表示
+        checkpoint.start_watchdog();  // ここからはループが8秒止まったらリセットして，保存したフェーズから再開する
+        try {power.calibrate(vsys.read());} catch(...){}  // モーターを止めてクロックを上げている今の電圧を，消費電流の推定の基準にする
 
     // ************************************************** //
     //                        loop                        //
@@ -104,433 +413,87 @@ int main()
         {
             try
             {
+                SC_PROFILE_SCOPE("loop");  // 1回のループの処理時間を計測
                 try {led_pico.on(); } catch(...) {}
-                print("\nfase : %d\n", int(fase));  // フェーズを表示
-                try {spresense.time();} catch(...){}  // タイムスタンプを表示
-                try {vsys.read();} catch(...){}  // 電源電圧を表示
+                print(LogLevel::Data, LogModule::Main, "\nfase : %d\n", int(loop.phase()));  // フェーズを表示 (ループの区切りなので，くり返しをまとめない)
                 try
                 {
-                    if (is_success)  // もし，前回のループがうまくいったなら
+                    // リセットされても続きから再開できるように，フェーズと経過時間を保存する
+                    checkpoint.feed();
+                    mission_state.phase = uint8_t(loop.phase());
+                    mission_state.elapsed_ms = uint32_t(loop.elapsed_us() / 1000);
+                    checkpoint.store(mission_state);
+                }
+                catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
+                try
+                {
+                    // フェーズが変わっていたらトレースに目印を付け，ためてある記録をSDカードに書き込む
+                    if (loop.phase() != traced_phase)
                     {
-                        recent_successful = get_absolute_time();
+                        traced_phase = loop.phase();
+                        TraceRecorder::marker(format_str("fase:%d", int(loop.phase())));
                     }
-                    is_success = true;
+                    SC_PROFILE_SCOPE("trace_flush");
+                    TraceRecorder::flush();
                 }
-                catch(const std::exception& e){print(e.what());}
-                
-                switch (fase)
+                catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
+                try
                 {
-                    // ************************************************** //
-                    //                     待機フェーズ                    //
-                    // ************************************************** //
-                    case Fase::Wait:
+                    // センサを読むだけの待機フェーズと落下フェーズではクロックを下げ，走行するフェーズでは上げる
+                    // USBの通信にはクロックが足りなくなるので，USBをつないでいる間は下げない
+                    const bool low_power = (loop.phase() == Phase::Wait || loop.phase() == Phase::Fall) && !usb_conect.read();
+                    power.set_speed(low_power ? PowerManager::Speed::Low : PowerManager::Speed::Full);
+                }
+                catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
+                static_cast<void>(spresense.try_time());  // タイムスタンプを表示 (失敗しても何もしない)
+                try {power.record(std::size_t(loop.phase()), vsys.read());} catch(...){}  // 電源電圧を表示し，フェーズごとの消費電流を推定する
+                try
+                {
+                    // 10秒ごとにI2Cの速度と使用率，エラーの回数を表示
+                    if (absolute_time_diff_us(stats_time, get_absolute_time()) > 10*1000*1000)
                     {
-                        try
-                        {
-                            sleep_ms(100);//後から追加
-                            led_red.off();
-                            led_green.off();
-
-                            //条件1：開始から10分以上　→落下フェーズへ
-                            if((absolute_time_diff_us(start_time, get_absolute_time())>13*60*1000*1000))
-                            {
-                                fase=Fase::Fall;
-                                print("Shifts to the falling phase under condition 1\n");  // 条件1で落下フェーズに移行します
-                                recent_successful = get_absolute_time();
-                                break;
-                            }
-                            //条件2：エラー２分以上　→落下フェーズへ
-                            if (absolute_time_diff_us(recent_successful, get_absolute_time()) > 11*60*1000*1000)
-                            {
-                                fase=Fase::Fall;
-                                print("Shifts to the falling phase under condition 2\n");  // 条件2で落下フェーズに移行します
-                                recent_successful = get_absolute_time();
-                                break;
-                            }
-                            try
-                            {
-                                //条件3：開始から２分以上＆高度５ｍ以下　→落下フェーズへ
-                                auto bme_data = bme280.read();  // BME280(温湿圧)から受信
-                                Pressure<Unit::Pa> pressure = std::get<0>(bme_data);  // 気圧
-                                Temperature<Unit::degC> temperature = std::get<2>(bme_data);  // 気温
-                                Altitude<Unit::m> altitude(pressure, temperature);
-                                print("altitude:%f\n", double(altitude));
-                                if((absolute_time_diff_us(start_time, get_absolute_time())>7*60*1000*1000)&&(altitude<5_m))
-                                {
-                                    fase=Fase::Fall;
-                                    print("Shifts to the falling phase under condition 3\n");  // 条件3で落下フェーズに移行します
-                                    recent_successful = get_absolute_time();
-                                    break;
-                                }
-                            }
-                            catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-                            try
-                            {
-                                //条件4：照度によりキャリア展開検知&&自由落下　→落下フェーズへ
-                                auto njl_data = njl5513r.read();
-                                auto bno_data = bno055.read();
-                                if((njl_data>4500_lx)&&(is_free_fall(std::get<0>(bno_data), std::get<1>(bno_data))))
-                                {
-                                    fase=Fase::Fall;
-                                    print("Shifts to the falling phase under condition 4\n");  // 条件4で落下フェーズに移行します
-                                    recent_successful = get_absolute_time();
-                                    break;
-                                }
-                            }
-                            catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-                        }
-                        catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-                        break;  // 保険のbreak
+                        stats_time = get_absolute_time();
+                        i2c_bme_bno.print_stats();
+                        ErrorCounter::print();
+                        power.print();  // フェーズごとの推定の消費電流
+                        SC_PROFILE_PRINT();  // ゾーンごとの処理時間を表示
+                        print("trace_dropped:%lu\n", static_cast<unsigned long>(TraceRecorder::dropped()));  // 記録しきれなかったトレースの数
+                        print("flush:%llu,%llu\n", static_cast<unsigned long long>(flush.input_bytes()), static_cast<unsigned long long>(flush.programmed_bytes()));  // 圧縮前のログと書き込んだページのバイト数
                     }
-
-                    // ************************************************** //
-                    //                     落下フェーズ                    //
-                    // ************************************************** //
-                    case Fase::Fall:
+                }
+                catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
+                try
+                {
+                    // ループの処理中に起きたパラシュートの分離やUSBの抜き差しを，起きた時刻とともに表示
+                    while (const auto edge = para_separate.next_edge())
                     {
-                        try
-                        {   
-                            led_red.off();
-                            led_green.on();
-
-                            //条件1：電源オンから5分以上経過　→遠距離フェーズへ
-                            if(absolute_time_diff_us(start_time, get_absolute_time())>16*60*1000*1000)
-                            {
-                                fase=Fase::Ldistance;
-                                print("Shifts to the long distance phase under condition 1\n");  // 条件1で遠距離フェーズに移行します
-                                recent_successful = get_absolute_time();
-                            }
-                            //条件2：エラーが2分以上続く　→遠距離フェーズへ
-                            if(absolute_time_diff_us(recent_successful, get_absolute_time()) > 3*60*1000*1000){
-                                fase=Fase::Ldistance;
-                                print("Shifts to the long distance phase under condition 2\n");  // 条件2で遠距離フェーズに移行します
-                                recent_successful = get_absolute_time();
-                            }
-
-                            try
-                            {
-                                auto bme_data = bme280.read();  // BME280(温湿圧)から受信
-                                Pressure<Unit::Pa> pressure = std::get<0>(bme_data);  // 気圧
-                                Temperature<Unit::degC> temperature = std::get<2>(bme_data);  // 気温
-                                Altitude<Unit::m> altitude(pressure, temperature);
-                                print("altitude:%f\n",double(altitude));
-                                if(altitude<5_m)  //地面からの標高が5m以内
-                                {
-                                    auto bno_data = bno055.read();  // BNO055(9軸)から受信
-                                    //条件3：静止　→遠距離フェーズへ
-                                    if(is_stationary(std::get<0>(bno_data), std::get<3>(bno_data)))
-                                    {
-                                        fase=Fase::Ldistance;
-                                        print("Shifts to the long distance phase under condition 3\n");  // 条件3で遠距離フェーズに移行します
-                                        recent_successful = get_absolute_time();
-                                    } else {
-                                        break;
-                                    }
-                                }
-                            }
-                            catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-
-                            if (fase == Fase::Ldistance)
-                            {
-                                speaker.play_hogwarts();  //念のため待機しておく
-
-                                // if(para_separate.read() == false)  //パラシュートが取れていない場合、動いてみる？
-                                // {
-                                //     print("para:toretenai\n");
-                                //     motor.forward(1.0);
-                                //     sleep(1_s);
-                                //     motor.forward(-1.0);
-                                //     sleep(1_s);6
-                                //     motor.forward(0);
-                                // } else {
-                                //     print("para:toreteiru\n");
-                                // }
-                                
-                                auto bno_data = bno055.read();  // BNO055(9軸)から受信
-                                Acceleration<Unit::m_s2> gravity_acceleration = std::get<1>(bno_data);//重力加速度取得
-                                //Z軸の重力加速度が正かどうかで機体の体制修正
-                                if(gravity_acceleration.z()<3_m_s2)//z軸が負なら正常
-                                {
-                                    print("muki:atteru\n");
-                                } else {
-                                    print("muki:hantai\n");
-                                    motor.forward(1.0);//じたばたして体制修正できるかな？
-                                    sleep(5_s);
-                                    motor.stop();
-                                    if (std::get<1>(bno055.read()).z() < 3_m_s2)  // それでもまだ反対向きなら
-                                    {
-                                        motor.forward(1.0);  // もう一回
-                                        sleep(5_s);
-                                        motor.stop();
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                        catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-                        break;  // 保険のbreak
+                        print(LogLevel::Event, LogModule::Main, "para_separate:%d,%llu\n", int(edge->level), edge->time_us);
                     }
-
-                    // ************************************************** //
-                    //                   遠距離フェーズ                    //
-                    // ************************************************** //
-                    case Fase::Ldistance:
+                    while (const auto edge = usb_conect.next_edge())
                     {
-                        try
-                        {
-                            led_green.off();
-                            led_red.on();
-                            //------ちゃんと動くか確認するためのコード-----
-                            auto bno_data = bno055.read();
-                            auto gps_data = spresense.gps();
-                            // double t_lon = 130.9600102;//ゴールの経度 (google)
-                            // double t_lat = 30.3742469;//ゴールの緯度 (google)
-                            double t_lon = 130.95994488;//ゴールの経度(自分たちで決めて書き換えてね)
-                            double t_lat = 30.37427937;//ゴールの緯度
-                            double m_lon = double(std::get<1>(gps_data));//自分の経度(ここはGPSで手に入れたものが入るように書き換えて)
-                            double m_lat = double(std::get<0>(gps_data));//自分の緯度
-                            // double t_lon = 130.9576844;//ゴールの経度(自分たちで決めて書き換えてね)
-                            // double t_lat = 30.3750261;//ゴールの緯度
-                            // double m_lon = 130.9576844;//自分の経度(ここはGPSで手に入れたものが入るように書き換えて)
-                            // double m_lat = 30.3750261;//自分の緯度
-                            double t_lon_rad = deg_to_rad(t_lon);
-                            double t_lat_rad = deg_to_rad(t_lat);
-                            double m_lon_rad = deg_to_rad(m_lon);
-                            double m_lat_rad = deg_to_rad(m_lat);
-                            MagneticFluxDensity<sc::Unit::T> magnetic = std::get<2>(bno_data);
-                            //-------------------------------------------
-
-                            //機体の正面のベクトルを作る.ただし、bnoの都合上、後ろがxの正の向きで左がyの正の向き、下がzの正の向きとなっている
-                            // Vector3<double> front_vetor_basic = (-1.0, 0.0, 0.0);//機体正面の単位ベクトル
-
-                            //北を見つける
-                            Vector3<double> North_vector(double(magnetic.x()),double(magnetic.y()),0);//磁気センサから求める北の向き
-                            // Vector3<double> North_vector_basic = Normalization(North_vector);//正規化
-                            double North_angle_rad;//後で使う北の角度
-
-                            // 北がBnoの座標軸において何度回転した位置にあるか求める
-                            // 但しθは[0,2Pi)とした
-                            North_angle_rad = atan2(double(magnetic.y()),double(magnetic.x()));
-                            if(North_angle_rad < 0)
-                            {
-                                North_angle_rad += 2 * PI;
-                            }
-
-                            printf("%f\n",North_angle_rad);
-                            
-                            //スタート地点からゴールまでのベクトルを求める
-                            //--------------一旦動くかわからんが書いてみる--------------
-
-                            double distance = distance_sphere(t_lon_rad,t_lat_rad,m_lon_rad,m_lat_rad);//ゴールと自分の距離を求める
-                            double distance_vertical = distance_sphere(m_lon_rad,t_lat_rad,m_lon_rad,m_lat_rad);//縦の距離を求める(経度を同じにすることで)
-                            double distance_horizontal = distance_sphere(t_lon_rad,m_lat_rad,m_lon_rad,m_lat_rad);//横の長さを求める(緯度を同じにすることで)
-
-                            //ここが結構怪しい
-                            //自分の緯度のほうが高い場合、南向きに進む必要があるため、－符号をかける(北が正のため)
-                            if(m_lat_rad > t_lat_rad)
-                            {
-                                distance_vertical = -1*distance_vertical;
-                                // return distance_vertical;
-                            }
-                            //自分の経度のほうが小さい場合、東に向かう必要があるため(以下略)
-                            if(m_lon_rad < t_lon_rad)
-                            {
-                                distance_horizontal = -1*distance_horizontal;
-                                // return distance_horizontal;
-                            }
-                            
-                            print("%f\n",distance);
-                            printf("%f\n",distance_vertical);
-                            printf("%f\n",distance_horizontal);
-                            
-                            Vector3<double> direction(distance_vertical,distance_horizontal,0);
-                            //----------------------------
-                            Vector3<double> direction_vector_1(direction.x(),direction.y(),0);//東西南北を基底としたベクトルでベクトルを表現(北がx軸,西がy軸)
-                            
-                            //ベクトルのprintわかんなかったからChatGPTさんに出力してもらったよ。間違ってたら直してほしい
-                            std::cout << "(" << direction_vector_1.x() << ", " << direction_vector_1.y() << ", " << direction_vector_1.z() << ")" << std::endl;
-                            
-                            Vector3<double> direction_vector_2 = Rotation_clockwise_xy(direction_vector_1,Latitude<sc::Unit::rad>(North_angle_rad));//東西南北の基底から機体のxyを基底とした座標に回転.
-                            double direction_angle_rad;
-                            
-                            //ここも
-                            std::cout << "(" << direction_vector_2.x() << ", " << direction_vector_2.y() << ", " << direction_vector_2.z() << ")" << std::endl;
-
-                            direction_angle_rad = atan2(direction_vector_2[1],direction_vector_2[0]);
-
-                            printf("%f\n",direction_angle_rad);
-
-                            //front_vectorと呼べるものが(1,0,0)の場合
-                            if(direction_angle_rad < 0)
-                            {
-                                direction_angle_rad += 2 * PI;
-                            }
-
-                            //front_vectorと呼べるものが(-1,0,0)の場合
-                            // direction_angle_rad = direction_angle_rad + PI;//正面がxの負の向きなので180°回転
-
-                            double direction_angle_degree = rad_to_deg(direction_angle_rad);
-                            print("%f\n",direction_angle_degree);
-                            //ここからdirection_angleをもとに機体を動かす
-                            //一旦SC-17のコードを引っ張ってきたよ
-                            //sleep_msよりsleep使ったほうがいい?
-                            if(direction_angle_degree < 30 || direction_angle_degree > 330)
-                            {
-                                print("forward\n");
-                                // forward(1);
-                                // sleep_ms(3000);
-                                // forward(0.6);
-                                // sleep_ms(1000);
-                                // forward(0.2);
-                                // sleep_ms(1000);
-                                // forward(0);
-                                // sleep_ms(100);
-                                motor.forward(1.0);
-                                sleep(0.1_s);
-                                // motor.stop();
-                            }else if((direction_angle_degree) <135){
-                                print("left\n");
-                                // left(0.5);
-                                // sleep_ms(300);
-                                // left(0);
-                                // sleep_ms(100);
-                                motor.left(1.0);
-                                sleep(0.1_s);
-                                // motor.stop();
-                            }else if(direction_angle_degree < 180){
-                                print("sharp_left\n");
-                                // left(0.5);
-                                // sleep_ms(600);
-                                // left(0);
-                                // sleep_ms(100);
-                                motor.left(1.0);
-                                sleep(0.1_s);
-                                // motor.stop();
-                            }else if(direction_angle_degree > 225){
-                                print("right\n");
-                                // right(0.5);
-                                // sleep_ms(300);
-                                // right(0);
-                                // sleep_ms(100);
-                                motor.right(1.0);
-                                sleep(0.1_s);
-                                // motor.stop();
-                            }else{
-                                print("sharp_right\n");
-                                // right(0.5);
-                                // sleep_ms(600);
-                                // right(0);
-                                // sleep_ms(100);
-                                motor.right(1.0);
-                                sleep(0.1_s);
-                                // motor.stop();
-                            }
-                            if(distance < 3.0) //条件1：ゴールとの距離が5ｍ未満　→近距離フェーズへ
-                            {
-                                fase=Fase::Sdistance;
-                                motor.stop();
-                                print("Shifts to the short distance phase under condition 1\n");  // 条件1で近距離フェーズに移行します
-                                speaker.play_starwars();
-                                break;
-                            }
-                        }
-                        catch(const std::exception& e)
-                        {
-                            print(f_err(__FILE__, __LINE__, e, "era-desu"));
-                            is_success = false;
-                            led_pico.off();
-                            // もしエラーがでるなら
-                            try
-                            {
-                                motor.left(1.0);  // とりあえず進んでみる
-                                sleep(0.4_s);
-                                motor.stop();
-                                sleep(3_s);
-                                motor.right(1.0);
-                                sleep(0.4_s);
-                                motor.stop();
-                                sleep(3_s);
-                            }
-                            catch(const std::exception& e){print(e.what());}                            
-                        }
-                        break;  // 保険のbreak
+                        print("usb_conect:%d,%llu\n", int(edge->level), edge->time_us);
                     }
+                }
+                catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
 
-                    //5m 以下になったら近距離フェーズに移行
-
-                    // ************************************************** //
-                    //                   近距離フェーズ                    //
-                    // ************************************************** //
-                    case Fase::Sdistance:
+                // フェーズごとの処理 (sc/include/mission_loop.hpp)
+                if (loop.step())  // ゴールしたら，リセットせずにここで止まる
+                {
+                    while(true)
                     {
-                        try
-                        {
-                            led_red.on();
-                            led_green.on();
-                            auto camera_data = spresense.camera();
-                            
-                            if(camera_data == Cam::Center)//ゴールがカメラの真ん中
-                            {
-                                //少し進む
-                                // motor.forward(1.0);
-                                // sleep(1_s);
-                                // motor.forward(0);
-                                //超音波でゴール検知　→ゴール    
-                                // double hcsr_data_average = 0;
-                                // for(int i=0;i<10;++i)//超音波の値の平均
-                                // {
-                                //     hcsr_data_average += double(hcsr04.read());
-                                // }
-                                // hcsr_data_average/=10.0;
-
-                                if(hcsr04.read() < 0.2_m)//0.2m以内でゴール
-                                {
-                                    speaker.play_mario();
-                                    print("goal\n");
-                                    while(true)
-                                    {
-                                        ;
-                                    }
-                                }
-                            }
-                            else if(camera_data == Cam::Right)//ゴールがカメラの右
-                            {
-                                motor.right(1.0); 
-                                sleep(0.1_s);
-                                // motor.right(0); 
-                                break;
-                            }
-                            else if(camera_data == Cam::Left)//ゴールがカメラの左
-                            {
-                                motor.left(1.0); 
-                                sleep(0.1_s);
-                                // motor.left(0); 
-                                break;
-                            }
-                            else//ゴールがみつからない
-                            {
-                                motor.stop(); 
-                                sleep(0.1_s);
-                                // motor.right(0); 
-                                break;
-                            }
-                        }
-                        catch(const std::exception& e) { print(e.what()); is_success = false; led_pico.off(); }
-                        break;  // 保険のbreak
+                        ;
                     }
-
-                    // ************************************************** //
                 }
             }
-            catch(const std::exception& e){print(e.what());}
+            catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
         }
-        } catch(const std::exception& e){print(e.what());}
+        } catch(const std::exception& e){print(LogLevel::Error, LogModule::Main, e.what());}
         }
     }
     catch(const std::exception& e)
     {
         // エラー時の出力
-        print(e.what());
+        print(LogLevel::Error, LogModule::Main, e.what());
         print("\nOut of the loop\n");
     }
 }
@@ -541,7 +504,7 @@ int main()
 int main()
 {
     stdio_init_all();
-    sleep_ms(1000);
+    sc::BootTimeline::mark("stdio");
     printf("init_ok\n");
     while(true) 
         sc::main();
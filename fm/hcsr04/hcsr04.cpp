@@ -1,34 +1,21 @@
 #include "hcsr04.hpp" //クラス定義
 
 
-// prototype ...
-void hcsr_callback(uint gpio, uint32_t emask);
-
-
-static absolute_time_t up_edge_time{};
-static absolute_time_t dn_edge_time{};
-static uint64_t dtime = 0;
-static uint8_t echo_pin_gpio_num = 0;
-
 namespace sc 
 {
 
 HCSR04::HCSR04(Pin trig_pin, Pin echo_pin) try :
-    _out_pin(trig_pin, Pull::Down), _in_pin(echo_pin)
+    _out_pin(trig_pin, Pull::Down), _echo(echo_pin, Pull::No, Time<Unit::s>(0))  // パルス幅を測るのでチャタリングは取り除かない
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     try
     {
-        // gpio_init(28);
-        // gpio_set_dir(28, GPIO_OUT);
-        // gpio_pull_down(28);
-
-        // gpio_init(19);
-        // gpio_set_dir(19, GPIO_IN);
-        gpio_set_irq_enabled_with_callback(_in_pin.gpio(), GPIO_IRQ_EDGE_RISE + GPIO_IRQ_EDGE_FALL, true, &hcsr_callback);
-        echo_pin_gpio_num = _in_pin.gpio();
+        if (_echo.save == false)
+        {
+throw std::logic_error(f_err(__FILE__, __LINE__, "Failed to set up the echo pin"));  // Echoピンのセットアップに失敗しました
+        }
     }
     catch(const std::exception& e)
     {
@@ -45,12 +32,24 @@ Length<Unit::m> HCSR04::read()
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
+    return try_read().value();  // 失敗したら例外を投げる
+}
+
+Result<Length<Unit::m>> HCSR04::try_read()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("hcsr04_read");  // 処理時間を計測
     int temperature=20,humidity=60;
     static double old_distance;
     double distance[3];
 
     for (int i=0; i<3; ++i)
     {
+        _echo.clear();  // 前回の測定の残りを捨てる
+        const uint64_t trigger_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+
         // trigger
         // gpio_put(28, 1);
         _out_pin.on();
@@ -58,12 +57,24 @@ Length<Unit::m> HCSR04::read()
         // gpio_put(28, 0);
         _out_pin.off();
 
-        // wait
-        busy_wait_ms(86);
+        // Echoピンが立ち上がってから立ち下がるまでの時間を，割り込みで記録した時刻から求める
+        const Result<EdgeInput::Edge> rise = _echo.wait_for_edge(Time<Unit::s>(0.01), EdgeInput::Trigger::Rise);
+        if (!rise)
+        {
+            return Error(ErrorSource::HCSR04, ErrorCode::Timeout, __FILE__, __LINE__);  // 距離の測定に失敗しました
+        }
+        const Result<EdgeInput::Edge> fall = _echo.wait_for_edge(Time<Unit::s>(0.08), EdgeInput::Trigger::Fall);
+        if (!fall)
+        {
+            return Error(ErrorSource::HCSR04, ErrorCode::Timeout, __FILE__, __LINE__);  // 距離の測定に失敗しました
+        }
+        const uint64_t dtime = fall->time_us - rise->time_us;
 
-        if (absolute_time_diff_us(get_absolute_time(), dn_edge_time) > 100*1000)
+        // wait (反響が消えるまで，前と同じ間隔を空ける)
+        const uint64_t elapsed_us = ::time_us_64() - trigger_us;  // pico-SDKの関数  起動からの時間(μs)を取得
+        if (elapsed_us < 86*1000)
         {
-            throw std::runtime_error(f_err(__FILE__, __LINE__, "Distance measurement failed"));  // 距離の測定に失敗しました
+            busy_wait_us(86*1000 - elapsed_us);
         }
         
         distance[i]=((331.4+(0.606*temperature)+(0.0124*humidity))*(dtime*milli/2.0)*milli);
@@ -71,42 +82,22 @@ Length<Unit::m> HCSR04::read()
         // 前回と全く同じ値だったら測定に失敗したとみなす
         if (old_distance == distance[i])
         {
-            throw std::runtime_error(f_err(__FILE__, __LINE__, "Distance measurement failed"));  // 距離の測定に失敗しました
+            return Error(ErrorSource::HCSR04, ErrorCode::Stuck, __FILE__, __LINE__);  // 距離の測定に失敗しました
         }
         old_distance = distance[i];
 
         if (distance[i] > 12.0)
         {
-            throw std::runtime_error(f_err(__FILE__, __LINE__, "Distance measurement failed"));  // 距離の測定に失敗しました
+            return Error(ErrorSource::HCSR04, ErrorCode::InvalidValue, __FILE__, __LINE__);  // 距離の測定に失敗しました
         }
     }
 
     double distance_med = median(distance[0], distance[1], distance[2]);
 
-    print("hcsr_read_data:%f\n", distance_med);
+    print(LogLevel::Data, LogModule::HCSR04, "hcsr_read_data:%f\n", distance_med);
     
     return Length<Unit::m>(distance_med);
 }
 
 
 }
-
-
-// function: callback of hcsr04 echo signal intrrupt
-void hcsr_callback(uint gpio, uint32_t emask) {
-    gpio_set_irq_enabled(gpio, (GPIO_IRQ_EDGE_RISE + GPIO_IRQ_EDGE_FALL), false);
-
-    if (emask == GPIO_IRQ_EDGE_RISE) {
-        // high -> up edge detect: count start
-        up_edge_time = get_absolute_time();
-    } else if (emask == GPIO_IRQ_EDGE_FALL) {
-        // low -> down edge detect: calculate time from rise edge to fall edge
-        dn_edge_time = get_absolute_time();
-        dtime = absolute_time_diff_us(up_edge_time, dn_edge_time);
-    } else {
-        // do nothing
-    }
-
-    // irq enable
-    gpio_set_irq_enabled(gpio, (GPIO_IRQ_EDGE_RISE + GPIO_IRQ_EDGE_FALL), true);
-}
\ No newline at end of file
@@ -15,7 +15,7 @@ namespace sc
 //! @param echo_pin 入力用のEchoピン
 class HCSR04 {
     const GPIO<Out> _out_pin;
-    const GPIO<In> _in_pin;
+    EdgeInput _echo;  // Echoピンの変化を時刻付きで記録する
 public:
     //! @brief HCSR04のクラス
     //! @param trig_pin 出力用のTrigピン
@@ -23,6 +23,10 @@ public:
     HCSR04(Pin trig_pin, Pin echo_pin);
     
     Length<Unit::m> read();          
+
+    //! @brief 距離を測定 (失敗しても例外を投げない)
+    //! @return 距離か，エラー
+    Result<Length<Unit::m>> try_read();
 };
 
 }
@@ -44,10 +44,19 @@ public:
                 adc_value[i] = _lux_adc.read();
             }
             uint16_t adc_m = median(adc_value[0], adc_value[1], adc_value[2]);
-            print("njl_read_data:%f\n", double(adc_m * 9));  // 9倍して単位がlxになるのは実験値
+            if (series)
+            {
+                series->add(to_ms_since_boot(get_absolute_time()), {float(adc_m * 9)});
+            } else {
+                print(LogLevel::Data, LogModule::NJL5513R, "njl_read_data:%f\n", double(adc_m * 9));  // 9倍して単位がlxになるのは実験値
+            }
             return Illuminance<Unit::lx>(adc_m * 9);  // 9倍して単位がlxになるのは実験値
         }
 
+    //! @brief 測定値の記録先 (照度 1lxの1チャンネル)
+    //! @note 設定すると，測定値を文字列でprintせずにここに記録します (nullptrなら今まで通りprint)
+    static inline SeriesEncoder* series = nullptr;
+
 };
 
 /*
@@ -5,6 +5,8 @@
  * ADCによる入力に関するコードです
  * このファイルは，adc.cppに書かれている関数の一覧です
  * 
+ * AdcSamplerを作成すると，ADCはDMAで常に全チャンネルを測定し続け，
+ * ADC，PicoTemp，VsysVoltageのread()は待機せずに最新の平均値を返すようになります．
 **************************************************/
 
 //! @file adc.hpp
@@ -12,7 +14,10 @@
 
 #include "sc_basic.hpp"
 
+#include <array>
+
 #include "pwm.hpp"
+#include "series.hpp"
 
 #include "hardware/adc.h"
 
@@ -38,8 +43,14 @@ private:
 
 public:
     //! @brief ADCを読み取り
+    //! @note AdcSamplerが動いているときは，待機せずに最新の平均値を返します
     uint16_t read() const;
 
+    //! @brief チャンネルを指定してADCを読み取り
+    //! @note AdcSamplerが動いているときは，待機せずに最新の平均値を返します
+    //! @param channel ADCのチャンネル (0～4)
+    static uint16_t read_channel(uint8_t channel);
+
     static inline bool IsUse[5] = {false, false, false, false, false};  // 既にADCを使用しているか
 
     bool save = true;
@@ -65,7 +76,59 @@ public:
 
     dimension::V read();
 
+    //! @brief 測定値の記録先 (電圧 1mVの1チャンネル)
+    //! @note 設定すると，測定値を文字列でprintせずにここに記録します (nullptrなら今まで通りprint)
+    static inline SeriesEncoder* series = nullptr;
+
+    bool save = true;
+};
+
+//! @brief ADCをラウンドロビンで測定し続け，DMAでリングバッファに書き込むクラス
+//! @note 作成した時点で使用中のチャンネル(ADC，PicoTemp，VsysVoltage)をすべて測定するので，それらを作成した後に作成してください
+//! @note 作成した後は，各チャンネルのread()が待機せずに最新の平均値を返します
+class AdcSampler : Noncopyable
+{
+public:
+    //! @brief ADCの連続測定をセットアップし，開始
+    //! @param sample_rate 1チャンネルあたりの測定の周波数
+    //! @param oversample read()で何個の測定値を平均するか (間引きフィルタ)
+    AdcSampler(Frequency<Unit::Hz> sample_rate = Frequency<Unit::Hz>(1000), std::size_t oversample = 16);
+
+    //! @brief 最新の平均値
+    //! @param channel ADCのチャンネル (0～4)
+    uint16_t latest(uint8_t channel) const;
+
+    //! @brief 最新のcount個の測定値の平均
+    //! @param channel ADCのチャンネル (0～4)
+    //! @param count 平均する個数 (リングバッファに残っている個数より多いときは，残っている分だけ)
+    uint16_t average(uint8_t channel, std::size_t count) const;
+
+    //! @brief 起動してから測定した回数 (全チャンネルの合計)
+    uint64_t sample_count() const;
+
+    ~AdcSampler();
+
+    static constexpr std::size_t RingSize = 256;  // リングバッファの長さ (2の累乗)
+
     bool save = true;
+
+    static inline AdcSampler* Instance = nullptr;  // 動いているAdcSampler (なければnullptr)
+
+private:
+    std::array<uint8_t, 5> _order{};  // 測定する順番 (チャンネルの番号)
+    std::array<uint8_t, 5> _position{};  // 各チャンネルが何番目に測定されるか (測定しないときはNotUsed)
+    std::size_t _channel_num = 0;  // 測定するチャンネルの数
+    std::size_t _oversample;  // read()で平均する個数
+    uint32_t _total_count = 0;  // DMAの1回の転送の回数 (RingSizeと_channel_numの倍数)
+    uint _dma_channel = 0;  // 使用するDMAのチャンネル
+    volatile uint64_t _base = 0;  // 今のDMAの転送が始まるまでに測定した回数
+
+    static constexpr uint8_t NotUsed = 0xFF;
+
+    //! @brief DMAの転送が終わったときに呼ばれる関数 (もう一度開始する)
+    static void dma_handler();
+
+    alignas(RingSize * sizeof(uint16_t)) static inline std::array<uint16_t, RingSize> Ring{};  // 測定値のリングバッファ (DMAのリングモードのため，サイズに揃える)
 };
 
 }
@@ -0,0 +1,95 @@
+#ifndef SC19_PICO_SC_ALTITUDE_FILTER_HPP_
+#define SC19_PICO_SC_ALTITUDE_FILTER_HPP_
+
+/**************************************************
+ * 高度の推定に関するコードです
+ * このファイルは，altitude_filter.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，気圧高度と鉛直加速度を融合するカルマンフィルタが宣言されています．
+**************************************************/
+
+//! @file altitude_filter.hpp
+//! @brief 気圧高度と鉛直加速度から高度・鉛直速度を推定
+
+// #include "sc_basic.hpp"
+
+#include "unit.hpp"
+
+
+namespace sc
+{
+
+//! @brief 気圧高度と鉛直加速度を融合する2状態(高度・鉛直速度)のカルマンフィルタ
+//! @note 動的メモリは使わず，内部の計算はすべてfloatで行います
+//! @note IMUを読むたびにpredict，BME280を読むたびにupdateを呼んでください
+class AltitudeFilter
+{
+    float _altitude = 0.0F;  // 推定高度 (m)
+    float _speed = 0.0F;  // 推定鉛直速度 (m/s)  上向きが正
+    float _p00 = 0.0F, _p01 = 0.0F, _p11 = 0.0F;  // 誤差共分散行列 (対称なので3要素だけ持つ)
+    float _max_altitude = 0.0F;  // これまでの推定高度の最大値 (m)
+    float _still_time = 0.0F;  // 鉛直速度が小さい状態が続いている時間 (s)
+    bool _initialized = false;  // 最初の観測値で初期化したか
+
+    const float _accel_var;  // 加速度のプロセスノイズの分散 (m²/s⁴)
+    const float _altitude_var;  // 気圧高度の観測ノイズの分散 (m²)
+
+    static constexpr float MaxDt = 1.0F;  // これより長い予測は1回で行わない (s)
+    static constexpr float StillSpeed = 0.3F;  // 静止とみなす鉛直速度 (m/s)
+
+public:
+    //! @brief カルマンフィルタを作成
+    //! @param accel_noise 鉛直加速度の標準偏差 (m/s²)
+    //! @param altitude_noise 気圧高度の標準偏差 (m)
+    explicit AltitudeFilter(float accel_noise = 0.5F, float altitude_noise = 0.5F);
+
+    //! @brief 推定値を指定した高度で初期化し，鉛直速度を0にする
+    //! @param altitude 初期高度
+    void reset(Altitude<Unit::m> altitude);
+
+    //! @brief 鉛直加速度を用いて状態を予測
+    //! @param vertical_acceleration 上向きを正とした鉛直方向の線形加速度
+    //! @param dt 前回の予測からの経過時間
+    void predict(dimension::m_s2 vertical_acceleration, Time<Unit::s> dt);
+
+    //! @brief 気圧高度の観測値で状態を更新
+    //! @param altitude BME280から求めた高度
+    void update(Altitude<Unit::m> altitude);
+
+    //! @brief 推定した高度
+    Altitude<Unit::m> altitude() const
+        {return Altitude<Unit::m>(_altitude);}
+
+    //! @brief 推定した鉛直速度 (上向きが正)
+    dimension::m_s vertical_speed() const
+        {return dimension::m_s(_speed);}
+
+    //! @brief これまでの推定高度の最大値
+    Altitude<Unit::m> max_altitude() const
+        {return Altitude<Unit::m>(_max_altitude);}
+
+    //! @brief 指定した速さ以上で降下しているか
+    //! @param speed 降下とみなす速さ (正の値)
+    bool is_descending(dimension::m_s speed) const
+        {return _initialized && _speed < -static_cast<float>(double(speed));}
+
+    //! @brief 最高点を通過したか (最高点より指定した高さ以上下がり，降下しているか)
+    //! @param drop 最高点からどれだけ下がったら通過とみなすか
+    bool is_past_apogee(dimension::m drop) const
+        {return _initialized && _speed < 0.0F && (_max_altitude - _altitude) > static_cast<float>(double(drop));}
+
+    //! @brief 鉛直方向に静止している状態が指定した時間以上続いているか
+    //! @param time 静止とみなすまでの時間
+    bool is_still(Time<Unit::s> time) const
+        {return _initialized && _still_time >= static_cast<float>(double(time));}
+
+    //! @brief 線形加速度を重力の向きに射影して鉛直加速度を求める
+    //! @param line_acce BNO055の線形加速度
+    //! @param gravity BNO055の重力加速度 (上向きの反力として出力されるもの)
+    //! @return 上向きを正とした鉛直加速度
+    static dimension::m_s2 vertical_acceleration(const Acceleration<Unit::m_s2>& line_acce, const Acceleration<Unit::m_s2>& gravity);
+};
+
+}
+
+#endif  // SC19_PICO_SC_ALTITUDE_FILTER_HPP_
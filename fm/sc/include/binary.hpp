@@ -14,7 +14,11 @@
 
 #include "sc_basic.hpp"
 
+#include <algorithm>
+#include <array>
+#include <initializer_list>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace sc
@@ -22,6 +26,42 @@ namespace sc
 
 class Binary;
 
+//! @brief バイト列を所有せずに参照するクラス
+//! @note データをコピーしないので，参照先のデータよりも長く使わないでください
+//! @note 通信の関数に毎回渡すものなので，デバッグ出力はしません
+class BinaryView
+{
+    const uint8_t* _data;  // 参照先のデータの先頭
+    std::size_t _size;  // 参照先のデータのサイズ
+public:
+    //! @brief 配列を参照
+    //! @param data 配列の先頭
+    //! @param size 配列の長さ
+    constexpr BinaryView(const uint8_t* data, std::size_t size) noexcept:
+        _data(data), _size(size) {}
+
+    //! @brief Binaryのデータを参照
+    BinaryView(const Binary& binary) noexcept;
+
+    //! @brief バイト列のサイズを返す
+    constexpr std::size_t size() const noexcept
+        {return _size;}
+
+    //! @brief データの先頭へのポインタを返す
+    constexpr const uint8_t* data() const noexcept
+        {return _data;}
+
+    //! @brief バイト列のindex番目の値を返す
+    //! @note バイト列のサイズ以上のindexを指定した場合，エラーが発生するかは未定義．
+    constexpr uint8_t operator[](std::size_t index) const noexcept
+        {return _data[index];}
+
+    constexpr const uint8_t* begin() const noexcept
+        {return _data;}
+    constexpr const uint8_t* end() const noexcept
+        {return _data + _size;}
+};
+
 //! @brief Binaryのデータをcoutで出力
 std::ostream& operator<< (std::ostream&, const Binary&);
 // この関数を作成するにあたり，以下を参考にしました
@@ -38,7 +78,8 @@ public:
 
     //! @brief 配列やvectorなどのコンテナからバイト列を作成
     //! @param data コンテナ形式のデータ
-    template<typename Iterable, typename std::enable_if<IsIterable<Iterable>::value, std::nullptr_t>::type = nullptr>  // コンテナ形式の型でなければエラーになる
+    //! @note StaticBinaryはBinaryViewとして渡されるので，ここでは受け取りません (通信の関数の引数で曖昧にならないようにするため)
+    template<typename Iterable, typename std::enable_if<IsIterable<Iterable>::value && !std::is_convertible<Iterable, BinaryView>::value, std::nullptr_t>::type = nullptr>  // コンテナ形式の型でなければエラーになる
     Binary(const Iterable& data) try :
         _binary_data(std::begin(data), std::end(data))
     {
@@ -182,6 +223,104 @@ Binary operator+ (uint8_t first_byte, const Binary& binary);
 //! @brief バイナリデータの末尾に1バイト追加
 Binary operator+ (const Binary& binary, uint8_t end_byte);
 
+inline BinaryView::BinaryView(const Binary& binary) noexcept:
+    _data(binary.data().data()), _size(binary.data().size()) {}
+
+
+//! @brief 最大Nバイトのバイト列を，動的メモリを使わずに保持するクラス
+//! @note 通信で受信したデータをこの中に直接書き込むことで，Binaryを作るときのメモリ確保とコピーをなくせます
+//! @note 通信の関数に毎回渡すものなので，デバッグ出力はしません
+template<std::size_t N>
+class StaticBinary
+{
+    std::array<uint8_t, N> _binary_data{};  // バイト列のデータ
+    std::size_t _size = N;  // 実際に使っているバイト数
+public:
+    //! @brief Nバイトのバイト列を作成 (中身は0)
+    StaticBinary() = default;
+
+    //! @brief sizeバイトのバイト列を作成 (中身は0)
+    //! @param size バイト数 (N以下)
+    explicit StaticBinary(std::size_t size):
+        _size(size)
+    {
+        if (N < size)
+        {
+throw std::length_error(f_err(__FILE__, __LINE__, "The size of StaticBinary must be %u bytes or less. However, %u was entered.", unsigned(N), unsigned(size)));  // StaticBinaryの容量を超えています
+        }
+    }
+
+    //! @brief { }からバイト列を作成
+    //! @param init_list {1, 2, 3}などのデータ
+    StaticBinary(std::initializer_list<uint8_t> init_list):
+        StaticBinary(init_list.size())
+    {
+        std::copy(init_list.begin(), init_list.end(), _binary_data.begin());
+    }
+
+    //! @brief バイト列のサイズを返す
+    std::size_t size() const noexcept
+        {return _size;}
+
+    //! @brief 保持できる最大のバイト数を返す
+    static constexpr std::size_t capacity() noexcept
+        {return N;}
+
+    //! @brief バイト列のサイズを変更 (増えた部分の中身は未定義)
+    //! @param size 新しいバイト数 (N以下)
+    void resize(std::size_t size)
+    {
+        if (N < size)
+        {
+throw std::length_error(f_err(__FILE__, __LINE__, "The size of StaticBinary must be %u bytes or less. However, %u was entered.", unsigned(N), unsigned(size)));  // StaticBinaryの容量を超えています
+        }
+        _size = size;
+    }
+
+    //! @brief データの先頭へのポインタを返す
+    uint8_t* data() noexcept
+        {return _binary_data.data();}
+    const uint8_t* data() const noexcept
+        {return _binary_data.data();}
+
+    //! @brief バイト列のindex番目の値を返す
+    //! @note バイト列のサイズ以上のindexを指定した場合，エラーが発生するかは未定義．
+    uint8_t& operator[](std::size_t index) noexcept
+        {return _binary_data[index];}
+    uint8_t operator[](std::size_t index) const noexcept
+        {return _binary_data[index];}
+
+    //! @brief バイト列のindex番目の値を返す
+    //! @note バイト列のサイズ以上のindexを指定した場合，エラーstd::out_of_rangeを返す．
+    uint8_t at(std::size_t index) const
+    {
+        if (_size <= index)
+        {
+throw std::out_of_range(f_err(__FILE__, __LINE__, "Index %u is out of range of StaticBinary (size %u)", unsigned(index), unsigned(_size)));  // 範囲外のindexです
+        }
+        return _binary_data[index];
+    }
+
+    uint8_t* begin() noexcept
+        {return _binary_data.data();}
+    uint8_t* end() noexcept
+        {return _binary_data.data() + _size;}
+    const uint8_t* begin() const noexcept
+        {return _binary_data.data();}
+    const uint8_t* end() const noexcept
+        {return _binary_data.data() + _size;}
+
+    //! @brief BinaryViewとして参照
+    BinaryView view() const noexcept
+        {return BinaryView(_binary_data.data(), _size);}
+    operator BinaryView() const noexcept
+        {return view();}
+
+    //! @brief 配列の先頭へのポインタにデータを代入
+    void to_assign(uint8_t* reg_ptr) const
+        {std::copy(begin(), end(), reg_ptr);}
+};
+
 }
 
 #endif  // SC19_PICO_SC_BINARY_HPP_
\ No newline at end of file
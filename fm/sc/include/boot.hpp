@@ -0,0 +1,55 @@
+#ifndef SC19_PICO_SC_BOOT_HPP_
+#define SC19_PICO_SC_BOOT_HPP_
+
+/**************************************************
+ * 起動にかかる時間を段階ごとに記録するためのコードです
+ * このファイルは，boot.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，電源を入れてから各段階(デバイスの作成，センサの初期化，基準気圧の設定など)が
+ * 終わるまでの時刻を記録し，段階ごとにかかった時間を表示するクラスが宣言されています．
+ * 起動を速くするときに，どこに時間がかかっているのかを確かめるために使います．
+**************************************************/
+
+//! @file boot.hpp
+//! @brief 起動の段階ごとの時間
+
+#include "sc_basic.hpp"
+
+#include <array>
+
+namespace sc
+{
+
+//! @brief 起動の段階ごとの時刻を記録するクラス
+//! @note 時刻は電源を入れて(リセットして)からの時間で，最初の段階は電源を入れた時刻から測ります
+class BootTimeline
+{
+public:
+    static constexpr std::size_t MaxStages = 16;  // 記録できる段階の数
+
+    //! @brief 段階が終わったことを記録
+    //! @param stage 段階の名前 (文字列リテラルなど，ずっと残る文字列を渡す)
+    //! @note MaxStagesを超えた分は記録しません
+    static void mark(const char* stage);
+
+    //! @brief 段階ごとにかかった時間と，電源を入れてからの時刻を表示
+    static void print();
+
+    //! @brief 電源を入れてから最後に記録した段階が終わるまでの時間 (μs)
+    static uint64_t total_us();
+
+private:
+    //! @brief 1つの段階
+    struct Stage
+    {
+        const char* name;  // 段階の名前
+        uint64_t end_us;  // 段階が終わった時刻 (μs)
+    };
+
+    static inline std::array<Stage, MaxStages> Stages{};  // 記録した段階
+    static inline std::size_t Count = 0;  // 記録した段階の数
+};
+
+}
+
+#endif  // SC19_PICO_SC_BOOT_HPP_
@@ -0,0 +1,145 @@
+#ifndef SC19_PICO_SC_CHECKPOINT_HPP_
+#define SC19_PICO_SC_CHECKPOINT_HPP_
+
+/**************************************************
+ * リセットされてもミッションを途中から続けるためのコードです
+ * このファイルは，checkpoint.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，ミッションの状態(フェーズ，開始からの時間，標高の基準，最後のGPSの位置)を
+ * 3か所に保存し，起動したときに読み出すクラスが宣言されています．
+ *   1. 初期化されないRAM       : 毎ループ保存  ウォッチドッグやRUNピンのリセットでは消えない
+ *   2. ウォッチドッグのスクラッチレジスタ : 毎ループ保存  RAMが壊れたときの予備 (フェーズ・時間・基準気圧だけ)
+ *   3. フラッシュメモリ          : フェーズが変わったときと一定時間ごとに保存  電源が落ちても消えない
+ * フラッシュメモリの状態は，ウォッチドッグかRUNピンによるリセットのときだけ読み出します．
+ * 電源を入れたときは前回の飛行の古い状態かもしれないので，読み出さずに消します．
+ * (RP2040では内蔵のブラウンアウト検出によるリセットも電源を入れたときと区別できませんが，短い電圧低下ならRAMが残っているので，そこから再開できます)
+ * また，ハードウェアのウォッチドッグを動かし，ループが止まったら自動でリセットします．
+ * リセット後は数ミリ秒で保存したフェーズから再開できます．
+**************************************************/
+
+//! @file checkpoint.hpp
+//! @brief リセット後にミッションを途中から再開する
+
+#include "sc_basic.hpp"
+
+#include <optional>
+
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/vreg_and_chip_reset.h"
+#include "hardware/structs/watchdog.h"
+
+namespace sc
+{
+
+//! @brief リセットされても引き継ぐミッションの状態
+struct MissionState
+{
+    uint8_t phase = 0;  // フェーズ (fm.cppのFaseの値)
+    uint32_t elapsed_ms = 0;  // ミッションを始めてからの時間 (ms)
+    float origin_pressure = 101325;  // 標高の基準の気圧 (Pa)
+    float origin_temperature = 20;  // 標高の基準の気温 (°C)
+    bool has_fix = false;  // GPSの位置を受信したことがあるか
+    double latitude = 0;  // 最後に受信した緯度 (°)
+    double longitude = 0;  // 最後に受信した経度 (°)
+};
+
+//! @brief ミッションの状態を保存し，リセット後に読み出すクラス
+//! @note フラッシュメモリの保存先は，Flushのログ(0x1F0000~)の直前の1セクタです
+//!       フラッシュメモリに保存した待機フェーズの状態は，電源を入れ直しただけのときと区別できないので読み出しません
+//!       電源を入れたときは，フラッシュメモリに保存した待機フェーズ以外の状態を消します
+class Checkpoint : Noncopyable
+{
+public:
+    //! @brief どこから読み出したか
+    enum class Source : uint8_t
+    {
+        None,  // 保存されていなかった (電源を入れて最初の起動)
+        Ram,  // 初期化されないRAM
+        Scratch,  // ウォッチドッグのスクラッチレジスタ
+        Flash  // フラッシュメモリ
+    };
+
+    //! @brief 前回のリセットの理由
+    enum class ResetReason : uint8_t
+    {
+        PowerOn,  // 電源を入れた (内蔵のブラウンアウト検出によるリセットを含む)
+        RunPin,  // RUNピン (リセットボタンや外付けの電圧監視IC)
+        Watchdog  // ウォッチドッグ (タイムアウトかwatchdog_reboot)
+    };
+
+    //! @brief 保存先を準備 (ウォッチドッグはstart_watchdogを呼ぶまで動かさない)
+    //! @param watchdog_ms この時間(ms)だけfeedされないとリセットする (最大8388ms)
+    //! @param flash_interval_ms フェーズが変わらなくても，この時間(ms)ごとにフラッシュメモリへ保存する
+    Checkpoint(uint32_t watchdog_ms = 8000, uint32_t flash_interval_ms = 10000);
+
+    //! @brief 前回保存した状態を読み出す (RAM，スクラッチレジスタ，フラッシュメモリの順に，壊れていないものを使う)
+    //! @note フラッシュメモリは，ウォッチドッグかRUNピンによるリセットのときだけ使います
+    //! @return 保存した状態  保存されていなければstd::nullopt
+    std::optional<MissionState> restore();
+
+    //! @brief restoreでどこから読み出したか
+    Source source() const
+        {return _source;}
+
+    //! @brief 前回のリセットがウォッチドッグによるものだったか
+    bool watchdog_reboot() const;
+
+    //! @brief 前回のリセットの理由
+    static ResetReason reset_reason();
+
+    //! @brief 状態を保存 (RAMとスクラッチレジスタには毎回，フラッシュメモリにはフェーズが変わったときと一定時間ごと)
+    //! @note フラッシュメモリへ保存するときだけ，割り込みを止めて約50ms待ちます
+    void store(const MissionState& state);
+
+    //! @brief ウォッチドッグを動かす (起動が終わってループに入る直前に呼ぶ)
+    //! @note USBでログを出力している間や，センサの起動を待っている間にリセットされないように，コンストラクタでは動かしません
+    void start_watchdog();
+
+    //! @brief ウォッチドッグを止める (必ず終わるが，watchdog_msより長く待つ処理(曲を鳴らすなど)の前に呼び，後でstart_watchdogを呼ぶ)
+    void pause_watchdog();
+
+    //! @brief ウォッチドッグのタイマーを戻す (ループごとに呼ぶ)
+    void feed();
+
+    //! @brief 保存した状態をすべて消す (地上でUSBをつないで起動したとき)
+    void clear();
+
+    bool save = true;
+
+private:
+    static constexpr uint32_t Magic = 0x53435031;  // "SCP1"
+    static constexpr uint32_t ScratchMagic = 0xC5;  // スクラッチレジスタ0の上位8bit
+    static constexpr uint32_t FlashOffset = 0x1EF000;  // Flushのログの直前のセクタ
+
+    //! @brief 保存する形式
+    struct Record
+    {
+        uint32_t magic;
+        uint32_t sequence;  // 保存するたびに増える
+        MissionState state;
+        uint32_t crc;  // magicからstateまでのCRC32
+    };
+
+    const uint32_t _watchdog_ms;
+    const uint32_t _flash_interval_ms;
+    Source _source = Source::None;
+    uint32_t _sequence = 0;
+    std::optional<uint8_t> _flash_phase;  // 最後にフラッシュメモリへ保存したフェーズ
+    uint32_t _flash_elapsed_ms = 0;  // 最後にフラッシュメモリへ保存したときの経過時間 (ms)
+
+    //! @brief CRC32 (多項式0xEDB88320)
+    static uint32_t crc32(const void* data, std::size_t size);
+    //! @brief Recordが壊れていないか
+    static bool valid(const Record& record);
+    //! @brief スクラッチレジスタ0~2から作るチェック用の値
+    static uint32_t scratch_check(uint32_t s0, uint32_t s1, uint32_t s2);
+
+    void store_flash(const Record& record);
+    void erase_flash();
+};
+
+}
+
+#endif  // SC19_PICO_SC_CHECKPOINT_HPP_
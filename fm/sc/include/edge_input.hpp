@@ -0,0 +1,125 @@
+#ifndef SC19_PICO_SC_EDGE_INPUT_HPP_
+#define SC19_PICO_SC_EDGE_INPUT_HPP_
+
+/**************************************************
+ * GPIOピンの変化を割り込みで記録するためのコードです
+ * このファイルは，edge_input.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，ピンの立ち上がり・立ち下がりを割り込みで検知し，
+ * チャタリングを取り除いてから時刻付きで記録するクラスが宣言されています．
+ * GPIO<In>::read()はその瞬間の状態しか分かりませんが，こちらを使うと
+ * メインループが他の処理をしている間に起きた変化(パラシュートの分離など)も取りこぼしません．
+**************************************************/
+
+//! @file edge_input.hpp
+//! @brief GPIOピンの変化の割り込みによる記録
+
+#include "sc_basic.hpp"
+
+#include <array>
+#include <optional>
+
+#include "gpio.hpp"
+#include "result.hpp"
+
+namespace sc
+{
+
+//! @brief ピンの変化(エッジ)を割り込みで検知し，チャタリングを取り除いて記録するクラス
+//! @note 変化してからdebounceの時間だけ同じ状態が続いたときに，最初に変化した時刻で記録します
+//! @note 途中で元の状態に戻ったもの(ノイズ)は記録しません
+//! @note GPIOの割り込みはこのクラスがまとめて受け取るので，他でgpio_set_irq_enabled_with_callbackを使わないでください
+class EdgeInput : Noncopyable
+{
+public:
+    //! @brief エッジの種類
+    enum class Trigger : uint8_t
+    {
+        Rise,  // 立ち上がり (Low→High)
+        Fall,  // 立ち下がり (High→Low)
+        Both  // 両方
+    };
+
+    //! @brief 記録したエッジ
+    struct Edge
+    {
+        bool level;  // 変化した後の状態 (立ち上がりならtrue)
+        uint64_t time_us;  // 変化した時刻 (起動からのμs)
+    };
+
+    //! @brief 割り込みによる入力用ピンをセットアップ
+    //! @param pin 入力用ピンのGPIO番号
+    //! @param pull プルアップ/プルダウンを指定
+    //! @param debounce この時間より短い変化はチャタリングとして無視する (0なら全ての変化を記録)
+    EdgeInput(Pin pin, Pull pull = Pull::No, Time<Unit::s> debounce = Time<Unit::s>(0.01));
+
+    //! @brief チャタリングを取り除いた現在の状態
+    //! @return High(1)かLow(0)か
+    bool read() const;
+
+    //! @brief 記録したエッジを1つ取り出す (待機しない)
+    //! @return 一番古いエッジ (なければ空)
+    std::optional<Edge> next_edge();
+
+    //! @brief エッジが記録されるまで待ち，取り出す
+    //! @param timeout 待つ時間の上限
+    //! @param trigger 待つエッジの種類 (違う種類のものは取り出して捨てる)
+    //! @return エッジか，エラー (時間内に記録されなかったとき)
+    Result<Edge> wait_for_edge(Time<Unit::s> timeout, Trigger trigger = Trigger::Both);
+
+    //! @brief 最後に記録したエッジ (取り出したものも含む)
+    //! @return 最後のエッジ (1度も変化していなければ空)
+    std::optional<Edge> last_edge() const;
+
+    //! @brief 取り出していないエッジの数
+    std::size_t available() const;
+
+    //! @brief 取り出していないエッジを全て捨てる
+    void clear();
+
+    //! @brief 記録しきれずに捨てたエッジの数
+    uint32_t overflow_count() const
+        {return _overflow;}
+
+    //! @brief GPIO番号を取得
+    //! @return GPIO番号
+    uint8_t gpio() const
+        {return _gpio.gpio();}
+
+    ~EdgeInput();
+
+    static constexpr std::size_t QueueSize = 16;  // 記録できるエッジの数
+
+    bool save = true;
+
+private:
+    const GPIO<In> _gpio;  // 使用するピン
+    const uint64_t _debounce_us;  // チャタリングとみなす時間 (μs)
+    volatile bool _stable_level = false;  // チャタリングを取り除いた状態
+    volatile bool _pending = false;  // 状態が変化してから，まだ確定していないか
+    volatile bool _candidate_level = false;  // 確定していない状態
+    volatile uint64_t _first_us = 0;  // 確定していない変化が最初に起きた時刻
+    volatile uint64_t _last_us = 0;  // 確定していない変化が最後に起きた時刻
+    std::array<Edge, QueueSize> _queue{};  // 取り出していないエッジ (リングバッファ)
+    volatile std::size_t _head = 0;  // 次に取り出すエッジの位置
+    volatile std::size_t _count = 0;  // 取り出していないエッジの数
+    volatile uint32_t _overflow = 0;  // 記録しきれずに捨てたエッジの数
+    Edge _last_edge{};  // 最後に記録したエッジ
+    volatile bool _has_edge = false;  // 1度でもエッジを記録したか
+
+    //! @brief 変化してからdebounceの時間が経っていれば，状態を確定させて記録する (割り込みを無効にして呼ぶこと)
+    //! @param now_us 現在の時刻 (μs)
+    void settle(uint64_t now_us);
+
+    //! @brief ピンが変化したときの処理 (割り込みの中で呼ばれる)
+    void on_edge(bool level, uint64_t now_us);
+
+    //! @brief GPIOの割り込みで呼ばれる関数 (ピンごとのインスタンスに振り分ける)
+    static void gpio_callback(uint gpio, uint32_t events);
+
+    static inline std::array<EdgeInput*, 30> Instances{};  // 各ピンの割り込みを受け取るインスタンス
+};
+
+}
+
+#endif  // SC19_PICO_SC_EDGE_INPUT_HPP_
@@ -5,6 +5,8 @@
  * マイコンのフラッシュメモリに直接データを保存するためのコードです
  * このファイルは，flush.cppに書かれている関数の一覧です
  * 
+ * 64KBの領域に多く残せるように，ログはLzssEncoderで圧縮し，256バイトのブロックを1ページずつ書き込みます．
+ * print()で展開して出力するほか，picotoolで読み出した領域をPCのツール(fm/traceのLOG_DECODE)でも展開できます．
 **************************************************/
 
 //! @file flush.hpp
@@ -17,6 +19,7 @@
 #include "hardware/sync.h"
 
 #include "binary.hpp"
+#include "lzss.hpp"
 
 namespace sc
 {
@@ -25,23 +28,45 @@ class Flush : Noncopyable
 {
     static constexpr uint32_t _target_begin = 0x1F0000;  // W25Q16JVの最終ブロック(Block31)のセクタ0の先頭アドレス = 0x1F0000
     static constexpr uint32_t _target_end = 0x1FFFFF;
-    static constexpr uint32_t _block_size = 0xFFFF;  // 1ブロックのサイズ
-    static constexpr uint8_t _block_num = 1;  // 使用するブロックの数
     uint32_t _target_offset = _target_begin;
+    uint32_t _erased_end = _target_begin;  // ここより前のセクタは消去済み (書き込み位置の1セクタ先まで消去しておく)
     std::array<uint8_t, FLASH_PAGE_SIZE> _write_data;
+    uint32_t _programmed_pages = 0;  // 書き込んだページ数
+
+    static_assert(LzssBlockSize == FLASH_PAGE_SIZE, "A compressed block must be one flash page");
+
+    //! @brief 1ページ分を書き込み，書き込み位置を進める (まだ消去していないセクタは，ここで消去する)
+    void program_page();
 public:
     //! @brief フラッシュメモリのセットアップ
     Flush();
 
-    //! @brief フラッシュメモリに書き込み
+    //! @brief フラッシュメモリに書き込み (圧縮して，1ページ分たまったら書き込む)
     void write(const Binary& write_data);
 
-    //! @brief フラッシュメモリのデータを出力
+    //! @brief 圧縮の途中のデータを書き込む (ゴールしたときなど，ログが止まる前に呼ぶ)
+    //! @note ページの残りは空いたままになるので，頻繁に呼ぶと圧縮の効果が下がります
+    void sync();
+
+    //! @brief 書き込む前のログのバイト数
+    uint64_t input_bytes() const;
+
+    //! @brief 書き込んだページのバイト数
+    uint64_t programmed_bytes() const
+        {return uint64_t(_programmed_pages) * FLASH_PAGE_SIZE;}
+
+    //! @brief フラッシュメモリのデータを展開して出力 (古い方から)
     void print();
 
     //! @brief フラッシュメモリのデータを削除
+    //! @note 64KBを一度に消去すると割り込みを止めたまま数百msかかるので，ここでは書き込み位置を戻すだけにして，
+    //!       書き込みがセクタ(4KB)をまたぐたびに，その先のセクタを消去します
     void clear();
 
+    //! @brief 前回のログの続きから書き込む (リセットから再開したとき，clearの代わりに呼ぶ)
+    //! @note 消去された所(0xFF)を探し，その次のページから書き込みます
+    void resume();
+
     ~Flush();
 };
 
@@ -0,0 +1,68 @@
+#ifndef SC19_PICO_SC_HEADING_CONTROLLER_HPP_
+#define SC19_PICO_SC_HEADING_CONTROLLER_HPP_
+
+/**************************************************
+ * 機体の向きの制御に関するコードです
+ * このファイルは，heading_controller.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，左右のモーターの出力を連続的に決める方位制御(PID)が宣言されています．
+**************************************************/
+
+//! @file heading_controller.hpp
+//! @brief 方位の誤差とジャイロから左右のモーターの出力を計算
+
+// #include "sc_basic.hpp"
+
+#include <tuple>
+
+#include "unit.hpp"
+
+
+namespace sc
+{
+
+//! @brief 差動二輪のための方位制御器
+//! @note 方位の誤差に対するPI制御に，ジャイロのz軸の角速度によるダンピング(微分項)を加えます
+//! @note 積分のワインドアップ防止と，出力の変化率の制限を行います
+class HeadingController
+{
+    const float _kp;  // 比例ゲイン (1/rad)
+    const float _ki;  // 積分ゲイン (1/(rad·s))
+    const float _kd;  // 角速度によるダンピングのゲイン (s/rad)
+    const float _max_turn;  // 旋回の出力の最大値 (0 ~ 1)
+    const float _slew_rate;  // 1秒あたりの出力の変化の最大値 (1/s)
+
+    float _integral = 0.0F;  // 誤差の積分値 (rad·s)
+    float _left = 0.0F;  // 前回の左モーターの出力
+    float _right = 0.0F;  // 前回の右モーターの出力
+
+    static constexpr float MaxDt = 0.5F;  // これより制御の間隔が空いたら積分をやり直す (s)
+
+public:
+    //! @brief 方位制御器を作成
+    //! @param kp 比例ゲイン (1/rad)
+    //! @param ki 積分ゲイン (1/(rad·s))
+    //! @param kd ジャイロの角速度によるダンピングのゲイン (s/rad)
+    //! @param max_turn 旋回の出力の最大値 (0 ~ 1)
+    //! @param slew_rate 1秒あたりの出力の変化の最大値 (1/s)
+    explicit HeadingController(float kp = 0.8F, float ki = 0.15F, float kd = 0.25F, float max_turn = 0.8F, float slew_rate = 3.0F);
+
+    //! @brief 積分値と出力の記憶を消す
+    //! @note モーターを止めたときなど，制御器以外でモーターを動かしたあとに呼んでください
+    void reset();
+
+    //! @brief 左右のモーターの出力を計算
+    //! @param heading_error 機体の正面から見たゴールの方向 (xからyへ回る向きが正)
+    //! @param yaw_rate ジャイロのz軸の角速度 (heading_errorと同じ回転の向きが正)
+    //! @param dt 前回の計算からの経過時間
+    //! @param speed 正面を向いているときの前進の出力 (0 ~ 1)
+    //! @return 左右のモーターの出力 (Motor2::runにそのまま渡せる値)
+    std::tuple<float, float> update(dimension::rad heading_error, dimension::rad_s yaw_rate, Time<Unit::s> dt, float speed = 1.0F);
+
+    //! @brief 角度を-π ~ +πに正規化
+    static float wrap_angle(float angle);
+};
+
+}
+
+#endif  // SC19_PICO_SC_HEADING_CONTROLLER_HPP_
@@ -13,9 +13,12 @@
 
 #include "sc_basic.hpp"
 #include "binary.hpp"
+#include "result.hpp"
 
 #include "hardware/i2c.h"
 
+#include <array>
+
 
 namespace sc
 {
@@ -88,14 +91,51 @@ public:
         operator uint8_t() const;
     };
 
+    //! @brief 1回の通信の結果
+    enum class Outcome : uint8_t
+    {
+        Success,  // 成功
+        Nack,  // 応答がなかった (通信に失敗した)
+        Timeout  // 時間内に終わらなかった
+    };
+
+    //! @brief 通信先のデバイスごとの記録
+    struct DeviceStats
+    {
+        uint8_t slave_addr;  // スレーブアドレス
+        uint32_t transfers;  // 通信した回数
+        uint32_t nacks;  // 応答がなかった回数
+        uint32_t timeouts;  // 時間内に終わらなかった回数
+    };
+
+    static constexpr uint32_t SpeedSteps[] = {400000, 100000, 10000};  // 速度を下げるときの段階 (Hz)
+    static constexpr std::size_t MaxDevices = 8;  // 記録する通信先のデバイスの数
+    static constexpr uint32_t ErrorWindow = 32;  // 何回の通信ごとに失敗の割合を確かめるか
+    static constexpr uint32_t ErrorThreshold = 4;  // ErrorWindow回のうち何回失敗したら速度を下げるか
+    static constexpr uint64_t QuietTime_us = 10*1000*1000;  // 何μs失敗しなければ速度を1段階上げるか
+
 private:
     const SDA _sda;  // I2Cで使用するSDAピン
     const SCL _scl;  // I2Cで使用するSCLピン
-    const Frequency<Unit::Hz> _freq;  // I2Cの通信速度
+    uint32_t _max_baudrate;  // I2Cの最大の通信速度 (Hz)
     const I2C_ID _i2c_id;  // I2C0かI2C1か
 
+    mutable std::size_t _speed_step = 0;  // 今の速度の段階 (SpeedStepsの番号)
+    mutable uint32_t _baudrate = 0;  // 今設定されている通信速度 (Hz)
+    mutable bool _recovery_needed = false;  // SDAがLowのまま止まっているので，次の通信の前にバスを回復させるか
+    mutable uint32_t _window_transfers = 0;  // 今の区切りで通信した回数
+    mutable uint32_t _window_errors = 0;  // 今の区切りで失敗した回数
+    mutable uint64_t _last_error_us = 0;  // 最後に失敗した時刻 (μs)
+    mutable uint32_t _step_downs = 0;  // 速度を下げた回数
+    mutable uint32_t _recoveries = 0;  // バスを回復させた回数
+    mutable uint64_t _busy_us = 0;  // 通信していた時間の合計 (μs)
+    mutable uint64_t _bytes = 0;  // 送受信したバイト数の合計
+    mutable uint64_t _stats_start_us = 0;  // 記録を始めた時刻 (μs)
+    mutable std::array<DeviceStats, MaxDevices> _devices{};  // 通信先のデバイスごとの記録
+    mutable std::size_t _device_num = 0;  // 記録している通信先のデバイスの数
+
 public:
-    //! @brief I2Cをセットアップ
+    //! @brief I2Cをセットアップ (Fast-mode 400kHzで始め，失敗が多ければ自動で速度を下げます)
     //! @param sda I2Cで使用するSDAピン
     //! @param scl I2Cで使用するSCLピン
     I2C(SDA sda, SCL scl);
@@ -103,26 +143,98 @@ public:
     //! @brief I2Cをセットアップ
     //! @param sda I2Cで使用するSDAピン
     //! @param scl I2Cで使用するSCLピン
-    //! @param freq I2Cの通信速度 (10000_hz のように入力)
+    //! @param freq I2Cの最大の通信速度 (10000_hz のように入力)
     I2C(SDA sda, SCL scl, Frequency<Unit::Hz> freq);
 
+    //! @brief 最大の通信速度を変更
+    //! @note 失敗が多いときは，これより遅い速度に自動で下げます
+    //! @param freq I2Cの最大の通信速度
+    void set_frequency(Frequency<Unit::Hz> freq);
+
+    //! @brief 今の通信速度
+    Frequency<Unit::Hz> frequency() const;
+
+    //! @brief システムクロックを変えたときに呼ぶ (次の通信の前に，今の速度の段階の通信速度を設定し直す)
+    void clock_changed();
+
+    //! @brief SDAがLowのまま止まったバスを，SCLを動かして解放させる
+    //! @return SDAが解放されたか
+    bool recover_bus() const;
+
+    //! @brief 通信の結果を記録し，失敗の割合に応じて速度を変える
+    //! @note 割り込みの中からも呼ばれるので，ここでは記録だけ行い，速度の変更は次の通信の前(prepare)に行います
+    //! @note 記録を書き換える間は割り込みを無効にします
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param size 送受信したバイト数
+    //! @param start_us 通信を始めた時刻 (μs)
+    //! @param outcome 通信の結果
+    void record(uint8_t slave_addr, std::size_t size, uint64_t start_us, Outcome outcome) const;
+
+    //! @brief 通信の前に，バスの回復と速度の変更を行う
+    //! @note 待機(busy_wait_us)やピンの機能の変更を含むので，割り込みの中では呼ばないでください (I2CAsyncはupdate()などで呼びます)
+    void prepare() const;
+
+    //! @brief 次の通信の前に，prepare()でバスの回復か速度の変更が必要か
+    //! @note 記録を変えないので，割り込みの中でも呼べます
+    bool prepare_needed() const;
+
+    //! @brief 通信先のデバイスごとの記録
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @return 記録 (まだ通信していないときはすべて0)
+    DeviceStats device_stats(SlaveAddr slave_addr) const;
+
+    //! @brief 通信していた時間の割合 (0.0～1.0)
+    double utilization() const;
+
+    //! @brief 通信速度，バスの使用率，デバイスごとの失敗の回数を出力
+    void print_stats() const;
+
+    //! @brief 記録をすべて0にする
+    void reset_stats() const;
+
     //! @brief I2Cによる送信
     //! @param output_data 送信するデータ
     //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰に送信するか)
     void write(Binary output_data, SlaveAddr slave_addr) const;
 
+    //! @brief I2Cによる送信 (データをコピーしない)
+    //! @param output_data 送信するデータ (StaticBinaryもそのまま渡せます)
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰に送信するか)
+    void write(BinaryView output_data, SlaveAddr slave_addr) const;
+
     //! @brief I2Cによる受信
     //! @param size 受信するバイト数
     //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰から受信するか)
     //! @return Binary型のバイト列
     Binary read(std::size_t size, SlaveAddr slave_addr) const;
 
+    //! @brief I2Cによる受信 (配列に直接書き込む)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰から受信するか)
+    //! @return 実際に受信したバイト数
+    std::size_t read(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr) const;
+
+    //! @brief I2Cによる受信 (StaticBinaryに直接書き込み，動的メモリを使わない)
+    //! @param input_data 受信したデータを書き込むバイト列．input_data.size()バイト受信し，受信したバイト数にサイズを合わせます
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰から受信するか)
+    template<std::size_t N>
+    void read(StaticBinary<N>& input_data, SlaveAddr slave_addr) const
+        {input_data.resize(read(input_data.data(), input_data.size(), slave_addr));}
+
     //! @brief I2Cによるメモリへの送信
     //! @param output_data 送信するデータ
     //! @param slave_addr 通信先のデバイスのスレーブアドレス
     //! @param memory_addr 通信先のデバイスのメモリの何番地にデータを記録するか
     void write_memory(Binary output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
 
+    //! @brief I2Cによるメモリへの送信 (データをコピーしない)
+    //! @param output_data 送信するデータ (StaticBinaryもそのまま渡せます)
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地にデータを記録するか
+    //! @note MaxStackWriteバイトまでは，メモリアドレスとデータをスタック上の配列につなげて送信します
+    void write_memory(BinaryView output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
+
     //! @brief I2Cによるメモリからの受信
     //! @param size 受信するバイト数
     //! @param slave_addr 通信先のデバイスのスレーブアドレス
@@ -130,6 +242,72 @@ public:
     //! @return Binary型のバイト列
     Binary read_memory(std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
 
+    //! @brief I2Cによるメモリからの受信 (配列に直接書き込む)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    //! @return 実際に受信したバイト数
+    std::size_t read_memory(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
+
+    //! @brief I2Cによるメモリからの受信 (StaticBinaryに直接書き込み，動的メモリを使わない)
+    //! @param input_data 受信したデータを書き込むバイト列．input_data.size()バイト受信し，受信したバイト数にサイズを合わせます
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    template<std::size_t N>
+    void read_memory(StaticBinary<N>& input_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+        {input_data.resize(read_memory(input_data.data(), input_data.size(), slave_addr, memory_addr));}
+
+    //! @brief I2Cによる送信 (失敗しても例外を投げない)
+    //! @param output_data 送信するデータ
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰に送信するか)
+    //! @return 成功したか，エラー
+    Result<void> try_write(BinaryView output_data, SlaveAddr slave_addr) const;
+
+    //! @brief I2Cによる受信 (失敗しても例外を投げない)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス (誰から受信するか)
+    //! @return 実際に受信したバイト数か，エラー
+    Result<std::size_t> try_read(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr) const;
+
+    //! @brief I2Cによるメモリへの送信 (失敗しても例外を投げない)
+    //! @param output_data 送信するデータ
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地にデータを記録するか
+    //! @return 成功したか，エラー
+    Result<void> try_write_memory(BinaryView output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
+
+    //! @brief I2Cによるメモリからの受信 (失敗しても例外を投げない)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    //! @return 実際に受信したバイト数か，エラー
+    Result<std::size_t> try_read_memory(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const;
+
+    //! @brief I2Cによるメモリからの受信 (StaticBinaryに直接書き込み，失敗しても例外を投げない)
+    //! @param input_data 受信したデータを書き込むバイト列．input_data.size()バイト受信し，受信したバイト数にサイズを合わせます
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    //! @return 成功したか，エラー
+    template<std::size_t N>
+    Result<void> try_read_memory(StaticBinary<N>& input_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+    {
+        const Result<std::size_t> input_size = try_read_memory(input_data.data(), input_data.size(), slave_addr, memory_addr);
+        if (!input_size)
+    return input_size.error();
+        input_data.resize(*input_size);
+        return {};
+    }
+
+    //! @brief i2cポートの種類を返す
+    //! @return i2c0かi2c1か
+    I2C_ID get_i2c_id() const
+        {return _i2c_id;}
+
+    static constexpr std::size_t MaxStackWrite = 32;  // write_memoryでスタック上の配列を使う最大のバイト数
+
     bool save = true;
 private:
     static inline bool IsUse[2] = {false, false};  // 既にI2C0とI2C1を使用しているか
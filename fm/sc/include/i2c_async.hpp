@@ -0,0 +1,152 @@
+#ifndef SC19_PICO_SC_I2C_ASYNC_HPP_
+#define SC19_PICO_SC_I2C_ASYNC_HPP_
+
+/**************************************************
+ * I2C通信を待機せずに行うためのコードです
+ * このファイルは，i2c_async.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，I2Cのメモリからの受信を予約し，割り込みで進めるクラスが宣言されています．
+ * 通常のI2C::read_memoryは転送が終わるまでCPUが待ち続けますが，
+ * こちらを使うと転送中に航法の計算やログの出力などを進められます．
+**************************************************/
+
+//! @file i2c_async.hpp
+//! @brief I2Cの割り込みによる受信
+
+#include "sc_basic.hpp"
+
+#include <array>
+
+#include "i2c.hpp"
+
+
+namespace sc
+{
+
+//! @brief I2Cのメモリからの受信を，予約した順に割り込みで行うクラス
+//! @note 送信するコマンドをI2CのFIFOに詰め，受信したデータはFIFOが空になる前に割り込みで取り出します
+//! @note 予約(Transfer)とデータを書き込む配列は呼び出し側が用意し，受信が終わるまで残しておいてください
+//! @note 受信中(busy()の間)は，同じI2Cを通常のread/writeで使わないでください
+class I2CAsync : Noncopyable
+{
+public:
+    //! @brief 予約の状態
+    enum class Status : uint8_t
+    {
+        Idle,  // 予約されていない
+        Queued,  // 順番待ち
+        Running,  // 受信中
+        Done,  // 受信が終わった
+        Failed,  // 通信に失敗した (応答なしなど)
+        TimedOut  // 時間内に終わらなかった
+    };
+
+    class Transfer;
+
+    //! @brief 受信が終わったときに呼ばれる関数
+    //! @note 割り込みの中で呼ばれるので，短い処理にして，例外を投げないでください
+    using Callback = void (*)(Transfer& transfer, void* context);
+
+    //! @brief 1回分の受信の予約
+    class Transfer
+    {
+        friend class I2CAsync;
+        uint8_t* _data = nullptr;  // 受信したデータを書き込む配列
+        std::size_t _size = 0;  // 受信するバイト数
+        uint8_t _slave_addr = 0;  // 通信先のデバイスのスレーブアドレス
+        uint8_t _memory_addr = 0;  // 通信先のデバイスのメモリの何番地から読み込むか
+        Callback _callback = nullptr;  // 受信が終わったときに呼ぶ関数
+        void* _context = nullptr;  // コールバックに渡す値
+        volatile std::size_t _requested = 0;  // 受信を要求したバイト数
+        volatile std::size_t _received = 0;  // 受信したバイト数
+        volatile Status _status = Status::Idle;  // 予約の状態
+        uint64_t _deadline_us = 0;  // この時刻(μs)までに終わらなければタイムアウト
+    public:
+        //! @brief 予約の状態
+        Status status() const
+            {return _status;}
+
+        //! @brief 受信が終わったか (成功か失敗かは問わない)
+        bool finished() const
+            {return _status == Status::Done || _status == Status::Failed || _status == Status::TimedOut;}
+
+        //! @brief 受信したバイト数
+        std::size_t size() const
+            {return _received;}
+
+        //! @brief 受信の結果
+        //! @note 失敗したときはErrorを作るので，1回の受信につき1回だけ呼んでください
+        Result<void> result() const;
+    };
+
+    //! @brief I2Cの割り込みによる受信をセットアップ
+    //! @param i2c 使用するI2C (1つのI2Cにつき1つまで)
+    //! @param timeout 1回の受信にかけてよい時間
+    I2CAsync(const I2C& i2c, Time<Unit::s> timeout = Time<Unit::s>(0.1));
+
+    //! @brief メモリからの受信を予約 (待機しない)
+    //! @param transfer 予約の情報を書き込む場所 (受信が終わるまで残しておくこと)
+    //! @param input_data 受信したデータを書き込む配列 (受信が終わるまで残しておくこと)
+    //! @param size 受信するバイト数
+    //! @param slave_addr 通信先のデバイスのスレーブアドレス
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    //! @param callback 受信が終わったときに呼ぶ関数 (割り込みの中で呼ばれます)
+    //! @param context コールバックに渡す値
+    //! @return 予約できたか，エラー (予約がいっぱいのときなど)
+    Result<void> read_memory(Transfer& transfer, uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, I2C::MemoryAddr memory_addr, Callback callback = nullptr, void* context = nullptr);
+
+    //! @brief メモリからの受信を予約 (StaticBinaryのサイズ分受信する)
+    template<std::size_t N>
+    Result<void> read_memory(Transfer& transfer, StaticBinary<N>& input_data, SlaveAddr slave_addr, I2C::MemoryAddr memory_addr, Callback callback = nullptr, void* context = nullptr)
+        {return read_memory(transfer, input_data.data(), input_data.size(), slave_addr, memory_addr, callback, context);}
+
+    //! @brief 予約中か受信中のものがあるか
+    bool busy() const;
+
+    //! @brief タイムアウトを確認し，止まっている予約の受信を始める
+    //! @note 割り込みでは時間を測らないので，受信を待つ間はこの関数を呼んでください
+    //! @note 失敗が続いてバスの回復や速度の変更が必要になると，割り込みでは次の受信を始めず，この関数の中で行ってから始めます
+    void update();
+
+    //! @brief 予約したものがすべて終わるまで待つ (update()を繰り返し呼ぶ)
+    void wait();
+
+    ~I2CAsync();
+
+    static constexpr std::size_t MaxTransfers = 8;  // 予約できる数
+    static constexpr std::size_t FifoDepth = 16;  // I2CのFIFOの段数
+
+    bool save = true;
+
+private:
+    const I2C& _i2c;
+    const uint64_t _timeout_us;  // 1回の受信にかけてよい時間 (μs)
+    std::array<Transfer*, MaxTransfers> _queue;  // 順番待ちの予約 (リングバッファ)
+    volatile std::size_t _head = 0;  // 次に受信する予約の位置
+    volatile std::size_t _count = 0;  // 順番待ちの予約の数
+    Transfer* volatile _current = nullptr;  // 受信中の予約
+
+    //! @brief 受信中のものがなければ，バスの回復と速度の変更(I2C::prepare)を行ってから次の予約の受信を始める (割り込みの外で呼ぶこと)
+    void start_if_idle();
+
+    //! @brief 次の予約の受信を始める (割り込みを無効にして呼ぶこと)
+    void start_next();
+
+    //! @brief FIFOにコマンドを詰め，受信したデータを取り出す
+    void fill_fifo();
+
+    //! @brief 受信中の予約を終わらせ，バスの回復や速度の変更が必要なければ次の受信を始める (割り込みを無効にして呼ぶこと)
+    void finish(Status status);
+
+    //! @brief I2Cの割り込みで呼ばれる関数
+    void on_irq();
+
+    static void irq_handler_0();
+    static void irq_handler_1();
+
+    static inline I2CAsync* Instances[2] = {nullptr, nullptr};  // I2C0とI2C1の割り込みを受け取るインスタンス
+};
+
+}
+
+#endif  // SC19_PICO_SC_I2C_ASYNC_HPP_
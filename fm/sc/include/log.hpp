@@ -0,0 +1,133 @@
+#ifndef SC19_PICO_SC_LOG_HPP_
+#define SC19_PICO_SC_LOG_HPP_
+
+/**************************************************
+ * ログの出力先ごとに，出力するメッセージを選ぶためのコードです
+ * このファイルは，log.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，メッセージの重要度(LogLevel)と出力元(LogModule)を付けて出力するprintと，
+ * 出力先(USB，フラッシュメモリ，SDカード，TWELITE)ごとの重要度の下限を管理するクラスが宣言されています．
+ *   print(LogLevel::Data, LogModule::BME280, "pres:%f\n", pressure);
+ * 出力しないメッセージは，文字列を作る前に比較1回だけで捨てます．
+ * 同じメッセージが短い間にくり返されたときは，2回目からは回数だけ数え，まとめて "repeated:回数,メッセージ" と出力します．
+ * 重要度と出力元を付けない今までのprintは，LogLevel::InfoとLogModule::Mainとして扱います (set_printからLog::writeを呼んだとき)．
+**************************************************/
+
+//! @file log.hpp
+//! @brief ログの重要度と出力先ごとの選別
+
+#include "sc_basic.hpp"
+
+#include <array>
+
+namespace sc
+{
+
+//! @brief メッセージの重要度 (下ほど重要)
+enum class LogLevel : uint8_t
+{
+    Data,  // センサの測定値など，毎ループ出力するもの
+    Info,  // 状態や統計など (重要度を付けないprintはこれ)
+    Event,  // フェーズの移行やゴールなど，ミッションの節目
+    Error,  // エラー
+    Off  // 何も出力しない (しきい値に使う)
+};
+
+//! @brief メッセージの出力元
+enum class LogModule : uint8_t
+{
+    Main,  // fm.cppなど (出力元を付けないprintはこれ)
+    I2C,
+    UART,
+    ADC,  // PicoTemp，VsysVoltage
+    BME280,
+    BNO055,
+    NJL5513R,
+    HCSR04,
+    Spresense,
+    SD,
+    Power,
+    Count  // 出力元の数 (最後に置く)
+};
+
+//! @brief 重要度の名前
+const char* to_str(LogLevel level);
+
+//! @brief 出力元の名前
+const char* to_str(LogModule module);
+
+//! @brief ログの出力先と，出力するかどうかのしきい値を管理するクラス
+class Log
+{
+public:
+    //! @brief 出力先の関数の型
+    using Sink = std::function<void(const std::string&)>;
+
+    static constexpr std::size_t MaxSinks = 4;  // 出力先の数の上限
+    static constexpr std::size_t RepeatSlots = 8;  // くり返しを数えるメッセージの数
+    static constexpr std::size_t RepeatTextSize = 40;  // まとめて出力するときに残すメッセージの長さ
+
+    //! @brief このメッセージを出力する出力先があるか (比較1回だけ)
+    static bool enabled(LogLevel level, LogModule module)
+        {return static_cast<uint8_t>(level) >= Gate[static_cast<std::size_t>(module)];}
+
+    //! @brief 出力先を加える
+    //! @param level この重要度以上のメッセージだけを出力する
+    //! @param sink 出力する関数
+    //! @return 出力先の番号 (set_sink_levelで使う)  いっぱいのときは加えずにMaxSinks
+    static std::size_t add_sink(LogLevel level, Sink sink);
+
+    //! @brief 出力先のしきい値を変える
+    static void set_sink_level(std::size_t index, LogLevel level);
+
+    //! @brief 出力元ごとのしきい値を変える (すべての出力先に効く)
+    static void set_level(LogModule module, LogLevel level);
+
+    //! @brief 同じメッセージのくり返しをまとめる条件を変える
+    //! @param level この重要度以上のメッセージをまとめる (測定値をまとめないように，初期値はInfo)
+    //! @param window_ms 最初に出力してからこの時間(ms)は，同じメッセージを数えるだけにする
+    static void set_repeat(LogLevel level, uint32_t window_ms);
+
+    //! @brief 作成したメッセージを，しきい値を満たす出力先に出力
+    //! @note 出力先がないときはstd::coutに出力します
+    static void write(LogLevel level, LogModule module, const std::string& message);
+
+    //! @brief まとめている途中のくり返しの回数を出力する (ログが止まる前に呼ぶ)
+    static void flush();
+
+private:
+    static inline std::array<uint8_t, static_cast<std::size_t>(LogModule::Count)> Gate{};  // 出力元ごとの，出力する重要度の下限
+    static inline std::array<LogLevel, static_cast<std::size_t>(LogModule::Count)> Levels{};  // 出力元ごとのしきい値
+
+    //! @brief しきい値が変わったらGateを計算し直す
+    static void update_gate();
+    //! @brief 出力先に出力 (くり返しは数えない)
+    static void dispatch(LogLevel level, const std::string& message);
+    //! @brief 時間が過ぎたくり返しの回数を出力
+    static void report_repeats(uint32_t now_ms, bool all);
+};
+
+//! @brief 重要度と出力元を付けて，printfの形式で出力
+//! @note 出力先がないメッセージは，文字列を作らずに戻ります (引数の計算だけは行われます)
+//! @param level メッセージの重要度
+//! @param module メッセージの出力元
+//! @param format フォーマット文字列 (文字列リテラルはstd::stringにせずに受け取る)
+//! @param args フォーマット文字列に埋め込む値
+template<typename Format, typename... Args>
+void print(LogLevel level, LogModule module, const Format& format, Args... args) noexcept
+{
+    if (!Log::enabled(level, module))
+        return;
+    try
+    {
+        Log::write(level, module, format_str(format, args...));
+    }
+    catch(const std::exception& e)
+    {
+        std::cout << "           From  FILE : " << __FILE__ << "  LINE : " << __LINE__ << "\n                 MESSAGE : Failed to print message\n" << e.what() << std::flush;
+    }
+}
+
+}
+
+#endif  // SC19_PICO_SC_LOG_HPP_
@@ -0,0 +1,161 @@
+#ifndef SC19_PICO_SC_LZSS_HPP_
+#define SC19_PICO_SC_LZSS_HPP_
+
+/**************************************************
+ * ログを圧縮して，フラッシュメモリやSDカードに多く残すためのコードです
+ * このファイルは，lzss.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，LZSS(前に出てきた文字列を「何文字前から何文字」で置き換える方式)で
+ * 少しずつ届く文字列を圧縮するクラスと，それを元に戻すクラスが宣言されています．
+ * ログは "bme:..." のように同じ形の行のくり返しなので，数分の1になります．
+ * 動的メモリは使わず，RAMは圧縮で約8KB，展開で約2KBだけ使います．
+ *
+ * 圧縮したデータは，フラッシュメモリのページと同じ256バイトのブロックに分けて出力します．
+ *   ブロック : [種類(1)] [使ったバイト数(1)] [圧縮したデータ(254)]
+ *   種類     : LzssBlockStart     新しい圧縮の始まり (前のブロックがなくても展開できる)
+ *              LzssBlockContinue  前のブロックの続き
+ * 圧縮したデータは，目印の1バイトと，それに続く8個の「文字」か「一致」のくり返しです．
+ *   目印 : 下位bitから順に，1なら一致(2バイト)，0なら文字(1バイト)
+ *   一致 : 何文字前か-1 (11bit) と 長さ-3 (5bit) をビッグエンディアンで2バイト
+ * リングバッファに上書きされても読めるところまで戻れるように，一定のブロック数ごとに新しい圧縮を始めます．
+ * PCのツール(fm/traceのLOG_DECODE)でも同じLzssDecoderで展開します．
+**************************************************/
+
+//! @file lzss.hpp
+//! @brief ログの圧縮と展開
+
+// #include "sc_basic.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>  // pair
+
+namespace sc
+{
+
+constexpr std::size_t LzssBlockSize = 256;  // 圧縮したデータを出力する単位 (フラッシュメモリの1ページ)
+constexpr std::size_t LzssHeaderSize = 2;  // ブロックの先頭の種類と使ったバイト数
+constexpr std::size_t LzssPayloadSize = LzssBlockSize - LzssHeaderSize;  // 1ブロックに入る圧縮したデータのバイト数
+constexpr uint8_t LzssBlockStart = 0xC7;  // 新しい圧縮の始まりのブロック (消去された0xFFと区別できる値)
+constexpr uint8_t LzssBlockContinue = 0xC6;  // 前のブロックの続き
+
+//! @brief 少しずつ届くデータを圧縮し，ブロックごとに出力するクラス
+class LzssEncoder
+{
+public:
+    //! @brief ブロックを書き込む関数の型 (dataはいつもLzssBlockSizeバイト)
+    using Sink = std::function<void(const uint8_t* data)>;
+
+    static constexpr std::size_t WindowSize = 2048;  // 一致を探す範囲 (何文字前までさかのぼるか)
+    static constexpr std::size_t MinMatch = 3;  // これより短い一致は文字のまま出力する
+    static constexpr std::size_t MaxMatch = 34;  // 1つの一致の最大の長さ
+
+    //! @brief 圧縮を準備
+    //! @param sink ブロックがいっぱいになるたびに呼ぶ関数
+    //! @param restart_blocks このブロック数を出力したら，次のwriteの終わりで新しい圧縮を始める
+    //! @param max_chain 一致を探す候補の最大数 (大きいほど縮むが遅い)
+    explicit LzssEncoder(Sink sink = nullptr, std::size_t restart_blocks = 16, std::size_t max_chain = 8);
+
+    //! @brief ブロックを書き込む関数を変える
+    void set_sink(Sink sink)
+        {_sink = sink;}
+
+    //! @brief データを圧縮する (ブロックがいっぱいになったらsinkを呼ぶ)
+    //! @note 最後のMaxMatchバイトは次のデータと合わせて圧縮するので，finishまで出力されません
+    void write(const uint8_t* data, std::size_t size);
+
+    //! @brief 文字列を圧縮する
+    void write(const std::string& text)
+        {write(reinterpret_cast<const uint8_t*>(text.data()), text.size());}
+
+    //! @brief 残りをすべて出力し，使ったところまでのブロックをsinkに渡す (次のwriteから新しい圧縮を始める)
+    void finish();
+
+    //! @brief これまでに圧縮したバイト数
+    uint64_t input_bytes() const
+        {return _input_bytes;}
+
+    //! @brief これまでに出力したブロックの，圧縮したデータのバイト数 (ブロックの先頭と空きを除く)
+    uint64_t output_bytes() const
+        {return _output_bytes;}
+
+private:
+    static constexpr std::size_t HashSize = 1024;  // 先頭3文字のハッシュの種類
+    static constexpr std::size_t MaxOffset = WindowSize - MaxMatch;  // 上書きされていない範囲だけを参照する
+
+    Sink _sink;
+    const std::size_t _restart_blocks;
+    const std::size_t _max_chain;
+
+    std::array<uint8_t, WindowSize> _window{};  // これまでのデータ (リングバッファ)
+    std::array<uint16_t, HashSize> _head{};  // ハッシュごとの最後の位置 (下位16bit)
+    std::array<uint16_t, WindowSize> _prev{};  // 同じハッシュの1つ前の位置 (下位16bit)
+    uint32_t _start = 0;  // 今の圧縮を始めた位置
+    uint32_t _cur = 0;  // 次に圧縮する位置
+    uint32_t _end = 0;  // 受け取ったデータの終わり
+
+    std::array<uint8_t, 1 + 8 * 2> _group{};  // 目印と8個分の文字か一致
+    std::size_t _group_size = 0;  // _groupに入れたバイト数
+    std::size_t _group_items = 0;  // _groupに入れた文字か一致の数
+
+    std::array<uint8_t, LzssBlockSize> _block{};  // 出力するブロック
+    std::size_t _block_size = LzssHeaderSize;  // _blockに入れたバイト数
+    std::size_t _stream_blocks = 0;  // 今の圧縮で出力したブロック数
+
+    uint64_t _input_bytes = 0;
+    uint64_t _output_bytes = 0;
+
+    //! @brief 新しい圧縮を始める
+    void restart();
+    //! @brief 先読みがmin_lookaheadバイト以上ある間，文字か一致を出力する
+    void encode(std::size_t min_lookahead);
+    //! @brief 位置posを一致の候補に加える
+    void insert(uint32_t pos);
+    //! @brief 位置posの先頭3文字のハッシュ
+    uint32_t hash(uint32_t pos) const;
+    //! @brief _curから始まる最も長い一致を探す
+    //! @return 長さ (MinMatch未満なら一致なし) と何文字前か
+    std::pair<std::size_t, std::size_t> find_match() const;
+    //! @brief 文字か一致を1つ_groupに加える (8個たまったらブロックへ)
+    void put_item(bool match, uint8_t first, uint8_t second);
+    //! @brief _groupをブロックに移す
+    void flush_group();
+    //! @brief ブロックをsinkに渡し，次のブロックを始める
+    void emit_block();
+};
+
+//! @brief LzssEncoderが出力したブロックを順に展開するクラス
+class LzssDecoder
+{
+public:
+    //! @brief ブロックを1つ展開し，元のデータをoutputの後ろに加える
+    //! @param block LzssBlockSizeバイトのブロック
+    //! @param output 展開したデータを加える文字列
+    //! @return 展開したか (圧縮のブロックでないときと，始まりのブロックより前の続きのブロックはfalse)
+    bool decode_block(const uint8_t* block, std::string& output);
+
+    //! @brief 展開の途中の状態を捨てる (次は始まりのブロックまで読み飛ばす)
+    void reset();
+
+    //! @brief 圧縮のブロックか (先頭の種類を見る)
+    static bool is_block(const uint8_t* block)
+        {return block[0] == LzssBlockStart || block[0] == LzssBlockContinue;}
+
+private:
+    std::array<uint8_t, LzssEncoder::WindowSize> _window{};  // 展開したデータ (リングバッファ)
+    uint32_t _pos = 0;  // 次に展開する位置
+    bool _in_stream = false;  // 始まりのブロックを読んだか
+    uint8_t _flags = 0;  // 今の目印
+    int _bit = 8;  // 次に読む目印のbit (8なら次のバイトが目印)
+    int _pending = -1;  // 一致の1バイト目 (なければ負)
+
+    //! @brief 1バイト展開する
+    void put(uint8_t byte, std::string& output);
+};
+
+}
+
+#endif  // SC19_PICO_SC_LZSS_HPP_
@@ -0,0 +1,113 @@
+#ifndef SC19_PICO_SC_MISSION_HPP_
+#define SC19_PICO_SC_MISSION_HPP_
+
+/**************************************************
+ * フェーズを移行する条件に関するコードです
+ * このファイルは，mission.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，fm.cppがフェーズを移行するかどうかを決める判定と，そのしきい値が宣言されています．
+ * 判定はセンサの値と時間だけから決まり，ハードウェアを使わないので，
+ * PCのシミュレータ(fm/sim)からも同じコードでしきい値を試すことができます．
+**************************************************/
+
+//! @file mission.hpp
+//! @brief フェーズを移行する条件の判定
+
+// #include "sc_basic.hpp"
+
+#include "altitude_filter.hpp"
+#include "unit.hpp"
+
+
+namespace sc
+{
+
+//! @brief フェーズを移行する条件のしきい値
+struct MissionParams
+{
+    float wait_timeout = 13 * 60;  // 待機フェーズの条件1  開始からこの時間(s)が経ったら落下フェーズへ
+    float wait_error_timeout = 11 * 60;  // 待機フェーズの条件2  エラーがこの時間(s)続いたら落下フェーズへ
+    float wait_low_time = 7 * 60;  // 待機フェーズの条件3  開始からこの時間(s)が経っていて，高度が低ければ落下フェーズへ
+    float ground_altitude = 5;  // 地面の近くとみなす高度 (m)
+    float deploy_lux = 4500;  // 待機フェーズの条件4  キャリアから出たとみなす照度 (lx)
+    float free_fall_accel = 4;  // 全加速度の大きさがこれ未満なら自由落下とみなす (m/s²)
+    float release_drop = 5;  // 待機フェーズの条件4  推定高度が最高点からこれ(m)以上下がり，
+    float release_speed = 2;  //                     この速さ(m/s)以上で降下していれば，自由落下を見逃しても放出されたとみなす
+    float fall_timeout = 16 * 60;  // 落下フェーズの条件1  開始からこの時間(s)が経ったら遠距離フェーズへ
+    float fall_error_timeout = 3 * 60;  // 落下フェーズの条件2  エラーがこの時間(s)続いたら遠距離フェーズへ
+    float landing_speed = 0.5;  // 降下の速さがこれ未満なら降下が止まったとみなす (m/s)
+    float landing_still_time = 2;  // 推定の鉛直速度がほぼ0の状態がこの時間(s)続いたら着地したとみなす
+    float still_accel = 0.8;  // 線形加速度の大きさがこれ未満なら静止とみなす (m/s²)
+    float still_gyro = 0.5;  // 角速度の大きさがこれ未満なら静止とみなす (rad/s)
+    float upside_down_gravity = 3;  // 重力加速度のz成分がこれ以上なら反対向きとみなす (m/s²)
+    float near_goal = 3;  // ゴールとの距離がこれ未満なら近距離フェーズへ (m)
+    float goal_distance = 0.2;  // 超音波センサの距離がこれ未満ならゴール (m)
+};
+
+//! @brief フェーズを移行する条件を判定するクラス
+//! @note センサの値を1回分だけ見て判定します (何回続けて成り立つかはfm.cpp側で確かめます)
+class Mission
+{
+    const MissionParams _params;  // しきい値
+
+public:
+    //! @brief しきい値を指定して作成
+    explicit Mission(const MissionParams& params = MissionParams());
+
+    //! @brief しきい値
+    const MissionParams& params() const
+        {return _params;}
+
+    //! @brief 待機フェーズを時間で終えるか
+    //! @param elapsed 開始からの時間
+    //! @param error_time エラーが続いている時間
+    //! @return 成り立った条件の番号 (1か2)  成り立たなければ0
+    int wait_timeout(Time<Unit::s> elapsed, Time<Unit::s> error_time) const;
+
+    //! @brief 待機フェーズの条件3  開始から一定時間が経っていて，推定高度が低いか
+    //! @param elapsed 開始からの時間
+    //! @param altitude 推定高度
+    bool is_low(Time<Unit::s> elapsed, Altitude<Unit::m> altitude) const;
+
+    //! @brief 待機フェーズの条件4  キャリアから出たと思えるほど明るいか
+    bool is_deployed(Illuminance<Unit::lx> illuminance) const;
+
+    //! @brief 自由落下しているか
+    //! @param line_acce BNO055の線形加速度
+    //! @param gravity BNO055の重力加速度
+    bool is_free_fall(const Acceleration<Unit::m_s2>& line_acce, const Acceleration<Unit::m_s2>& gravity) const;
+
+    //! @brief 最高点を過ぎて降下しているか (放出された後，パラシュートで降りている)
+    //! @note 自由落下は1～2秒しか続かないので，BNO055を読む間隔によっては見逃します  そのときも高度の推定から放出を判定できます
+    bool is_dropping(const AltitudeFilter& altitude_filter) const;
+
+    //! @brief 落下フェーズを時間で終えるか
+    //! @param elapsed 開始からの時間
+    //! @param error_time エラーが続いている時間
+    //! @return 成り立った条件の番号 (1か2)  成り立たなければ0
+    int fall_timeout(Time<Unit::s> elapsed, Time<Unit::s> error_time) const;
+
+    //! @brief 地面の近くで降下が止まり，その状態が続いているか
+    bool is_landed(const AltitudeFilter& altitude_filter) const;
+
+    //! @brief 静止しているか
+    //! @param line_acce BNO055の線形加速度
+    //! @param gyro BNO055の角速度
+    bool is_stationary(const Acceleration<Unit::m_s2>& line_acce, const AngularVelocity<Unit::rad_s>& gyro) const;
+
+    //! @brief 機体が反対向きか
+    //! @param gravity BNO055の重力加速度
+    bool is_upside_down(const Acceleration<Unit::m_s2>& gravity) const;
+
+    //! @brief 近距離フェーズに移るほどゴールに近いか
+    //! @param distance GPSから求めたゴールとの距離 (m)
+    bool is_near_goal(double distance) const;
+
+    //! @brief ゴールしたか
+    //! @param distance 超音波センサで測った距離
+    bool is_goal(Length<Unit::m> distance) const;
+};
+
+}
+
+#endif  // SC19_PICO_SC_MISSION_HPP_
@@ -0,0 +1,485 @@
+#ifndef SC19_PICO_SC_MISSION_LOOP_HPP_
+#define SC19_PICO_SC_MISSION_LOOP_HPP_
+
+/**************************************************
+ * ミッションのフェーズを進めるコードです
+ * このファイルはテンプレートなので，関数の中身もここに書かれています
+ *
+ * このファイルでは，fm.cppのループの中で1回ごとにフェーズを進める処理(センサを読む順番，
+ * フェーズを移行する条件，モーターの動作の予約)が定義されています．
+ * センサやモーターは型引数のIoを通して使うので，fm.cppは実際のセンサで，
+ * PCのシミュレータ(fm/sim)は物理モデルで，テスト(fm/test)は用意した値で，同じ処理を動かせます．
+ *
+ * Ioには次の関数が必要です (センサが読めなかったときは，エラーを出力してstd::nulloptを返す)
+ *     uint64_t now_us()                            起動からの時間 (μs)
+ *     void sleep_until_us(uint64_t time_us)        その時刻まで待つ
+ *     void set_leds(bool red, bool green)          フェーズを表すLED
+ *     std::optional<Altitude<Unit::m>> read_altitude()   BME280の気圧高度
+ *     Illuminance<Unit::lx> read_lux()             照度
+ *     std::optional<Imu> read_imu()                BNO055の線形加速度，重力加速度，地磁気，角速度 (std::tupleでstd::getで読む)
+ *     bool request_imu()                           BNO055の受信を予約 (待たずに戻る)
+ *     std::optional<Imu> collect_imu()             予約したBNO055の受信を受け取る
+ *     std::optional<std::tuple<緯度, 経度>> read_gps()
+ *     double goal_direction(const Imu&, const GoalVector&)   機体の正面から反時計回りに測ったゴールの方向 (rad)
+ *     GoalSight read_camera()                      カメラで見たゴールの方向
+ *     Length<Unit::m> read_sonar()                 超音波センサの距離
+ *     bool parachute_tangled()                     パラシュートが分離していないか
+ *     Motor& motor()                               MotorActuatorと同じ関数(run，run_now，run_for，stop，busy，output)を持つもの
+ *     void play_landing() / play_near_goal()       遠距離フェーズ・近距離フェーズに移るときの曲
+ *     void goal()                                  ゴールしたときの処理
+ *     void event(format, args...) / data(format, args...)   フェーズの移行などの記録と，測定値の記録
+ *     void report_exception(const std::exception&) 例外を出力する
+**************************************************/
+
+//! @file mission_loop.hpp
+//! @brief ミッションのフェーズを進める処理
+
+#include <cstdint>
+#include <exception>
+#include <tuple>
+
+#include "altitude_filter.hpp"
+#include "heading_controller.hpp"
+#include "mission.hpp"
+#include "navigation.hpp"
+#include "profiler.hpp"
+#include "stuck_detector.hpp"
+#include "unit.hpp"
+
+namespace sc
+{
+
+//! @brief ミッションのフェーズ (Checkpointにはこの番号を保存する)
+enum class Phase : uint8_t
+{
+    Wait,  // 待機
+    Fall,  // 落下
+    Ldistance,  // 遠距離
+    Sdistance,  // 近距離
+};
+
+//! @brief 近距離フェーズでカメラから見たゴールの方向
+enum class GoalSight
+{
+    Left,
+    Center,
+    Right,
+    NotFound,
+};
+
+//! @brief ループの1回ごとにフェーズを進めるクラス
+//! @note 高度の推定・方位制御・スタックの検知の状態もこのクラスが持つので，リセットから再開するときは作り直してください
+//! @tparam Io センサとモーター (必要な関数はファイルの先頭を見てください)
+template<typename Io>
+class MissionLoop
+{
+    Io& _io;
+    const Mission& _mission;
+    const LocalNavigator& _navigator;
+
+    Phase _phase;
+    const uint64_t _start_us;  // 開始時刻 (μs)
+    uint64_t _recent_successful_us;  // エラーが出続けている時間を測るために使う
+    bool _is_success = true;  // 前回のループでエラーが出なかったか
+    AltitudeFilter _altitude_filter;  // 気圧高度とBNO055の鉛直加速度から，高度と鉛直速度を推定する
+    uint64_t _imu_us;  // 前回BNO055で高度の推定を進めた時刻 (μs)
+    HeadingController _heading_controller;  // 遠距離フェーズで機体の向きを連続的に制御する
+    uint64_t _control_us;  // 前回モーターの出力を決めた時刻 (μs)
+    bool _righting_check;  // 体勢修正の動作が終わったら，もう一度向きを確認するか
+    StuckDetector _stuck_detector;  // モーターを回しているのに進んでいないことを検知する (100ms周期で80サンプル = 8秒)
+
+public:
+    //! @brief フェーズを進める準備をする
+    //! @param io センサとモーター
+    //! @param mission フェーズを移行する条件
+    //! @param navigator ゴールの位置
+    //! @param phase 始めるフェーズ (リセットから再開したときは保存したフェーズ)
+    //! @param start_us 開始時刻 (μs)  再開したときは，保存した経過時間の分だけ前にする
+    MissionLoop(Io& io, const Mission& mission, const LocalNavigator& navigator, Phase phase, uint64_t start_us):
+        _io(io), _mission(mission), _navigator(navigator), _phase(phase), _start_us(start_us),
+        _recent_successful_us(io.now_us()), _imu_us(io.now_us()), _control_us(io.now_us()),
+        _righting_check(phase == Phase::Ldistance)  // 遠距離フェーズで再開したときは，転んでいないかもう一度確認する
+    {
+    }
+
+    //! @brief 今のフェーズ
+    Phase phase() const
+        {return _phase;}
+
+    //! @brief 開始からの時間 (μs)
+    uint64_t elapsed_us() const
+        {return _io.now_us() - _start_us;}
+
+    //! @brief 高度の推定
+    const AltitudeFilter& altitude_filter() const
+        {return _altitude_filter;}
+
+    //! @brief ループの1回分，今のフェーズの処理をする
+    //! @return ゴールしたか
+    bool step()
+    {
+        if (_is_success)  // もし，前回のループがうまくいったなら
+        {
+            _recent_successful_us = _io.now_us();
+        }
+        _is_success = true;
+        switch (_phase)
+        {
+            case Phase::Wait:
+            {
+                SC_PROFILE_SCOPE("fase_wait");  // フェーズごとの処理時間を計測
+                wait();
+                return false;
+            }
+            case Phase::Fall:
+            {
+                SC_PROFILE_SCOPE("fase_fall");
+                fall();
+                return false;
+            }
+            case Phase::Ldistance:
+            {
+                SC_PROFILE_SCOPE("fase_ldistance");
+                ldistance();
+                return false;
+            }
+            case Phase::Sdistance:
+            {
+                SC_PROFILE_SCOPE("fase_sdistance");
+                return sdistance();
+            }
+        }
+        return false;
+    }
+
+private:
+    //! @brief 時刻の差 (s)
+    static Time<Unit::s> seconds(uint64_t from_us, uint64_t to_us)
+        {return Time<Unit::s>(static_cast<double>(static_cast<int64_t>(to_us - from_us)) * micro);}
+
+    //! @brief フェーズを移る
+    void shift(Phase phase)
+    {
+        _phase = phase;
+        _recent_successful_us = _io.now_us();
+    }
+
+    //! @brief センサが読めなかったか，例外が出た
+    void fail()
+        {_is_success = false;}
+
+    //! @brief 例外を出力し，エラーとして数える
+    void fail(const std::exception& e)
+    {
+        _io.report_exception(e);
+        _is_success = false;
+    }
+
+    //! @brief BNO055の加速度で高度の推定を進める
+    template<typename Imu>
+    void predict_altitude(const Imu& imu)
+    {
+        const uint64_t now = _io.now_us();
+        _altitude_filter.predict(AltitudeFilter::vertical_acceleration(std::get<0>(imu), std::get<1>(imu)), seconds(_imu_us, now));
+        _imu_us = now;
+    }
+
+    //! @brief 0.5秒後にもう一度自由落下しているかを確かめる (値は読み直さない)
+    template<typename Imu>
+    bool is_free_fall(const Imu& imu)
+    {
+        return _mission.is_free_fall(std::get<0>(imu), std::get<1>(imu)) && (sleep(0.5), _mission.is_free_fall(std::get<0>(imu), std::get<1>(imu)));
+    }
+
+    //! @brief 0.5秒ごとに3回静止しているかを確かめる (値は読み直さない)
+    template<typename Imu>
+    bool is_stationary(const Imu& imu)
+    {
+        return _mission.is_stationary(std::get<0>(imu), std::get<3>(imu))
+            && (sleep(0.5), _mission.is_stationary(std::get<0>(imu), std::get<3>(imu)))
+            && (sleep(0.5), _mission.is_stationary(std::get<0>(imu), std::get<3>(imu)));
+    }
+
+    //! @brief 秒数だけ待つ
+    void sleep(double seconds)
+        {_io.sleep_until_us(_io.now_us() + static_cast<uint64_t>(seconds / micro));}
+
+    //! @brief 遠距離フェーズでセンサが読めないときは，とりあえず左右に少しずつ動いてみる (予約だけして待たずに次のループへ進む)
+    void search_fallback()
+    {
+        try
+        {
+            if (!_io.motor().busy())
+            {
+                _io.motor().run_for(0.0F, 1.0F, Time<Unit::s>(0.4));  // 左
+                _io.motor().run_for(0.0F, 0.0F, Time<Unit::s>(3));
+                _io.motor().run_for(1.0F, 0.0F, Time<Unit::s>(0.4));  // 右
+                _io.motor().run_for(0.0F, 0.0F, Time<Unit::s>(3));
+            }
+            _heading_controller.reset();  // 止まった状態から制御をやり直す
+        }
+        catch(const std::exception& e){_io.report_exception(e);}
+    }
+
+    // ************************************************** //
+    //                     待機フェーズ                    //
+    // ************************************************** //
+    void wait()
+    {
+        try
+        {
+            {SC_PROFILE_SCOPE("wait_sleep"); sleep(0.1);}
+            _io.set_leds(false, false);
+
+            //条件1：開始から13分以上　→落下フェーズへ
+            //条件2：エラー11分以上　→落下フェーズへ
+            const uint64_t now = _io.now_us();
+            const int timeout_condition = _mission.wait_timeout(seconds(_start_us, now), seconds(_recent_successful_us, now));
+            if (timeout_condition != 0)
+            {
+                shift(Phase::Fall);
+                _io.event("Shifts to the falling phase under condition %d\n", timeout_condition);  // 条件1か2で落下フェーズに移行します
+                return;
+            }
+            try
+            {
+                //条件3：開始から7分以上＆高度５ｍ以下　→落下フェーズへ
+                const auto altitude = _io.read_altitude();  // BME280(温湿圧)から受信
+                if (!altitude)
+                {
+                    fail();
+                } else {
+                    _altitude_filter.update(*altitude);
+                    _io.data("filtered_altitude:%f,vertical_speed:%f\n", double(_altitude_filter.altitude()), double(_altitude_filter.vertical_speed()));
+                    if (_mission.is_low(seconds(_start_us, _io.now_us()), _altitude_filter.altitude()))
+                    {
+                        shift(Phase::Fall);
+                        _io.event("Shifts to the falling phase under condition 3\n");  // 条件3で落下フェーズに移行します
+                        return;
+                    }
+                }
+            }
+            catch(const std::exception& e) {fail(e);}
+            try
+            {
+                //条件4：照度によりキャリア展開検知&&(最高点を過ぎて降下中||自由落下)　→落下フェーズへ
+                const auto lux = _io.read_lux();
+                const auto imu = _io.read_imu();  // BNO055(9軸)から受信
+                if (!imu)
+                {
+                    fail();
+                } else {
+                    predict_altitude(*imu);
+                    // 高度の推定で放出が分かったときは，自由落下を確かめずに移る
+                    if (_mission.is_deployed(lux) && (_mission.is_dropping(_altitude_filter) || is_free_fall(*imu)))
+                    {
+                        shift(Phase::Fall);
+                        _io.event("Shifts to the falling phase under condition 4\n");  // 条件4で落下フェーズに移行します
+                        return;
+                    }
+                }
+            }
+            catch(const std::exception& e) {fail(e);}
+        }
+        catch(const std::exception& e) {fail(e);}
+    }
+
+    // ************************************************** //
+    //                     落下フェーズ                    //
+    // ************************************************** //
+    void fall()
+    {
+        try
+        {
+            _io.set_leds(false, true);
+
+            //条件1：開始から16分以上経過　→遠距離フェーズへ
+            //条件2：エラーが3分以上続く　→遠距離フェーズへ
+            const uint64_t now = _io.now_us();
+            const int timeout_condition = _mission.fall_timeout(seconds(_start_us, now), seconds(_recent_successful_us, now));
+            if (timeout_condition != 0)
+            {
+                shift(Phase::Ldistance);
+                _io.event("Shifts to the long distance phase under condition %d\n", timeout_condition);  // 条件1か2で遠距離フェーズに移行します
+            }
+
+            try
+            {
+                const auto altitude = _io.read_altitude();  // BME280(温湿圧)から受信
+                if (!altitude)
+                {
+                    fail();
+                } else {
+                    _altitude_filter.update(*altitude);
+                    const auto imu = _io.read_imu();  // BNO055(9軸)から受信
+                    if (!imu)
+                    {
+                        fail();
+                    } else {
+                        predict_altitude(*imu);
+                        _io.data("filtered_altitude:%f,vertical_speed:%f\n", double(_altitude_filter.altitude()), double(_altitude_filter.vertical_speed()));
+                        if (_mission.is_landed(_altitude_filter))  // 地面からの標高が5m以内で，降下が止まった状態が続いている
+                        {
+                            //条件3：静止　→遠距離フェーズへ
+                            if (is_stationary(*imu))
+                            {
+                                shift(Phase::Ldistance);
+                                _io.event("Shifts to the long distance phase under condition 3\n");  // 条件3で遠距離フェーズに移行します
+                            } else {
+                                return;
+                            }
+                        }
+                    }
+                }
+            }
+            catch(const std::exception& e) {fail(e);}
+
+            if (_phase == Phase::Ldistance)
+            {
+                _io.play_landing();  // 念のため待機しておく
+
+                const auto imu = _io.read_imu();  // BNO055(9軸)から受信
+                if (!imu)
+                {
+                    fail();
+                    return;
+                }
+                // Z軸の重力加速度が正かどうかで機体の体制修正
+                if (!_mission.is_upside_down(std::get<1>(*imu)))  // z軸が負なら正常
+                {
+                    _io.data("muki:atteru\n");
+                } else {
+                    _io.data("muki:hantai\n");
+                    _io.motor().run_for(1.0F, 1.0F, Time<Unit::s>(5));  // じたばたして体制修正できるかな？ (5秒後に自動で止まる)
+                    _righting_check = true;  // 終わったら遠距離フェーズでもう一度確認する
+                }
+            }
+        }
+        catch(const std::exception& e) {fail(e);}
+    }
+
+    // ************************************************** //
+    //                   遠距離フェーズ                    //
+    // ************************************************** //
+    void ldistance()
+    {
+        try
+        {
+            _io.set_leds(true, false);
+            // BNO055(9軸)の受信を予約し，I2Cで受信している間にGPSの値を読む
+            if (!_io.request_imu())
+            {
+                fail();
+                search_fallback();
+                return;
+            }
+            const auto gps = _io.read_gps();
+            const auto imu = _io.collect_imu();
+            if (!imu)
+            {
+                fail();
+                search_fallback();
+                return;
+            }
+
+            // 体勢修正や回避の動作中は，センサの記録だけ続けて制御はしない
+            if (_io.motor().busy())
+            {
+                return;
+            }
+            if (_righting_check)  // 体勢修正の動作が終わったら
+            {
+                _righting_check = false;
+                if (_mission.is_upside_down(std::get<1>(*imu)))  // それでもまだ反対向きなら
+                {
+                    _io.data("muki:hantai\n");
+                    _io.motor().run_for(1.0F, 1.0F, Time<Unit::s>(5));  // もう一回
+                    return;
+                }
+            }
+            if (!gps)
+            {
+                fail();
+                search_fallback();
+                return;
+            }
+            const GoalVector to_goal = _navigator.to_goal(std::get<0>(*gps), std::get<1>(*gps));  // 自分からゴールへのベクトル
+            const double direction = _io.goal_direction(*imu, to_goal);
+
+            // 方位の誤差とジャイロのz軸の角速度から，左右のモーターの出力を連続的に決める
+            {SC_PROFILE_SCOPE("ldistance_sleep"); _io.sleep_until_us(_control_us + 100 * 1000);}  // 制御周期(100ms)を一定にする
+            const uint64_t now = _io.now_us();
+            const auto [left_speed, right_speed] = _heading_controller.update(dimension::rad(direction), std::get<3>(*imu).z(), seconds(_control_us, now));
+            _control_us = now;
+            _io.data("motor:%f,%f\n", left_speed, right_speed);
+            _io.motor().run(left_speed, right_speed);
+            if (_mission.is_near_goal(to_goal.distance))  // 条件1：ゴールとの距離が3ｍ未満　→近距離フェーズへ
+            {
+                _phase = Phase::Sdistance;
+                _io.motor().stop();
+                _io.event("Shifts to the short distance phase under condition 1\n");  // 条件1で近距離フェーズに移行します
+                _io.play_near_goal();
+                return;
+            }
+            // 引っかかりや空転を検知したら脱出動作を予約する
+            const auto [output_left, output_right] = _io.motor().output();  // 実際に出している値で判定する
+            const StuckDetector::Status stuck = _stuck_detector.update(output_left, output_right, std::get<0>(*imu), std::get<3>(*imu).z(), -to_goal.north, -to_goal.east);
+            if (stuck != StuckDetector::Status::Moving)
+            {
+                const bool tangled = _io.parachute_tangled();  // パラシュートが分離していないなら絡まっているとみなす
+                _io.event("stuck:%s%s\n", (stuck == StuckDetector::Status::Slip) ? "slip" : "stuck", tangled ? ",tangled" : "");
+                const auto [steps, size] = _stuck_detector.escape(tangled);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    _io.motor().run_for(steps[i].left, steps[i].right, Time<Unit::s>(steps[i].time));
+                }
+                _heading_controller.reset();
+                _stuck_detector.reset();
+            }
+        }
+        catch(const std::exception& e)
+        {
+            fail(e);
+            search_fallback();  // もしエラーがでるなら
+        }
+    }
+
+    // ************************************************** //
+    //                   近距離フェーズ                    //
+    // ************************************************** //
+    bool sdistance()
+    {
+        try
+        {
+            _io.set_leds(true, true);
+            switch (_io.read_camera())
+            {
+                case GoalSight::Center:  // ゴールがカメラの真ん中
+                    if (_mission.is_goal(_io.read_sonar()))  // 超音波でゴール検知 (0.2m以内でゴール)
+                    {
+                        _io.event("goal\n");
+                        _io.goal();
+                        return true;
+                    }
+                    return false;  // 出力はそのまま
+                case GoalSight::Right:  // ゴールがカメラの右
+                    _io.motor().run_now(1.0F, 0.0F);  // 右に曲がる (0.1秒で全力を出すため，ランプ制御はしない)
+                    break;
+                case GoalSight::Left:  // ゴールがカメラの左
+                    _io.motor().run_now(0.0F, 1.0F);  // 左に曲がる
+                    break;
+                default:  // ゴールがみつからない
+                    _io.motor().run_now(0.0F, 0.0F);  // すぐに止まる
+                    break;
+            }
+            SC_PROFILE_SCOPE("sdistance_sleep");
+            sleep(0.1);
+        }
+        catch(const std::exception& e) {fail(e);}
+        return false;
+    }
+};
+
+}
+
+#endif  // SC19_PICO_SC_MISSION_LOOP_HPP_
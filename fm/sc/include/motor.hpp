@@ -47,6 +47,12 @@ public:
     // speed : モーターの出力  -1.0以上+1.0以下の値  負の値のとき逆回転
     void run(float speed) const;
 
+    //! @brief モーターを動かす (割り込みの中から呼ぶための，例外を投げない版)
+    //! @note -1.0未満は-1.0に，+1.0より大きい値は+1.0にします
+    //! @param speed モーターの出力  -1.0以上+1.0以下の値  負の値のとき逆回転
+    //! @return 出力できたか (PWMの初期化に失敗していたらfalse)
+    bool drive(float speed) const noexcept;
+
     // ブレーキをかける
     void brake() const;
 private:
@@ -60,6 +66,7 @@ class Motor2
 {
     const Motor1& _left_motor;
     const Motor1& _right_motor;
+    static constexpr float Keisuu = 1.0F;  // ちょっと推進力を落とす
 public:
     //! @brief  左右のモーターをセットアップ
     //! @param left_motor 左のモーター
@@ -93,11 +100,17 @@ public:
         #ifndef NODEBUG
             std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
         #endif
-        constexpr double keisuu = 1.0;  // ちょっと推進力を落とす
-        _left_motor.run(left_speed * keisuu);
-        _right_motor.run(right_speed * keisuu);
+        _left_motor.run(left_speed * Keisuu);
+        _right_motor.run(right_speed * Keisuu);
     }
 
+    //! @brief 左右のモーターを同時に動かす (割り込みの中から呼ぶための，例外を投げない版)
+    //! @note 範囲外の出力は-1.0か+1.0にします
+    //! @param left_speed 左モーターの出力  -1.0以上+1.0以下の値  負の値のとき逆回転
+    //! @param right_speed 右モーターの出力  -1.0以上+1.0以下の値  負の値のとき逆回転
+    //! @return 出力できたか (PWMの初期化に失敗していたらfalse)
+    bool drive(float left_speed, float right_speed) const noexcept;
+
     // まっすぐ進む
     // speed : モーターの出力  -1.0以上+1.0以下の値  負の値のとき逆回転
     void forward(float speed) const 
@@ -0,0 +1,117 @@
+#ifndef SC19_PICO_SC_MOTOR_ACTUATOR_HPP_
+#define SC19_PICO_SC_MOTOR_ACTUATOR_HPP_
+
+/**************************************************
+ * モーターを待機せずに動かすためのコードです
+ * このファイルは，motor_actuator.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，時間指定のモーター動作の予約と，出力のなめらかな変化に関するコードが宣言されています．
+**************************************************/
+
+//! @file motor_actuator.hpp
+//! @brief 時間指定のモーター動作とランプ制御
+
+#include "sc_basic.hpp"
+
+#include <array>
+#include <tuple>
+
+#include "motor.hpp"
+
+
+namespace sc
+{
+
+//! @brief モーターの動作をタイマー割り込みで進めるクラス
+//! @note run_forで「左右の出力をこの時間だけ続ける」という動作を予約でき，予約を入れた側は待機せずに次の処理に進めます
+//! @note 出力は1周期ごとに少しずつ目標に近づけ，急な変化による電流の跳ね上がりを防ぎます
+//! @note このクラスを作ったあとは，Motor2を直接動かさず，すべてこのクラスを通してください
+class MotorActuator : Noncopyable
+{
+    //! @brief 予約された1つの動作
+    struct Command
+    {
+        float left;  // 左モーターの出力
+        float right;  // 右モーターの出力
+        uint64_t time_us;  // 続ける時間 (μs)
+    };
+
+    static constexpr std::size_t MaxCommands = 8;  // 予約できる動作の数
+
+    const Motor2& _motor;
+    const float _ramp_rate;  // 1秒あたりの出力の変化の最大値 (1/s)
+    const int64_t _tick_us;  // 更新周期 (μs)
+
+    std::array<Command, MaxCommands> _commands;  // 予約された動作 (リングバッファ)
+    volatile std::size_t _head = 0;  // 次に実行する動作の位置
+    volatile std::size_t _count = 0;  // 予約されている動作の数
+    volatile bool _running_command = false;  // 予約された動作を実行中か
+    uint64_t _command_end_us = 0;  // 実行中の動作が終わる時刻 (μs)
+
+    volatile float _idle_left = 0.0F;  // 予約がないときの左モーターの目標
+    volatile float _idle_right = 0.0F;  // 予約がないときの右モーターの目標
+    volatile float _left = 0.0F;  // 今の左モーターの出力
+    volatile float _right = 0.0F;  // 今の右モーターの出力
+    uint64_t _last_update_us = 0;  // 前回更新した時刻 (μs)
+    volatile bool _fault = false;  // モーターへの出力に失敗したか
+
+    ::repeating_timer_t _timer;  // pico-SDKの繰り返しタイマー
+
+public:
+    //! @brief モーターの動作を管理するクラスを作成し，タイマー割り込みを開始
+    //! @param motor 左右のモーター
+    //! @param ramp_rate 1秒あたりの出力の変化の最大値 (4.0なら0から全力まで0.25秒)
+    //! @param tick 出力を更新する周期
+    MotorActuator(const Motor2& motor, float ramp_rate = 4.0F, Time<Unit::s> tick = Time<Unit::s>(0.01));
+
+    //! @brief 予約を取り消し，指定した出力を続ける
+    //! @param left_speed 左モーターの出力  -1.0以上+1.0以下の値
+    //! @param right_speed 右モーターの出力  -1.0以上+1.0以下の値
+    void run(float left_speed, float right_speed);
+
+    //! @brief 予約を取り消し，指定した出力にすぐ変える (ランプ制御は行わない)
+    //! @note 0.1秒ごとに向きを少しずつ変えるときなど，短い時間で全力を出したいときに使います
+    //! @param left_speed 左モーターの出力  -1.0以上+1.0以下の値
+    //! @param right_speed 右モーターの出力  -1.0以上+1.0以下の値
+    void run_now(float left_speed, float right_speed);
+
+    //! @brief 指定した出力を指定した時間だけ続ける動作を予約
+    //! @note 予約した動作がすべて終わると，最後にrunで指定した出力(初期値は停止)に戻ります
+    //! @param left_speed 左モーターの出力  -1.0以上+1.0以下の値
+    //! @param right_speed 右モーターの出力  -1.0以上+1.0以下の値
+    //! @param time 続ける時間
+    void run_for(float left_speed, float right_speed, Time<Unit::s> time);
+
+    //! @brief 予約を取り消し，止まる
+    void stop();
+
+    //! @brief 予約を取り消し，すぐにブレーキをかける (ランプ制御は行わない)
+    void brake();
+
+    //! @brief 予約された動作が残っているか
+    bool busy() const;
+
+    //! @brief 今モーターに出力している値
+    //! @return 左右のモーターの出力
+    std::tuple<float, float> output() const;
+
+    //! @brief モーターへの出力に失敗したことがあるか (PWMの初期化に失敗していたとき)
+    bool has_fault() const
+        {return _fault;}
+
+    //! @brief 1周期分，動作を進める
+    //! @note タイマー割り込みから呼ばれます (例外を投げず，SC_HOT_IN_RAMのときはSRAMに置かれた関数だけを呼びます)
+    void update();
+
+    ~MotorActuator();
+
+    bool save = true;
+
+private:
+    //! @brief タイマー割り込みで呼ばれる関数
+    static bool timer_callback(::repeating_timer_t* timer);
+};
+
+}
+
+#endif  // SC19_PICO_SC_MOTOR_ACTUATOR_HPP_
@@ -0,0 +1,77 @@
+#ifndef SC19_PICO_SC_NAVIGATION_HPP_
+#define SC19_PICO_SC_NAVIGATION_HPP_
+
+/**************************************************
+ * ゴールまでの航法計算に関するコードです
+ * このファイルは，navigation.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，ゴールを原点とした局所接平面(北・東)座標への変換と，球面上の大円距離が宣言されています．
+**************************************************/
+
+//! @file navigation.hpp
+//! @brief 緯度経度からゴールまでの北・東成分，距離，方位を計算
+
+// #include "sc_basic.hpp"
+
+#include "unit.hpp"
+
+
+namespace sc
+{
+
+//! @brief 現在地からゴールへ向かうベクトル
+struct GoalVector
+{
+    float north;  // 北向きの成分 (m)
+    float east;  // 東向きの成分 (m)
+    float distance;  // 水平距離 (m)
+    float bearing;  // 北から時計回りに測った方位 0 ~ 2π (rad)
+};
+
+//! @brief ゴールを原点とした局所接平面(正距円筒図法)による航法計算
+//! @note 楕円体(GRS80)の曲率半径を使うので，半径6371kmの球で測るdistance_sphereとは方位によって0.1～0.3%(500mで1.3m程度)違います
+//! @note 投影(ゴールの緯度の縮尺を使い続けること)による誤差そのものは，500mで数cm程度です
+//! @note 投影の係数はゴールを決めたときに一度だけ計算し，GPSを受信するたびの計算はfloatの乗算数回で済みます
+class LocalNavigator
+{
+    double _goal_lat;  // ゴールの緯度 (rad)
+    double _goal_lon;  // ゴールの経度 (rad)
+    float _north_per_rad;  // 緯度1radあたりの南北方向の長さ (m)  子午線曲率半径
+    float _east_per_rad;  // 経度1radあたりの東西方向の長さ (m)  卯酉線曲率半径×cosφ
+
+    static constexpr double EarthA = 6'378'137.0;  // 地球の長半径(赤道半径) a (m)
+    static constexpr double EarthF = 1.0 / 298.257222101;  // 地球の扁平率 f
+    static constexpr double EarthE2 = EarthF * (2.0 - EarthF);  // 地球の離心率の2乗 e²
+
+public:
+    //! @brief ゴールを設定し，投影の係数を計算
+    //! @param goal_lat ゴールの緯度
+    //! @param goal_lon ゴールの経度
+    LocalNavigator(const Latitude<Unit::rad>& goal_lat, const Longitude<Unit::rad>& goal_lon);
+
+    //! @brief ゴールを変更し，投影の係数を計算しなおす
+    //! @param goal_lat ゴールの緯度
+    //! @param goal_lon ゴールの経度
+    void set_goal(const Latitude<Unit::rad>& goal_lat, const Longitude<Unit::rad>& goal_lon);
+
+    //! @brief 現在地からゴールへ向かうベクトルを計算
+    //! @param lat 現在地の緯度
+    //! @param lon 現在地の経度
+    //! @return 北・東成分，距離，方位
+    GoalVector to_goal(const Latitude<Unit::rad>& lat, const Longitude<Unit::rad>& lon) const;
+};
+// 曲率半径の計算式は以下の資料を参考にしました
+// https://psgsv.gsi.go.jp/koukyou/jyunsoku/pdf/r2/r2_shinkyu_furoku6.pdf
+
+//! @brief 半径6371kmの球の上で，2点間の大円距離を計算 (半正矢(haversine)の公式)
+//! @note 三角関数を5回使うので，毎ループの計算にはLocalNavigatorを使ってください
+//! @param t_lon 1点目の経度 (rad)
+//! @param t_lat 1点目の緯度 (rad)
+//! @param m_lon 2点目の経度 (rad)
+//! @param m_lat 2点目の緯度 (rad)
+//! @return 距離 (m)
+double distance_sphere(double t_lon, double t_lat, double m_lon, double m_lat);
+
+}
+
+#endif  // SC19_PICO_SC_NAVIGATION_HPP_
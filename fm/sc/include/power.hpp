@@ -0,0 +1,110 @@
+#ifndef SC19_PICO_SC_POWER_HPP_
+#define SC19_PICO_SC_POWER_HPP_
+
+/**************************************************
+ * フェーズに合わせてシステムクロックを下げ，電池を長持ちさせるためのコードです
+ * このファイルは，power.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，システムクロック(clk_sys)とコアの電圧を切り替えるクラスが宣言されています．
+ * 待機フェーズや落下フェーズは100msごとにセンサを読むだけなので，クロックを下げても間に合います．
+ * クロックを変えても通信がずれないように，次のようにしています．
+ *   UART・SPI : clk_periをclk_sysではなくPLLから直接とるので，clk_sysを変えても影響を受けない
+ *   I2C       : clk_sysで動くので，クロックを変えたら次の通信の前に通信速度を設定し直す
+ *   PWM       : clk_sysで動くので，分周比をクロックの比で直す (下げたときに分周比が1未満になる分は周波数が下がる)
+ * タイマー(sleep_msなど)はclk_ref，ADCとUSBはUSB用のPLLで動くので，クロックを変えても影響を受けません．
+ *
+ * また，VSYSの電圧の下がり方から消費電流を推定し，フェーズごとの平均の電圧・電流と使った電気量を記録します．
+ * 電池の内部抵抗などで，電流が増えるとVSYSが下がることを使います (推定なので目安です)．
+**************************************************/
+
+//! @file power.hpp
+//! @brief フェーズに合わせたクロックの切り替えと消費電流の推定
+
+#include "sc_basic.hpp"
+
+#include <array>
+
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/vreg.h"
+
+#include "i2c.hpp"
+
+namespace sc
+{
+
+//! @brief システムクロックの切り替えと消費電流の推定を行うクラス
+class PowerManager : Noncopyable
+{
+public:
+    //! @brief クロックの速さ
+    enum class Speed : uint8_t
+    {
+        Full,  // 起動したときのクロック (125MHz)
+        Low  // 下げたクロック
+    };
+
+    static constexpr std::size_t MaxPhases = 8;  // 記録するフェーズの数
+
+    //! @brief clk_periをclk_sysから切り離す (UARTなどを作った後に作成してもよい)
+    //! @param i2c クロックを変えたときに通信速度を設定し直すI2C
+    //! @param low_divider 下げるときにclk_sysを何分の1にするか (5なら125MHz→25MHz)
+    //! @param source_resistance 電池から VSYS までの抵抗 (電池の内部抵抗，配線，ダイオード) (Ω)  一度電源装置で測って合わせる
+    PowerManager(I2C& i2c, uint32_t low_divider = 5, float source_resistance = 0.3F);
+
+    //! @brief クロックを切り替える (同じ速さなら何もしない)
+    //! @note 上げるときはコアの電圧を先に上げてから，下げるときはクロックを下げてからコアの電圧を下げます
+    void set_speed(Speed speed);
+
+    //! @brief 今のクロックの速さ
+    Speed speed() const
+        {return _speed;}
+
+    //! @brief 電流の推定の基準にする (モーターを止めてクロックを上げた状態で1回呼ぶ)
+    //! @param vsys そのときのVSYSの電圧
+    //! @param current そのときの消費電流 (picoとセンサだけなので数十mA) (A)
+    void calibrate(dimension::V vsys, float current = 0.05F);
+
+    //! @brief VSYSの電圧を記録し，前回からの時間をphaseに加える (ループごとに呼ぶ)
+    //! @param phase 今のフェーズ (MaxPhases未満)
+    //! @param vsys VSYSの電圧
+    void record(std::size_t phase, dimension::V vsys);
+
+    //! @brief フェーズごとの時間，クロック，平均の電圧と推定の電流，使った電気量を表示
+    void print() const;
+
+    bool save = true;
+
+private:
+    //! @brief フェーズごとの記録
+    struct PhaseStats
+    {
+        uint64_t time_us = 0;  // このフェーズにいた時間 (μs)
+        double voltage_us = 0;  // 電圧×時間の合計 (V・μs)
+        double charge = 0;  // 推定の電流×時間の合計 (A・s)
+        uint64_t low_us = 0;  // クロックを下げていた時間 (μs)
+    };
+
+    I2C& _i2c;
+    const uint32_t _low_divider;
+    const float _source_resistance;
+    uint32_t _full_hz = 0;  // 起動したときのclk_sysの周波数 (Hz)
+    Speed _speed = Speed::Full;
+    std::array<uint32_t, NUM_PWM_SLICES> _full_div{};  // クロックを下げる前のPWMの分周比のレジスタの値
+    std::array<uint32_t, NUM_PWM_SLICES> _low_div{};  // クロックを下げたときに設定した分周比のレジスタの値
+
+    bool _calibrated = false;
+    float _calibration_voltage = 0;  // 基準のVSYSの電圧 (V)
+    float _calibration_current = 0;  // 基準の消費電流 (A)
+    uint64_t _last_record_us = 0;  // 前回recordを呼んだ時刻 (μs)
+    std::array<PhaseStats, MaxPhases> _phases{};
+
+    //! @brief VSYSの電圧から消費電流を推定 (A)
+    float estimate_current(float vsys) const;
+    //! @brief PWMの分周比をクロックの比で直す
+    void rescale_pwm(Speed speed);
+};
+
+}
+
+#endif  // SC19_PICO_SC_POWER_HPP_
@@ -0,0 +1,106 @@
+#ifndef SC19_PICO_SC_PROFILER_HPP_
+#define SC19_PICO_SC_PROFILER_HPP_
+
+/**************************************************
+ * 処理にかかった時間を測るためのコードです
+ * このファイルは，profiler.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，名前を付けた区間(ゾーン)ごとに処理時間を記録するクラスと，
+ * それを簡単に使うためのマクロが宣言されています．
+ * 処理時間は1μs単位で測り，2の累乗ごとに区切ったヒストグラムに記録するので，
+ * ゾーンの数が決まっていれば使うメモリは変わりません．
+ *
+ * CMakeでSC_PROFILEをONにしたときだけ計測し，OFFのときはマクロが空になります．
+ *     cmake -DSC_PROFILE=ON ..
+ * PC(-DPICO_PLATFORM=host)ではシミュレータ(fm/sim)のMissionLoopも計測し，すべてのスレッドの分を同じゾーンに記録します．
+**************************************************/
+
+//! @file profiler.hpp
+//! @brief 処理時間の計測
+
+#include "sc_basic.hpp"
+
+#include <array>
+
+namespace sc
+{
+
+//! @brief ゾーンごとの処理時間を記録するクラス
+//! @note 直接使わず，SC_PROFILE_SCOPEとSC_PROFILE_PRINTを使ってください
+class Profiler
+{
+public:
+    static constexpr std::size_t MaxZones = 32;  // 記録できるゾーンの数
+    static constexpr std::size_t BucketNum = 24;  // ヒストグラムの区切りの数 (最後の区切りは2^22μs≒4.2s以上)
+
+    //! @brief 1つのゾーンの記録
+    struct Zone
+    {
+        const char* name = nullptr;  // ゾーンの名前 (文字列リテラル)
+        uint32_t count = 0;  // 計測した回数
+        uint64_t total_us = 0;  // 処理時間の合計 (μs)
+        uint32_t max_us = 0;  // 処理時間の最大値 (μs)
+        std::array<uint32_t, BucketNum> histogram{};  // i番目は処理時間が[2^(i-1), 2^i)μsだった回数 (0番目は0μs)
+
+        //! @brief 処理時間を1回分記録
+        //! @note 複数のスレッドから同じゾーンに記録できます
+        void add(uint32_t duration_us);
+
+        //! @brief ヒストグラムから求めた百分位数 (区切りの上限なので，実際の値以上になる)
+        //! @param percent 何パーセント点か (0～100)
+        uint32_t percentile_us(double percent) const;
+    };
+
+    //! @brief ゾーンを取得 (なければ登録する)
+    //! @param name ゾーンの名前 (文字列リテラルなど，ずっと残るもの)
+    //! @note 複数のスレッドから同時に呼べます
+    //! @return ゾーン (いっぱいのときは"others"にまとめる)
+    static Zone& zone(const char* name);
+
+    //! @brief 起動からの時間 (μs)
+    static uint64_t now_us();
+
+    //! @brief すべてのゾーンの記録を出力
+    //! @note "profile:名前,回数,合計,平均,最大,50%点,99%点" と "profile_hist:名前,ヒストグラム..." の形式
+    static void print();
+
+    //! @brief 記録をすべて0にする (ゾーンの登録は残す)
+    static void reset();
+
+private:
+    static std::array<Zone, MaxZones> Zones;  // 登録したゾーン (Zoneの定義が終わってから初期化するため，profiler.cppで定義)
+    static inline std::size_t ZoneNum = 0;  // 登録したゾーンの数
+};
+
+//! @brief 作成してから破棄されるまでの時間をゾーンに記録するクラス
+class ProfileScope : Noncopyable
+{
+    Profiler::Zone& _zone;  // 記録するゾーン
+    const uint64_t _start_us;  // 作成した時刻 (μs)
+public:
+    explicit ProfileScope(Profiler::Zone& zone):
+        _zone(zone), _start_us(Profiler::now_us()) {}
+
+    ~ProfileScope()
+        {_zone.add(static_cast<uint32_t>(Profiler::now_us() - _start_us));}
+};
+
+}
+
+#define SC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SC_PROFILE_CONCAT(a, b) SC_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SC_PROFILE
+    //! @brief このマクロを書いた場所から，ブロックの終わりまでの時間を記録
+    //! @param name ゾーンの名前 (文字列リテラル)
+    #define SC_PROFILE_SCOPE(name) \
+        static ::sc::Profiler::Zone& SC_PROFILE_CONCAT(sc_profile_zone_, __LINE__) = ::sc::Profiler::zone(name); \
+        const ::sc::ProfileScope SC_PROFILE_CONCAT(sc_profile_scope_, __LINE__)(SC_PROFILE_CONCAT(sc_profile_zone_, __LINE__))
+    //! @brief すべてのゾーンの記録を出力
+    #define SC_PROFILE_PRINT() ::sc::Profiler::print()
+#else
+    #define SC_PROFILE_SCOPE(name) static_cast<void>(0)
+    #define SC_PROFILE_PRINT() static_cast<void>(0)
+#endif
+
+#endif  // SC19_PICO_SC_PROFILER_HPP_
@@ -69,6 +69,12 @@ public:
     //! @param high_time high(1)になる時間
     void write(Time<Unit::s> high_time) const;
 
+    //! @brief ピンの出力レベルを設定 (割り込みの中から呼ぶための，例外を投げない版)
+    //! @note 0.0未満は0.0に，1.0より大きい値は1.0にします (NaNは0.0)
+    //! @param duty : 出力レベル (0.0 ~ 1.0)
+    //! @return 出力できたか (初期化に失敗していたらfalse)
+    bool write_level(float duty) const noexcept;
+
     bool save = true;
 
 private:
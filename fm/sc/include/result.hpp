@@ -0,0 +1,207 @@
+#ifndef SC19_PICO_SC_RESULT_HPP_
+#define SC19_PICO_SC_RESULT_HPP_
+
+/**************************************************
+ * 例外を使わずにエラーを返すためのコードです
+ * このファイルは，result.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，値かエラーのどちらかを持つResult型と，エラーの種類ごとの回数の記録が宣言されています．
+ * センサの読み取りなど，毎回のループで失敗する可能性がある処理では，例外の代わりにこちらを使うことで，
+ * エラーメッセージの作成やスタックの巻き戻しにかかる時間を省けます．
+**************************************************/
+
+//! @file result.hpp
+//! @brief 例外を使わないエラー処理
+
+#include "sc_basic.hpp"
+
+#include <array>
+#include <optional>
+#include <utility>
+#include <variant>
+
+namespace sc
+{
+
+//! @brief エラーが起きた場所 (デバイスや通信の種類)
+enum class ErrorSource : uint8_t
+{
+    I2C,
+    UART,
+    BME280,
+    BNO055,
+    HCSR04,
+    Spresense,
+    GPIO,
+    Count  // 種類の数 (最後に置く)
+};
+
+//! @brief エラーの種類
+enum class ErrorCode : uint8_t
+{
+    NotInitialized,  // 初期化に失敗している
+    BusFailed,  // 通信に失敗した (I2Cの応答なしなど)
+    Timeout,  // 時間内に応答がなかった
+    InvalidValue,  // 測定値が異常
+    Stuck,  // 測定値が変化しない (センサが固まっている)
+    NoData,  // 最新のデータがない
+    Busy,  // 処理中のため受け付けられない
+    Count  // 種類の数 (最後に置く)
+};
+
+//! @brief エラーの情報
+//! @note 作成した時点では文字列を作らず，message()を呼んだときに初めてフォーマットします
+//! @note 作成するたびにErrorCounterの回数が増えます (コピーでは増えません)
+//! @note 割り込み処理の中で作っても，回数は正しく数えられます
+//! @note 異常な測定値は3つまで数値のまま持ち，メッセージに含めます
+class Error
+{
+    ErrorSource _source;  // エラーが起きた場所
+    ErrorCode _code;  // エラーの種類
+    const char* _file;  // エラーが起きたファイル (__FILE__)
+    int _line;  // エラーが起きた行 (__LINE__)
+    const char* _label = nullptr;  // 測定値の名前 (測定値を持たないときはnullptr)
+    std::array<float, 3> _values{};  // 異常だった測定値
+public:
+    //! @brief エラーを作成し，回数を記録
+    //! @param source エラーが起きた場所
+    //! @param code エラーの種類
+    //! @param file __FILE__としてください
+    //! @param line __LINE__としてください
+    Error(ErrorSource source, ErrorCode code, const char* file, int line);
+
+    //! @brief 異常だった測定値と一緒にエラーを作成し，回数を記録
+    //! @param label 測定値の名前 (文字列リテラルとしてください)
+    //! @param x,y,z 異常だった測定値 (メッセージを作るときにフォーマットします)
+    Error(ErrorSource source, ErrorCode code, const char* file, int line, const char* label, float x, float y, float z);
+
+    ErrorSource source() const
+        {return _source;}
+    ErrorCode code() const
+        {return _code;}
+    const char* file() const
+        {return _file;}
+    int line() const
+        {return _line;}
+    const std::array<float, 3>& values() const
+        {return _values;}
+
+    //! @brief エラーメッセージを作成 (f_errと同じ形式)
+    std::string message() const;
+};
+
+//! @brief エラーが起きた場所の名前
+const char* to_str(ErrorSource source);
+
+//! @brief エラーの種類の名前
+const char* to_str(ErrorCode code);
+
+
+//! @brief 値か，エラーのどちらかを持つクラス
+//! @note 失敗しても例外を投げないので，呼び出し側でhas_value()を確かめてください
+//! @note value()をエラーのときに呼ぶと，従来どおりstd::runtime_errorを投げます
+template<typename T>
+class [[nodiscard]] Result
+{
+    std::variant<T, Error> _data;  // 値かエラー
+public:
+    //! @brief 成功したときの値
+    Result(const T& value):
+        _data(std::in_place_index<0>, value) {}
+    Result(T&& value):
+        _data(std::in_place_index<0>, std::move(value)) {}
+
+    //! @brief 失敗したときのエラー
+    Result(const Error& error):
+        _data(std::in_place_index<1>, error) {}
+
+    //! @brief 値を持っているか (成功したか)
+    bool has_value() const
+        {return _data.index() == 0;}
+    explicit operator bool() const
+        {return has_value();}
+
+    //! @brief 値を取得
+    //! @note エラーのときはstd::runtime_errorを投げます
+    const T& value() const
+    {
+        if (!has_value())
+        {
+throw std::runtime_error(std::get<1>(_data).message());  // 値がないのに取り出そうとしました
+        }
+        return std::get<0>(_data);
+    }
+
+    //! @brief 値を取得 (エラーのときはdefault_value)
+    T value_or(const T& default_value) const
+        {return has_value() ? std::get<0>(_data) : default_value;}
+
+    //! @brief エラーを取得
+    //! @note 値を持っているときに呼んだ場合の動作は未定義
+    const Error& error() const
+        {return *std::get_if<1>(&_data);}
+
+    const T& operator*() const
+        {return *std::get_if<0>(&_data);}
+    const T* operator->() const
+        {return std::get_if<0>(&_data);}
+};
+
+//! @brief 値を返さない処理の成功か，エラー
+template<>
+class [[nodiscard]] Result<void>
+{
+    std::optional<Error> _error;  // エラー (成功したときは空)
+public:
+    //! @brief 成功
+    Result() = default;
+
+    //! @brief 失敗したときのエラー
+    Result(const Error& error):
+        _error(error) {}
+
+    //! @brief 成功したか
+    bool has_value() const
+        {return !_error.has_value();}
+    explicit operator bool() const
+        {return has_value();}
+
+    //! @brief エラーのときはstd::runtime_errorを投げる
+    void value() const
+    {
+        if (_error)
+        {
+throw std::runtime_error(_error->message());  // 処理に失敗しました
+        }
+    }
+
+    //! @brief エラーを取得
+    //! @note 成功したときに呼んだ場合の動作は未定義
+    const Error& error() const
+        {return *_error;}
+};
+
+
+//! @brief エラーの回数を，場所と種類ごとに記録するクラス
+class ErrorCounter
+{
+    static inline std::array<std::array<uint32_t, std::size_t(ErrorCode::Count)>, std::size_t(ErrorSource::Count)> Counts{};  // 場所と種類ごとの回数
+    friend class Error;
+public:
+    //! @brief ある場所で，ある種類のエラーが起きた回数
+    static uint32_t get(ErrorSource source, ErrorCode code)
+        {return Counts[std::size_t(source)][std::size_t(code)];}
+
+    //! @brief ある場所でエラーが起きた回数の合計
+    static uint32_t total(ErrorSource source);
+
+    //! @brief 回数をすべて0にする
+    static void reset();
+
+    //! @brief 0回でないものだけを出力
+    static void print();
+};
+
+}
+
+#endif  // SC19_PICO_SC_RESULT_HPP_
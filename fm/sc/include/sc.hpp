@@ -12,18 +12,37 @@
 #include "sc_basic.hpp"
 
 #include "adc.hpp"
+#include "altitude_filter.hpp"
 #include "binary.hpp"
+#include "boot.hpp"
+#include "checkpoint.hpp"
+#include "edge_input.hpp"
 #include "flush.hpp"
 #include "gpio.hpp"
+#include "heading_controller.hpp"
+#include "i2c_async.hpp"
 #include "i2c_slave.hpp"
 #include "i2c.hpp"
+#include "log.hpp"
+#include "lzss.hpp"
 #include "measurement.hpp"
+#include "mission.hpp"
+#include "mission_loop.hpp"
 #include "motor.hpp"
+#include "motor_actuator.hpp"
+#include "navigation.hpp"
 #include "omit.hpp"
 // #include "pin.hpp"
+#include "power.hpp"
+#include "profiler.hpp"
 #include "pwm.hpp"
+#include "result.hpp"
+#include "series.hpp"
 #include "spi_slave.hpp"
 #include "spi.hpp"
+#include "stuck_detector.hpp"
+#include "text_format.hpp"
+#include "trace.hpp"
 #include "uart.hpp"
 // #include "unit.hpp"
 
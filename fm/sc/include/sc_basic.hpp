@@ -12,6 +12,10 @@
 //! @brief プログラム全体で共通の，基本的な機能
 
 #include "pico/stdlib.h"
+#if __has_include("hardware/structs/timer.h")  // pico-SDKのhostのビルド(PCで実行する)にはレジスタがない
+    #include "hardware/structs/timer.h"
+    #define SC_HAS_TIMER_HW
+#endif
 
 #define NODEBUG
 
@@ -25,25 +29,68 @@
 
 #include "unit.hpp"
 #include "pin.hpp"
+#include "text_format.hpp"
+
+// SC_HOT_IN_RAMを定義すると(cmake -DSC_HOT_IN_RAM=ON ..)，次の2つで囲んだ関数をフラッシュ(XIP)ではなくSRAMに置きます．
+// XIPのキャッシュから追い出されていても遅れません．どこに置かれたかはbench/map_report.cppでFM.elf.mapから確かめられます (呼び出し先までは逆アセンブルの結果から確かめます)．
+
+//! @brief 割り込みハンドラと，そこから呼ぶ関数を定義するときに，関数名をこれで囲む
+#ifdef SC_HOT_IN_RAM
+    #define SC_ISR_FUNC(name) __not_in_flash_func(name)
+#else
+    #define SC_ISR_FUNC(name) name
+#endif
+
+//! @brief 毎ループ呼ぶ計算(フィルタや補正式)を定義するときに，関数名をこれで囲む
+#ifdef SC_HOT_IN_RAM
+    #define SC_HOT_FUNC(name) __not_in_flash_func(name)
+#else
+    #define SC_HOT_FUNC(name) name
+#endif
 
 namespace sc
 {
 
+//! @brief 起動からの時間(μs)を取得 (SC_ISR_FUNCの関数の中ではtime_us_64の代わりにこれを使う)
+//! @note pico-SDKのtime_us_64はフラッシュに置かれるので，同じようにタイマーのレジスタを直接読む (上位を読み直して，下位が一周したときに備える)
+__attribute__((always_inline)) inline uint64_t isr_time_us()
+{
+#ifdef SC_HAS_TIMER_HW
+    uint32_t high = timer_hw->timerawh;
+    while (true)
+    {
+        const uint32_t low = timer_hw->timerawl;
+        const uint32_t next_high = timer_hw->timerawh;
+        if (next_high == high)
+return (static_cast<uint64_t>(high) << 32) | low;
+        high = next_high;
+    }
+#else
+    return ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+#endif
+}
+
+constexpr std::size_t FormatBufferSize = 128;  // format_strがスタックに用意するバッファのバイト数 (ほとんどのログの1行が入る)
+
 //! @brief printfの形式で文字列をフォーマット
+//! @note snprintfではなくformat_to(text_format.hpp)で1回でフォーマットします (FormatBufferSizeを超えたときだけもう1回)
 //! @param format フォーマット文字列
 //! @param args フォーマット文字列に埋め込む値
 template<typename... Args>
-std::string format_str(const std::string& format, Args... args) noexcept
+std::string format_str(const char* format, Args... args) noexcept
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     try
     {
-        const std::size_t formatted_chars_num = std::snprintf(nullptr, 0, format.c_str(), args...);  // フォーマット後の文字数を計算
-        char formatted_chars[formatted_chars_num + 1];  // フォーマット済みの文字列を保存するための配列を作成
-        std::snprintf(&formatted_chars[0], formatted_chars_num + 1, format.c_str(), args...);  // フォーマットを実行
-return std::string(formatted_chars);  // フォーマット済み文字列を出力
+        char buffer[FormatBufferSize];
+        const std::size_t length = format_to(buffer, sizeof(buffer), format, args...);  // フォーマットを実行し，文字数を得る
+        if (length < sizeof(buffer))
+return std::string(buffer, length);  // フォーマット済み文字列を出力
+        std::string formatted(length, '\0');  // 入らなかったときは，文字数が分かったので直接書き込む
+        format_to(formatted.data(), length + 1, format, args...);
+        return formatted;
     }
     catch(const std::exception& e) {std::cout << "           From  FILE : " << __FILE__ << "  LINE : " << __LINE__ << "\n                 MESSAGE : Failed to format string\n" << e.what() << std::flush;}  // ログの保存に失敗しました
     catch(...) {std::cout << "<<ERROR>>  FILE : " << __FILE__ << "  LINE : " << __LINE__ << "\n           MESSAGE : Failed to format string" << std::endl;}  // ログの保存に失敗しました
@@ -52,6 +99,13 @@ return std::string(formatted_chars);  // フォーマット済み文字列を出
 // この関数は以下の資料を参考にて作成しました
 // https://pyopyopyo.hatenablog.com/entry/2019/02/08/102456
 
+//! @brief printfの形式で文字列をフォーマット
+//! @param format フォーマット文字列
+//! @param args フォーマット文字列に埋め込む値
+template<typename... Args>
+std::string format_str(const std::string& format, Args... args) noexcept
+    {return format_str(format.c_str(), args...);}
+
 
 //! @brief エラーメッセージのフォーマットを整える
 //! @param FILE __FILE__としてください (自動でファイル名に置き換わります)
@@ -114,10 +168,10 @@ inline std::function<void(const std::string&)> set_print = [](const std::string&
 };
 
 //! @brief printfの形式で出力
-//! @param format フォーマット文字列
+//! @param format フォーマット文字列 (文字列リテラルはstd::stringにせずに受け取る)
 //! @param args フォーマット文字列に埋め込む値
 template<typename... Args>
-void print(const std::string& format, Args... args) noexcept
+void print(const char* format, Args... args) noexcept
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -132,6 +186,13 @@ void print(const std::string& format, Args... args) noexcept
     }
 }
 
+//! @brief printfの形式で出力
+//! @param format フォーマット文字列
+//! @param args フォーマット文字列に埋め込む値
+template<typename... Args>
+void print(const std::string& format, Args... args) noexcept
+    {print(format.c_str(), args...);}
+
 
 //! @brief 指定した時間 待機
 //! @param time 待機する時間 (100_ms のように入力)
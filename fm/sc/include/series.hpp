@@ -0,0 +1,165 @@
+#ifndef SC19_PICO_SC_SERIES_HPP_
+#define SC19_PICO_SC_SERIES_HPP_
+
+/**************************************************
+ * センサの測定値を少ないバイト数で記録するためのコードです
+ * このファイルは，series.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，いくつかのチャンネル(気圧，3軸の加速度など)の測定値を，
+ * 決めた桁で丸めた整数にし，前回との差をzig-zag符号化したvarintで記録するクラスが宣言されています．
+ * センサの値はゆっくり変わるので，"%f"の文字列(1つ約10バイト)が1~2バイトになります．
+ *
+ * 記録はブロックごとに出力し，どのブロックもそれだけで元に戻せるように，最初の測定値は差ではなくそのまま記録します．
+ *   ブロック : [SeriesSync(1)] [本体のバイト数(2, リトルエンディアン)] [本体] [本体のCRC-8(1)]
+ *   本体     : [SeriesStream(1)] [チャンネル数N(1)] [チャンネルごとの桁(N)] [測定の回数(1)]
+ *              [時刻(ms)] [値×N]                  最初の測定 (時刻はvarint，値はzig-zagのvarint)
+ *              [前回からの時間(ms)] [前回との差×N]  2回目以降
+ * 桁は10の何乗の単位で丸めるかで，-2なら0.01の単位になります．
+ * PCのツール(fm/traceのSERIES_DECODE)でSeriesDecoderを使って元に戻します．
+**************************************************/
+
+//! @file series.hpp
+//! @brief センサの測定値の差分の記録
+
+// #include "sc_basic.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace sc
+{
+
+constexpr uint8_t SeriesSync = 0xD5;  // ブロックの先頭の目印
+
+//! @brief 記録するセンサ (ブロックの先頭に書き込む)
+enum class SeriesStream : uint8_t
+{
+    BME280 = 1,  // 気圧 (Pa)，湿度 (%)，気温 (°C)
+    BNO055 = 2,  // 加速度 (m/s²)，重力加速度 (m/s²)，地磁気 (T)，角速度 (rad/s)  それぞれxyz
+    Lux = 3,  // 照度 (lx)
+    Vsys = 4  // VSYSの電圧 (V)
+};
+
+//! @brief センサの名前
+inline const char* to_str(SeriesStream stream)
+{
+    switch (stream)
+    {
+        case SeriesStream::BME280: return "BME280";
+        case SeriesStream::BNO055: return "BNO055";
+        case SeriesStream::Lux: return "Lux";
+        case SeriesStream::Vsys: return "VSYS";
+    }
+    return "?";
+}
+
+//! @brief 測定値を差分で記録し，ブロックごとに出力するクラス
+//! @note 動的メモリは使いません
+class SeriesEncoder
+{
+public:
+    //! @brief ブロックを書き込む関数の型
+    using Sink = std::function<void(const uint8_t* data, std::size_t size)>;
+
+    static constexpr std::size_t MaxChannels = 16;  // チャンネル数の上限
+    static constexpr std::size_t MaxBodySize = 512;  // ブロックの本体のバイト数の上限
+
+    //! @brief 記録を準備
+    //! @param stream どのセンサか
+    //! @param exponents チャンネルごとに，10の何乗の単位で丸めるか (チャンネル数はこの数になる)
+    //! @param block_samples 1つのブロックに入れる測定の回数 (最大255)  多いほど縮むが，リセットで失う分が増える
+    //! @param sink ブロックを書き込む関数
+    SeriesEncoder(SeriesStream stream, std::initializer_list<int8_t> exponents, std::size_t block_samples = 32, Sink sink = nullptr);
+
+    //! @brief ブロックを書き込む関数を変える
+    void set_sink(Sink sink)
+        {_sink = sink;}
+
+    //! @brief 1回分の測定値を記録 (ブロックがいっぱいになったらsinkを呼ぶ)
+    //! @param time_ms 測定した時刻 (ms)
+    //! @param values チャンネル数と同じ数の測定値 (足りない分は0)
+    void add(uint32_t time_ms, std::initializer_list<float> values);
+
+    //! @brief 1回分の測定値を記録
+    //! @param values チャンネル数と同じ数の測定値
+    void add(uint32_t time_ms, const float* values);
+
+    //! @brief 途中のブロックを出力する (記録が止まる前に呼ぶ)
+    void flush();
+
+    //! @brief チャンネル数
+    std::size_t channels() const
+        {return _channels;}
+
+    //! @brief これまでに記録した測定の回数
+    uint64_t samples() const
+        {return _samples;}
+
+    //! @brief これまでに出力したバイト数
+    uint64_t output_bytes() const
+        {return _output_bytes;}
+
+private:
+    static constexpr std::size_t HeaderSize = 3;  // 目印と本体のバイト数
+
+    const SeriesStream _stream;
+    const std::size_t _channels;
+    const std::size_t _block_samples;
+    Sink _sink;
+    std::array<int8_t, MaxChannels> _exponents{};
+    std::array<float, MaxChannels> _scales{};  // 丸める前に掛ける値 (10の-exponents乗)
+
+    std::array<uint8_t, HeaderSize + MaxBodySize + 1> _buffer{};  // 出力するブロック (最後はCRC-8)
+    std::size_t _size = 0;  // _bufferに入れたバイト数 (0ならまだブロックを始めていない)
+    std::size_t _block_count = 0;  // 今のブロックに入れた測定の回数
+    uint32_t _last_time = 0;  // 前回の時刻 (ms)
+    std::array<int32_t, MaxChannels> _last{};  // 前回の丸めた値
+
+    uint64_t _samples = 0;
+    uint64_t _output_bytes = 0;
+
+    //! @brief ブロックの先頭を書き込む
+    void begin_block();
+    //! @brief varintを1つ書き込む
+    void put_varint(uint32_t value);
+};
+
+//! @brief 元に戻した1回分の測定値
+struct SeriesSample
+{
+    SeriesStream stream;  // どのセンサか
+    uint32_t time_ms;  // 測定した時刻 (ms)
+    std::vector<double> values;  // チャンネルごとの測定値 (丸めた単位の値)
+};
+
+//! @brief SeriesEncoderが出力したバイト列を元に戻すクラス (主にPC用)
+class SeriesDecoder
+{
+public:
+    //! @brief バイト列からブロックを探して元に戻し，outputの後ろに加える
+    //! @note 壊れたブロックは読み飛ばし，次の目印から探し直します
+    //! @return 元に戻したブロックの数
+    std::size_t decode(const uint8_t* data, std::size_t size, std::vector<SeriesSample>& output);
+
+    //! @brief 読み飛ばしたバイト数 (壊れたブロックなど)
+    std::size_t skipped_bytes() const
+        {return _skipped;}
+
+private:
+    std::size_t _skipped = 0;
+
+    //! @brief 1つのブロックの本体を元に戻す
+    //! @return 最後まで正しく読めたか
+    static bool decode_body(const uint8_t* body, std::size_t size, std::vector<SeriesSample>& output);
+};
+
+//! @brief CRC-8 (多項式0x07)
+uint8_t series_crc8(const uint8_t* data, std::size_t size);
+
+}
+
+#endif  // SC19_PICO_SC_SERIES_HPP_
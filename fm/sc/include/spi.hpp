@@ -54,7 +54,7 @@ public:
     //! @param cs_gpios CSピンのGPIO番号を(3, 4, 5)のように並べて入力
     template<typename... T>
     CS(T... cs_gpios) try:
-        _cs_pins(Pin(cs_gpios)...)
+        _cs_pins{Pin(cs_gpios)...}  // ()だと1つのときにvector(n)として扱われるので{}で初期化する
     {
         try
         {
@@ -180,26 +180,67 @@ public:
     //! @brief SPIによる送信
     //! @param output_data 送信するデータ
     //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
-    void write(Binary output_data, CS cs_pin) const;
+    void write(Binary output_data, const CS& cs_pin) const;
+
+    //! @brief SPIによる送信 (データをコピーしない)
+    //! @param output_data 送信するデータ (StaticBinaryもそのまま渡せます)
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    void write(BinaryView output_data, const CS& cs_pin) const;
 
     //! @brief SPIによる受信
     //! @param size 受信するバイト数
     //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
     //! @return Binary型のバイト列
-    Binary read(std::size_t size, CS cs_pin) const;
+    Binary read(std::size_t size, const CS& cs_pin) const;
+
+    //! @brief SPIによる受信 (配列に直接書き込む)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    //! @return 実際に受信したバイト数
+    std::size_t read(uint8_t* input_data, std::size_t size, const CS& cs_pin) const;
+
+    //! @brief SPIによる受信 (StaticBinaryに直接書き込み，動的メモリを使わない)
+    //! @param input_data 受信したデータを書き込むバイト列．input_data.size()バイト受信し，受信したバイト数にサイズを合わせます
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    template<std::size_t N>
+    void read(StaticBinary<N>& input_data, const CS& cs_pin) const
+        {input_data.resize(read(input_data.data(), input_data.size(), cs_pin));}
 
     //! @brief SPIによるメモリへの送信
     //! @param output_data 送信するデータ
     //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
     //! @param memory_addr 通信先のデバイスのメモリの何番地にデータを記録するか
-    void write_memory(Binary output_data, CS cs_pin, MemoryAddr memory_addr) const;
+    void write_memory(Binary output_data, const CS& cs_pin, MemoryAddr memory_addr) const;
+
+    //! @brief SPIによるメモリへの送信 (データをコピーしない)
+    //! @param output_data 送信するデータ (StaticBinaryもそのまま渡せます)
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    //! @param memory_addr 通信先のデバイスのメモリの何番地にデータを記録するか
+    void write_memory(BinaryView output_data, const CS& cs_pin, MemoryAddr memory_addr) const;
 
     //! @brief SPIによるメモリからの受信
     //! @param size 受信するバイト数
     //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
     //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
     //! @return Binary型のバイト列
-    Binary read_memory(std::size_t size, CS cs_pin, MemoryAddr memory_addr) const;
+    Binary read_memory(std::size_t size, const CS& cs_pin, MemoryAddr memory_addr) const;
+
+    //! @brief SPIによるメモリからの受信 (配列に直接書き込む)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 受信するバイト数
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    //! @return 実際に受信したバイト数
+    std::size_t read_memory(uint8_t* input_data, std::size_t size, const CS& cs_pin, MemoryAddr memory_addr) const;
+
+    //! @brief SPIによるメモリからの受信 (StaticBinaryに直接書き込み，動的メモリを使わない)
+    //! @param input_data 受信したデータを書き込むバイト列．input_data.size()バイト受信し，受信したバイト数にサイズを合わせます
+    //! @param cs_pin 通信先のデバイスのチップセレクトピンの番号
+    //! @param memory_addr 通信先のデバイスのメモリの何番地からデータを読み込むか
+    template<std::size_t N>
+    void read_memory(StaticBinary<N>& input_data, const CS& cs_pin, MemoryAddr memory_addr) const
+        {input_data.resize(read_memory(input_data.data(), input_data.size(), cs_pin, memory_addr));}
 
     using TX = MOSI;
     using RX = MISO;
@@ -207,6 +248,10 @@ public:
     bool save = true;
 private:
     static inline bool IsUse[2] = {false, false};  // 既にSPI0とSPI1を使用しているか
+
+    //! @brief 通信先のデバイスにつながるCSピンを探す
+    //! @note CSピンは_cs_pinsの中からGPIO番号で探します (_cs_pinsの番号ではありません)
+    const GPIO<Out>& select_cs(const CS& cs_pin) const;
 };
 
 }
@@ -0,0 +1,115 @@
+#ifndef SC19_PICO_SC_STUCK_DETECTOR_HPP_
+#define SC19_PICO_SC_STUCK_DETECTOR_HPP_
+
+/**************************************************
+ * スタック(空転・引っかかり)の検知に関するコードです
+ * このファイルは，stuck_detector.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，モーターへの指令と実際の動きを比べてスタックを検知するコードが宣言されています．
+**************************************************/
+
+//! @file stuck_detector.hpp
+//! @brief モーターの指令値とIMU・GPSの動きからスタックを検知
+
+// #include "sc_basic.hpp"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>  // pair
+
+#include "unit.hpp"
+
+
+namespace sc
+{
+
+//! @brief 脱出動作の1ステップ
+struct MotorStep
+{
+    float left;  // 左モーターの出力  -1.0以上+1.0以下
+    float right;  // 右モーターの出力  -1.0以上+1.0以下
+    float time;  // 続ける時間 (s)
+};
+
+//! @brief モーターを回しているのに機体が動いていない状態を検知するクラス
+//! @note 直近の一定個数のサンプルをリングバッファに持ち，合計値を差分で更新するので1サンプルあたりの計算量はO(1)です
+//! @note 動的メモリは使いません
+class StuckDetector
+{
+public:
+    //! @brief 検知結果
+    enum class Status
+    {
+        Moving,  // 動いている (またはまだ判定できない)
+        Stuck,  // 指令を出しているのに振動も回転も移動もない (引っかかり，パラシュートの絡まりなど)
+        Slip  // 振動はあるのに回転も移動もしない (車輪の空転)
+    };
+
+    static constexpr std::size_t MaxWindow = 100;  // 窓に入れられるサンプルの最大数
+    static constexpr std::size_t MaxSteps = 6;  // 脱出動作の最大ステップ数
+
+private:
+    //! @brief 1サンプル分の値
+    struct Sample
+    {
+        float effort;  // 指令した前進の強さ |左+右|/2
+        float turn;  // 指令した旋回の強さ |右-左|/2
+        float accel;  // 線形加速度の大きさ (m/s²)
+        float yaw;  // ヨー角速度の大きさ (rad/s)
+        float north;  // 北向きの位置 (m)
+        float east;  // 東向きの位置 (m)
+    };
+
+    std::array<Sample, MaxWindow> _samples;  // 直近のサンプル (リングバッファ)
+    std::size_t _next = 0;  // 次に書き込む位置
+    std::size_t _count = 0;  // 窓に入っているサンプルの数
+    float _sum_effort = 0.0F, _sum_turn = 0.0F, _sum_accel = 0.0F, _sum_yaw = 0.0F;  // 窓の中の合計
+
+    const std::size_t _window;  // 判定に使うサンプルの数
+    const float _min_effort;  // これより強く指令しているときだけ判定する
+    const float _min_displacement;  // 窓の中でこれより移動していれば動いているとみなす (m)
+    const float _min_yaw;  // 平均でこれより回転していれば動いているとみなす (rad/s)
+    const float _min_accel;  // 平均でこれより加速度(振動)があれば空転とみなす (m/s²)
+
+    std::array<MotorStep, MaxSteps> _escape;  // 脱出動作
+    std::size_t _escape_size = 0;
+    std::array<MotorStep, MaxSteps> _tangled_escape;  // パラシュートが絡まっているときの脱出動作
+    std::size_t _tangled_escape_size = 0;
+
+public:
+    //! @brief スタックの検知器を作成
+    //! @param window 判定に使うサンプルの数 (MaxWindow以下)
+    //! @param min_effort これより強く指令しているときだけ判定する (0 ~ 1)
+    //! @param min_displacement 窓の中でこれより移動していれば動いているとみなす
+    //! @param min_yaw 平均でこれより回転していれば動いているとみなす
+    //! @param min_accel 平均でこれより加速度(振動)があれば空転とみなす
+    StuckDetector(std::size_t window = 80, float min_effort = 0.3F, Length<Unit::m> min_displacement = Length<Unit::m>(1.0), dimension::rad_s min_yaw = dimension::rad_s(0.15), dimension::m_s2 min_accel = dimension::m_s2(0.3));
+
+    //! @brief 1サンプルを追加して判定
+    //! @param left_speed 左モーターに出力している値
+    //! @param right_speed 右モーターに出力している値
+    //! @param line_acce BNO055の線形加速度
+    //! @param yaw_rate ジャイロのz軸の角速度
+    //! @param north 北向きの位置 (ゴールからの相対位置などでよい) (m)
+    //! @param east 東向きの位置 (m)
+    //! @return 検知結果
+    Status update(float left_speed, float right_speed, const Acceleration<Unit::m_s2>& line_acce, dimension::rad_s yaw_rate, float north, float east);
+
+    //! @brief 窓の中のサンプルを捨てる (脱出動作のあとなど)
+    void reset();
+
+    //! @brief 脱出動作を設定
+    //! @param steps 脱出動作 (MaxSteps個まで)
+    //! @param tangled trueならパラシュートが絡まっているとき用の動作を設定
+    void set_escape(std::initializer_list<MotorStep> steps, bool tangled = false);
+
+    //! @brief 脱出動作を取得
+    //! @param tangled パラシュートが分離していないならtrue
+    //! @return 脱出動作の先頭と個数
+    std::pair<const MotorStep*, std::size_t> escape(bool tangled) const;
+};
+
+}
+
+#endif  // SC19_PICO_SC_STUCK_DETECTOR_HPP_
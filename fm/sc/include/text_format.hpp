@@ -0,0 +1,123 @@
+#ifndef SC19_PICO_SC_TEXT_FORMAT_HPP_
+#define SC19_PICO_SC_TEXT_FORMAT_HPP_
+
+/**************************************************
+ * ログの文字列を速く作るためのコードです
+ * このファイルは，text_format.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，printfと同じ形式のフォーマット文字列を，渡されたバッファに1回で書き込む関数が宣言されています．
+ * snprintfは"%f"をdoubleのまま10進に変換するので，浮動小数点の計算をソフトウェアで行うpicoでは遅くなります．
+ * ここでは"%.3f"などの小数を，整数部分と「小数部分×10^桁数」の2つの整数にしてから文字にします．
+ *   自分で変換する : %d %i %u %x %X %c %s %p %f %F %% (フラグ -+ 0#，幅，精度，長さの指定 hh h l ll j z tも使える)
+ *   snprintfに任せる : %e %g %aなど，精度が10桁以上の%f，値が大きすぎる%f，NaNと無限大
+ * 丸めは，5の境目に近いときだけfmaで正確に確かめるので，snprintfと同じ結果になります．
+ * 引数の型はテンプレートで受け取るので，%dにdoubleを渡すような型の違いがあっても壊れません (引数が足りないときは何も書きません)．
+ * 整数は長さの指定(なければintに広げた引数の型)のビット数に切り詰めるので，intの-1は"%x"でffffffff，"%hhx"でffになります (snprintfと同じ)．
+**************************************************/
+
+//! @file text_format.hpp
+//! @brief printf形式の高速なフォーマット
+
+// #include "sc_basic.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sc
+{
+
+//! @brief フォーマットに渡す引数を1つ保存するクラス
+//! @note 直接使わず，format_toを使ってください
+class FormatArg
+{
+public:
+    enum class Type : uint8_t
+    {
+        Int,  // 符号付き整数
+        Uint,  // 符号なし整数
+        Double,  // 浮動小数点
+        String,  // 文字列 (const char*)
+        Pointer  // ポインタ
+    };
+
+    template<typename T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>, int> = 0>
+    FormatArg(T value):
+        _type(Type::Int), _size(sizeof(T)) {_value.i = value;}
+
+    template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_signed_v<T>, int> = 0>
+    FormatArg(T value):
+        _type(Type::Uint), _size(sizeof(T)) {_value.u = value;}
+
+    template<typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    FormatArg(T value):
+        _type(Type::Double), _size(sizeof(T)) {_value.d = static_cast<double>(value);}
+
+    template<typename T, std::enable_if_t<std::is_enum_v<T>, int> = 0>
+    FormatArg(T value):
+        FormatArg(static_cast<std::underlying_type_t<T>>(value)) {}
+
+    // PinやSlaveAddrなど，整数に変換できるクラス
+    template<typename T, std::enable_if_t<std::is_class_v<T> && std::is_convertible_v<T, uint64_t>, int> = 0>
+    FormatArg(const T& value):
+        _type(Type::Uint), _size(sizeof(uint64_t)) {_value.u = static_cast<uint64_t>(value);}
+
+    FormatArg(const char* value):
+        _type(Type::String), _size(sizeof(value)) {_value.s = value;}
+
+    FormatArg(const void* value):
+        _type(Type::Pointer), _size(sizeof(value)) {_value.p = value;}
+
+    Type type() const
+        {return _type;}
+
+    //! @brief 渡された型のバイト数 (長さの指定がない%xなどで，上の桁を切り捨てるのに使う)
+    int size() const
+        {return _size;}
+
+    //! @brief 整数として取得 (浮動小数点は切り捨て)
+    int64_t as_int() const;
+    //! @brief 符号なし整数として取得 (負の値は2の補数)
+    uint64_t as_uint() const;
+    //! @brief 浮動小数点として取得
+    double as_double() const;
+    //! @brief 文字列として取得 (文字列でなければnullptr)
+    const char* as_string() const
+        {return (_type == Type::String) ? _value.s : nullptr;}
+    //! @brief ポインタとして取得
+    const void* as_pointer() const;
+
+private:
+    Type _type;
+    uint8_t _size;  // 渡された型のバイト数
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const char* s;
+        const void* p;
+    } _value;
+};
+
+//! @brief printf形式でバッファに書き込む (引数を保存した後の処理)
+//! @note 直接使わず，format_toを使ってください
+std::size_t format_args_to(char* buffer, std::size_t size, const char* format, const FormatArg* args, std::size_t arg_num);
+
+//! @brief printf形式の文字列を，バッファに1回で書き込む
+//! @param buffer 書き込む先 (最後に'\0'を付ける)
+//! @param size バッファのバイト数 (足りないときは入る分だけ書く)
+//! @param format フォーマット文字列
+//! @param args フォーマット文字列に埋め込む値
+//! @return フォーマットした文字列の長さ ('\0'を除く)  size以上ならバッファが足りなかった (snprintfと同じ)
+template<typename... Args>
+std::size_t format_to(char* buffer, std::size_t size, const char* format, Args... args)
+{
+    const std::array<FormatArg, sizeof...(Args)> saved{FormatArg(args)...};
+    return format_args_to(buffer, size, format, saved.data(), saved.size());
+}
+
+}
+
+#endif  // SC19_PICO_SC_TEXT_FORMAT_HPP_
@@ -0,0 +1,84 @@
+#ifndef SC19_PICO_SC_TRACE_HPP_
+#define SC19_PICO_SC_TRACE_HPP_
+
+/**************************************************
+ * 飛行中の入力を記録(トレース)するためのコードです
+ * このファイルは，trace.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，センサや通信から受け取った生のデータを，時刻付きのバイナリで記録するクラスが宣言されています．
+ * printの文字列だけでは，飛行後にどの入力でどう判断したのかを確かめられないので，
+ * I2C・UARTの受信データ，ADCの測定値，ピンの変化をすべて残し，PCのツール(fm/trace)で読み込みます．
+ *
+ * 記録は割り込みの中からでもできるように，まずRAMのリングバッファにため，
+ * メインループでflush()を呼んだときにまとめて出力先(SDカードなど)に書き込みます．
+**************************************************/
+
+//! @file trace.hpp
+//! @brief 入力の記録
+
+#include "sc_basic.hpp"
+
+#include <array>
+#include <functional>
+
+#include "trace_format.hpp"
+
+namespace sc
+{
+
+//! @brief 入力を時刻付きで記録するクラス
+//! @note start()を呼ぶまでは何も記録せず，record()はすぐに戻ります
+class TraceRecorder
+{
+public:
+    //! @brief 記録を書き込む関数の型
+    using Sink = std::function<void(const uint8_t* data, std::size_t size)>;
+
+    //! @brief 記録を開始
+    //! @param sink flush()で記録を書き込む関数
+    static void start(Sink sink);
+
+    //! @brief 記録を止める (ためてある分は書き込む)
+    static void stop();
+
+    //! @brief 記録中か
+    static bool enabled()
+        {return Enabled;}
+
+    //! @brief 入力を1つ記録 (割り込みの中からも呼べる)
+    //! @param type 入力の種類
+    //! @param id I2Cのスレーブアドレス，UARTの番号，ADCのチャンネル，GPIOの番号
+    //! @param sub I2Cのメモリアドレス (それ以外は0)
+    //! @param data 記録するデータ (TraceMaxDataバイトより長いときは分けて記録する)
+    //! @param size データのバイト数
+    //! @param time_us 入力を受け取った時刻 (μs)
+    static void record(TraceType type, uint8_t id, uint8_t sub, const uint8_t* data, std::size_t size, uint64_t time_us);
+
+    //! @brief 入力を1つ記録 (時刻は現在)
+    static void record(TraceType type, uint8_t id, uint8_t sub, const uint8_t* data, std::size_t size);
+
+    //! @brief フェーズの移行などの目印を記録
+    //! @param text 目印の文字列
+    static void marker(const std::string& text);
+
+    //! @brief ためてある記録を書き込む (メインループで呼ぶ)
+    static void flush();
+
+    //! @brief 記録しきれずに捨てた記録の数
+    static uint32_t dropped()
+        {return Dropped;}
+
+    static constexpr std::size_t BufferSize = 8192;  // ためておけるバイト数 (2の累乗)
+
+private:
+    static inline volatile bool Enabled = false;  // 記録中か
+    static inline Sink OutputSink;  // 記録を書き込む関数
+    static inline std::array<uint8_t, BufferSize> Buffer{};  // 書き込む前の記録 (リングバッファ)
+    static inline volatile std::size_t Head = 0;  // 次に書き込む位置
+    static inline volatile std::size_t Tail = 0;  // 次に記録する位置
+    static inline volatile uint32_t Dropped = 0;  // 記録しきれずに捨てた数
+};
+
+}
+
+#endif  // SC19_PICO_SC_TRACE_HPP_
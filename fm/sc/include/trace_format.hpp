@@ -0,0 +1,62 @@
+#ifndef SC19_PICO_SC_TRACE_FORMAT_HPP_
+#define SC19_PICO_SC_TRACE_FORMAT_HPP_
+
+/**************************************************
+ * 飛行中の入力の記録(トレース)の形式です
+ *
+ * このファイルでは，TraceRecorderがSDカードに書き込み，PCのツールが読み込むバイナリの形式が定義されています．
+ * PCのツールからも読み込むので，pico-SDKやscライブラリの他のファイルには依存しません．
+ *
+ * 1つの記録は，9バイトのヘッダと，size バイトのデータからなります (数値はリトルエンディアン)
+ *     [0]    TraceSync (0xA5)  記録の先頭の目印 (途中から読んでも次の記録の先頭を探せる)
+ *     [1]    TraceType         入力の種類
+ *     [2]    id                I2Cのスレーブアドレス，UARTの番号，ADCのチャンネル，GPIOの番号
+ *     [3]    sub               I2Cのメモリアドレス (それ以外は0)
+ *     [4]    size              データのバイト数 (0～255)
+ *     [5-8]  time_us           起動からの時間(μs)の下位32bit (約71分で1周するので，読むときに繋げる)
+ *     [9～]  データ            I2C・UARTは受信したバイト列，ADCは測定値(2バイト)，GPIOは変化後の状態(1バイト)，
+ *                              Markerは文字列
+**************************************************/
+
+//! @file trace_format.hpp
+//! @brief トレースの形式
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sc
+{
+
+//! @brief 記録した入力の種類
+enum class TraceType : uint8_t
+{
+    I2CRead = 1,  // I2Cによる受信
+    I2CMemory = 2,  // I2Cによるメモリからの受信
+    UART = 3,  // UARTによる受信
+    ADC = 4,  // ADCの測定値
+    GPIO = 5,  // ピンの変化
+    Marker = 6  // フェーズの移行などの目印 (文字列)
+};
+
+constexpr uint8_t TraceSync = 0xA5;  // 記録の先頭の目印
+constexpr std::size_t TraceHeaderSize = 9;  // ヘッダのバイト数
+constexpr std::size_t TraceMaxData = 255;  // 1つの記録のデータの最大のバイト数
+
+//! @brief 記録の種類の名前
+inline const char* to_str(TraceType type)
+{
+    switch (type)
+    {
+        case TraceType::I2CRead: return "i2c";
+        case TraceType::I2CMemory: return "i2c_mem";
+        case TraceType::UART: return "uart";
+        case TraceType::ADC: return "adc";
+        case TraceType::GPIO: return "gpio";
+        case TraceType::Marker: return "marker";
+        default: return "unknown";
+    }
+}
+
+}
+
+#endif  // SC19_PICO_SC_TRACE_FORMAT_HPP_
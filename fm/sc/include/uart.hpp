@@ -11,11 +11,12 @@
 //! @file uart.hpp
 //! @brief UARTでの入出力
 
-#include <deque>
+#include <array>
 #include <vector>
 
 #include "sc_basic.hpp"
 #include "binary.hpp"
+#include "result.hpp"
 
 #include "hardware/uart.h"
 
@@ -81,19 +82,71 @@ public:
     //! @param output_data 送信するデータ
     void write(Binary output_data) const;
 
+    //! @brief UARTによる送信 (データをコピーしない)
+    //! @param output_data 送信するデータ (StaticBinaryもそのまま渡せます)
+    void write(BinaryView output_data) const;
+
     //! @brief UARTによる受信
     //! @return Binary型のバイト列
     Binary read() const;
 
+    //! @brief UARTによる受信 (配列に直接書き込む)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 配列の長さ (これより多く受信していた分は，次に読むときまで残ります)
+    //! @return 実際に書き込んだバイト数
+    std::size_t read(uint8_t* input_data, std::size_t size) const;
+
+    //! @brief UARTによる受信 (StaticBinaryに直接書き込み，動的メモリを使わない)
+    //! @param input_data 受信したデータを書き込むバイト列．最大Nバイト書き込み，書き込んだバイト数にサイズを合わせます
+    template<std::size_t N>
+    void read(StaticBinary<N>& input_data) const
+        {input_data.resize(read(input_data.begin(), N));}
+
+    //! @brief UARTによる受信 (失敗しても例外を投げない)
+    //! @param input_data 受信したデータを書き込む配列
+    //! @param size 配列の長さ
+    //! @return 実際に書き込んだバイト数か，エラー
+    Result<std::size_t> try_read(uint8_t* input_data, std::size_t size) const;
+
+    //! @brief UARTによる受信 (StaticBinaryに直接書き込み，失敗しても例外を投げない)
+    //! @param input_data 受信したデータを書き込むバイト列．最大Nバイト書き込み，書き込んだバイト数にサイズを合わせます
+    //! @return 成功したか，エラー
+    template<std::size_t N>
+    Result<void> try_read(StaticBinary<N>& input_data) const
+    {
+        const Result<std::size_t> input_size = try_read(input_data.begin(), N);
+        if (!input_size)
+    return input_size.error();
+        input_data.resize(*input_size);
+        return {};
+    }
+
     bool save = true;
 
 private:
     static inline bool IsUse[2] = {false, false};  // 既にUART0とUART1を使用しているか
+
+public:
     static constexpr std::size_t MaxInputLen = 255;  // 受信したデータを最大で何バイトまで保管しておくか
 
+private:
+    //! @brief 割り込み処理で受信したデータを一時保存するリングバッファ
+    //! @note 割り込み処理の中でメモリを確保しないように，大きさを固定しています
+    //! @note staticな変数としてだけ使うので，最初はすべて0になっています
+    struct InputBuffer
+    {
+        std::array<uint8_t, MaxInputLen + 1> data;  // 満杯と空を区別するために1バイト多くとる
+        volatile std::size_t head;  // 次に読み出す位置
+        volatile std::size_t tail;  // 次に書き込む位置
+
+        //! @brief 末尾に1バイト追加 (いっぱいのときは一番古いデータを捨てる)
+        void push(uint8_t byte);
+    };
+
+    static inline InputBuffer uart0_buffer;
+    static inline InputBuffer uart1_buffer;
+
 public:
-    static inline std::deque<uint8_t> uart0_queue{0};
-    static inline std::deque<uint8_t> uart1_queue{0};
     static void uart0_handler();
     static void uart1_handler();
 };
@@ -14,6 +14,8 @@
 // #include "sc_basic.hpp"
 
 #include <cmath>
+#include <cstddef>  // size_tなど
+#include <string>  // stodなど
 
 
 namespace sc
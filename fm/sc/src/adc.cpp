@@ -9,6 +9,15 @@
 
 #include "adc.hpp"
 
+#include <algorithm>
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "log.hpp"
+#include "trace.hpp"
+
 namespace sc
 {
 
@@ -66,8 +75,25 @@ uint16_t ADC::read() const
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    ::adc_select_input(_channel);
-    return ::adc_read();
+    return ADC::read_channel(_channel);
+}
+
+uint16_t ADC::read_channel(uint8_t channel)
+{
+    #ifndef NODEBUG
+    std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    uint16_t code;
+    if (AdcSampler::Instance != nullptr)
+    {
+        code = AdcSampler::Instance->latest(channel);  // 連続測定中は最新の平均値
+    } else {
+        ::adc_select_input(channel);
+        code = ::adc_read();
+    }
+    const uint8_t code_bytes[2] = {static_cast<uint8_t>(code), static_cast<uint8_t>(code >> 8)};
+    TraceRecorder::record(TraceType::ADC, channel, 0, code_bytes, sizeof(code_bytes));  // 測定値を記録
+    return code;
 }
 
 
@@ -107,9 +133,8 @@ dimension::degC PicoTemp::read()
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    ::adc_select_input(4);
-    double read_temp = 27 - ((::adc_read() * 3.3 / (1<<12)) - 0.706)/0.001721;
-    print("pico_temp_data:%f\n", read_temp);
+    double read_temp = 27 - ((ADC::read_channel(4) * 3.3 / (1<<12)) - 0.706)/0.001721;
+    print(LogLevel::Data, LogModule::ADC, "pico_temp_data:%f\n", read_temp);
     return dimension::degC(read_temp);
 }
 
@@ -150,11 +175,171 @@ dimension::V VsysVoltage::read()
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    ::adc_select_input(3);
-    double voltage = 3 * ::adc_read() * 3.3 / (1 << 12);
-    print("vsys_voltage_data:%f\n", voltage);
+    double voltage = 3 * ADC::read_channel(3) * 3.3 / (1 << 12);
+    if (series)
+    {
+        series->add(::to_ms_since_boot(::get_absolute_time()), {float(voltage)});  // pico-SDKの関数 起動してからの時間(ms)
+    } else {
+        print(LogLevel::Data, LogModule::ADC, "vsys_voltage_data:%f\n", voltage);
+    }
     return dimension::V(voltage);
 }
 
 
+/***** class AdcSampler *****/
+
+AdcSampler::AdcSampler(Frequency<Unit::Hz> sample_rate, std::size_t oversample) try :
+    _oversample(oversample)
+{
+    #ifndef NODEBUG
+    std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    try
+    {
+        if (AdcSampler::Instance != nullptr)
+        {
+    throw std::logic_error(f_err(__FILE__, __LINE__, "AdcSampler cannot be initialized twice"));  // AdcSamplerを2つ作ることはできません
+        } else if (double(sample_rate) <= 0 || oversample == 0) {
+    throw std::invalid_argument(f_err(__FILE__, __LINE__, "The sampling rate and the number of samples to average must be positive"));  // 周波数と平均する個数は正の値にしてください
+        }
+
+        // 使用中のチャンネルを，番号の小さい順に測定する (ラウンドロビンの順番)
+        uint32_t round_robin_mask = 0;
+        for (uint8_t channel = 0; channel < 5; ++channel)
+        {
+            _position[channel] = NotUsed;
+            if (ADC::IsUse[channel])
+            {
+                _position[channel] = static_cast<uint8_t>(_channel_num);
+                _order[_channel_num] = channel;
+                ++_channel_num;
+                round_robin_mask |= (1u << channel);
+            }
+        }
+        if (_channel_num == 0)
+        {
+    throw std::logic_error(f_err(__FILE__, __LINE__, "There is no ADC channel to sample"));  // 測定するADCのチャンネルがありません
+        }
+
+        // DMAの転送回数は，リングバッファの長さとチャンネルの数の倍数にして，転送をやり直しても位置と順番がずれないようにする
+        const uint32_t unit = static_cast<uint32_t>(RingSize * _channel_num);
+        _total_count = (UINT32_MAX / unit) * unit;
+
+        ::adc_select_input(_order[0]);  // pico-SDKの関数  最初に測定するチャンネル
+        ::adc_set_round_robin(round_robin_mask);  // pico-SDKの関数  使用中のチャンネルを順番に測定する
+        ::adc_fifo_setup(true, true, 1, false, false);  // pico-SDKの関数  測定値をFIFOに入れ，1個たまったらDMAに知らせる
+        // ADCは48MHzで，(1+div)サイクルごとに1回測定する (96サイクル未満なら最速の500kHz)
+        const double clock_div = 48000000.0 / (double(sample_rate) * _channel_num) - 1.0;
+        ::adc_set_clkdiv(static_cast<float>(std::max(clock_div, 0.0)));  // pico-SDKの関数
+
+        _dma_channel = ::dma_claim_unused_channel(true);  // pico-SDKの関数  空いているDMAのチャンネルを使う
+        ::dma_channel_config config = ::dma_channel_get_default_config(_dma_channel);
+        ::channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        ::channel_config_set_read_increment(&config, false);  // 読むのは常にADCのFIFO
+        ::channel_config_set_write_increment(&config, true);
+        ::channel_config_set_ring(&config, true, 9);  // 書き込み先を 2^9 = 512バイト(RingSize個)で折り返す
+        ::channel_config_set_dreq(&config, DREQ_ADC);  // ADCの測定に合わせて転送する
+        ::dma_channel_configure(_dma_channel, &config, Ring.data(), &adc_hw->fifo, _total_count, true);  // pico-SDKの関数  DMAを開始
+
+        AdcSampler::Instance = this;
+        ::dma_channel_set_irq0_enabled(_dma_channel, true);  // pico-SDKの関数  転送が終わったら割り込みを発生させる
+        ::irq_add_shared_handler(DMA_IRQ_0, dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);  // pico-SDKの関数  割り込み処理で実行する関数を追加
+        ::irq_set_enabled(DMA_IRQ_0, true);  // pico-SDKの関数  割り込み処理を有効にする
+        ::adc_run(true);  // pico-SDKの関数  連続測定を開始
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+uint16_t AdcSampler::latest(uint8_t channel) const
+{
+    #ifndef NODEBUG
+    std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    return average(channel, _oversample);
+}
+
+uint16_t AdcSampler::average(uint8_t channel, std::size_t count) const
+{
+    #ifndef NODEBUG
+    std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (5 <= channel || _position[channel] == NotUsed)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "ADC %hhu is not sampled", channel));  // このチャンネルは測定していません
+    }
+    const uint64_t position = _position[channel];
+
+    // まだ1回も測定していなければ，測定されるまで待つ
+    uint64_t done = sample_count();
+    while (done <= position)
+    {
+        ::tight_loop_contents();  // pico-SDKの関数  何もしない
+        done = sample_count();
+    }
+
+    // このチャンネルの最新の測定値の番号から，_channel_num個ずつさかのぼって平均する
+    // (DMAに上書きされないように，リングバッファの1周分より少し手前まで)
+    const uint64_t newest = done - 1 - ((done - 1 - position) % _channel_num);
+    const std::size_t available = static_cast<std::size_t>((newest - position) / _channel_num) + 1;
+    count = std::min({count, available, RingSize / _channel_num - 1});
+    if (count == 0)
+    {
+        count = 1;
+    }
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sum += Ring[(newest - i * _channel_num) % RingSize] & 0x0FFF;  // 下位12bitが測定値
+    }
+    return static_cast<uint16_t>(sum / count);
+}
+
+uint64_t AdcSampler::sample_count() const
+{
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする (_baseと残り回数を同時に読む)
+    const uint64_t count = _base + (_total_count - ::dma_channel_hw_addr(_dma_channel)->transfer_count);  // pico-SDKの関数  DMAの残りの転送回数
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return count;
+}
+
+AdcSampler::~AdcSampler()
+{
+    #ifndef NODEBUG
+    std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save)
+    {
+        ::adc_run(false);  // pico-SDKの関数  連続測定を止める
+        ::dma_channel_set_irq0_enabled(_dma_channel, false);
+        ::dma_channel_abort(_dma_channel);
+        ::irq_remove_handler(DMA_IRQ_0, dma_handler);
+        ::dma_channel_unclaim(_dma_channel);
+        ::adc_fifo_setup(false, false, 0, false, false);
+        ::adc_fifo_drain();
+        ::adc_set_round_robin(0);
+        AdcSampler::Instance = nullptr;  // これ以降のread()は，その場で測定する
+    }
+}
+
+void SC_ISR_FUNC(AdcSampler::dma_handler)()
+{
+    AdcSampler* sampler = AdcSampler::Instance;
+    if (sampler == nullptr || !::dma_channel_get_irq0_status(sampler->_dma_channel))
+        return;  // 他のDMAのチャンネルの割り込み
+    ::dma_channel_acknowledge_irq0(sampler->_dma_channel);
+    sampler->_base = sampler->_base + sampler->_total_count;
+    ::dma_channel_set_trans_count(sampler->_dma_channel, sampler->_total_count, true);  // 書き込み先はリングバッファの続きから
+}
+
+
 }
\ No newline at end of file
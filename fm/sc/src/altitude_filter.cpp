@@ -0,0 +1,104 @@
+/**************************************************
+ * 高度の推定に関するコードです
+ * このファイルは，altitude_filter.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，気圧高度と鉛直加速度を融合するカルマンフィルタが定義されています．
+**************************************************/
+
+//! @file altitude_filter.cpp
+//! @brief 気圧高度と鉛直加速度から高度・鉛直速度を推定
+
+#include "altitude_filter.hpp"
+
+#include "sc_basic.hpp"  // SC_HOT_FUNC
+
+#include <cmath>
+
+namespace sc
+{
+
+AltitudeFilter::AltitudeFilter(float accel_noise, float altitude_noise):
+    _accel_var(accel_noise * accel_noise),
+    _altitude_var(altitude_noise * altitude_noise)
+{
+}
+
+void AltitudeFilter::reset(Altitude<Unit::m> altitude)
+{
+    _altitude = static_cast<float>(double(altitude));
+    _speed = 0.0F;
+    _p00 = _altitude_var;  // 高度の不確かさは観測ノイズ程度
+    _p01 = 0.0F;
+    _p11 = 1.0F;  // 鉛直速度の不確かさは1m/s程度
+    _max_altitude = _altitude;
+    _still_time = 0.0F;
+    _initialized = true;
+}
+
+void SC_HOT_FUNC(AltitudeFilter::predict)(dimension::m_s2 vertical_acceleration, Time<Unit::s> dt)
+{
+    if (!_initialized)
+        return;  // 最初の気圧高度が得られるまでは予測しない
+
+    float t = static_cast<float>(double(dt));
+    if (!(t > 0.0F))
+        return;
+    if (t > MaxDt)
+        t = MaxDt;  // 長時間読めなかったときに加速度を積分しすぎないようにする
+
+    const float a = static_cast<float>(double(vertical_acceleration));
+
+    // 状態の予測  x = F x + B a
+    _altitude += (_speed + 0.5F * a * t) * t;
+    _speed += a * t;
+
+    // 共分散の予測  P = F P Fᵀ + Q  (Qは加速度の白色雑音による離散化したプロセスノイズ)
+    const float t2 = t * t;
+    const float p01 = _p01 + t * _p11;
+    _p00 += t * (_p01 + p01) + _accel_var * 0.25F * t2 * t2;
+    _p01 = p01 + _accel_var * 0.5F * t2 * t;
+    _p11 += _accel_var * t2;
+
+    if (_altitude > _max_altitude)
+        _max_altitude = _altitude;
+    _still_time = (std::fabs(_speed) < StillSpeed) ? _still_time + t : 0.0F;
+}
+
+void SC_HOT_FUNC(AltitudeFilter::update)(Altitude<Unit::m> altitude)
+{
+    if (!_initialized)
+    {
+        reset(altitude);
+        return;
+    }
+
+    const float innovation = static_cast<float>(double(altitude)) - _altitude;  // 観測値と予測値の差
+    const float s = _p00 + _altitude_var;
+    const float k0 = _p00 / s;  // カルマンゲイン(高度)
+    const float k1 = _p01 / s;  // カルマンゲイン(鉛直速度)
+
+    _altitude += k0 * innovation;
+    _speed += k1 * innovation;
+
+    // P = (I - K H) P
+    _p11 -= k1 * _p01;
+    _p00 -= k0 * _p00;
+    _p01 -= k0 * _p01;
+
+    if (_altitude > _max_altitude)
+        _max_altitude = _altitude;
+}
+
+dimension::m_s2 AltitudeFilter::vertical_acceleration(const Acceleration<Unit::m_s2>& line_acce, const Acceleration<Unit::m_s2>& gravity)
+{
+    const float gx = static_cast<float>(double(gravity.x()));
+    const float gy = static_cast<float>(double(gravity.y()));
+    const float gz = static_cast<float>(double(gravity.z()));
+    const float g = std::sqrt(gx*gx + gy*gy + gz*gz);
+    if (g < 1.0F)
+        return dimension::m_s2(0.0);  // 重力の向きが分からないときは加速度を使わない
+    const float dot = static_cast<float>(double(line_acce.x()))*gx + static_cast<float>(double(line_acce.y()))*gy + static_cast<float>(double(line_acce.z()))*gz;
+    return dimension::m_s2(dot / g);
+}
+
+}
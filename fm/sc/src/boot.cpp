@@ -0,0 +1,50 @@
+/**************************************************
+ * 起動にかかる時間を段階ごとに記録するためのコードです
+ * このファイルは，boot.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，起動の段階ごとの時刻の記録と表示が定義されています．
+**************************************************/
+
+//! @file boot.cpp
+//! @brief 起動の段階ごとの時間
+
+#include "boot.hpp"
+
+namespace sc
+{
+
+/***** class BootTimeline *****/
+
+void BootTimeline::mark(const char* stage)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (Count >= Stages.size())
+        return;
+    Stages[Count] = Stage{stage, ::time_us_64()};  // pico-SDKの関数  起動からの時間(μs)を取得
+    ++Count;
+}
+
+void BootTimeline::print()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    uint64_t begin_us = 0;  // 段階が始まった時刻 (最初の段階は電源を入れた時刻)
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        sc::print("boot:%-16s %8.1f ms (at %8.1f ms)\n", Stages[i].name, (Stages[i].end_us - begin_us) / 1000.0, Stages[i].end_us / 1000.0);
+        begin_us = Stages[i].end_us;
+    }
+}
+
+uint64_t BootTimeline::total_us()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    return (Count == 0) ? 0 : Stages[Count - 1].end_us;
+}
+
+}
@@ -0,0 +1,250 @@
+/**************************************************
+ * リセットされてもミッションを途中から続けるためのコードです
+ * このファイルは，checkpoint.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，ミッションの状態の保存と読み出し，ウォッチドッグの設定が定義されています．
+**************************************************/
+
+//! @file checkpoint.cpp
+//! @brief リセット後にミッションを途中から再開する
+
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace sc
+{
+
+namespace
+{
+
+// 起動時に0で埋められないRAM (pico-SDKのリンカスクリプトの.uninitialized_dataに置く)
+// Checkpoint::Recordをそのままコピーして置く
+alignas(8) uint8_t __uninitialized_ram(RamImage)[64];
+
+constexpr uint32_t MaxWatchdog_ms = 0x7fffff / 1000;  // pico-SDKのwatchdog_enableに指定できる最大の時間 (ms)
+
+}
+
+/***** class Checkpoint *****/
+
+Checkpoint::Checkpoint(uint32_t watchdog_ms, uint32_t flash_interval_ms) try :
+    _watchdog_ms(std::min(watchdog_ms, MaxWatchdog_ms)), _flash_interval_ms(flash_interval_ms)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    try
+    {
+        static_assert(sizeof(Record) <= sizeof(RamImage));
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        sc::print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    sc::print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+std::optional<MissionState> Checkpoint::restore()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    _source = Source::None;
+
+    // 1. RAM (すべての状態が残っている)
+    Record record;
+    std::memcpy(&record, RamImage, sizeof(Record));
+    if (valid(record))
+    {
+        _source = Source::Ram;
+        _sequence = record.sequence + 1;
+        return record.state;
+    }
+
+    // 2. スクラッチレジスタ (フェーズ，経過時間，基準気圧と気温)
+    const uint32_t s0 = watchdog_hw->scratch[0];
+    const uint32_t s1 = watchdog_hw->scratch[1];
+    const uint32_t s2 = watchdog_hw->scratch[2];
+    if ((s0 >> 24) == ScratchMagic && watchdog_hw->scratch[3] == scratch_check(s0, s1, s2))
+    {
+        MissionState state;
+        state.phase = static_cast<uint8_t>(s0 >> 16);
+        state.origin_temperature = static_cast<int16_t>(s0 & 0xFFFF) / 100.0F;
+        state.elapsed_ms = s1;
+        std::memcpy(&state.origin_pressure, &s2, sizeof(float));
+        _source = Source::Scratch;
+        return state;
+    }
+
+    // 3. フラッシュメモリ (RAMとスクラッチレジスタが壊れていたとき)
+    std::memcpy(&record, reinterpret_cast<const void*>(XIP_BASE + FlashOffset), sizeof(Record));
+    if (!valid(record) || record.state.phase == 0)
+        return std::nullopt;
+    if (reset_reason() == ResetReason::PowerOn)
+    {
+        // 電源を入れたときは，前回の飛行で最後に保存した状態が残っているだけかもしれないので，使わずに消す
+        sc::print("Checkpoint: discarded the phase %d saved in flash at power-on\n", int(record.state.phase));  // 電源を入れたので，フラッシュメモリに保存したフェーズを消しました
+        erase_flash();
+        return std::nullopt;
+    }
+    _source = Source::Flash;
+    _sequence = record.sequence + 1;
+    return record.state;
+}
+
+bool Checkpoint::watchdog_reboot() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    return ::watchdog_enable_caused_reboot();  // pico-SDKの関数  ウォッチドッグのタイムアウトでリセットされたか
+}
+
+Checkpoint::ResetReason Checkpoint::reset_reason()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    // ウォッチドッグによるリセットではCHIP_RESETは変わらないので，先にウォッチドッグの理由を見る
+    if (::watchdog_caused_reboot())  // pico-SDKの関数  ウォッチドッグでリセットされたか
+        return ResetReason::Watchdog;
+    if (vreg_and_chip_reset_hw->chip_reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS)
+        return ResetReason::RunPin;
+    return ResetReason::PowerOn;
+}
+
+void Checkpoint::store(const MissionState& state)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    Record record;
+    std::memset(static_cast<void*>(&record), 0, sizeof(Record));  // すき間のバイトも決まった値にしてからCRCを計算する
+    record.magic = Magic;
+    record.sequence = _sequence++;
+    record.state = state;
+    record.crc = crc32(&record, offsetof(Record, crc));
+    std::memcpy(RamImage, &record, sizeof(Record));
+
+    // スクラッチレジスタ4~7はpico-SDKのwatchdog_rebootが使うので，0~3だけを使う
+    const uint32_t temperature = static_cast<uint16_t>(static_cast<int16_t>(std::clamp(state.origin_temperature * 100.0F, -32768.0F, 32767.0F)));
+    const uint32_t s0 = (ScratchMagic << 24) | (uint32_t(state.phase) << 16) | temperature;
+    uint32_t s2;
+    std::memcpy(&s2, &state.origin_pressure, sizeof(float));
+    watchdog_hw->scratch[0] = s0;
+    watchdog_hw->scratch[1] = state.elapsed_ms;
+    watchdog_hw->scratch[2] = s2;
+    watchdog_hw->scratch[3] = scratch_check(s0, state.elapsed_ms, s2);
+
+    // フラッシュメモリは書き換えられる回数に限りがあり，消去の間は割り込みが止まるので，ときどきだけ保存する
+    // 待機フェーズでは最初の1回だけ保存する (前回の飛行の状態を上書きするため)
+    const bool phase_changed = (!_flash_phase || *_flash_phase != state.phase);
+    const bool interval = (state.phase != 0 && state.elapsed_ms - _flash_elapsed_ms >= _flash_interval_ms);
+    if (phase_changed || interval)
+    {
+        store_flash(record);
+        _flash_phase = state.phase;
+        _flash_elapsed_ms = state.elapsed_ms;
+    }
+}
+
+void Checkpoint::start_watchdog()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    ::watchdog_enable(_watchdog_ms, true);  // pico-SDKの関数  ウォッチドッグを動かす (デバッガで止めている間は止まる)
+}
+
+void Checkpoint::pause_watchdog()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    ::hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);  // pico-SDKの関数  ウォッチドッグのタイマーを止める
+}
+
+void Checkpoint::feed()
+{
+    ::watchdog_update();  // pico-SDKの関数  ウォッチドッグのタイマーを戻す
+}
+
+void Checkpoint::clear()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    std::memset(RamImage, 0, sizeof(RamImage));
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        watchdog_hw->scratch[i] = 0;
+    }
+    erase_flash();
+    _flash_phase.reset();
+    _flash_elapsed_ms = 0;
+    _sequence = 0;
+}
+
+uint32_t Checkpoint::crc32(const void* data, std::size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFF;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+bool Checkpoint::valid(const Record& record)
+{
+    return record.magic == Magic && record.crc == crc32(&record, offsetof(Record, crc));
+}
+
+uint32_t Checkpoint::scratch_check(uint32_t s0, uint32_t s1, uint32_t s2)
+{
+    const std::array<uint32_t, 3> words{s0, s1, s2};
+    return crc32(words.data(), sizeof(words));
+}
+
+void Checkpoint::store_flash(const Record& record)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    std::array<uint8_t, FLASH_PAGE_SIZE> page;
+    page.fill(0xFF);
+    std::memcpy(page.data(), &record, sizeof(Record));
+    // 割り込み無効にする
+    uint32_t ints = save_and_disable_interrupts();
+    //  消去単位はflash.hで定義されている FLASH_SECTOR_SIZE(4096Byte) の倍数とする
+    flash_range_erase(FlashOffset, FLASH_SECTOR_SIZE);
+    //  書込単位はflash.hで定義されている FLASH_PAGE_SIZE(256Byte) の倍数とする
+    flash_range_program(FlashOffset, page.data(), page.size());
+    // 割り込みフラグを戻す
+    restore_interrupts(ints);
+}
+
+void Checkpoint::erase_flash()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    uint32_t ints = save_and_disable_interrupts();  // 割り込み無効にする
+    flash_range_erase(FlashOffset, FLASH_SECTOR_SIZE);
+    restore_interrupts(ints);  // 割り込みフラグを戻す
+}
+
+}
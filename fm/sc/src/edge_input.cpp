@@ -0,0 +1,220 @@
+/**************************************************
+ * GPIOピンの変化を割り込みで記録するためのコードです
+ * このファイルは，edge_input.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，ピンの立ち上がり・立ち下がりを割り込みで検知し，
+ * チャタリングを取り除いてから時刻付きで記録するクラスが定義されています．
+**************************************************/
+
+//! @file edge_input.cpp
+//! @brief GPIOピンの変化の割り込みによる記録
+
+#include "edge_input.hpp"
+
+#include "hardware/sync.h"
+
+#include "trace.hpp"
+
+namespace sc
+{
+
+/***** class EdgeInput *****/
+
+EdgeInput::EdgeInput(Pin pin, Pull pull, Time<Unit::s> debounce) try :
+    _gpio(pin, pull), _debounce_us(static_cast<uint64_t>(double(debounce) * (1/micro)))
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    try
+    {
+        if (_gpio.save == false)
+        {
+throw std::logic_error(f_err(__FILE__, __LINE__, "Failed to set up pin %hhu", pin.gpio()));  // ピンのセットアップに失敗しました
+        } else if (double(debounce) < 0) {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The debounce time must be 0 or more"));  // チャタリングとみなす時間は0以上にしてください
+        }
+        _stable_level = ::gpio_get(pin.gpio());  // pico-SDKの関数  ピンがHighになっているかLowになっているかを取得する
+        _candidate_level = _stable_level;
+        Instances.at(pin.gpio()) = this;
+        ::gpio_set_irq_enabled_with_callback(pin.gpio(), GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, &EdgeInput::gpio_callback);  // pico-SDKの関数  立ち上がりと立ち下がりで割り込みを発生させる
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+bool EdgeInput::read() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const_cast<EdgeInput*>(this)->settle(::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+    const bool level = _stable_level;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return level;
+}
+
+std::optional<EdgeInput::Edge> EdgeInput::next_edge()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    settle(::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+    if (_count == 0)
+    {
+        ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+        return std::nullopt;
+    }
+    const Edge edge = _queue[_head];
+    _head = (_head + 1) % QueueSize;
+    _count = _count - 1;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return edge;
+}
+
+Result<EdgeInput::Edge> EdgeInput::wait_for_edge(Time<Unit::s> timeout, Trigger trigger)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint64_t deadline_us = ::time_us_64() + static_cast<uint64_t>(double(timeout) * (1/micro));  // pico-SDKの関数  起動からの時間(μs)を取得
+    while (true)
+    {
+        while (const std::optional<Edge> edge = next_edge())
+        {
+            if (trigger == Trigger::Both || edge->level == (trigger == Trigger::Rise))
+            {
+                return *edge;
+            }
+        }
+        if (::time_us_64() > deadline_us)  // pico-SDKの関数  起動からの時間(μs)を取得
+        {
+return Error(ErrorSource::GPIO, ErrorCode::Timeout, __FILE__, __LINE__);  // 時間内にピンが変化しませんでした
+        }
+        ::tight_loop_contents();  // pico-SDKの関数  何もしない
+    }
+}
+
+std::optional<EdgeInput::Edge> EdgeInput::last_edge() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const_cast<EdgeInput*>(this)->settle(::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+    const std::optional<Edge> edge = _has_edge ? std::optional<Edge>(_last_edge) : std::nullopt;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return edge;
+}
+
+std::size_t EdgeInput::available() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const_cast<EdgeInput*>(this)->settle(::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+    const std::size_t count = _count;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return count;
+}
+
+void EdgeInput::clear()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    settle(::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+    _head = 0;
+    _count = 0;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+EdgeInput::~EdgeInput()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save)
+    {
+        ::gpio_set_irq_enabled(_gpio.gpio(), GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);  // pico-SDKの関数  割り込みを無効にする
+        Instances.at(_gpio.gpio()) = nullptr;
+    }
+}
+
+void SC_ISR_FUNC(EdgeInput::settle)(uint64_t now_us)
+{
+    if (_pending == false || now_us - _last_us < _debounce_us)
+        return;  // まだ変化していないか，チャタリングの途中
+    _pending = false;
+    if (_candidate_level == _stable_level)
+        return;  // 元の状態に戻った (ノイズ)
+    _stable_level = _candidate_level;
+
+    const Edge edge{_candidate_level, _first_us};
+    if (_count == QueueSize)
+    {
+        // いっぱいのときは一番古いものを捨てる
+        _head = (_head + 1) % QueueSize;
+        _count = _count - 1;
+        _overflow = _overflow + 1;
+    }
+    _queue[(_head + _count) % QueueSize] = edge;
+    _count = _count + 1;
+    _last_edge = edge;
+    _has_edge = true;
+    const uint8_t level = edge.level;
+    TraceRecorder::record(TraceType::GPIO, _gpio.gpio(), 0, &level, 1, edge.time_us);  // 変化を記録
+}
+
+void SC_ISR_FUNC(EdgeInput::on_edge)(bool level, uint64_t now_us)
+{
+    settle(now_us);  // 前の変化がもう落ち着いていれば，先に確定させる
+    if (_pending == false)
+    {
+        _pending = true;
+        _first_us = now_us;
+    }
+    _candidate_level = level;
+    _last_us = now_us;
+    settle(now_us);  // debounceが0のときはすぐに確定する
+}
+
+void SC_ISR_FUNC(EdgeInput::gpio_callback)(uint gpio, uint32_t events)
+{
+    const uint64_t now_us = isr_time_us();  // 起動からの時間(μs)を取得 (time_us_64はフラッシュにある)
+    if (gpio >= Instances.size() || Instances[gpio] == nullptr)
+        return;
+    bool level;
+    if ((events & GPIO_IRQ_EDGE_RISE) && (events & GPIO_IRQ_EDGE_FALL))
+    {
+        level = ::gpio_get(gpio);  // 両方起きていたら今の状態を使う
+    } else {
+        level = (events & GPIO_IRQ_EDGE_RISE);
+    }
+    Instances[gpio]->on_edge(level, now_us);
+}
+
+}
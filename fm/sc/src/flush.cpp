@@ -9,9 +9,20 @@
 
 #include "flush.hpp"
 
+#include <algorithm>
+#include <memory>
+
 namespace sc
 {
 
+namespace
+{
+
+// 圧縮のためのRAM(約8KB)はスタックに置けないので，ここに置く (Flushは1つしか作らない)
+LzssEncoder Encoder;
+
+}
+
 Flush::Flush() try
 {
     #ifndef NODEBUG
@@ -19,6 +30,12 @@ Flush::Flush() try
     #endif
     try
     {
+        // 圧縮したブロックを，そのまま1ページとして書き込む
+        Encoder.set_sink([this](const uint8_t* block)
+        {
+            std::copy(block, block + LzssBlockSize, _write_data.begin());
+            program_page();
+        });
     }
     catch(const std::exception& e)
     {
@@ -35,61 +52,98 @@ void Flush::clear()
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    // 割り込み無効にする
-    uint32_t ints = save_and_disable_interrupts();
-    // Flash消去。
-    //  消去単位はflash.hで定義されている FLASH_SECTOR_SIZE(4096Byte) の倍数とする
-    flash_range_erase(_target_begin, _block_size * _block_num);
-    // 割り込みフラグを戻す
-    restore_interrupts(ints);
+    // ここでは消去せず，program_pageで書き込む直前に消去する
+    _target_offset = _target_begin;
+    _erased_end = _target_begin;
+    _write_data.fill(0);
+}
 
+void Flush::resume()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    // 書き込んだページの先頭はLzssBlockStartかLzssBlockContinueなので，先頭が0xFFのページを探す
     _target_offset = _target_begin;
+    while (_target_offset < _target_end && *(const uint8_t *) (XIP_BASE + _target_offset) != 0xFF)
+    {
+        _target_offset += FLASH_PAGE_SIZE;
+    }
+    if (_target_offset > _target_end)
+    {
+        _target_offset = _target_begin;  // 最後まで書き込まれていたら先頭から上書きする
+    }
+    // 書き込み位置のセクタは消去済み (その次のセクタはprogram_pageで消去する)
+    _erased_end = _target_offset - (_target_offset - _target_begin) % FLASH_SECTOR_SIZE + FLASH_SECTOR_SIZE;
     _write_data.fill(0);
 }
 
-void Flush::write(const Binary& write_binary)
+void Flush::program_page()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    static std::size_t _write_index = 0;
+    // 書き込むセクタとその次のセクタを消去済みにする (次のセクタが消えていれば，前回のログの続きと区別できる)
+    //  消去単位はflash.hで定義されている FLASH_SECTOR_SIZE(4096Byte) の倍数とする
+    const uint32_t sector = _target_offset - (_target_offset - _target_begin) % FLASH_SECTOR_SIZE;
+    const uint32_t erase_end = std::min<uint32_t>(sector + 2 * FLASH_SECTOR_SIZE, _target_end + 1);
+    while (_erased_end < erase_end)
+    {
+        // 割り込み無効にする
+        uint32_t ints = save_and_disable_interrupts();
+        flash_range_erase(_erased_end, FLASH_SECTOR_SIZE);
+        // 割り込みフラグを戻す
+        restore_interrupts(ints);
+        _erased_end += FLASH_SECTOR_SIZE;
+    }
 
-    const uint8_t* ptr = write_binary;
-    std::size_t write_size = write_binary.size();
-    for (std::size_t i=0; i<write_size; ++i)
+    // 割り込み無効にする
+    uint32_t ints = save_and_disable_interrupts();
+    // Flash書き込み。
+    //  書込単位はflash.hで定義されている FLASH_PAGE_SIZE(256Byte) の倍数とする
+    flash_range_program(_target_offset, _write_data.data(), _write_data.size());
+    // 割り込みフラグを戻す
+    restore_interrupts(ints);
+    ++_programmed_pages;
+    _target_offset += _write_data.size();
+    if (_target_offset > _target_end)
     {
-        if (_write_index < _write_data.size())
-        {
-            _write_data.at(_write_index) = *(ptr + i);
-        } else {
-            // 割り込み無効にする
-            uint32_t ints = save_and_disable_interrupts();
-            // Flash書き込み。
-            //  書込単位はflash.hで定義されている FLASH_PAGE_SIZE(256Byte) の倍数とする
-            flash_range_program(_target_offset, _write_data.data(), _write_data.size());
-            // 割り込みフラグを戻す
-            restore_interrupts(ints);
-            _target_offset += _write_data.size();
-            if (_target_offset > _target_end)
-            {
-                _target_offset = _target_begin;
-            }
-
-            _write_data.fill(0U);
-            _write_data.at(0) = *(ptr + 0);
-            _write_index = 0;
-        }
-        ++_write_index;
+        // 先頭に戻ったら，古いデータを上書きしながらもう一度消去していく
+        _target_offset = _target_begin;
+        _erased_end = _target_begin;
     }
 }
 
+void Flush::write(const Binary& write_binary)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    const uint8_t* ptr = write_binary;
+    Encoder.write(ptr, write_binary.size());  // 1ページ分たまるたびにprogram_pageが呼ばれる
+}
+
+void Flush::sync()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    Encoder.finish();
+}
+
+uint64_t Flush::input_bytes() const
+{
+    return Encoder.input_bytes();
+}
+
 Flush::~Flush()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     this->write(std::string("\nlog end ") + __DATE__ + __TIME__);
-    flash_range_program(_target_offset, _write_data.data(), _write_data.size());
+    Encoder.finish();
+    Encoder.set_sink(nullptr);
 }
 
 void Flush::print()
@@ -98,9 +152,25 @@ void Flush::print()
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     std::cout << "\n#################### Log Data ####################" << std::endl;
-    for (uint32_t i=_target_begin; i<_target_end; ++i)
+    // 書き込み位置の先は消去されているので，消去されたページの後ろが一番古い (一周していなければ先頭)
+    constexpr uint32_t page_num = (_target_end + 1 - _target_begin) / FLASH_PAGE_SIZE;
+    const auto page = [](uint32_t index) {return (const uint8_t *) (XIP_BASE + _target_begin + (index % page_num) * FLASH_PAGE_SIZE);};
+    uint32_t oldest = 0;
+    while (oldest < page_num && page(oldest)[0] != 0xFF)
+    {
+        ++oldest;
+    }
+    while (oldest < page_num && page(oldest)[0] == 0xFF)
+    {
+        ++oldest;
+    }
+    const auto decoder = std::make_unique<LzssDecoder>();  // 展開のためのRAM(約2KB)はスタックに置かない
+    std::string text;
+    for (uint32_t i=0; i<page_num; ++i)
     {
-        std::cout << *(const uint8_t *) (XIP_BASE + i);
+        text.clear();
+        decoder->decode_block(page(oldest + i), text);  // 消去されたページと，始まりが上書きされたページは読み飛ばす
+        std::cout << text;
     }
     std::cout << std::endl;
     std::cout << "##################################################\n" << std::endl;
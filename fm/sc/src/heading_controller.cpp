@@ -0,0 +1,93 @@
+/**************************************************
+ * 機体の向きの制御に関するコードです
+ * このファイルは，heading_controller.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，左右のモーターの出力を連続的に決める方位制御(PID)が定義されています．
+**************************************************/
+
+//! @file heading_controller.cpp
+//! @brief 方位の誤差とジャイロから左右のモーターの出力を計算
+
+#include "heading_controller.hpp"
+
+#include "sc_basic.hpp"  // SC_HOT_FUNC
+
+#include <algorithm>
+#include <cmath>
+
+namespace sc
+{
+
+HeadingController::HeadingController(float kp, float ki, float kd, float max_turn, float slew_rate):
+    _kp(kp), _ki(ki), _kd(kd), _max_turn(max_turn), _slew_rate(slew_rate)
+{
+}
+
+void HeadingController::reset()
+{
+    _integral = 0.0F;
+    _left = 0.0F;
+    _right = 0.0F;
+}
+
+std::tuple<float, float> SC_HOT_FUNC(HeadingController::update)(dimension::rad heading_error, dimension::rad_s yaw_rate, Time<Unit::s> dt, float speed)
+{
+    float t = static_cast<float>(double(dt));
+    if (!(t > 0.0F))
+        t = 0.0F;
+    if (t > MaxDt)
+    {
+        _integral = 0.0F;  // 間隔が空きすぎたら，古い積分値は使わない
+        t = MaxDt;
+    }
+
+    const float error = wrap_angle(static_cast<float>(double(heading_error)));
+    const float rate = static_cast<float>(double(yaw_rate));
+
+    // 比例項と，誤差の微分の代わりに角速度を使ったダンピング項 (d(error)/dt = -yaw_rate)
+    const float p_and_d = _kp * error - _kd * rate;
+
+    // 積分項  出力が飽和している向きには積分しない (ワインドアップ防止)
+    const float next_integral = _integral + error * t;
+    const float unclamped = p_and_d + _ki * next_integral;
+    if (std::fabs(unclamped) < _max_turn || (unclamped > 0.0F) != (error > 0.0F))
+    {
+        _integral = next_integral;
+    }
+    if (_ki > 0.0F)
+    {
+        const float max_integral = _max_turn / _ki;
+        _integral = std::clamp(_integral, -max_integral, max_integral);
+    }
+
+    const float turn = std::clamp(p_and_d + _ki * _integral, -_max_turn, _max_turn);
+
+    // ゴールが横や後ろにあるときは前進を弱めてその場で回る
+    const float forward = speed * std::max(0.0F, std::cos(error));
+    float left = forward - turn;
+    float right = forward + turn;
+    const float larger = std::max(std::fabs(left), std::fabs(right));
+    if (larger > 1.0F)
+    {
+        left /= larger;
+        right /= larger;
+    }
+
+    // 出力の変化率を制限
+    const float step = _slew_rate * t;
+    _left += std::clamp(left - _left, -step, step);
+    _right += std::clamp(right - _right, -step, step);
+
+    return {_left, _right};
+}
+
+float HeadingController::wrap_angle(float angle)
+{
+    constexpr float Pi = static_cast<float>(PI);
+    angle = std::fmod(angle + Pi, 2.0F * Pi);
+    if (angle < 0.0F)
+        angle += 2.0F * Pi;
+    return angle - Pi;
+}
+
+}
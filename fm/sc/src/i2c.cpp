@@ -10,11 +10,33 @@
 
 #include "i2c.hpp"
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <vector>
 
+#include "hardware/sync.h"
+
+#include "trace.hpp"
+
 namespace sc
 {
 
+namespace
+{
+
+//! @brief pico-SDKの送受信の関数の戻り値を，通信の結果に変換
+I2C::Outcome to_outcome(int result)
+{
+    if (result == PICO_ERROR_TIMEOUT)
+return I2C::Outcome::Timeout;
+    if (result < 0)
+return I2C::Outcome::Nack;
+    return I2C::Outcome::Success;
+}
+
+}
+
 /***** class SDA *****/
 
 SDA::SDA(int sda_gpio) try :
@@ -123,7 +145,7 @@ I2C::MemoryAddr::operator uint8_t() const
 /***** class I2C *****/
 
 I2C::I2C(SDA sda, SCL scl):
-    I2C(sda, scl, 10000_hz)
+    I2C(sda, scl, 400000_hz)
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -131,7 +153,7 @@ I2C::I2C(SDA sda, SCL scl):
 }
 
 I2C::I2C(SDA sda, SCL scl, Frequency<Unit::Hz> freq) try :
-    _sda(sda), _scl(scl), _freq(freq), _i2c_id(sda.get_i2c_id())
+    _sda(sda), _scl(scl), _max_baudrate(static_cast<uint32_t>(double(freq))), _i2c_id(sda.get_i2c_id())
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -145,6 +167,8 @@ throw std::invalid_argument(f_err(__FILE__, __LINE__, "An incorrect I2C pin numb
 throw std::logic_error(f_err(__FILE__, __LINE__, "This pin is already in use"));  // このピンは既に使用されています
         } else if (I2C::IsUse[_i2c_id]) {
 throw std::logic_error(f_err(__FILE__, __LINE__, "I2C cannot be reinitialized"));  // I2Cを再度初期化することはできません
+        } else if (_max_baudrate == 0) {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The I2C frequency must be positive"));  // I2Cの通信速度は正の値にしてください
         }
 
         Pin::Status.at(_sda.gpio()) = PinStatus::I2cSda;
@@ -152,7 +176,14 @@ throw std::logic_error(f_err(__FILE__, __LINE__, "I2C cannot be reinitialized"))
 
         I2C::IsUse[_i2c_id] = true;
 
-        ::i2c_init((_i2c_id ? i2c1 : i2c0), static_cast<double>(_freq));  // pico-SDKの関数  I2Cを初期化する
+        // 最大の通信速度以下の，最も速い段階から始める
+        while (_speed_step + 1 < std::size(SpeedSteps) && _max_baudrate < SpeedSteps[_speed_step])
+        {
+            ++_speed_step;
+        }
+        _baudrate = std::min(SpeedSteps[_speed_step], _max_baudrate);
+        ::i2c_init((_i2c_id ? i2c1 : i2c0), _baudrate);  // pico-SDKの関数  I2Cを初期化する
+        _stats_start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
 
         ::gpio_set_function(_sda.gpio(), GPIO_FUNC_I2C);  // pico-SDKの関数  ピンの機能をI2Cモードにする
         ::gpio_pull_up(_sda.gpio());  // pico-SDKの関数  プルアップ抵抗を有効にする
@@ -170,16 +201,262 @@ catch (const std::exception& e)
     print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
 }
 
+void I2C::set_frequency(Frequency<Unit::Hz> freq)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (double(freq) < 1)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The I2C frequency must be positive"));  // I2Cの通信速度は正の値にしてください
+    }
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする (I2CAsyncの割り込みで記録が変わらないようにする)
+    _max_baudrate = static_cast<uint32_t>(double(freq));
+    _speed_step = 0;
+    while (_speed_step + 1 < std::size(SpeedSteps) && _max_baudrate < SpeedSteps[_speed_step])
+    {
+        ++_speed_step;
+    }
+    _window_transfers = 0;
+    _window_errors = 0;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    prepare();  // すぐに速度を変える
+}
+
+void I2C::clock_changed()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    _baudrate = 0;  // i2c_set_baudrateはclk_sysから分周比を決めるので，同じ速度でも設定し直す
+}
+
+Frequency<Unit::Hz> I2C::frequency() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    return Frequency<Unit::Hz>(_baudrate);
+}
+
+bool I2C::recover_bus() const
+{
+    const uint sda = _sda.gpio();
+    const uint scl = _scl.gpio();
+    // 一時的にピンをGPIOとして使う (Lowのときだけ出力にし，Highはプルアップ抵抗に任せる)
+    ::gpio_put(sda, false);  // pico-SDKの関数  出力する値をLowにしておく
+    ::gpio_put(scl, false);
+    ::gpio_set_dir(sda, GPIO_IN);  // pico-SDKの関数  入力にする (プルアップ抵抗でHigh)
+    ::gpio_set_dir(scl, GPIO_IN);
+    ::gpio_set_function(sda, GPIO_FUNC_SIO);  // pico-SDKの関数  ピンの機能をGPIOにする
+    ::gpio_set_function(scl, GPIO_FUNC_SIO);
+
+    // SDAが解放されるまで，最大9回SCLを動かす (デバイスに送信途中のバイトを送り切らせる)
+    for (int i = 0; i < 9 && !::gpio_get(sda); ++i)
+    {
+        ::gpio_set_dir(scl, GPIO_OUT);  // SCLをLow
+        ::busy_wait_us(5);
+        ::gpio_set_dir(scl, GPIO_IN);  // SCLをHigh
+        ::busy_wait_us(5);
+    }
+
+    // STOPを送る (SCLがHighの間に，SDAをLowからHighにする)
+    ::gpio_set_dir(sda, GPIO_OUT);
+    ::busy_wait_us(5);
+    ::gpio_set_dir(sda, GPIO_IN);
+    ::busy_wait_us(5);
+    const bool released = ::gpio_get(sda);  // pico-SDKの関数  ピンの状態を読む
+
+    ::gpio_set_function(sda, GPIO_FUNC_I2C);  // pico-SDKの関数  ピンの機能をI2Cモードに戻す
+    ::gpio_set_function(scl, GPIO_FUNC_I2C);
+    // 回数はprint_statsなどと共有しているので，書き換える間は割り込みを無効にする
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    ++_recoveries;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return released;
+}
+
+void SC_ISR_FUNC(I2C::record)(uint8_t slave_addr, std::size_t size, uint64_t start_us, Outcome outcome) const
+{
+    // 通常の通信とI2CAsyncの割り込みの両方から呼ばれるので，記録を書き換える間は割り込みを無効にする
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const uint64_t now = isr_time_us();  // 起動からの時間(μs)を取得 (time_us_64はフラッシュにある)
+    _busy_us += now - start_us;
+    _bytes += size;
+
+    // 通信先のデバイスごとの記録 (初めての通信先なら追加する．いっぱいのときは記録しない)
+    DeviceStats* device = nullptr;
+    for (std::size_t i = 0; i < _device_num; ++i)
+    {
+        if (_devices[i].slave_addr == slave_addr)
+        {
+            device = &_devices[i];
+            break;
+        }
+    }
+    if (device == nullptr && _device_num < MaxDevices)
+    {
+        device = &_devices[_device_num];
+        *device = DeviceStats{slave_addr, 0, 0, 0};
+        ++_device_num;
+    }
+    if (device != nullptr)
+    {
+        ++device->transfers;
+        if (outcome == Outcome::Nack)
+        {
+            ++device->nacks;
+        } else if (outcome == Outcome::Timeout) {
+            ++device->timeouts;
+        }
+    }
+
+    ++_window_transfers;
+    if (outcome != Outcome::Success)
+    {
+        ++_window_errors;
+        _last_error_us = now;
+        if (!::gpio_get(_sda.gpio()))  // 通信が終わったのにSDAがLowのままなら，デバイスが止まっている
+        {
+            _recovery_needed = true;
+        }
+    }
+
+    // 失敗が多ければ速度を1段階下げる
+    if (_window_errors >= ErrorThreshold || _window_transfers >= ErrorWindow)
+    {
+        if (_window_errors >= ErrorThreshold && _speed_step + 1 < std::size(SpeedSteps))
+        {
+            ++_speed_step;
+            ++_step_downs;
+        }
+        _window_transfers = 0;
+        _window_errors = 0;
+    }
+    // しばらく失敗しなければ速度を1段階上げる
+    if (_speed_step > 0 && _max_baudrate >= SpeedSteps[_speed_step - 1] && now - _last_error_us > QuietTime_us)
+    {
+        --_speed_step;
+        _last_error_us = now;  // 次に上げるのは，またしばらく失敗しなかったとき
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+bool SC_ISR_FUNC(I2C::prepare_needed)() const
+{
+    return _recovery_needed || std::min(SpeedSteps[_speed_step], _max_baudrate) != _baudrate;
+}
+
+void I2C::prepare() const
+{
+    // 割り込み(I2CAsync)で書き換えられる記録は，割り込みを無効にして読む
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const bool recovery_needed = _recovery_needed;
+    _recovery_needed = false;
+    const uint32_t baudrate = std::min(SpeedSteps[_speed_step], _max_baudrate);
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+
+    // バスの回復と速度の変更は時間がかかるので，割り込みは有効のまま行う
+    if (recovery_needed)
+    {
+        recover_bus();
+    }
+    if (baudrate != _baudrate)
+    {
+        ::i2c_set_baudrate((_i2c_id ? i2c1 : i2c0), baudrate);  // pico-SDKの関数  I2Cの通信速度を変える
+        _baudrate = baudrate;
+    }
+}
+
+I2C::DeviceStats I2C::device_stats(SlaveAddr slave_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    DeviceStats stats{slave_addr, 0, 0, 0};
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする (読んでいる途中で記録が変わらないようにする)
+    for (std::size_t i = 0; i < _device_num; ++i)
+    {
+        if (_devices[i].slave_addr == slave_addr)
+        {
+            stats = _devices[i];
+            break;
+        }
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    return stats;
+}
+
+double I2C::utilization() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする (64ビットの値は1回で読めないため)
+    const uint64_t busy_us = _busy_us;
+    const uint64_t elapsed_us = ::time_us_64() - _stats_start_us;  // pico-SDKの関数  起動からの時間(μs)を取得
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    if (elapsed_us == 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(busy_us) / static_cast<double>(elapsed_us);
+}
+
+void I2C::print_stats() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    // 出力には時間がかかるので，割り込みを無効にして記録を写してから出力する
+    const double used = utilization();
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    const uint64_t bytes = _bytes;
+    const uint32_t step_downs = _step_downs;
+    const uint32_t recoveries = _recoveries;
+    const std::array<DeviceStats, MaxDevices> devices = _devices;
+    const std::size_t device_num = _device_num;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    sc::print("i2c_stats:%d,%lu,%f,%llu,%lu,%lu\n", int(_i2c_id), static_cast<unsigned long>(_baudrate), used, static_cast<unsigned long long>(bytes), static_cast<unsigned long>(step_downs), static_cast<unsigned long>(recoveries));
+    for (std::size_t i = 0; i < device_num; ++i)
+    {
+        sc::print("i2c_device:%02x,%lu,%lu,%lu\n", devices[i].slave_addr, static_cast<unsigned long>(devices[i].transfers), static_cast<unsigned long>(devices[i].nacks), static_cast<unsigned long>(devices[i].timeouts));
+    }
+}
+
+void I2C::reset_stats() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    _busy_us = 0;
+    _bytes = 0;
+    _step_downs = 0;
+    _recoveries = 0;
+    _device_num = 0;
+    _stats_start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
 void I2C::write(Binary output_data, SlaveAddr slave_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    write(BinaryView(output_data), slave_addr);
+}
+
+void I2C::write(BinaryView output_data, SlaveAddr slave_addr) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    int output_size = 0;  // 実際には何バイト送信したか
-    ::i2c_write_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, output_data, output_data.size(), false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで送信
-    if (output_size < 0)
+    if (!try_write(output_data, slave_addr))
     {
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to transmit via I2C. SlaveAddr:%hhx", slave_addr));  // I2Cによる送信に失敗しました
     }
@@ -190,57 +467,167 @@ Binary I2C::read(std::size_t size, SlaveAddr slave_addr) const
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    if (save == false)
-        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
     std::vector<uint8_t> input_data(size);
+    input_data.resize(read(input_data.data(), size, slave_addr));
+    return Binary(input_data);
+}
 
-    int input_size = 0;  // 実際には何バイト受信したか
-    input_size = ::i2c_read_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, input_data.data(), size, false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで受信
-    if (input_size < 0)
+std::size_t I2C::read(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const Result<std::size_t> input_size = try_read(input_data, size, slave_addr);
+    if (!input_size)
     {
-        // input_size = 0;
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to receive via I2C. SlaveAddr:%hhx", slave_addr));  // I2Cによる受信に失敗しました
     }
-    input_data.resize(input_size);
-    return Binary(input_data);
+    return *input_size;
 }
 
 void I2C::write_memory(Binary output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    write_memory(BinaryView(output_data), slave_addr, memory_addr);
+}
+
+void I2C::write_memory(BinaryView output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    Binary corrected_data = memory_addr + output_data;
-    int output_size = 0;  // 実際には何バイト送信したか
-    output_size = ::i2c_write_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, corrected_data, corrected_data.size(), false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで送信
-    if (output_size < 0)
+    if (!try_write_memory(output_data, slave_addr, memory_addr))
     {
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to transmit via I2C. SlaveAddr:%hhx, MemoryAddr:%hhx", slave_addr, memory_addr));  // I2Cによる送信に失敗しました
     }
 }
 
 Binary I2C::read_memory(std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    std::vector<uint8_t> input_data(size);
+    input_data.resize(read_memory(input_data.data(), size, slave_addr, memory_addr));
+    return Binary(input_data);
+}
+
+std::size_t I2C::read_memory(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    std::vector<uint8_t> input_data(size);
+    const Result<std::size_t> input_size = try_read_memory(input_data, size, slave_addr, memory_addr);
+    if (!input_size)
+    {
+throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to receive via I2C. SlaveAddr:%hhx, MemoryAddr:%hhx", slave_addr, memory_addr));  // I2Cによる受信に失敗しました
+    }
+    return *input_size;
+}
+
+Result<void> I2C::try_write(BinaryView output_data, SlaveAddr slave_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+return Error(ErrorSource::I2C, ErrorCode::NotInitialized, __FILE__, __LINE__);
+    prepare();
+    const uint64_t start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    int output_size = 0;  // 実際には何バイト送信したか
+    output_size = ::i2c_write_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, output_data.data(), output_data.size(), false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで送信
+    record(slave_addr, std::max(output_size, 0), start_us, to_outcome(output_size));
+    if (output_size == PICO_ERROR_TIMEOUT)
+return Error(ErrorSource::I2C, ErrorCode::Timeout, __FILE__, __LINE__);  // I2Cの送信が時間内に終わりませんでした
+    if (output_size < 0)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // I2Cによる送信に失敗しました
+    return {};
+}
+
+Result<std::size_t> I2C::try_read(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+return Error(ErrorSource::I2C, ErrorCode::NotInitialized, __FILE__, __LINE__);
+    prepare();
+    const uint64_t start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    int input_size = 0;  // 実際には何バイト受信したか
+    input_size = ::i2c_read_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, input_data, size, false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで受信
+    record(slave_addr, std::max(input_size, 0), start_us, to_outcome(input_size));
+    if (input_size == PICO_ERROR_TIMEOUT)
+return Error(ErrorSource::I2C, ErrorCode::Timeout, __FILE__, __LINE__);  // I2Cの受信が時間内に終わりませんでした
+    if (input_size < 0)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // I2Cによる受信に失敗しました
+    TraceRecorder::record(TraceType::I2CRead, slave_addr, 0, input_data, input_size, start_us);  // 受信したデータを記録
+    return static_cast<std::size_t>(input_size);
+}
+
+Result<void> I2C::try_write_memory(BinaryView output_data, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+return Error(ErrorSource::I2C, ErrorCode::NotInitialized, __FILE__, __LINE__);
+    // メモリアドレスとデータは1回の送信で送る必要があるので，先頭にメモリアドレスをつなげる
+    std::array<uint8_t, MaxStackWrite + 1> stack_data;
+    std::vector<uint8_t> heap_data;  // MaxStackWriteバイトを超えるときだけ使う
+    uint8_t* corrected_data = stack_data.data();
+    if (output_data.size() > MaxStackWrite)
+    {
+        heap_data.resize(output_data.size() + 1);
+        corrected_data = heap_data.data();
+    }
+    corrected_data[0] = memory_addr;
+    std::copy(output_data.begin(), output_data.end(), corrected_data + 1);
+    prepare();
+    const uint64_t start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    int output_size = 0;  // 実際には何バイト送信したか
+    output_size = ::i2c_write_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, corrected_data, output_data.size() + 1, false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで送信
+    record(slave_addr, std::max(output_size, 0), start_us, to_outcome(output_size));
+    if (output_size == PICO_ERROR_TIMEOUT)
+return Error(ErrorSource::I2C, ErrorCode::Timeout, __FILE__, __LINE__);  // I2Cの送信が時間内に終わりませんでした
+    if (output_size < 0)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // I2Cによる送信に失敗しました
+    return {};
+}
+
+Result<std::size_t> I2C::try_read_memory(uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+return Error(ErrorSource::I2C, ErrorCode::NotInitialized, __FILE__, __LINE__);
     int output_size = 0;  // 実際には何バイト送信したか
     int input_size = 0;  // 実際には何バイト受信したか
     uint8_t output_data = memory_addr;
+    prepare();
+    const uint64_t start_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
     output_size = ::i2c_write_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, &output_data, 1, true, make_timeout_time_us(100*1000));  // まず，メモリアドレスを送信
-    input_size = ::i2c_read_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, input_data.data(), size, false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで受信
-    if (input_size < 0 || output_size < 0)
+    if (output_size < 0)
     {
-        // input_size = 0;
-throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to receive via I2C. SlaveAddr:%hhx, MemoryAddr:%hhx", slave_addr, memory_addr));  // I2Cによる受信に失敗しました
+        record(slave_addr, 0, start_us, to_outcome(output_size));
+return Error(ErrorSource::I2C, (output_size == PICO_ERROR_TIMEOUT) ? ErrorCode::Timeout : ErrorCode::BusFailed, __FILE__, __LINE__);  // メモリアドレスの送信に失敗したら受信しない
     }
-    input_data.resize(input_size);
-    return Binary(input_data);
+    input_size = ::i2c_read_blocking_until((_i2c_id ? i2c1 : i2c0), slave_addr, input_data, size, false, make_timeout_time_us(100*1000));  // pico-SDKの関数  I2Cで受信
+    record(slave_addr, 1 + std::max(input_size, 0), start_us, to_outcome(input_size));
+    if (input_size == PICO_ERROR_TIMEOUT)
+return Error(ErrorSource::I2C, ErrorCode::Timeout, __FILE__, __LINE__);  // I2Cの受信が時間内に終わりませんでした
+    if (input_size < 0)
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // I2Cによる受信に失敗しました
+    TraceRecorder::record(TraceType::I2CMemory, slave_addr, memory_addr, input_data, input_size, start_us);  // 受信したデータを記録
+    return static_cast<std::size_t>(input_size);
 }
 
 }
@@ -0,0 +1,310 @@
+/**************************************************
+ * I2C通信を待機せずに行うためのコードです
+ * このファイルは，i2c_async.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，I2Cのメモリからの受信を予約し，割り込みで進めるクラスが定義されています．
+**************************************************/
+
+//! @file i2c_async.cpp
+//! @brief I2Cの割り込みによる受信
+
+#include "i2c_async.hpp"
+
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "trace.hpp"
+
+namespace sc
+{
+
+/***** class I2CAsync::Transfer *****/
+
+Result<void> I2CAsync::Transfer::result() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    switch (_status)
+    {
+        case Status::Done:
+return {};
+        case Status::Failed:
+return Error(ErrorSource::I2C, ErrorCode::BusFailed, __FILE__, __LINE__);  // I2Cの通信に失敗しました
+        case Status::TimedOut:
+return Error(ErrorSource::I2C, ErrorCode::Timeout, __FILE__, __LINE__);  // 時間内に受信が終わりませんでした
+        default:
+return Error(ErrorSource::I2C, ErrorCode::NoData, __FILE__, __LINE__);  // まだ受信が終わっていません
+    }
+}
+
+/***** class I2CAsync *****/
+
+I2CAsync::I2CAsync(const I2C& i2c, Time<Unit::s> timeout) try :
+    _i2c(i2c), _timeout_us(static_cast<uint64_t>(double(timeout) * (1/micro)))
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    try
+    {
+        if (_i2c.save == false)
+        {
+throw std::logic_error(f_err(__FILE__, __LINE__, "I2C used for asynchronous reception is not initialized"));  // 使用するI2Cが初期化されていません
+        }
+        const I2C_ID i2c_id = _i2c.get_i2c_id();
+        if (Instances[i2c_id] != nullptr)
+        {
+throw std::logic_error(f_err(__FILE__, __LINE__, "I2C%d is already used for asynchronous reception", int(i2c_id)));  // 既にこのI2Cは割り込みによる受信に使われています
+        }
+        Instances[i2c_id] = this;
+
+        ::i2c_hw_t* hw = ::i2c_get_hw(i2c_id ? i2c1 : i2c0);  // pico-SDKの関数  I2Cのレジスタを取得
+        hw->intr_mask = 0;  // 受信を予約するまでは割り込みを発生させない
+        hw->rx_tl = 0;  // 1バイトでも受信したら割り込みを発生させる
+        ::irq_set_exclusive_handler((i2c_id ? I2C1_IRQ : I2C0_IRQ), (i2c_id ? irq_handler_1 : irq_handler_0));  // pico-SDKの関数  割り込み処理で実行する関数をセット
+        ::irq_set_enabled((i2c_id ? I2C1_IRQ : I2C0_IRQ), true);  // pico-SDKの関数  割り込み処理を有効にする
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+Result<void> I2CAsync::read_memory(Transfer& transfer, uint8_t* input_data, std::size_t size, SlaveAddr slave_addr, I2C::MemoryAddr memory_addr, Callback callback, void* context)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (size == 0)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The number of bytes to receive must be at least 1"));  // 受信するバイト数は1以上にしてください
+    }
+    if (transfer._status == Status::Queued || transfer._status == Status::Running)
+    {
+return Error(ErrorSource::I2C, ErrorCode::Busy, __FILE__, __LINE__);  // この予約はまだ終わっていません
+    }
+
+    transfer._data = input_data;
+    transfer._size = size;
+    transfer._slave_addr = slave_addr;
+    transfer._memory_addr = memory_addr;
+    transfer._callback = callback;
+    transfer._context = context;
+    transfer._requested = 0;
+    transfer._received = 0;
+
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    if (_count == MaxTransfers)
+    {
+        ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+return Error(ErrorSource::I2C, ErrorCode::Busy, __FILE__, __LINE__);  // 予約がいっぱいです
+    }
+    transfer._status = Status::Queued;
+    _queue[(_head + _count) % MaxTransfers] = &transfer;
+    _count = _count + 1;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    start_if_idle();
+    return {};
+}
+
+bool I2CAsync::busy() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    return _current != nullptr || _count != 0;
+}
+
+void I2CAsync::update()
+{
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    if (_current != nullptr && ::time_us_64() > _current->_deadline_us)  // pico-SDKの関数  起動からの時間(μs)を取得
+    {
+        finish(Status::TimedOut);
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    start_if_idle();  // 割り込みの中で始められなかった予約を始める
+}
+
+void I2CAsync::wait()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    while (_current != nullptr || _count != 0)  // 1回ごとにタイムアウトがあるので，必ず終わる
+    {
+        update();
+        ::tight_loop_contents();  // pico-SDKの関数  何もしない
+    }
+}
+
+I2CAsync::~I2CAsync()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save)
+    {
+        const I2C_ID i2c_id = _i2c.get_i2c_id();
+        ::irq_set_enabled((i2c_id ? I2C1_IRQ : I2C0_IRQ), false);  // pico-SDKの関数  割り込み処理を無効にする
+        ::i2c_get_hw(i2c_id ? i2c1 : i2c0)->intr_mask = 0;  // pico-SDKの関数  I2Cのレジスタを取得
+        // 終わっていない予約は失敗したことにする
+        if (_current != nullptr)
+        {
+            _current->_status = Status::Failed;
+        }
+        for (std::size_t i = 0; i < _count; ++i)
+        {
+            _queue[(_head + i) % MaxTransfers]->_status = Status::Failed;
+        }
+        Instances[i2c_id] = nullptr;
+    }
+}
+
+void I2CAsync::start_if_idle()
+{
+    if (_current != nullptr || _count == 0)
+    {
+        return;
+    }
+    _i2c.prepare();  // 割り込みの外で，必要ならバスの回復と速度の変更を行う
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    if (_current == nullptr)
+    {
+        start_next();
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+void SC_ISR_FUNC(I2CAsync::start_next)()
+{
+    if (_count == 0)
+    {
+        _current = nullptr;
+        return;
+    }
+    Transfer* transfer = _queue[_head];
+    _head = (_head + 1) % MaxTransfers;
+    _count = _count - 1;
+    _current = transfer;
+
+    ::i2c_hw_t* hw = ::i2c_get_hw(_i2c.get_i2c_id() ? i2c1 : i2c0);  // pico-SDKの関数  I2Cのレジスタを取得
+    // 通信先を変えるときは，一度I2Cを無効にする必要がある (FIFOも空になる)
+    hw->enable = 0;
+    hw->tar = transfer->_slave_addr;
+    hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+
+    transfer->_status = Status::Running;
+    transfer->_deadline_us = isr_time_us() + _timeout_us;  // 起動からの時間(μs)を取得 (time_us_64はフラッシュにある)
+    hw->data_cmd = transfer->_memory_addr;  // まず，メモリアドレスを送信 (STOPは送らない)
+    fill_fifo();
+    hw->intr_mask = I2C_IC_INTR_MASK_M_RX_FULL_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+}
+
+void SC_ISR_FUNC(I2CAsync::fill_fifo)()
+{
+    ::i2c_hw_t* hw = ::i2c_get_hw(_i2c.get_i2c_id() ? i2c1 : i2c0);  // pico-SDKの関数  I2Cのレジスタを取得
+    Transfer* transfer = _current;
+
+    // 受信したデータを取り出す
+    while (hw->rxflr > 0 && transfer->_received < transfer->_requested)
+    {
+        transfer->_data[transfer->_received] = static_cast<uint8_t>(hw->data_cmd);
+        transfer->_received = transfer->_received + 1;
+    }
+
+    // 読み込みのコマンドを詰める (受信したデータがFIFOからあふれないように，取り出していない分は段数以下にする)
+    while (transfer->_requested < transfer->_size && hw->txflr < FifoDepth && transfer->_requested - transfer->_received < FifoDepth)
+    {
+        uint32_t command = I2C_IC_DATA_CMD_CMD_BITS;
+        if (transfer->_requested == 0)
+        {
+            command |= I2C_IC_DATA_CMD_RESTART_BITS;  // メモリアドレスの送信から受信に切り替える
+        }
+        if (transfer->_requested + 1 == transfer->_size)
+        {
+            command |= I2C_IC_DATA_CMD_STOP_BITS;  // 最後のバイトで通信を終える
+        }
+        hw->data_cmd = command;
+        transfer->_requested = transfer->_requested + 1;
+    }
+}
+
+void SC_ISR_FUNC(I2CAsync::finish)(Status status)
+{
+    ::i2c_hw_t* hw = ::i2c_get_hw(_i2c.get_i2c_id() ? i2c1 : i2c0);  // pico-SDKの関数  I2Cのレジスタを取得
+    hw->intr_mask = 0;
+    if (status == Status::TimedOut)
+    {
+        hw->enable = 0;  // 途中の通信を打ち切り，FIFOを空にする
+    }
+
+    Transfer* transfer = _current;
+    _current = nullptr;
+    transfer->_status = status;
+    // 通信の結果をI2Cの記録に加える (失敗が多ければ，次の受信から速度が下がる)
+    const I2C::Outcome outcome = (status == Status::Done) ? I2C::Outcome::Success : (status == Status::TimedOut) ? I2C::Outcome::Timeout : I2C::Outcome::Nack;
+    _i2c.record(transfer->_slave_addr, 1 + transfer->_received, transfer->_deadline_us - _timeout_us, outcome);
+    if (status == Status::Done)
+    {
+        TraceRecorder::record(TraceType::I2CMemory, transfer->_slave_addr, transfer->_memory_addr, transfer->_data, transfer->_received, transfer->_deadline_us - _timeout_us);  // 受信したデータを記録
+    }
+    if (transfer->_callback != nullptr)
+    {
+        transfer->_callback(*transfer, transfer->_context);
+    }
+    // バスの回復や速度の変更が必要なときは，割り込みの中では行わず，update()などで始める
+    if (!_i2c.prepare_needed())
+    {
+        start_next();
+    }
+}
+
+void SC_ISR_FUNC(I2CAsync::on_irq)()
+{
+    ::i2c_hw_t* hw = ::i2c_get_hw(_i2c.get_i2c_id() ? i2c1 : i2c0);  // pico-SDKの関数  I2Cのレジスタを取得
+    if (_current == nullptr)
+    {
+        hw->intr_mask = 0;
+        return;
+    }
+    if (hw->intr_stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)
+    {
+        static_cast<void>(hw->clr_tx_abrt);  // 読み込むと中断の割り込みが解除される
+        finish(Status::Failed);
+        return;
+    }
+    fill_fifo();
+    if (_current->_received == _current->_size)
+    {
+        finish(Status::Done);
+    }
+}
+
+void SC_ISR_FUNC(I2CAsync::irq_handler_0)()
+{
+    if (Instances[0] != nullptr)
+    {
+        Instances[0]->on_irq();
+    }
+}
+
+void SC_ISR_FUNC(I2CAsync::irq_handler_1)()
+{
+    if (Instances[1] != nullptr)
+    {
+        Instances[1]->on_irq();
+    }
+}
+
+}
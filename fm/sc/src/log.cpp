@@ -0,0 +1,227 @@
+/**************************************************
+ * ログの出力先ごとに，出力するメッセージを選ぶためのコードです
+ * このファイルは，log.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，しきい値の管理と，出力先への振り分け，同じメッセージのくり返しをまとめる処理が定義されています．
+**************************************************/
+
+//! @file log.cpp
+//! @brief ログの重要度と出力先ごとの選別
+
+#include "log.hpp"
+
+
+namespace sc
+{
+
+namespace
+{
+
+//! @brief メッセージのハッシュ (FNV-1a)  0は空きの印なので使わない
+uint32_t message_hash(const std::string& message)
+{
+    uint32_t hash = 2166136261U;
+    for (const char c : message)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619U;
+    }
+    return (hash == 0) ? 1 : hash;
+}
+
+//! @brief 出力先
+struct SinkEntry
+{
+    LogLevel level = LogLevel::Off;
+    Log::Sink sink;
+};
+
+//! @brief くり返しを数えているメッセージ
+struct Repeat
+{
+    uint32_t hash = 0;  // メッセージのハッシュ (0なら空き)
+    uint32_t since_ms = 0;  // 最初に出力した時刻
+    uint32_t count = 0;  // その後に捨てた回数
+    LogLevel level = LogLevel::Info;
+    std::array<char, Log::RepeatTextSize + 1> text{};  // メッセージの先頭 (改行は除く)
+};
+
+std::array<SinkEntry, Log::MaxSinks> Sinks{};
+std::size_t SinkNum = 0;
+std::array<Repeat, Log::RepeatSlots> Repeats{};
+LogLevel RepeatLevel = LogLevel::Info;
+uint32_t RepeatWindow_ms = 1000;
+
+}
+
+const char* to_str(LogLevel level)
+{
+    switch (level)
+    {
+        case LogLevel::Data: return "Data";
+        case LogLevel::Info: return "Info";
+        case LogLevel::Event: return "Event";
+        case LogLevel::Error: return "Error";
+        case LogLevel::Off: return "Off";
+        default: return "Unknown";
+    }
+}
+
+const char* to_str(LogModule module)
+{
+    switch (module)
+    {
+        case LogModule::Main: return "Main";
+        case LogModule::I2C: return "I2C";
+        case LogModule::UART: return "UART";
+        case LogModule::ADC: return "ADC";
+        case LogModule::BME280: return "BME280";
+        case LogModule::BNO055: return "BNO055";
+        case LogModule::NJL5513R: return "NJL5513R";
+        case LogModule::HCSR04: return "HCSR04";
+        case LogModule::Spresense: return "Spresense";
+        case LogModule::SD: return "SD";
+        case LogModule::Power: return "Power";
+        default: return "Unknown";
+    }
+}
+
+/***** class Log *****/
+
+std::size_t Log::add_sink(LogLevel level, Sink sink)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (SinkNum == MaxSinks)
+        return MaxSinks;
+    Sinks[SinkNum] = SinkEntry{level, sink};
+    update_gate();
+    return SinkNum++;
+}
+
+void Log::set_sink_level(std::size_t index, LogLevel level)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (index >= SinkNum)
+        return;
+    Sinks[index].level = level;
+    update_gate();
+}
+
+void Log::set_level(LogModule module, LogLevel level)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    Levels[static_cast<std::size_t>(module)] = level;
+    update_gate();
+}
+
+void Log::set_repeat(LogLevel level, uint32_t window_ms)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    flush();
+    RepeatLevel = level;
+    RepeatWindow_ms = window_ms;
+}
+
+void Log::update_gate()
+{
+    // 出力先がないときはstd::coutにすべて出力する
+    LogLevel lowest = (SinkNum == 0) ? LogLevel::Data : LogLevel::Off;
+    for (std::size_t i = 0; i < SinkNum; ++i)
+    {
+        lowest = std::min(lowest, Sinks[i].level);
+    }
+    for (std::size_t module = 0; module < Gate.size(); ++module)
+    {
+        Gate[module] = static_cast<uint8_t>(std::max(lowest, Levels[module]));
+    }
+}
+
+void Log::write(LogLevel level, LogModule module, const std::string& message)
+{
+    if (!enabled(level, module))
+        return;  // 重要度を付けないprintからset_print経由で呼ばれたとき
+    const uint32_t now_ms = ::to_ms_since_boot(::get_absolute_time());  // pico-SDKの関数  起動してからの時間(ms)
+    report_repeats(now_ms, false);
+    if (level >= RepeatLevel)
+    {
+        const uint32_t hash = message_hash(message);
+        Repeat* free_slot = nullptr;
+        Repeat* oldest = &Repeats[0];
+        for (auto& repeat : Repeats)
+        {
+            if (repeat.hash == hash)
+            {
+                ++repeat.count;  // 時間内に同じメッセージがきたので，数えるだけ
+                return;
+            }
+            if (repeat.hash == 0 && free_slot == nullptr)
+            {
+                free_slot = &repeat;
+            }
+            if (now_ms - repeat.since_ms > now_ms - oldest->since_ms)
+            {
+                oldest = &repeat;
+            }
+        }
+        Repeat& slot = free_slot ? *free_slot : *oldest;
+        if (slot.hash != 0 && slot.count > 0)
+        {
+            dispatch(slot.level, format_str("repeated:%lu,%s\n", static_cast<unsigned long>(slot.count), slot.text.data()));
+        }
+        slot.hash = hash;
+        slot.since_ms = now_ms;
+        slot.count = 0;
+        slot.level = level;
+        const std::size_t length = message.copy(slot.text.data(), std::min(message.find('\n'), RepeatTextSize));
+        slot.text[length] = '\0';
+    }
+    dispatch(level, message);
+}
+
+void Log::flush()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    report_repeats(0, true);
+}
+
+void Log::dispatch(LogLevel level, const std::string& message)
+{
+    if (SinkNum == 0)
+    {
+        std::cout << message << std::flush;
+        return;
+    }
+    for (std::size_t i = 0; i < SinkNum; ++i)
+    {
+        if (level >= Sinks[i].level && Sinks[i].sink)
+        {
+            try {Sinks[i].sink(message);} catch(const std::exception& e){printf(e.what());}  // 1つの出力先で失敗しても，ほかには出力する
+        }
+    }
+}
+
+void Log::report_repeats(uint32_t now_ms, bool all)
+{
+    for (auto& repeat : Repeats)
+    {
+        if (repeat.hash == 0 || (!all && now_ms - repeat.since_ms < RepeatWindow_ms))
+            continue;
+        if (repeat.count > 0)
+        {
+            dispatch(repeat.level, format_str("repeated:%lu,%s\n", static_cast<unsigned long>(repeat.count), repeat.text.data()));
+        }
+        repeat.hash = 0;  // 次に同じメッセージがきたら，また出力する
+        repeat.count = 0;
+    }
+}
+
+}
@@ -0,0 +1,262 @@
+/**************************************************
+ * ログを圧縮して，フラッシュメモリやSDカードに多く残すためのコードです
+ * このファイルは，lzss.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，LZSSの圧縮(一致の探し方とブロックへの出力)と展開が定義されています．
+ * 一致は，先頭3文字のハッシュが同じ位置を新しい順にmax_chain個までたどって探します．
+**************************************************/
+
+//! @file lzss.cpp
+//! @brief ログの圧縮と展開
+
+#include "lzss.hpp"
+
+#include <algorithm>
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr uint32_t WindowMask = LzssEncoder::WindowSize - 1;
+static_assert((LzssEncoder::WindowSize & WindowMask) == 0, "WindowSize must be a power of 2");
+static_assert(LzssEncoder::WindowSize <= (1 << 11) && LzssEncoder::MaxMatch - LzssEncoder::MinMatch < (1 << 5), "A match must fit in 2 bytes");
+
+}
+
+/***** class LzssEncoder *****/
+
+LzssEncoder::LzssEncoder(Sink sink, std::size_t restart_blocks, std::size_t max_chain):
+    _sink(sink), _restart_blocks(restart_blocks), _max_chain(max_chain)
+{
+}
+
+void LzssEncoder::write(const uint8_t* data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        _window[_end & WindowMask] = data[i];
+        ++_end;
+        if (_end - _cur >= MaxMatch)
+        {
+            encode(MaxMatch);  // 最も長い一致を探せるだけたまったら，1つ出力する
+        }
+    }
+    _input_bytes += size;
+    if (_restart_blocks > 0 && _stream_blocks >= _restart_blocks)
+    {
+        finish();
+    }
+}
+
+void LzssEncoder::finish()
+{
+    encode(1);
+    if (_group_items > 0)
+    {
+        flush_group();
+    }
+    if (_block_size > LzssHeaderSize)
+    {
+        emit_block();
+    }
+    restart();
+}
+
+void LzssEncoder::restart()
+{
+    _start = _cur;
+    _stream_blocks = 0;
+    _block_size = LzssHeaderSize;
+    _group_size = 0;
+    _group_items = 0;
+}
+
+void LzssEncoder::encode(std::size_t min_lookahead)
+{
+    while (_end - _cur >= min_lookahead && _end != _cur)
+    {
+        const auto [length, offset] = find_match();
+        if (length >= MinMatch)
+        {
+            const uint32_t code = (uint32_t(offset - 1) << 5) | uint32_t(length - MinMatch);
+            put_item(true, static_cast<uint8_t>(code >> 8), static_cast<uint8_t>(code));
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                insert(_cur + i);
+            }
+            _cur += length;
+        } else {
+            put_item(false, _window[_cur & WindowMask], 0);
+            insert(_cur);
+            ++_cur;
+        }
+    }
+}
+
+uint32_t LzssEncoder::hash(uint32_t pos) const
+{
+    const uint32_t key = (uint32_t(_window[pos & WindowMask]) << 16) | (uint32_t(_window[(pos + 1) & WindowMask]) << 8) | _window[(pos + 2) & WindowMask];
+    return (key * 2654435761U) >> 22;  // 上位10bit (HashSize = 1024)
+}
+
+void LzssEncoder::insert(uint32_t pos)
+{
+    if (pos + MinMatch > _end)
+        return;  // 先頭3文字がまだそろっていない
+    const uint32_t h = hash(pos);
+    _prev[pos & WindowMask] = _head[h];
+    _head[h] = static_cast<uint16_t>(pos);
+}
+
+std::pair<std::size_t, std::size_t> LzssEncoder::find_match() const
+{
+    const std::size_t lookahead = std::min<std::size_t>(_end - _cur, MaxMatch);
+    if (lookahead < MinMatch)
+        return {0, 0};
+    std::size_t best_length = 0, best_offset = 0;
+    uint16_t candidate = _head[hash(_cur)];
+    uint32_t last_distance = 0;
+    for (std::size_t chain = 0; chain < _max_chain; ++chain)
+    {
+        // 位置は下位16bitしか持っていないので，今の位置からの距離に直す (古くなった候補は距離が遠くなって止まる)
+        const uint32_t distance = static_cast<uint16_t>(static_cast<uint16_t>(_cur) - candidate);
+        if (distance <= last_distance || distance > MaxOffset || distance > _cur - _start)
+            break;
+        const uint32_t pos = _cur - distance;
+        std::size_t length = 0;
+        while (length < lookahead && _window[(pos + length) & WindowMask] == _window[(_cur + length) & WindowMask])
+        {
+            ++length;
+        }
+        if (length > best_length)
+        {
+            best_length = length;
+            best_offset = distance;
+            if (length == lookahead)
+                break;
+        }
+        last_distance = distance;
+        candidate = _prev[pos & WindowMask];
+    }
+    return {best_length, best_offset};
+}
+
+void LzssEncoder::put_item(bool match, uint8_t first, uint8_t second)
+{
+    if (_group_items == 0)
+    {
+        _group[0] = 0;
+        _group_size = 1;
+    }
+    if (match)
+    {
+        _group[0] |= static_cast<uint8_t>(1U << _group_items);
+        _group[_group_size++] = first;
+        _group[_group_size++] = second;
+    } else {
+        _group[_group_size++] = first;
+    }
+    if (++_group_items == 8)
+    {
+        flush_group();
+    }
+}
+
+void LzssEncoder::flush_group()
+{
+    // 目印と文字・一致がブロックをまたいでもよい (展開するときは続けて読む)
+    for (std::size_t i = 0; i < _group_size; ++i)
+    {
+        if (_block_size == LzssBlockSize)
+        {
+            emit_block();
+        }
+        _block[_block_size++] = _group[i];
+    }
+    _group_size = 0;
+    _group_items = 0;
+}
+
+void LzssEncoder::emit_block()
+{
+    _block[0] = (_stream_blocks == 0) ? LzssBlockStart : LzssBlockContinue;
+    _block[1] = static_cast<uint8_t>(_block_size - LzssHeaderSize);
+    std::fill(_block.begin() + _block_size, _block.end(), 0);
+    _output_bytes += _block_size - LzssHeaderSize;
+    if (_sink)
+    {
+        _sink(_block.data());
+    }
+    ++_stream_blocks;
+    _block_size = LzssHeaderSize;
+}
+
+
+/***** class LzssDecoder *****/
+
+bool LzssDecoder::decode_block(const uint8_t* block, std::string& output)
+{
+    if (!is_block(block))
+    {
+        reset();
+        return false;
+    }
+    if (block[0] == LzssBlockStart)
+    {
+        reset();
+        _in_stream = true;
+    } else if (!_in_stream) {
+        return false;  // 始まりのブロックが上書きされている
+    }
+    const std::size_t used = std::min<std::size_t>(block[1], LzssPayloadSize);
+    for (std::size_t i = 0; i < used; ++i)
+    {
+        const uint8_t byte = block[LzssHeaderSize + i];
+        if (_bit == 8)
+        {
+            _flags = byte;
+            _bit = 0;
+            continue;
+        }
+        if ((_flags >> _bit) & 1)
+        {
+            if (_pending < 0)
+            {
+                _pending = byte;  // 一致の1バイト目
+                continue;
+            }
+            const uint32_t code = (uint32_t(_pending) << 8) | byte;
+            const uint32_t offset = (code >> 5) + 1;
+            const uint32_t length = (code & 0x1F) + LzssEncoder::MinMatch;
+            for (uint32_t k = 0; k < length; ++k)
+            {
+                put(_window[(_pos - offset) & WindowMask], output);  // 重なっていてもよいように1文字ずつ
+            }
+            _pending = -1;
+        } else {
+            put(byte, output);
+        }
+        ++_bit;
+    }
+    return true;
+}
+
+void LzssDecoder::reset()
+{
+    _pos = 0;
+    _in_stream = false;
+    _flags = 0;
+    _bit = 8;
+    _pending = -1;
+}
+
+void LzssDecoder::put(uint8_t byte, std::string& output)
+{
+    _window[_pos & WindowMask] = byte;
+    ++_pos;
+    output += static_cast<char>(byte);
+}
+
+}
@@ -0,0 +1,85 @@
+/**************************************************
+ * フェーズを移行する条件に関するコードです
+ * このファイルは，mission.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，fm.cppがフェーズを移行するかどうかを決める判定が定義されています．
+**************************************************/
+
+//! @file mission.cpp
+//! @brief フェーズを移行する条件の判定
+
+#include "mission.hpp"
+
+namespace sc
+{
+
+Mission::Mission(const MissionParams& params):
+    _params(params)
+{
+}
+
+int Mission::wait_timeout(Time<Unit::s> elapsed, Time<Unit::s> error_time) const
+{
+    if (double(elapsed) > _params.wait_timeout)
+        return 1;
+    if (double(error_time) > _params.wait_error_timeout)
+        return 2;
+    return 0;
+}
+
+bool Mission::is_low(Time<Unit::s> elapsed, Altitude<Unit::m> altitude) const
+{
+    return double(elapsed) > _params.wait_low_time && double(altitude) < _params.ground_altitude;
+}
+
+bool Mission::is_deployed(Illuminance<Unit::lx> illuminance) const
+{
+    return double(illuminance) > _params.deploy_lux;
+}
+
+bool Mission::is_free_fall(const Acceleration<Unit::m_s2>& line_acce, const Acceleration<Unit::m_s2>& gravity) const
+{
+    return double((line_acce + gravity).magnitude()) < _params.free_fall_accel;  // 重力加速度と線形加速度の和(全加速度)が小さい
+}
+
+bool Mission::is_dropping(const AltitudeFilter& altitude_filter) const
+{
+    return altitude_filter.is_past_apogee(dimension::m(_params.release_drop)) && altitude_filter.is_descending(dimension::m_s(_params.release_speed));
+}
+
+int Mission::fall_timeout(Time<Unit::s> elapsed, Time<Unit::s> error_time) const
+{
+    if (double(elapsed) > _params.fall_timeout)
+        return 1;
+    if (double(error_time) > _params.fall_error_timeout)
+        return 2;
+    return 0;
+}
+
+bool Mission::is_landed(const AltitudeFilter& altitude_filter) const
+{
+    return double(altitude_filter.altitude()) < _params.ground_altitude && !altitude_filter.is_descending(dimension::m_s(_params.landing_speed))
+        && altitude_filter.is_still(Time<Unit::s>(_params.landing_still_time));
+}
+
+bool Mission::is_stationary(const Acceleration<Unit::m_s2>& line_acce, const AngularVelocity<Unit::rad_s>& gyro) const
+{
+    return double(line_acce.magnitude()) < _params.still_accel && double(gyro.magnitude()) < _params.still_gyro;
+}
+
+bool Mission::is_upside_down(const Acceleration<Unit::m_s2>& gravity) const
+{
+    return double(gravity.z()) >= _params.upside_down_gravity;
+}
+
+bool Mission::is_near_goal(double distance) const
+{
+    return distance < _params.near_goal;
+}
+
+bool Mission::is_goal(Length<Unit::m> distance) const
+{
+    return double(distance) < _params.goal_distance;
+}
+
+}
@@ -12,6 +12,7 @@
 namespace sc
 {
 
+/***** class Motor1 *****/
 
 void Motor1::run(float speed) const
 {
@@ -35,6 +36,23 @@ void Motor1::run(float speed) const
     }
 }
 
+bool SC_ISR_FUNC(Motor1::drive)(float speed) const noexcept
+{
+    // 範囲外の値はPWM::write_levelが0.0~1.0に丸める
+    if (speed >= 0.0F)
+    {
+        // 正回転するとき
+        const bool in1 = _in1_pwm.write_level(speed);
+        const bool in2 = _in2_pwm.write_level(0.0F);
+        return in1 && in2;
+    } else {
+        // 逆回転するとき
+        const bool in1 = _in1_pwm.write_level(0.0F);
+        const bool in2 = _in2_pwm.write_level(-speed);
+        return in1 && in2;
+    }
+}
+
 // ブレーキをかける
 void Motor1::brake() const
 {
@@ -45,4 +63,14 @@ void Motor1::brake() const
     _in2_pwm.write(1.0F);
 }
 
+
+/***** class Motor2 *****/
+
+bool SC_ISR_FUNC(Motor2::drive)(float left_speed, float right_speed) const noexcept
+{
+    const bool left = _left_motor.drive(left_speed * Keisuu);
+    const bool right = _right_motor.drive(right_speed * Keisuu);
+    return left && right;
+}
+
 }
\ No newline at end of file
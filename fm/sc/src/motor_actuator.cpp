@@ -0,0 +1,200 @@
+/**************************************************
+ * モーターを待機せずに動かすためのコードです
+ * このファイルは，motor_actuator.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，時間指定のモーター動作の予約と，出力のなめらかな変化に関するコードが定義されています．
+**************************************************/
+
+//! @file motor_actuator.cpp
+//! @brief 時間指定のモーター動作とランプ制御
+
+#include "motor_actuator.hpp"
+
+#include "hardware/sync.h"
+
+namespace sc
+{
+
+MotorActuator::MotorActuator(const Motor2& motor, float ramp_rate, Time<Unit::s> tick) try :
+    _motor(motor), _ramp_rate(ramp_rate), _tick_us(static_cast<int64_t>(double(tick) * (1/micro)))
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    try
+    {
+        if (_tick_us <= 0)
+        {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The update period of the motor must be positive"));  // 更新周期は正の値にしてください
+        }
+        _motor.stop();
+        _last_update_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+        if (!::add_repeating_timer_us(-_tick_us, timer_callback, this, &_timer))  // pico-SDKの関数  繰り返しタイマーを開始 (負の値なので前回の開始時刻から一定周期)
+        {
+throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to start the motor timer"));  // モーター用のタイマーの開始に失敗しました
+        }
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+void MotorActuator::run(float left_speed, float right_speed)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (left_speed < -1.0F || +1.0F < left_speed || right_speed < -1.0F || +1.0F < right_speed)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The motor output is a number between -1 and 1. However, %f, %f was entered.", left_speed, right_speed));  // 出力が-1未満または1より大きいならエラー
+    }
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    _count = 0;
+    _running_command = false;
+    _idle_left = left_speed;
+    _idle_right = right_speed;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+void MotorActuator::run_now(float left_speed, float right_speed)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (left_speed < -1.0F || +1.0F < left_speed || right_speed < -1.0F || +1.0F < right_speed)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The motor output is a number between -1 and 1. However, %f, %f was entered.", left_speed, right_speed));  // 出力が-1未満または1より大きいならエラー
+    }
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    _count = 0;
+    _running_command = false;
+    _idle_left = _left = left_speed;  // 今の出力を目標と同じにするので，タイマー割り込みはPWMを書き換えない
+    _idle_right = _right = right_speed;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    _motor.run(left_speed, right_speed);
+}
+
+void MotorActuator::run_for(float left_speed, float right_speed, Time<Unit::s> time)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (left_speed < -1.0F || +1.0F < left_speed || right_speed < -1.0F || +1.0F < right_speed)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The motor output is a number between -1 and 1. However, %f, %f was entered.", left_speed, right_speed));  // 出力が-1未満または1より大きいならエラー
+    }
+    if (double(time) < 0.0)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "The duration of the motor command must not be negative"));  // 動作時間は0以上にしてください
+    }
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    if (_count >= MaxCommands)
+    {
+        ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+throw std::length_error(f_err(__FILE__, __LINE__, "Too many motor commands are queued"));  // 予約できる動作の数を超えました
+    }
+    _commands[(_head + _count) % MaxCommands] = Command{left_speed, right_speed, static_cast<uint64_t>(double(time) * (1/micro))};
+    _count = _count + 1;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+void MotorActuator::stop()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    run(0.0F, 0.0F);
+}
+
+void MotorActuator::brake()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    _count = 0;
+    _running_command = false;
+    _idle_left = _idle_right = 0.0F;
+    _left = _right = 0.0F;
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    _motor.brake();
+}
+
+bool MotorActuator::busy() const
+{
+    return _running_command || _count > 0;
+}
+
+std::tuple<float, float> MotorActuator::output() const
+{
+    return {_left, _right};
+}
+
+void SC_ISR_FUNC(MotorActuator::update)()
+{
+    const uint64_t now = isr_time_us();  // 起動からの時間(μs)を取得 (time_us_64はフラッシュにある)
+    const float dt = static_cast<float>(now - _last_update_us) * static_cast<float>(micro);
+    _last_update_us = now;
+
+    // 実行中の動作が終わったら次の動作へ
+    if (_running_command && now >= _command_end_us)
+    {
+        _running_command = false;
+        _head = (_head + 1) % MaxCommands;
+        _count = _count - 1;
+    }
+    if (!_running_command && _count > 0)
+    {
+        _running_command = true;
+        _command_end_us = now + _commands[_head].time_us;
+    }
+
+    const float target_left = _running_command ? _commands[_head].left : _idle_left;
+    const float target_right = _running_command ? _commands[_head].right : _idle_right;
+
+    // 出力を目標に少しずつ近づける
+    const float step = _ramp_rate * dt;
+    const float left = _left + std::clamp(target_left - _left, -step, step);
+    const float right = _right + std::clamp(target_right - _right, -step, step);
+    if (left == _left && right == _right)
+        return;  // 出力が変わらないときはPWMを書き換えない
+
+    _left = left;
+    _right = right;
+    // 目標はrun/run_now/run_forで範囲を確かめてあるので，割り込みの中では例外を投げない版で出力する
+    if (!_motor.drive(_left, _right))
+    {
+        _fault = true;  // 割り込み中なので出力はせず，記録だけしておく
+    }
+}
+
+MotorActuator::~MotorActuator()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save)
+    {
+        ::cancel_repeating_timer(&_timer);  // pico-SDKの関数  繰り返しタイマーを止める
+    }
+}
+
+bool SC_ISR_FUNC(MotorActuator::timer_callback)(::repeating_timer_t* timer)
+{
+    static_cast<MotorActuator*>(timer->user_data)->update();
+    return true;  // trueを返すとタイマーが続く
+}
+
+}
@@ -0,0 +1,58 @@
+/**************************************************
+ * ゴールまでの航法計算に関するコードです
+ * このファイルは，navigation.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，ゴールを原点とした局所接平面(北・東)座標への変換と，球面上の大円距離が定義されています．
+**************************************************/
+
+//! @file navigation.cpp
+//! @brief 緯度経度からゴールまでの北・東成分，距離，方位を計算
+
+#include "navigation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sc
+{
+
+LocalNavigator::LocalNavigator(const Latitude<Unit::rad>& goal_lat, const Longitude<Unit::rad>& goal_lon)
+{
+    set_goal(goal_lat, goal_lon);
+}
+
+void LocalNavigator::set_goal(const Latitude<Unit::rad>& goal_lat, const Longitude<Unit::rad>& goal_lon)
+{
+    _goal_lat = double(goal_lat);
+    _goal_lon = double(goal_lon);
+
+    // ここだけ三角関数と平方根を使うが，ゴールを決めたときに一度だけ
+    const double sin_lat = std::sin(_goal_lat);
+    const double w = std::sqrt(1.0 - EarthE2 * sin_lat * sin_lat);
+    _north_per_rad = static_cast<float>(EarthA * (1.0 - EarthE2) / (w * w * w));  // 子午線曲率半径 M
+    _east_per_rad = static_cast<float>(EarthA / w * std::cos(_goal_lat));  // 卯酉線曲率半径 N × cosφ
+}
+
+GoalVector LocalNavigator::to_goal(const Latitude<Unit::rad>& lat, const Longitude<Unit::rad>& lon) const
+{
+    // 緯度経度の差はdoubleで取り，桁落ちを防いでからfloatにする
+    const float north = static_cast<float>(_goal_lat - double(lat)) * _north_per_rad;
+    const float east = static_cast<float>(_goal_lon - double(lon)) * _east_per_rad;
+    const float distance = std::sqrt(north*north + east*east);
+    float bearing = std::atan2(east, north);
+    if (bearing < 0.0F)
+        bearing += static_cast<float>(2.0 * PI);
+    return GoalVector{north, east, distance, bearing};
+}
+
+double distance_sphere(double t_lon, double t_lat, double m_lon, double m_lat)
+{
+    // 余弦定理のacos(なす角のcos)は，近い2点ではcosが1に近すぎて桁落ちするので，半正矢(haversine)の公式で計算する
+    const double sin_lat = std::sin((t_lat - m_lat) / 2);
+    const double sin_lon = std::sin((t_lon - m_lon) / 2);
+    const double h = sin_lat*sin_lat + std::cos(t_lat)*std::cos(m_lat)*sin_lon*sin_lon;
+    constexpr double R = 6371.0;  // 地球の半径 (km)
+    return 2 * R * std::asin(std::sqrt(std::min(h, 1.0))) * 1000;  // 対蹠点の近くでは丸め誤差で1を超えることがあるので，asinの定義域に収める
+}
+
+}
@@ -37,7 +37,7 @@ catch (const std::exception& e)
     print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
 }
 
-uint8_t Pin::gpio() const
+uint8_t SC_ISR_FUNC(Pin::gpio)() const
 {
     return _pin_gpio;
 }
@@ -0,0 +1,153 @@
+/**************************************************
+ * フェーズに合わせてシステムクロックを下げ，電池を長持ちさせるためのコードです
+ * このファイルは，power.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，クロックとコアの電圧の切り替え，PWMとI2Cの分周比の直し方，
+ * VSYSの電圧からの消費電流の推定が定義されています．
+**************************************************/
+
+//! @file power.cpp
+//! @brief フェーズに合わせたクロックの切り替えと消費電流の推定
+
+#include "power.hpp"
+
+#include <algorithm>
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr uint32_t MinPwmDiv = 0x010;  // PWMの分周比のレジスタの最小値 (整数部8bit，小数部4bitで1.0)
+constexpr uint32_t MaxPwmDiv = 0xFFF;  // PWMの分周比のレジスタの最大値 (255+15/16)
+
+}
+
+/***** class PowerManager *****/
+
+PowerManager::PowerManager(I2C& i2c, uint32_t low_divider, float source_resistance) try :
+    _i2c(i2c), _low_divider(std::max<uint32_t>(1, low_divider)), _source_resistance(source_resistance)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    try
+    {
+        _full_hz = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数を取得
+        // clk_periの元をclk_sysからPLLに変える (周波数は同じなので，設定済みのUARTとSPIの通信速度はそのまま使える)
+        ::clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, _full_hz, _full_hz);  // pico-SDKの関数  クロックを設定
+        _last_record_us = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    }
+    catch(const std::exception& e)
+    {
+        save = false;
+        sc::print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n%s\n\n********************\n", __FILE__, __LINE__, e.what());
+    }
+}
+catch (const std::exception& e)
+{
+    sc::print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
+}
+
+void PowerManager::set_speed(Speed speed)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    if (speed == _speed)
+        return;
+    if (speed == Speed::Full)
+    {
+        ::vreg_set_voltage(VREG_VOLTAGE_DEFAULT);  // pico-SDKの関数  コアの電圧を戻す
+        sleep_ms(1);  // 電圧が上がるのを待つ
+        ::clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX, CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, _full_hz, _full_hz);  // pico-SDKの関数  クロックを設定
+    } else {
+        ::clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX, CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, _full_hz, _full_hz / _low_divider);  // pico-SDKの関数  クロックを設定
+        ::vreg_set_voltage(VREG_VOLTAGE_0_95);  // pico-SDKの関数  コアの電圧を下げる (低いクロックなら0.95Vで動く)
+    }
+    _speed = speed;
+    rescale_pwm(speed);
+    _i2c.clock_changed();
+}
+
+void PowerManager::calibrate(dimension::V vsys, float current)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    _calibration_voltage = static_cast<float>(double(vsys));
+    _calibration_current = current;
+    _calibrated = true;
+}
+
+void PowerManager::record(std::size_t phase, dimension::V vsys)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    const uint64_t now = ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得
+    const uint64_t dt = now - _last_record_us;
+    _last_record_us = now;
+    if (phase >= MaxPhases)
+        return;
+    const float voltage = static_cast<float>(double(vsys));
+    PhaseStats& stats = _phases[phase];
+    stats.time_us += dt;
+    stats.voltage_us += static_cast<double>(voltage) * dt;
+    stats.charge += static_cast<double>(estimate_current(voltage)) * dt * 1e-6;
+    if (_speed == Speed::Low)
+        stats.low_us += dt;
+}
+
+void PowerManager::print() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    sc::print("power:clk_sys=%luHz\n", static_cast<unsigned long>(::clock_get_hz(clk_sys)));  // pico-SDKの関数  clk_sysの周波数を取得
+    for (std::size_t i = 0; i < MaxPhases; ++i)
+    {
+        const PhaseStats& stats = _phases[i];
+        if (stats.time_us == 0)
+            continue;
+        const double seconds = stats.time_us * 1e-6;
+        if (_calibrated)
+        {
+            sc::print("power:phase=%u,time=%.1fs,low=%.0f%%,vsys=%.3fV,current=%.1fmA,charge=%.2fmAh\n", unsigned(i), seconds, 100.0 * stats.low_us / stats.time_us,
+                stats.voltage_us / stats.time_us, 1000.0 * stats.charge / seconds, stats.charge / 3.6);
+        } else {
+            sc::print("power:phase=%u,time=%.1fs,low=%.0f%%,vsys=%.3fV\n", unsigned(i), seconds, 100.0 * stats.low_us / stats.time_us, stats.voltage_us / stats.time_us);
+        }
+    }
+}
+
+float PowerManager::estimate_current(float vsys) const
+{
+    if (!_calibrated)
+        return 0;
+    // 基準のときより電圧が下がった分だけ，電流が増えたとみなす
+    return std::max(0.0F, _calibration_current + (_calibration_voltage - vsys) / _source_resistance);
+}
+
+void PowerManager::rescale_pwm(Speed speed)
+{
+    for (std::size_t slice = 0; slice < NUM_PWM_SLICES; ++slice)
+    {
+        const uint32_t div = pwm_hw->slice[slice].div;
+        if (speed == Speed::Low)
+        {
+            _full_div[slice] = div;
+            _low_div[slice] = std::clamp<uint32_t>((div + _low_divider / 2) / _low_divider, MinPwmDiv, MaxPwmDiv);
+            pwm_hw->slice[slice].div = _low_div[slice];
+        } else if (div == _low_div[slice]) {
+            pwm_hw->slice[slice].div = _full_div[slice];  // 下げている間に設定し直されていなければ，元の値に戻す
+        } else {
+            pwm_hw->slice[slice].div = std::clamp<uint32_t>(div * _low_divider, MinPwmDiv, MaxPwmDiv);  // 下げている間に設定し直されたときは，その値から直す
+        }
+    }
+}
+
+}
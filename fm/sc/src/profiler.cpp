@@ -0,0 +1,180 @@
+/**************************************************
+ * 処理にかかった時間を測るためのコードです
+ * このファイルは，profiler.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，名前を付けた区間(ゾーン)ごとに処理時間を記録するクラスが定義されています．
+ * ゾーンの登録と記録は，picoでは割り込みを止めて，PC(シミュレータ)ではミューテックスで1つずつ行います．
+**************************************************/
+
+//! @file profiler.cpp
+//! @brief 処理時間の計測
+
+#include "profiler.hpp"
+
+#include <cstring>
+#if PICO_ON_DEVICE
+    #include "hardware/sync.h"
+#else
+    #include <mutex>  // PCのシミュレータは複数のスレッドで動く
+#endif
+
+namespace sc
+{
+
+namespace
+{
+
+#if PICO_ON_DEVICE
+    //! @brief ゾーンを書き換える間，割り込みを止める (picoのループは1つのコアで動くので，これで足りる)
+    class ZoneLock : Noncopyable
+    {
+        const uint32_t _interrupts;
+    public:
+        ZoneLock() : _interrupts(::save_and_disable_interrupts()) {}  // pico-SDKの関数  割り込みを無効にする
+        ~ZoneLock()
+            {::restore_interrupts(_interrupts);}  // pico-SDKの関数  割り込みを元に戻す
+    };
+#else
+    std::mutex ZoneMutex;  // シミュレータでは，すべてのスレッドが同じゾーンに記録する
+
+    //! @brief ゾーンを書き換える間，ほかのスレッドを待たせる
+    class ZoneLock : Noncopyable
+    {
+        const std::lock_guard<std::mutex> _lock;
+    public:
+        ZoneLock() : _lock(ZoneMutex) {}
+    };
+#endif
+
+}
+
+/***** class Profiler::Zone *****/
+
+void Profiler::Zone::add(uint32_t duration_us)
+{
+    // 2の累乗ごとの区切りの番号 (0μsは0番目，1μsは1番目，2～3μsは2番目，…)
+    std::size_t bucket = (duration_us == 0) ? 0 : (32 - __builtin_clz(duration_us));
+    if (bucket >= BucketNum)
+    {
+        bucket = BucketNum - 1;
+    }
+    const ZoneLock lock;
+    ++histogram[bucket];
+    ++count;
+    total_us += duration_us;
+    if (duration_us > max_us)
+    {
+        max_us = duration_us;
+    }
+}
+
+uint32_t Profiler::Zone::percentile_us(double percent) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (count == 0)
+        return 0;
+    const double target = count * percent / 100.0;
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < BucketNum; ++i)
+    {
+        sum += histogram[i];
+        if (sum >= target)
+        {
+            const uint32_t upper_us = (i == 0) ? 0 : ((1u << i) - 1);  // この区切りの上限
+            return (upper_us < max_us) ? upper_us : max_us;
+        }
+    }
+    return max_us;
+}
+
+
+/***** class Profiler *****/
+
+std::array<Profiler::Zone, Profiler::MaxZones> Profiler::Zones{};
+
+Profiler::Zone& Profiler::zone(const char* name)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    const ZoneLock lock;
+    for (std::size_t i = 0; i < ZoneNum; ++i)
+    {
+        if (Zones[i].name == name || std::strcmp(Zones[i].name, name) == 0)
+        {
+            return Zones[i];
+        }
+    }
+    if (ZoneNum >= MaxZones - 1)
+    {
+        // いっぱいのときは，最後のゾーン("others")にまとめる
+        Zones[MaxZones - 1].name = "others";
+        ZoneNum = MaxZones;
+        return Zones[MaxZones - 1];
+    }
+    Zones[ZoneNum].name = name;
+    return Zones[ZoneNum++];
+}
+
+uint64_t Profiler::now_us()
+{
+    return ::time_us_64();  // pico-SDKの関数  起動からの時間(μs)を取得 (ホスト用のpico-SDKでも使える)
+}
+
+void Profiler::print()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    for (std::size_t i = 0; ; ++i)
+    {
+        // 出力中にもprintのゾーンが記録されるので，先に写しておく (出力はロックの外で行う)
+        Zone zone;
+        {
+            const ZoneLock lock;
+            if (i >= ZoneNum)
+                break;
+            zone = Zones[i];
+        }
+        if (zone.count == 0)
+            continue;
+        sc::print("profile:%s,%lu,%llu,%lu,%lu,%lu,%lu\n", zone.name,
+            static_cast<unsigned long>(zone.count), static_cast<unsigned long long>(zone.total_us),
+            static_cast<unsigned long>(zone.total_us / zone.count), static_cast<unsigned long>(zone.max_us),
+            static_cast<unsigned long>(zone.percentile_us(50)), static_cast<unsigned long>(zone.percentile_us(99)));
+
+        // ヒストグラムは，0でない最後の区切りまで出力する
+        std::size_t last = 0;
+        for (std::size_t j = 0; j < BucketNum; ++j)
+        {
+            if (zone.histogram[j] != 0)
+            {
+                last = j;
+            }
+        }
+        std::string histogram = zone.name;
+        for (std::size_t j = 0; j <= last; ++j)
+        {
+            histogram += "," + std::to_string(zone.histogram[j]);
+        }
+        sc::print("profile_hist:%s\n", histogram.c_str());
+    }
+}
+
+void Profiler::reset()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    const ZoneLock lock;
+    for (std::size_t i = 0; i < ZoneNum; ++i)
+    {
+        const char* name = Zones[i].name;
+        Zones[i] = Zone{};
+        Zones[i].name = name;
+    }
+}
+
+}
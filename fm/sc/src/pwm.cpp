@@ -86,6 +86,20 @@ void PWM::write(Time<Unit::s> high_time) const
     // ::pwm_set_chan_level(_slice, (_channel==Channel::A ? PWM_CHAN_A : PWM_CHAN_B), static_cast<double>(static_cast<_s>(high_time))*SysClock*SysClock/(_clk_div*_clk_div*(_wrap+1)));  // pico-SDKの関数  sliceとchannelで指定したGPIOピンのPWMの出力レベルを設定する
 }
 
+bool SC_ISR_FUNC(PWM::write_level)(float duty) const noexcept
+{
+    if (save == false)
+        return false;
+    if (!(duty > 0.0F))
+    {
+        duty = 0.0F;  // 負の値とNaN
+    } else if (duty > 1.0F) {
+        duty = 1.0F;
+    }
+    ::pwm_set_gpio_level(_pin.gpio(), _wrap * duty);  // pico-SDKの関数  あるGPIOピンのPWMの出力レベルを設定する
+    return true;
+}
+
 uint16_t PWM::to_wrap(Frequency<Unit::Hz> freq)
 {
     #ifndef NODEBUG
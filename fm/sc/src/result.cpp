@@ -0,0 +1,126 @@
+/**************************************************
+ * 例外を使わずにエラーを返すためのコードです
+ * このファイルは，result.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，値かエラーのどちらかを持つResult型と，エラーの種類ごとの回数の記録が定義されています．
+**************************************************/
+
+//! @file result.cpp
+//! @brief 例外を使わないエラー処理
+
+#include "result.hpp"
+
+#include "hardware/sync.h"
+
+namespace sc
+{
+
+/***** class Error *****/
+
+Error::Error(ErrorSource source, ErrorCode code, const char* file, int line):
+    _source(source), _code(code), _file(file), _line(line)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    // I2CAsyncの割り込み処理などでも作られるので，回数を増やす間(読んで，足して，書く間)は割り込みを無効にする
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    ++ErrorCounter::Counts[std::size_t(source)][std::size_t(code)];
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+Error::Error(ErrorSource source, ErrorCode code, const char* file, int line, const char* label, float x, float y, float z):
+    Error(source, code, file, line)
+{
+    _label = label;
+    _values = {x, y, z};
+}
+
+std::string Error::message() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (_label)
+    {
+        return f_err(_file, _line, "%s: %s. %s:%f, %f, %f (%lu times)", to_str(_source), to_str(_code), _label, double(_values[0]), double(_values[1]), double(_values[2]), static_cast<unsigned long>(ErrorCounter::get(_source, _code)));
+    }
+    return f_err(_file, _line, "%s: %s (%lu times)", to_str(_source), to_str(_code), static_cast<unsigned long>(ErrorCounter::get(_source, _code)));
+}
+
+const char* to_str(ErrorSource source)
+{
+    switch (source)
+    {
+        case ErrorSource::I2C: return "I2C";
+        case ErrorSource::UART: return "UART";
+        case ErrorSource::BME280: return "BME280";
+        case ErrorSource::BNO055: return "BNO055";
+        case ErrorSource::HCSR04: return "HCSR04";
+        case ErrorSource::Spresense: return "Spresense";
+        case ErrorSource::GPIO: return "GPIO";
+        default: return "Unknown";
+    }
+}
+
+const char* to_str(ErrorCode code)
+{
+    switch (code)
+    {
+        case ErrorCode::NotInitialized: return "Cannot execute because initialization failed";  // 初期化に失敗しているので実行できません
+        case ErrorCode::BusFailed: return "Communication failed";  // 通信に失敗しました
+        case ErrorCode::Timeout: return "No response within the time limit";  // 時間内に応答がありませんでした
+        case ErrorCode::InvalidValue: return "Measurement value is abnormal";  // 測定値が異常です
+        case ErrorCode::Stuck: return "Measurement value does not change";  // 測定値が変化しません
+        case ErrorCode::NoData: return "Latest data not available";  // 最新のデータがありません
+        case ErrorCode::Busy: return "Cannot accept because it is busy";  // 処理中のため受け付けられません
+        default: return "Unknown error";
+    }
+}
+
+/***** class ErrorCounter *****/
+
+uint32_t ErrorCounter::total(ErrorSource source)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    uint32_t sum = 0;
+    for (uint32_t count : Counts[std::size_t(source)])
+    {
+        sum += count;
+    }
+    return sum;
+}
+
+void ErrorCounter::reset()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+    for (auto& counts : Counts)
+    {
+        counts.fill(0);
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+}
+
+void ErrorCounter::print()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    for (std::size_t source = 0; source < Counts.size(); ++source)
+    {
+        for (std::size_t code = 0; code < Counts[source].size(); ++code)
+        {
+            if (Counts[source][code] != 0)
+            {
+                sc::print("error_count:%s,%s,%lu\n", to_str(ErrorSource(source)), to_str(ErrorCode(code)), static_cast<unsigned long>(Counts[source][code]));
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,257 @@
+/**************************************************
+ * センサの測定値を少ないバイト数で記録するためのコードです
+ * このファイルは，series.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，測定値の丸めと差分のzig-zag符号化・varint，ブロックへの出力と，それを元に戻す処理が定義されています．
+ * 差はuint32_tの引き算(一周してもよい)で求めるので，丸めた値がどれだけ飛んでも元に戻せます．
+**************************************************/
+
+//! @file series.cpp
+//! @brief センサの測定値の差分の記録
+
+#include "series.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>  // move
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr std::size_t MaxVarintSize = 5;  // uint32_tのvarintの最大のバイト数
+
+//! @brief 符号付きの値を，0に近いほど小さい符号なしの値にする (0,-1,1,-2,... -> 0,1,2,3,...)
+uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value)
+{
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+//! @brief 測定値を丸めた整数にする (範囲外は端に，NaNは0にする)
+int32_t quantize(float value, float scale)
+{
+    const float scaled = value * scale;
+    if (!(scaled == scaled))
+        return 0;
+    if (scaled >= 2147483520.0f)  // floatで表せるint32_tの最大値
+        return std::numeric_limits<int32_t>::max();
+    if (scaled <= -2147483648.0f)
+        return std::numeric_limits<int32_t>::min();
+    return static_cast<int32_t>(std::lround(scaled));
+}
+
+//! @brief varintを1つ読む
+//! @return 読めたか (途中で終わっていたらfalse)
+bool get_varint(const uint8_t*& data, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (std::size_t i = 0; i < MaxVarintSize; ++i)
+    {
+        if (data == end)
+            return false;
+        const uint8_t byte = *data++;
+        value |= uint32_t(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+}
+
+/***** class SeriesEncoder *****/
+
+SeriesEncoder::SeriesEncoder(SeriesStream stream, std::initializer_list<int8_t> exponents, std::size_t block_samples, Sink sink):
+    _stream(stream),
+    _channels(std::min(exponents.size(), MaxChannels)),
+    _block_samples(std::clamp<std::size_t>(block_samples, 1, 255)),
+    _sink(sink)
+{
+    std::copy_n(exponents.begin(), _channels, _exponents.begin());
+    for (std::size_t i = 0; i < _channels; ++i)
+    {
+        _scales[i] = static_cast<float>(std::pow(10.0, -_exponents[i]));
+    }
+}
+
+void SeriesEncoder::add(uint32_t time_ms, std::initializer_list<float> values)
+{
+    std::array<float, MaxChannels> padded{};
+    std::copy_n(values.begin(), std::min(values.size(), _channels), padded.begin());
+    add(time_ms, padded.data());
+}
+
+void SeriesEncoder::add(uint32_t time_ms, const float* values)
+{
+    // 差が最も大きくなっても入らないときは，先にブロックを出力する
+    if (_size != 0 && _size + MaxVarintSize * (_channels + 1) > HeaderSize + MaxBodySize)
+    {
+        flush();
+    }
+    if (_size == 0)
+    {
+        begin_block();
+        put_varint(time_ms);  // 最初の測定はそのまま (キーフレーム)
+        for (std::size_t i = 0; i < _channels; ++i)
+        {
+            _last[i] = quantize(values[i], _scales[i]);
+            put_varint(zigzag(_last[i]));
+        }
+    } else {
+        put_varint(time_ms - _last_time);
+        for (std::size_t i = 0; i < _channels; ++i)
+        {
+            const int32_t current = quantize(values[i], _scales[i]);
+            put_varint(zigzag(static_cast<int32_t>(static_cast<uint32_t>(current) - static_cast<uint32_t>(_last[i]))));
+            _last[i] = current;
+        }
+    }
+    _last_time = time_ms;
+    ++_samples;
+    if (++_block_count == _block_samples)
+    {
+        flush();
+    }
+}
+
+void SeriesEncoder::flush()
+{
+    if (_size == 0)
+        return;
+    const std::size_t body_size = _size - HeaderSize;
+    _buffer[1] = static_cast<uint8_t>(body_size);
+    _buffer[2] = static_cast<uint8_t>(body_size >> 8);
+    _buffer[HeaderSize + 2 + _channels] = static_cast<uint8_t>(_block_count);
+    _buffer[_size] = series_crc8(_buffer.data() + HeaderSize, body_size);
+    ++_size;
+    _output_bytes += _size;
+    if (_sink)
+    {
+        _sink(_buffer.data(), _size);
+    }
+    _size = 0;
+    _block_count = 0;
+}
+
+void SeriesEncoder::begin_block()
+{
+    _buffer[0] = SeriesSync;
+    _size = HeaderSize;
+    _buffer[_size++] = static_cast<uint8_t>(_stream);
+    _buffer[_size++] = static_cast<uint8_t>(_channels);
+    for (std::size_t i = 0; i < _channels; ++i)
+    {
+        _buffer[_size++] = static_cast<uint8_t>(_exponents[i]);
+    }
+    _buffer[_size++] = 0;  // 測定の回数 (flushで書き込む)
+}
+
+void SeriesEncoder::put_varint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        _buffer[_size++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    _buffer[_size++] = static_cast<uint8_t>(value);
+}
+
+
+/***** class SeriesDecoder *****/
+
+std::size_t SeriesDecoder::decode(const uint8_t* data, std::size_t size, std::vector<SeriesSample>& output)
+{
+    std::size_t blocks = 0;
+    std::size_t pos = 0;
+    while (pos < size)
+    {
+        if (data[pos] != SeriesSync)
+        {
+            ++_skipped;
+            ++pos;
+            continue;
+        }
+        if (pos + 3 > size)
+        {
+            _skipped += size - pos;  // ブロックが途中で終わっている
+            break;
+        }
+        const std::size_t body_size = data[pos + 1] | (std::size_t(data[pos + 2]) << 8);
+        const uint8_t* body = data + pos + 3;
+        const std::size_t output_size = output.size();
+        if (body_size <= SeriesEncoder::MaxBodySize && pos + 3 + body_size + 1 <= size
+            && series_crc8(body, body_size) == body[body_size] && decode_body(body, body_size, output))
+        {
+            ++blocks;
+            pos += 3 + body_size + 1;
+        } else {
+            output.resize(output_size);  // 目印に見えた別のバイトだったので，次のバイトから探し直す
+            ++_skipped;
+            ++pos;
+        }
+    }
+    return blocks;
+}
+
+bool SeriesDecoder::decode_body(const uint8_t* body, std::size_t size, std::vector<SeriesSample>& output)
+{
+    const uint8_t* data = body;
+    const uint8_t* const end = body + size;
+    if (size < 3)
+        return false;
+    const auto stream = static_cast<SeriesStream>(*data++);
+    const std::size_t channels = *data++;
+    if (channels == 0 || channels > SeriesEncoder::MaxChannels || data + channels + 1 > end)
+        return false;
+    std::array<double, SeriesEncoder::MaxChannels> units{};
+    for (std::size_t i = 0; i < channels; ++i)
+    {
+        units[i] = std::pow(10.0, static_cast<int8_t>(*data++));
+    }
+    const std::size_t count = *data++;
+
+    uint32_t time = 0;
+    std::array<int32_t, SeriesEncoder::MaxChannels> last{};
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        uint32_t value = 0;
+        if (!get_varint(data, end, value))
+            return false;
+        time = (n == 0) ? value : time + value;
+        SeriesSample sample{stream, time, std::vector<double>(channels)};
+        for (std::size_t i = 0; i < channels; ++i)
+        {
+            if (!get_varint(data, end, value))
+                return false;
+            last[i] = (n == 0) ? unzigzag(value) : static_cast<int32_t>(static_cast<uint32_t>(last[i]) + static_cast<uint32_t>(unzigzag(value)));
+            sample.values[i] = last[i] * units[i];
+        }
+        output.push_back(std::move(sample));
+    }
+    return data == end;
+}
+
+
+uint8_t series_crc8(const uint8_t* data, std::size_t size)
+{
+    uint8_t crc = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+}
@@ -146,10 +146,6 @@ throw std::logic_error(f_err(__FILE__, __LINE__, "SPI cannot be reinitialized"))
         Pin::Status.at(_miso.gpio()) = PinStatus::SpiMiso;
         Pin::Status.at(_sck.gpio()) = PinStatus::SpiSck;
         Pin::Status.at(_mosi.gpio()) = PinStatus::SpiMosi;
-        for (Pin cs_pin : cs.get())
-        {
-            Pin::Status.at(cs_pin.gpio()) = PinStatus::SpiCs;
-        }
 
         SPI::IsUse[_spi_id] = true;
 
@@ -162,6 +158,7 @@ throw std::logic_error(f_err(__FILE__, __LINE__, "SPI cannot be reinitialized"))
         {
             _cs_pins.push_back(GPIO<Out>(cs_pin));  // CSピンをGPIO出力用のピンとしてセットアップ
             _cs_pins.back().write(1);  // CSピンをオンに設定
+            Pin::Status.at(cs_pin.gpio()) = PinStatus::SpiCs;  // GPIO<Out>は未使用のピンしかセットアップしないので，その後で記録する
         }
     }
     catch(const std::exception& e)
@@ -175,100 +172,140 @@ catch (const std::exception& e)
     print(f_err(__FILE__, __LINE__, e, "An initialization error occurred"));
 }
 
-void SPI::write(Binary output_data, CS cs_pin) const
+const GPIO<Out>& SPI::select_cs(const CS& cs_pin) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    if (save == false)
-        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
     if (cs_pin.size() > 1)
     {
 throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot communicate with multiple devices at the same time"));  // 複数のデバイスと同時に通信することはできません
     }
-    _cs_pins.at(cs_pin.get().at(0)).write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
-    int output_size = 0;  // 実際には何バイト送信したか
-    output_size = spi_write_blocking((_spi_id ? spi1 : spi0), output_data, output_data.size());  // pico-SDKの関数  SPIで送信
-    _cs_pins.at(cs_pin.get().at(0)).write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
-    if (output_size < 0)
+    for (const GPIO<Out>& cs : _cs_pins)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to transmit via SPI. CsPin:%hhx", cs_pin.get().at(0)));  // SPIによる送信に失敗しました
+        if (cs.gpio() == cs_pin.get().at(0).gpio())
+return cs;
     }
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "CS pin %hhu is not set up for this SPI", cs_pin.get().at(0).gpio()));  // このSPIのCSピンとしてセットアップされていないピンです
 }
 
-Binary SPI::read(std::size_t size, CS cs_pin) const
+void SPI::write(Binary output_data, const CS& cs_pin) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    write(BinaryView(output_data), cs_pin);
+}
+
+void SPI::write(BinaryView output_data, const CS& cs_pin) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    if (cs_pin.size() > 1)
+    const GPIO<Out>& cs = select_cs(cs_pin);
+    cs.write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
+    int output_size = 0;  // 実際には何バイト送信したか
+    output_size = ::spi_write_blocking((_spi_id ? spi1 : spi0), output_data.data(), output_data.size());  // pico-SDKの関数  SPIで送信
+    cs.write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
+    if (output_size < 0)
     {
-throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot communicate with multiple devices at the same time"));  // 複数のデバイスと同時に通信することはできません
+throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to transmit via SPI. CsPin:%hhx", cs_pin.get().at(0)));  // SPIによる送信に失敗しました
     }
+}
+
+Binary SPI::read(std::size_t size, const CS& cs_pin) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
     std::vector<uint8_t> input_data(size);
+    input_data.resize(read(input_data.data(), size, cs_pin));
+    return Binary(input_data);
+}
+
+std::size_t SPI::read(uint8_t* input_data, std::size_t size, const CS& cs_pin) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+        throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
+    const GPIO<Out>& cs = select_cs(cs_pin);
     int input_size = 0;  // 実際には何バイト受信したか
-    _cs_pins.at(cs_pin.get().at(0)).write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
-    input_size = ::spi_read_blocking((_spi_id ? spi1 : spi0), 0, input_data.data(), size);  // pico-SDKの関数  SPIで受信
-    _cs_pins.at(cs_pin.get().at(0)).write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
+    cs.write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
+    input_size = ::spi_read_blocking((_spi_id ? spi1 : spi0), 0, input_data, size);  // pico-SDKの関数  SPIで受信
+    cs.write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
     if (input_size < 0)
     {
         // input_size = 0;
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to receive via SPI. CsPin:%hhx", cs_pin.get().at(0)));  // SPIによる受信に失敗しました
     }
-    input_data.resize(input_size);
-    return Binary(input_data);
+    return static_cast<std::size_t>(input_size);
 }
 
-void SPI::write_memory(Binary output_data, CS cs_pin, MemoryAddr memory_addr) const
+void SPI::write_memory(Binary output_data, const CS& cs_pin, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    write_memory(BinaryView(output_data), cs_pin, memory_addr);
+}
+
+void SPI::write_memory(BinaryView output_data, const CS& cs_pin, MemoryAddr memory_addr) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    if (cs_pin.size() > 1)
-    {
-throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot communicate with multiple devices at the same time"));  // 複数のデバイスと同時に通信することはできません
-    }
-    Binary corrected_data = uint8_t(memory_addr & 0b01111111) + output_data;
+    const GPIO<Out>& cs = select_cs(cs_pin);
+    const uint8_t write_memory_addr = memory_addr & 0b01111111;
     int output_size = 0;  // 実際には何バイト送信したか
-    _cs_pins.at(cs_pin.get().at(0)).write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
-    output_size = ::spi_write_blocking((_spi_id ? spi1 : spi0), corrected_data, corrected_data.size());  // pico-SDKの関数  SPIで送信
-    _cs_pins.at(cs_pin.get().at(0)).write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
-    if (output_size < 0)
+    int data_size = 0;  // データを実際には何バイト送信したか
+    // CSピンをオフにしている間は1回の通信として扱われるので，メモリアドレスとデータをつなげずに続けて送信する
+    cs.write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
+    output_size = ::spi_write_blocking((_spi_id ? spi1 : spi0), &write_memory_addr, 1);  // まず，メモリアドレスを送信
+    data_size = ::spi_write_blocking((_spi_id ? spi1 : spi0), output_data.data(), output_data.size());  // pico-SDKの関数  SPIで送信
+    cs.write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
+    if (output_size < 0 || data_size < 0)
     {
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to transmit via SPI. CsPin:%hhx, MemoryAddr:%hhx", cs_pin.get().at(0), memory_addr));  // SPIによる送信に失敗しました
     }
 }
 
-Binary SPI::read_memory(std::size_t size, CS cs_pin, MemoryAddr memory_addr) const
+Binary SPI::read_memory(std::size_t size, const CS& cs_pin, MemoryAddr memory_addr) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    std::vector<uint8_t> input_data(size);
+    input_data.resize(read_memory(input_data.data(), size, cs_pin, memory_addr));
+    return Binary(input_data);
+}
+
+std::size_t SPI::read_memory(uint8_t* input_data, std::size_t size, const CS& cs_pin, MemoryAddr memory_addr) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    if (cs_pin.size() > 1)
-    {
-throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot communicate with multiple devices at the same time"));  // 複数のデバイスと同時に通信することはできません
-    }
-    std::vector<uint8_t> input_data(size);
+    const GPIO<Out>& cs = select_cs(cs_pin);
     uint8_t write_memory_addr = memory_addr | 0b10000000;
     int output_size = 0;  // 実際には何バイト送信したか
     int input_size = 0;  // 実際には何バイト受信したか
-    _cs_pins.at(cs_pin.get().at(0)).write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
+    cs.write(0);  // 通信先のデバイスにつながるCSピンをオフにして，通信の開始を伝える
     output_size = ::spi_write_blocking((_spi_id ? spi1 : spi0), &write_memory_addr, 1);  // まず，メモリアドレスを送信
-    input_size = ::spi_read_blocking((_spi_id ? spi1 : spi0), 0, input_data.data(), size);  // pico-SDKの関数  SPIで受信
-    _cs_pins.at(cs_pin.get().at(0)).write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
+    input_size = ::spi_read_blocking((_spi_id ? spi1 : spi0), 0, input_data, size);  // pico-SDKの関数  SPIで受信
+    cs.write(1);  // 通信先のデバイスにつながるCSピンをオンにして，通信の終了を伝える
     if (input_size < 0 || output_size < 0)
     {
         // input_size = 0;
 throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to receive via SPI. CsPin:%hhx, MemoryAddr:%hhx", cs_pin.get().at(0), memory_addr));  // SPIによる受信に失敗しました
     }
-    input_data.resize(input_size);
-    return Binary(input_data);
+    return static_cast<std::size_t>(input_size);
 }
 
 }
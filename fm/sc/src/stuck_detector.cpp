@@ -0,0 +1,112 @@
+/**************************************************
+ * スタック(空転・引っかかり)の検知に関するコードです
+ * このファイルは，stuck_detector.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，モーターへの指令と実際の動きを比べてスタックを検知するコードが定義されています．
+**************************************************/
+
+//! @file stuck_detector.cpp
+//! @brief モーターの指令値とIMU・GPSの動きからスタックを検知
+
+#include "stuck_detector.hpp"
+
+#include "sc_basic.hpp"  // SC_HOT_FUNC
+
+#include <algorithm>
+#include <cmath>
+
+namespace sc
+{
+
+StuckDetector::StuckDetector(std::size_t window, float min_effort, Length<Unit::m> min_displacement, dimension::rad_s min_yaw, dimension::m_s2 min_accel):
+    _window(std::clamp(window, std::size_t(2), MaxWindow)),
+    _min_effort(min_effort),
+    _min_displacement(static_cast<float>(double(min_displacement))),
+    _min_yaw(static_cast<float>(double(min_yaw))),
+    _min_accel(static_cast<float>(double(min_accel)))
+{
+    set_escape({{-1.0F, -1.0F, 1.5F}, {-0.8F, 0.8F, 1.0F}, {0.0F, 0.0F, 0.5F}});  // 下がってから向きを変える
+    set_escape({{1.0F, 1.0F, 1.0F}, {-1.0F, -1.0F, 1.0F}, {1.0F, 1.0F, 1.0F}, {-1.0F, -1.0F, 1.0F}, {0.0F, 0.0F, 0.5F}}, true);  // 前後にゆすってパラシュートを振りほどく
+}
+
+StuckDetector::Status SC_HOT_FUNC(StuckDetector::update)(float left_speed, float right_speed, const Acceleration<Unit::m_s2>& line_acce, dimension::rad_s yaw_rate, float north, float east)
+{
+    const Sample sample{
+        std::fabs(left_speed + right_speed) * 0.5F,
+        std::fabs(right_speed - left_speed) * 0.5F,
+        static_cast<float>(double(line_acce.magnitude())),
+        std::fabs(static_cast<float>(double(yaw_rate))),
+        north,
+        east
+    };
+
+    // 一番古いサンプルを合計から引き，新しいサンプルを足す
+    if (_count == _window)
+    {
+        const Sample& oldest = _samples[_next];
+        _sum_effort -= oldest.effort;
+        _sum_turn -= oldest.turn;
+        _sum_accel -= oldest.accel;
+        _sum_yaw -= oldest.yaw;
+    } else {
+        ++_count;
+    }
+    _samples[_next] = sample;
+    _sum_effort += sample.effort;
+    _sum_turn += sample.turn;
+    _sum_accel += sample.accel;
+    _sum_yaw += sample.yaw;
+    _next = (_next + 1) % _window;
+
+    // 足し引きの丸め誤差がたまらないよう，窓を一周するごとに合計を計算しなおす
+    if (_next == 0)
+    {
+        _sum_effort = _sum_turn = _sum_accel = _sum_yaw = 0.0F;
+        for (std::size_t i = 0; i < _count; ++i)
+        {
+            _sum_effort += _samples[i].effort;
+            _sum_turn += _samples[i].turn;
+            _sum_accel += _samples[i].accel;
+            _sum_yaw += _samples[i].yaw;
+        }
+    }
+
+    if (_count < _window)
+        return Status::Moving;  // 窓が埋まるまでは判定しない
+
+    const float n = static_cast<float>(_window);
+    if (_sum_effort < _min_effort * n && _sum_turn < _min_effort * n)
+        return Status::Moving;  // ほとんど指令を出していない
+
+    const Sample& oldest = _samples[_next];  // 窓が埋まっているときは，次に書き込む位置が一番古い
+    const float dn = sample.north - oldest.north;
+    const float de = sample.east - oldest.east;
+    if (dn*dn + de*de >= _min_displacement * _min_displacement)
+        return Status::Moving;  // GPSで移動している
+    if (_sum_yaw >= _min_yaw * n)
+        return Status::Moving;  // 回転している
+
+    return (_sum_accel >= _min_accel * n) ? Status::Slip : Status::Stuck;
+}
+
+void StuckDetector::reset()
+{
+    _next = 0;
+    _count = 0;
+    _sum_effort = _sum_turn = _sum_accel = _sum_yaw = 0.0F;
+}
+
+void StuckDetector::set_escape(std::initializer_list<MotorStep> steps, bool tangled)
+{
+    auto& escape = tangled ? _tangled_escape : _escape;
+    auto& size = tangled ? _tangled_escape_size : _escape_size;
+    size = std::min(steps.size(), MaxSteps);  // 多すぎる分は使わない
+    std::copy_n(steps.begin(), size, escape.begin());
+}
+
+std::pair<const MotorStep*, std::size_t> StuckDetector::escape(bool tangled) const
+{
+    return tangled ? std::pair(_tangled_escape.data(), _tangled_escape_size) : std::pair(_escape.data(), _escape_size);
+}
+
+}
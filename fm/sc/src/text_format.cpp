@@ -0,0 +1,514 @@
+/**************************************************
+ * ログの文字列を速く作るためのコードです
+ * このファイルは，text_format.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，フォーマット文字列を先頭から1回だけ読み，変換指定ごとに数値を文字にしてバッファに書き込む処理が定義されています．
+ * 数値は一時的な配列に後ろの桁から書き込み，幅に合わせて空白か0を足してからバッファに移します．
+ * 小数は整数部分と小数部分に分けるので，picoでも64bitの割り算は整数部分が大きいときしか使いません．
+**************************************************/
+
+//! @file text_format.cpp
+//! @brief printf形式の高速なフォーマット
+
+#include "text_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr int MaxFastPrecision = 9;  // 自分で変換する小数の桁数の上限 (小数部分がuint32_tに入る)
+constexpr std::array<uint32_t, MaxFastPrecision + 1> Pow10 = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+constexpr double MaxFastValue = 9007199254740992.0;  // これ以上の小数はsnprintfに任せる (2^53  整数部分が正確にdoubleで表せる)
+
+//! @brief 変換指定 (%から変換の文字まで)
+struct Spec
+{
+    bool left = false;  // - : 左寄せ
+    bool plus = false;  // + : 正の数にも符号を付ける
+    bool space = false;  // 空白 : 正の数の符号の位置に空白を入れる
+    bool zero = false;  // 0 : 幅に満たない分を0で埋める
+    bool alt = false;  // # : 16進数に0xを付ける
+    int width = 0;  // 最小の幅
+    int precision = -1;  // 精度 (負なら指定なし)
+    int length = 0;  // 長さの指定による整数のバイト数 (0なら指定なし)
+    char conversion = '\0';  // 変換の文字 (dやfなど)
+};
+
+//! @brief バッファに書き込むクラス (入らない分は数えるだけ)
+class Writer
+{
+    char* const _buffer;
+    const std::size_t _size;
+    std::size_t _length = 0;
+public:
+    Writer(char* buffer, std::size_t size):
+        _buffer(buffer), _size(size) {}
+
+    void put(char c)
+    {
+        if (_length + 1 < _size)
+        {
+            _buffer[_length] = c;
+        }
+        ++_length;
+    }
+
+    void put(const char* text, std::size_t length)
+    {
+        if (_length + 1 < _size)
+        {
+            std::memcpy(_buffer + _length, text, std::min(length, _size - 1 - _length));
+        }
+        _length += length;
+    }
+
+    void fill(char c, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            put(c);
+        }
+    }
+
+    //! @brief '\0'を付けて，全体の長さを返す
+    std::size_t finish()
+    {
+        if (_size > 0)
+        {
+            _buffer[std::min(_length, _size - 1)] = '\0';
+        }
+        return _length;
+    }
+};
+
+//! @brief 符号なし整数を10進数(か16進数)にして，endの前に後ろの桁から書き込む
+//! @return 書き込んだ先頭
+char* write_digits(uint64_t value, char* end, unsigned base = 10, bool upper = false)
+{
+    const char* const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    if (base == 16)
+    {
+        do
+        {
+            *--end = digits[value & 0xF];
+            value >>= 4;
+        } while (value != 0);
+        return end;
+    }
+    // 32bitに入る部分は32bitで割る (picoでは64bitの割り算はソフトウェアで遅い)
+    while (value > UINT32_MAX)
+    {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    uint32_t small = static_cast<uint32_t>(value);
+    do
+    {
+        *--end = static_cast<char>('0' + small % 10);
+        small /= 10;
+    } while (small != 0);
+    return end;
+}
+
+//! @brief 符号と数字を，幅に合わせて書き込む
+//! @param sign 符号 (なければ'\0')
+//! @param prefix 0xなど (なければnullptr)
+//! @param digits 数字
+//! @param zeros 数字の前に足す0の数 (精度による)
+void write_number(Writer& out, const Spec& spec, char sign, const char* prefix, const char* digits, std::size_t length, int zeros)
+{
+    const int prefix_length = prefix ? static_cast<int>(std::strlen(prefix)) : 0;
+    const int body = (sign ? 1 : 0) + prefix_length + zeros + static_cast<int>(length);
+    const int pad = std::max(spec.width - body, 0);
+    if (!spec.left && !spec.zero)
+    {
+        out.fill(' ', pad);
+    }
+    if (sign)
+    {
+        out.put(sign);
+    }
+    if (prefix)
+    {
+        out.put(prefix, prefix_length);
+    }
+    if (!spec.left && spec.zero)
+    {
+        out.fill('0', pad);
+    }
+    out.fill('0', zeros);
+    out.put(digits, length);
+    if (spec.left)
+    {
+        out.fill(' ', pad);
+    }
+}
+
+//! @brief 正の数の符号
+char positive_sign(const Spec& spec)
+{
+    return spec.plus ? '+' : (spec.space ? ' ' : '\0');
+}
+
+//! @brief 整数のバイト数 (長さの指定がなければ，渡された型をsnprintfと同じくintに広げたバイト数)
+int integer_bytes(const Spec& spec, const FormatArg& arg)
+{
+    return (spec.length > 0) ? spec.length : std::max(arg.size(), static_cast<int>(sizeof(int)));
+}
+
+//! @brief 符号なし整数として取得し，バイト数より上の桁を切り捨てる (intの-1は%xでffffffffになる)
+uint64_t unsigned_value(const Spec& spec, const FormatArg& arg)
+{
+    const int bytes = integer_bytes(spec, arg);
+    const uint64_t value = arg.as_uint();
+    return (bytes < 8) ? (value & ((uint64_t{1} << (bytes * 8)) - 1)) : value;
+}
+
+//! @brief 符号付き整数として取得し，バイト数の最上位ビットを符号にする (%hhdの200は-56になる)
+int64_t signed_value(const Spec& spec, const FormatArg& arg)
+{
+    const int bytes = integer_bytes(spec, arg);
+    if (bytes >= 8)
+        return arg.as_int();
+    const int shift = 64 - bytes * 8;
+    return static_cast<int64_t>(arg.as_uint() << shift) >> shift;
+}
+
+void write_integer(Writer& out, Spec spec, const FormatArg& arg)
+{
+    char sign = '\0';
+    uint64_t value;
+    const bool is_signed = (spec.conversion == 'd' || spec.conversion == 'i');
+    if (is_signed)
+    {
+        const int64_t number = signed_value(spec, arg);
+        value = (number < 0) ? (~static_cast<uint64_t>(number) + 1) : static_cast<uint64_t>(number);
+        sign = (number < 0) ? '-' : positive_sign(spec);
+    } else {
+        value = unsigned_value(spec, arg);
+    }
+    const bool hex = (spec.conversion == 'x' || spec.conversion == 'X');
+    char digits[24];
+    char* const end = digits + sizeof(digits);
+    char* begin = write_digits(value, end, hex ? 16 : 10, spec.conversion == 'X');
+    if (spec.precision == 0 && value == 0)
+    {
+        begin = end;  // printfと同じく，精度0の0は何も書かない
+    }
+    const std::size_t length = static_cast<std::size_t>(end - begin);
+    int zeros = 0;
+    if (spec.precision >= 0)
+    {
+        zeros = std::max(spec.precision - static_cast<int>(length), 0);
+        spec.zero = false;  // 精度を指定したときは0で埋めない
+    }
+    const char* prefix = (hex && spec.alt && value != 0) ? ((spec.conversion == 'X') ? "0X" : "0x") : nullptr;
+    write_number(out, spec, sign, prefix, begin, length, zeros);
+}
+
+void write_string(Writer& out, const Spec& spec, const char* text)
+{
+    if (text == nullptr)
+    {
+        text = "(null)";
+    }
+    std::size_t length = 0;
+    while (text[length] != '\0' && (spec.precision < 0 || length < static_cast<std::size_t>(spec.precision)))
+    {
+        ++length;
+    }
+    const int pad = std::max(spec.width - static_cast<int>(length), 0);
+    if (!spec.left)
+    {
+        out.fill(' ', pad);
+    }
+    out.put(text, length);
+    if (spec.left)
+    {
+        out.fill(' ', pad);
+    }
+}
+
+//! @brief 自分で変換できない指定をsnprintfに任せる
+void write_by_snprintf(Writer& out, const Spec& spec, const FormatArg& arg)
+{
+    // 変換指定を作り直す (整数は切り詰めてからlong longで渡すので，長さの指定はllにする)
+    char format[32];
+    char* p = format;
+    *p++ = '%';
+    if (spec.left) *p++ = '-';
+    if (spec.plus) *p++ = '+';
+    if (spec.space) *p++ = ' ';
+    if (spec.zero) *p++ = '0';
+    if (spec.alt) *p++ = '#';
+    p += std::snprintf(p, format + sizeof(format) - p, "%d", spec.width);
+    if (spec.precision >= 0)
+    {
+        p += std::snprintf(p, format + sizeof(format) - p, ".%d", spec.precision);
+    }
+    const bool floating = std::strchr("fFeEgGaA", spec.conversion) != nullptr;
+    if (!floating && spec.conversion != 'c')
+    {
+        *p++ = 'l';
+        *p++ = 'l';
+    }
+    *p++ = spec.conversion;
+    *p = '\0';
+
+    const auto run = [&](char* buffer, std::size_t size)
+    {
+        if (floating)
+            return std::snprintf(buffer, size, format, arg.as_double());
+        if (spec.conversion == 'c')
+            return std::snprintf(buffer, size, format, static_cast<int>(arg.as_int()));
+        return std::snprintf(buffer, size, format, static_cast<unsigned long long>(unsigned_value(spec, arg)));  // %oなど
+    };
+    char text[64];
+    const int length = run(text, sizeof(text));
+    if (length < 0)
+        return;
+    if (static_cast<std::size_t>(length) < sizeof(text))
+    {
+        out.put(text, length);
+    } else {
+        std::string long_text(length, '\0');  // 幅がとても大きいときなど
+        run(long_text.data(), long_text.size() + 1);
+        out.put(long_text.data(), long_text.size());
+    }
+}
+
+void write_fixed(Writer& out, Spec spec, const FormatArg& arg)
+{
+    const double value = arg.as_double();
+    const int precision = (spec.precision < 0) ? 6 : spec.precision;
+    const double magnitude = std::fabs(value);
+    if (!std::isfinite(value) || precision > MaxFastPrecision || magnitude >= MaxFastValue)
+    {
+        write_by_snprintf(out, spec, arg);
+        return;
+    }
+    // 整数部分と，小数部分×10^precision を整数にする (小数部分を引く計算は誤差がない)
+    uint64_t integer = static_cast<uint64_t>(magnitude);
+    const double scaled = (magnitude - static_cast<double>(integer)) * Pow10[precision];
+    uint32_t fraction = static_cast<uint32_t>(scaled);
+    double over_half = scaled - fraction - 0.5;  // 正なら切り上げ，負なら切り捨て
+    if (std::fabs(over_half) < 1e-6)
+    {
+        // 掛け算の誤差で丸める向きが変わらないように，半分との差をfmaで正確に求め直す (printfと同じく正確な10進の値で丸める)
+        over_half = std::fma(magnitude - static_cast<double>(integer), Pow10[precision], -(fraction + 0.5));
+    }
+    const bool odd = (precision > 0) ? (fraction & 1) : (integer & 1);  // 最後の桁が奇数か
+    if (over_half > 0 || (over_half == 0 && odd))  // 最も近い方へ，ちょうど半分なら偶数へ丸める
+    {
+        ++fraction;
+    }
+    if (fraction >= Pow10[precision])
+    {
+        fraction -= Pow10[precision];  // 0.9999...が繰り上がった
+        ++integer;
+    }
+
+    char digits[40];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    if (precision > 0)
+    {
+        begin = write_digits(fraction, end);
+        while (end - begin < precision)
+        {
+            *--begin = '0';
+        }
+        *--begin = '.';
+    } else if (spec.alt) {
+        *--begin = '.';
+    }
+    begin = write_digits(integer, begin);
+    const char sign = std::signbit(value) ? '-' : positive_sign(spec);
+    write_number(out, spec, sign, nullptr, begin, static_cast<std::size_t>(end - begin), 0);
+}
+
+}
+
+/***** class FormatArg *****/
+
+int64_t FormatArg::as_int() const
+{
+    switch (_type)
+    {
+        case Type::Int: return _value.i;
+        case Type::Uint: return static_cast<int64_t>(_value.u);
+        case Type::Double: return static_cast<int64_t>(_value.d);
+        case Type::String: return reinterpret_cast<intptr_t>(_value.s);
+        case Type::Pointer: return reinterpret_cast<intptr_t>(_value.p);
+    }
+    return 0;
+}
+
+uint64_t FormatArg::as_uint() const
+{
+    return static_cast<uint64_t>(as_int());
+}
+
+double FormatArg::as_double() const
+{
+    switch (_type)
+    {
+        case Type::Int: return static_cast<double>(_value.i);
+        case Type::Uint: return static_cast<double>(_value.u);
+        case Type::Double: return _value.d;
+        default: return 0.0;
+    }
+}
+
+const void* FormatArg::as_pointer() const
+{
+    switch (_type)
+    {
+        case Type::String: return _value.s;
+        case Type::Pointer: return _value.p;
+        default: return reinterpret_cast<const void*>(static_cast<uintptr_t>(as_uint()));
+    }
+}
+
+
+std::size_t format_args_to(char* buffer, std::size_t size, const char* format, const FormatArg* args, std::size_t arg_num)
+{
+    Writer out(buffer, size);
+    std::size_t next = 0;  // 次に使う引数
+    const auto next_int = [&]() {return (next < arg_num) ? static_cast<int>(args[next++].as_int()) : 0;};
+    const char* p = format;
+    while (*p != '\0')
+    {
+        // %までをまとめて書き込む
+        const char* const literal = p;
+        while (*p != '\0' && *p != '%')
+        {
+            ++p;
+        }
+        out.put(literal, static_cast<std::size_t>(p - literal));
+        if (*p == '\0')
+            break;
+        ++p;  // %
+
+        Spec spec;
+        for (;; ++p)
+        {
+            if (*p == '-') spec.left = true;
+            else if (*p == '+') spec.plus = true;
+            else if (*p == ' ') spec.space = true;
+            else if (*p == '0') spec.zero = true;
+            else if (*p == '#') spec.alt = true;
+            else break;
+        }
+        if (*p == '*')
+        {
+            spec.width = next_int();
+            if (spec.width < 0)
+            {
+                spec.left = true;
+                spec.width = -spec.width;
+            }
+            ++p;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            spec.width = spec.width * 10 + (*p++ - '0');
+        }
+        if (*p == '.')
+        {
+            ++p;
+            spec.precision = 0;
+            if (*p == '*')
+            {
+                spec.precision = next_int();
+                ++p;
+            }
+            while (*p >= '0' && *p <= '9')
+            {
+                spec.precision = spec.precision * 10 + (*p++ - '0');
+            }
+        }
+        // 長さの指定は，整数を切り詰めるバイト数にする (引数の型は分かっているので，読み込み方は変えない)
+        if (*p == 'h' || *p == 'l')
+        {
+            const char modifier = *p++;
+            const bool twice = (*p == modifier);
+            if (twice)
+                ++p;
+            if (modifier == 'h')
+                spec.length = twice ? sizeof(char) : sizeof(short);
+            else
+                spec.length = twice ? sizeof(long long) : sizeof(long);
+        } else if (*p == 'j' || *p == 'q') {
+            spec.length = sizeof(intmax_t);
+            ++p;
+        } else if (*p == 'z') {
+            spec.length = sizeof(std::size_t);
+            ++p;
+        } else if (*p == 't') {
+            spec.length = sizeof(std::ptrdiff_t);
+            ++p;
+        } else if (*p == 'L') {
+            ++p;  // long double (小数はdoubleで変換する)
+        }
+        spec.conversion = *p;
+        if (spec.conversion == '\0')
+            break;
+        ++p;
+        if (spec.left)
+        {
+            spec.zero = false;
+        }
+
+        if (spec.conversion == '%')
+        {
+            out.put('%');
+            continue;
+        }
+        if (next >= arg_num)
+            continue;  // 引数が足りない (snprintfでは未定義の動作)
+        const FormatArg& arg = args[next++];
+        switch (spec.conversion)
+        {
+            case 'd': case 'i': case 'u': case 'x': case 'X':
+                write_integer(out, spec, arg);
+                break;
+            case 'f': case 'F':
+                write_fixed(out, spec, arg);
+                break;
+            case 's':
+                write_string(out, spec, arg.as_string());
+                break;
+            case 'c':
+            {
+                const char c = static_cast<char>(arg.as_int());
+                const int pad = std::max(spec.width - 1, 0);
+                if (!spec.left) out.fill(' ', pad);
+                out.put(c);
+                if (spec.left) out.fill(' ', pad);
+                break;
+            }
+            case 'p':
+            {
+                spec.alt = true;
+                spec.conversion = 'x';
+                write_integer(out, spec, FormatArg(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(arg.as_pointer()))));
+                break;
+            }
+            default:
+                write_by_snprintf(out, spec, arg);  // %e %g %o など
+                break;
+        }
+    }
+    return out.finish();
+}
+
+}
@@ -0,0 +1,115 @@
+/**************************************************
+ * 飛行中の入力を記録(トレース)するためのコードです
+ * このファイルは，trace.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，センサや通信から受け取った生のデータを，時刻付きのバイナリで記録するクラスが定義されています．
+**************************************************/
+
+//! @file trace.cpp
+//! @brief 入力の記録
+
+#include "trace.hpp"
+
+#include "hardware/sync.h"
+
+namespace sc
+{
+
+/***** class TraceRecorder *****/
+
+void TraceRecorder::start(Sink sink)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (!sink)
+    {
+throw std::invalid_argument(f_err(__FILE__, __LINE__, "No output destination for the trace"));  // 記録の出力先がありません
+    }
+    OutputSink = sink;
+    Head = 0;
+    Tail = 0;
+    Enabled = true;
+}
+
+void TraceRecorder::stop()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    Enabled = false;
+    flush();
+}
+
+void SC_ISR_FUNC(TraceRecorder::record)(TraceType type, uint8_t id, uint8_t sub, const uint8_t* data, std::size_t size, uint64_t time_us)
+{
+    if (!Enabled)
+        return;
+    do
+    {
+        // 長いデータは，TraceMaxDataバイトずつ分けて記録する
+        const std::size_t chunk = std::min(size, TraceMaxData);
+        const uint8_t header[TraceHeaderSize] = {TraceSync, static_cast<uint8_t>(type), id, sub, static_cast<uint8_t>(chunk),
+            static_cast<uint8_t>(time_us), static_cast<uint8_t>(time_us >> 8), static_cast<uint8_t>(time_us >> 16), static_cast<uint8_t>(time_us >> 24)};
+
+        const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする
+        const std::size_t used = (Tail - Head) & (BufferSize - 1);
+        if (used + TraceHeaderSize + chunk >= BufferSize)
+        {
+            Dropped = Dropped + 1;  // 入りきらないときは記録ごと捨てる (途中で切れた記録を残さない)
+        } else {
+            std::size_t tail = Tail;
+            for (const uint8_t byte : header)
+            {
+                Buffer[tail] = byte;
+                tail = (tail + 1) & (BufferSize - 1);
+            }
+            for (std::size_t i = 0; i < chunk; ++i)
+            {
+                Buffer[tail] = data[i];
+                tail = (tail + 1) & (BufferSize - 1);
+            }
+            Tail = tail;
+        }
+        ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+
+        data += chunk;
+        size -= chunk;
+    } while (size > 0);
+}
+
+void TraceRecorder::record(TraceType type, uint8_t id, uint8_t sub, const uint8_t* data, std::size_t size)
+{
+    if (!Enabled)
+        return;
+    record(type, id, sub, data, size, ::time_us_64());  // pico-SDKの関数  起動からの時間(μs)を取得
+}
+
+void TraceRecorder::marker(const std::string& text)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    record(TraceType::Marker, 0, 0, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+void TraceRecorder::flush()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl;
+    #endif
+    if (!OutputSink)
+        return;
+    // 書き込む間は割り込みを止めないので，この時点までにたまった分だけを書き込む
+    // (record()はHeadより前には書き込まないので，書き込み中の部分は上書きされない)
+    const std::size_t tail = Tail;
+    while (Head != tail)
+    {
+        const std::size_t head = Head;
+        const std::size_t end = (head < tail) ? tail : BufferSize;  // リングバッファの末尾で折り返す
+        OutputSink(Buffer.data() + head, end - head);
+        Head = end & (BufferSize - 1);
+    }
+}
+
+}
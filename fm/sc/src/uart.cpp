@@ -10,6 +10,10 @@
 
 #include "uart.hpp"
 
+#include "hardware/sync.h"
+
+#include "trace.hpp"
+
 namespace sc
 {
 
@@ -143,57 +147,98 @@ catch (const std::exception& e)
 }
 
 void UART::write(Binary output_data) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    write(BinaryView(output_data));
+}
+
+void UART::write(BinaryView output_data) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    ::uart_write_blocking((_uart_id ? uart1 : uart0), output_data, output_data.size());  // pico-SDKの関数  UARTで送信
+    ::uart_write_blocking((_uart_id ? uart1 : uart0), output_data.data(), output_data.size());  // pico-SDKの関数  UARTで送信
 }
 
 Binary UART::read() const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    StaticBinary<MaxInputLen> input_data;
+    read(input_data);
+    return Binary(input_data.data(), input_data.size());  // 割り込み処理で一時保存しておいたデータを返す
+}
+
+std::size_t UART::read(uint8_t* input_data, std::size_t size) const
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     if (save == false)
         throw std::logic_error(f_err(__FILE__, __LINE__, "Cannot execute because initialization failed"));
-    std::deque<uint8_t> other_data(0);
-    std::swap((_uart_id ? uart1_queue : uart0_queue), other_data);
-    return sc::Binary(other_data);  // 割り込み処理で一時保存しておいたデータを返す
+    return *try_read(input_data, size);
+}
+
+Result<std::size_t> UART::try_read(uint8_t* input_data, std::size_t size) const
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (save == false)
+return Error(ErrorSource::UART, ErrorCode::NotInitialized, __FILE__, __LINE__);
+    InputBuffer& buffer = (_uart_id ? uart1_buffer : uart0_buffer);
+    std::size_t input_size = 0;  // 実際に書き込んだバイト数
+    const uint32_t ints = ::save_and_disable_interrupts();  // pico-SDKの関数  割り込みを無効にする (読んでいる途中で古いデータを捨てられないようにする)
+    while (input_size < size && buffer.head != buffer.tail)
+    {
+        input_data[input_size++] = buffer.data[buffer.head];
+        buffer.head = (buffer.head + 1) % buffer.data.size();
+    }
+    ::restore_interrupts(ints);  // pico-SDKの関数  割り込みを元に戻す
+    if (input_size > 0)
+    {
+        TraceRecorder::record(TraceType::UART, _uart_id, 0, input_data, input_size);  // 受信したデータを記録
+    }
+    return input_size;
+}
+
+void SC_ISR_FUNC(UART::InputBuffer::push)(uint8_t byte)
+{
+    data[tail] = byte;
+    tail = (tail + 1) % data.size();
+    if (tail == head)
+    {
+        head = (head + 1) % data.size();  // データが多すぎるときは一番古いデータを捨てる
+    }
 }
 
 
 //! @brief 割り込み処理でUART0の受信をする際に呼び出される関数
-void UART::uart0_handler()
+void SC_ISR_FUNC(UART::uart0_handler)()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     while (uart_is_readable(uart0))
     {
-        uart0_queue.push_back(uart_getc(uart0));  // 1文字読み込んで末尾に値を追加
-    }
-    if (uart0_queue.size() > MaxInputLen)
-    {
-        uart0_queue.erase(uart0_queue.begin(), uart0_queue.begin() + (uart0_queue.size() - MaxInputLen));  // データが多すぎるときは一部を削除
+        uart0_buffer.push(uart_getc(uart0));  // 1文字読み込んで末尾に値を追加
     }
 }
 
 //! @brief 割り込み処理でUART1の受信をする際に呼び出される関数
-void UART::uart1_handler()
+void SC_ISR_FUNC(UART::uart1_handler)()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
     while (uart_is_readable(uart1))
     {
-        uart1_queue.push_back(uart_getc(uart1));  // 1文字読み込んで末尾に値を追加
-    }
-    if (uart1_queue.size() > MaxInputLen)
-    {
-        uart1_queue.erase(uart1_queue.begin(), uart1_queue.begin() + (uart1_queue.size() - MaxInputLen));  // データが多すぎるときは一部を削除
+        uart1_buffer.push(uart_getc(uart1));  // 1文字読み込んで末尾に値を追加
     }
 }
 
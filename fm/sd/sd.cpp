@@ -3,7 +3,16 @@
 namespace sc 
 {
 
-SD::SD() try
+namespace
+{
+
+// 圧縮のためのRAM(約8KB)はスタックに置けないので，ここに置く (SDは1つしか作らない)
+LzssEncoder Encoder;
+
+}
+
+SD::SD(bool compress) try :
+    _compress(compress)
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -18,8 +27,9 @@ SD::SD() try
         {
             SD::save = false;
             print("\n********************\n\n<<!! INIT ERRPR !!>> in %s line %d\n\n********************\n", __FILE__, __LINE__);
-            print(f_err(__FILE__, __LINE__, "f_mount error: %s (%d)\n", FRESULT_str(fr), fr));
+            print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_mount error: %s (%d)\n", FRESULT_str(fr), fr));
         }
+        Encoder.set_sink([this](const uint8_t* block){write_block(block);});
     }
     catch(const std::exception& e)
     {
@@ -33,6 +43,8 @@ catch (const std::exception& e)
 
 SD::~SD()
 {
+    sync();
+    Encoder.set_sink(nullptr);
     f_unmount(pSD->pcName);
 }
 
@@ -47,23 +59,103 @@ void SD::write(const std::string& write_str)
         return;
     }
 
+    if (_compress)
+    {
+        // 1セクタ分たまるまでは，SDカードに書き込まない
+        Encoder.write(write_str);
+        return;
+    }
+
     FIL fil;
     fr = f_open(&fil, filename, FA_OPEN_APPEND | FA_WRITE);
     if (FR_OK != fr && FR_EXIST != fr)
     {
         SD::save = false;
-        print(f_err(__FILE__, __LINE__, "f_open(%s) error: %s (%d)\n", filename, FRESULT_str(fr), fr));
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_open(%s) error: %s (%d)\n", filename, FRESULT_str(fr), fr));
         return;
     }
     if (f_printf(&fil, write_str.c_str()) < 0) {
         SD::save = false;
-        print(f_err(__FILE__, __LINE__, "f_printf failed\n"));
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_printf failed\n"));
+        return;
+    }
+    fr = f_close(&fil);
+    if (FR_OK != fr) {
+        SD::save = false;
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_close error: %s (%d)\n", FRESULT_str(fr), fr));
+        return;
+    }
+}
+
+void SD::sync()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    if (!_compress)
+        return;
+    Encoder.finish();
+    if (_sector_size > 0)
+    {
+        append(filename, _sector.data(), _sector_size);  // ブロック単位なので，セクタの途中まででも展開できる
+        _sector_size = 0;
+    }
+}
+
+void SD::write_block(const uint8_t* block)
+{
+    std::copy(block, block + LzssBlockSize, _sector.begin() + _sector_size);
+    _sector_size += LzssBlockSize;
+    if (_sector_size == _sector.size())
+    {
+        append(filename, _sector.data(), _sector_size);
+        _sector_size = 0;
+    }
+}
+
+void SD::write_trace(const uint8_t* data, std::size_t size)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    append(trace_filename, data, size);
+}
+
+void SD::write_series(const uint8_t* data, std::size_t size)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    append(series_filename, data, size);
+}
+
+void SD::append(const char* name, const uint8_t* data, std::size_t size)
+{
+    if (SD::save == false)
+    {
+        return;
+    }
+
+    FIL fil;
+    fr = f_open(&fil, name, FA_OPEN_APPEND | FA_WRITE);
+    if (FR_OK != fr && FR_EXIST != fr)
+    {
+        SD::save = false;
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_open(%s) error: %s (%d)\n", name, FRESULT_str(fr), fr));
+        return;
+    }
+    UINT written = 0;  // 実際に書き込んだバイト数
+    fr = f_write(&fil, data, size, &written);
+    if (FR_OK != fr || written != size) {
+        SD::save = false;
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_write error: %s (%d)\n", FRESULT_str(fr), fr));
+        f_close(&fil);
         return;
     }
     fr = f_close(&fil);
     if (FR_OK != fr) {
         SD::save = false;
-        print(f_err(__FILE__, __LINE__, "f_close error: %s (%d)\n", FRESULT_str(fr), fr));
+        print(LogLevel::Error, LogModule::SD, f_err(__FILE__, __LINE__, "f_close error: %s (%d)\n", FRESULT_str(fr), fr));
         return;
     }
 }
@@ -15,6 +15,8 @@
 
 #include "sc.hpp"
 
+#include <array>
+
 namespace sc 
 {
 
@@ -24,15 +26,43 @@ class SD
 {
     sd_card_t *pSD;
     FRESULT fr;
-    std::string filename_str = std::string("log_") + __DATE__[4] + __DATE__[5] + '_' + __TIME__[0] + __TIME__[1] + __TIME__[3] + __TIME__[4] + ".txt";
+    const bool _compress;  // ログを圧縮するか
+    std::string filename_str = std::string("log_") + __DATE__[4] + __DATE__[5] + '_' + __TIME__[0] + __TIME__[1] + __TIME__[3] + __TIME__[4] + (_compress ? ".lzs" : ".txt");
     const char* filename = filename_str.c_str();
+    std::string trace_filename_str = std::string("trace_") + __DATE__[4] + __DATE__[5] + '_' + __TIME__[0] + __TIME__[1] + __TIME__[3] + __TIME__[4] + ".bin";
+    const char* trace_filename = trace_filename_str.c_str();
+    std::string series_filename_str = std::string("series_") + __DATE__[4] + __DATE__[5] + '_' + __TIME__[0] + __TIME__[1] + __TIME__[3] + __TIME__[4] + ".bin";
+    const char* series_filename = series_filename_str.c_str();
+    std::array<uint8_t, 512> _sector{};  // 圧縮したログを1セクタ分ためておく
+    std::size_t _sector_size = 0;  // _sectorに入れたバイト数
+
+    //! @brief ファイルの後ろにバイナリを追記
+    void append(const char* name, const uint8_t* data, std::size_t size);
+    //! @brief 圧縮したブロックを_sectorに加え，いっぱいになったら書き込む
+    void write_block(const uint8_t* block);
 public:
-    SD();
+    //! @brief SDカードをマウント
+    //! @param compress trueならログをLzssEncoderで圧縮し，1セクタ(512バイト)ずつlog_....lzsに追記する (PCのツール(fm/traceのLOG_DECODE)で展開する)
+    //!                 falseなら文字列のままlog_....txtに追記する
+    explicit SD(bool compress = true);
 
     ~SD();
 
     void write(const std::string& write_str);
 
+    //! @brief 圧縮の途中のログと，たまっているセクタを書き込む (ゴールしたときなど，ログが止まる前に呼ぶ)
+    void sync();
+
+    //! @brief 入力の記録(トレース)をバイナリのまま別のファイルに追記
+    //! @param data 書き込むデータ
+    //! @param size データのバイト数
+    void write_trace(const uint8_t* data, std::size_t size);
+
+    //! @brief SeriesEncoderが出力したセンサの測定値のブロックを，別のファイルに追記 (PCのツール(fm/traceのSERIES_DECODE)で読む)
+    //! @param data 書き込むブロック
+    //! @param size ブロックのバイト数
+    void write_series(const uint8_t* data, std::size_t size);
+
     static inline bool save = true;  // 正常に動作しているか
 };
 
@@ -0,0 +1,411 @@
+/**************************************************
+ * ミッション全体をPCでシミュレーションするためのコードです
+ * このファイルは，flight.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，plant.hppの物理モデルの状態にノイズを加えてセンサの値を作り，
+ * fm.cppと同じMissionLoop(mission_loop.hpp)でフェーズを進めるシミュレータが定義されています．
+ * センサを読む順番やフェーズを移行する条件はMissionLoopにしかないので，fm.cppとずれることはありません．
+**************************************************/
+
+//! @file flight.cpp
+//! @brief 1回分の飛行のシミュレーション
+
+#include "flight.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <tuple>
+
+#include "mission_loop.hpp"
+#include "navigation.hpp"
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr double ActuatorStep = 0.01;  // MotorActuatorの出力の変化を計算する間隔 (s)
+constexpr double LoopCost = 0.03;  // 1回のループで表示やセンサの読み取りにかかる時間 (s)
+constexpr double RampRate = 4.0;  // MotorActuatorの1秒あたりの出力の変化の最大値
+constexpr double ConeRadius = 0.1;  // ゴールのコーンの半径 (m)
+constexpr double CameraRange = 8.0;  // カメラでコーンが見える距離 (m)
+constexpr double GoalLat = 30.37427937 * PI / 180.0;  // ゴールの緯度 (rad)  fm.cppと同じ
+constexpr double GoalLon = 130.95994488 * PI / 180.0;  // ゴールの経度 (rad)
+constexpr double EarthRadius = 6'378'137.0;  // 緯度経度に戻すための地球の半径 (m)
+constexpr double RebootTime = 1.0;  // リセットしてからループに戻るまでの時間 (BNO055の起動待ちなど) (s)
+
+//! @brief 角度を-π ~ +πに正規化
+double wrap(double angle)
+{
+    angle = std::fmod(angle + PI, 2.0 * PI);
+    if (angle < 0.0)
+        angle += 2.0 * PI;
+    return angle - PI;
+}
+
+//! @brief scのベクトル量を作る
+Acceleration<Unit::m_s2> accel(double x, double y, double z)
+    {return Acceleration<Unit::m_s2>(dimension::m_s2(x), dimension::m_s2(y), dimension::m_s2(z));}
+
+//! @brief MotorActuatorと同じように，予約された動作を順に進めるモデル
+class Actuator
+{
+    struct Command
+    {
+        float left, right;
+        double time;
+    };
+    std::array<Command, 8> _commands{};  // 予約された動作 (MotorActuatorと同じく8個まで)
+    std::size_t _count = 0;
+    double _elapsed = 0;  // 先頭の動作を始めてからの時間 (s)
+    float _run_left = 0, _run_right = 0;  // runで指定した出力
+    float _left = 0, _right = 0;  // 今の出力
+
+public:
+    void run(float left, float right)
+    {
+        _count = 0;
+        _run_left = left;
+        _run_right = right;
+    }
+    //! @brief ランプ制御をせずに，すぐに出力を変える
+    void run_now(float left, float right)
+    {
+        run(left, right);
+        _left = left;
+        _right = right;
+    }
+    void run_for(float left, float right, Time<Unit::s> time)
+    {
+        if (_count == _commands.size())
+            return;  // 予約がいっぱいなら無視される
+        if (_count == 0)
+            _elapsed = 0;
+        _commands[_count++] = Command{left, right, double(time)};
+    }
+    void stop()
+        {run(0, 0);}
+    bool busy() const
+        {return _count > 0;}
+    //! @brief 止まっていて，予約もないか
+    bool idle() const
+        {return _count == 0 && _left == 0 && _right == 0 && _run_left == 0 && _run_right == 0;}
+    std::tuple<float, float> output() const
+        {return {_left, _right};}
+
+    //! @brief 時間を進める
+    void update(double dt)
+    {
+        float target_left = _run_left, target_right = _run_right;
+        if (_count > 0)
+        {
+            target_left = _commands[0].left;
+            target_right = _commands[0].right;
+            _elapsed += dt;
+            if (_elapsed >= _commands[0].time)
+            {
+                std::move(_commands.begin() + 1, _commands.begin() + _count, _commands.begin());
+                --_count;
+                _elapsed = 0;
+            }
+        }
+        const float step = static_cast<float>(RampRate * dt);
+        _left += std::clamp(target_left - _left, -step, step);
+        _right += std::clamp(target_right - _right, -step, step);
+    }
+};
+
+//! @brief 1回分の飛行
+//! @note fm.cppのFmIoの代わりにMissionLoopへセンサとモーターを渡す
+class Flight
+{
+    friend class MissionLoop<Flight>;
+    using Imu = std::tuple<Acceleration<Unit::m_s2>, Acceleration<Unit::m_s2>, MagneticFluxDensity<Unit::T>, AngularVelocity<Unit::rad_s>>;
+
+    const FlightScenario& _s;
+    const Mission _mission;
+    Random _random;
+
+    Plant _plant;  // 真の状態
+    double _leak_until = -1;  // この時刻までキャリアに光が漏れている (s)
+    double _next_reset;  // 次にリセットされる時刻 (s)
+
+    LocalNavigator _navigator{Latitude<Unit::rad>(GoalLat), Longitude<Unit::rad>(GoalLon)};
+    Actuator _actuator;
+    std::optional<MissionLoop<Flight>> _loop;  // fm.cppと同じフェーズを進める処理 (リセットしたら作り直す)
+    Phase _saved_phase = Phase::Wait;  // Checkpointに保存したフェーズ
+    uint64_t _saved_elapsed_us = 0;  // Checkpointに保存した経過時間 (μs)
+
+public:
+    Flight(const MissionParams& params, const FlightScenario& scenario, uint64_t seed) :
+        _s(scenario), _mission(params), _random(seed), _plant(scenario.plant), _next_reset(draw_reset(0))
+    {
+        _loop.emplace(*this, _mission, _navigator, Phase::Wait, now_us());
+    }
+
+    FlightResult run(double time_limit)
+    {
+        FlightResult result;
+        result.release_time = _s.plant.release_time;
+        while (now() < time_limit && !result.goal)
+        {
+            if (now() >= _next_reset)
+            {
+                reboot();
+                ++result.resets;
+            }
+            // fm.cppと同じく，ループの最初にフェーズと経過時間を保存する
+            _saved_phase = _loop->phase();
+            _saved_elapsed_us = _loop->elapsed_us();
+            advance(LoopCost);
+            const Phase before = _loop->phase();
+            result.goal = _loop->step();
+            const Phase phase = _loop->phase();
+            if (phase != before)
+            {
+                if (phase == Phase::Fall)
+                {
+                    result.fall_time = now();
+                    result.early_fall = (now() < _s.plant.release_time);
+                } else if (phase == Phase::Ldistance) {
+                    result.ldistance_time = now();
+                } else if (phase == Phase::Sdistance) {
+                    result.sdistance_time = now();
+                }
+            }
+        }
+        if (result.goal)
+            result.goal_time = now();
+        result.landing_time = _plant.landing_time();
+        result.early_ldistance = (result.ldistance_time >= 0 && (!_plant.landed() || result.ldistance_time < _plant.landing_time()));
+        result.final_distance = std::max(0.0, _plant.goal_view().distance - ConeRadius);
+        return result;
+    }
+
+private:
+    /***** 真の状態 *****/
+
+    //! @brief 電源を入れてからの時間 (s)
+    double now() const
+        {return _plant.time();}
+
+    //! @brief 電源を入れてからの時間 (μs)  MissionLoopの時計
+    uint64_t now_us() const
+        {return static_cast<uint64_t>(std::llround(now() * 1e6));}
+
+    //! @brief 次にリセットされる時刻 (指数分布)
+    double draw_reset(double from)
+    {
+        if (_s.reset_rate <= 0)
+            return std::numeric_limits<double>::infinity();
+        return from - std::log(1.0 - _random.uniform()) / _s.reset_rate;
+    }
+
+    //! @brief リセットして，fm.cppのsetupからやり直す
+    //! @note モーターは止まり，MissionLoopは作り直される  resumeなら，Checkpointに保存したフェーズと経過時間だけが引き継がれる
+    void reboot()
+    {
+        _actuator = Actuator();
+        advance(RebootTime);
+        const Phase phase = _s.resume ? _saved_phase : Phase::Wait;
+        const uint64_t elapsed_us = _s.resume ? _saved_elapsed_us : 0;
+        _loop.emplace(*this, _mission, _navigator, phase, now_us() - elapsed_us);
+        _next_reset = draw_reset(now());
+    }
+
+    //! @brief 時間を進める  MotorActuatorの出力を物理モデルに渡しながら進める
+    void advance(double dt)
+    {
+        const double end = now() + dt;
+        while (now() < end)
+        {
+            if (_actuator.idle())
+            {
+                // モーターが止まっている間は出力が変わらないので，物理モデルに一度に任せる
+                _plant.set_duty(0.0F, 0.0F);
+                _plant.advance(end - now());
+                return;
+            }
+            const double h = std::min(ActuatorStep, end - now());
+            _actuator.update(h);
+            const auto [left, right] = _actuator.output();
+            _plant.set_duty(left, right);
+            _plant.advance(h);
+        }
+    }
+
+    /***** MissionLoopに渡すセンサとモーター *****/
+
+    void sleep_until_us(uint64_t time_us)
+    {
+        if (time_us > now_us())
+            advance(double(time_us - now_us()) * 1e-6);
+    }
+
+    void set_leds(bool, bool) {}
+
+    template<typename... Args>
+    void event(const char*, Args...) {}
+
+    template<typename... Args>
+    void data(const char*, Args...) {}
+
+    void report_exception(const std::exception&) {}
+
+    bool dropout()
+        {return _random.uniform() < _s.dropout;}
+
+    std::optional<Altitude<Unit::m>> read_altitude()
+    {
+        advance(0.002);
+        if (dropout())
+            return std::nullopt;
+        return Altitude<Unit::m>(_plant.altitude() + _s.baro_noise * _random.normal());
+    }
+
+    //! @brief BNO055の線形加速度，重力加速度，地磁気，角速度 (方位はgoal_directionで真の向きから作るので，地磁気は使わない)
+    std::optional<Imu> read_imu()
+    {
+        advance(0.002);
+        if (dropout())
+            return std::nullopt;
+        const Plant::Imu imu = _plant.imu();
+        const auto rate = _plant.angular_rate();
+        const double n = _s.accel_noise;
+        const double g = _s.gyro_noise;
+        return std::make_tuple(
+            accel(imu.linear[0] + n * _random.normal(), imu.linear[1] + n * _random.normal(), imu.linear[2] + n * _random.normal()),
+            accel(imu.gravity[0], imu.gravity[1], imu.gravity[2]),
+            MagneticFluxDensity<Unit::T>(dimension::T(0), dimension::T(0), dimension::T(0)),
+            AngularVelocity<Unit::rad_s>(dimension::rad_s(rate[0] + g * _random.normal()), dimension::rad_s(rate[1] + g * _random.normal()), dimension::rad_s(rate[2] + g * _random.normal())));
+    }
+
+    //! @brief 受信の予約は失敗しないとする (失敗はcollect_imuで起こす)
+    bool request_imu()
+        {return true;}
+
+    std::optional<Imu> collect_imu()
+        {return read_imu();}
+
+    Illuminance<Unit::lx> read_lux()
+    {
+        advance(0.01);  // 10回読んで平均する
+        if (_plant.released())
+            return Illuminance<Unit::lx>(_s.sky_lux * (1.0 + 0.2 * _random.normal()));
+        if (now() >= _leak_until && _random.uniform() < _s.leak_rate * 0.1)
+            _leak_until = now() + 1.0;  // キャリアの隙間から光が漏れる
+        if (now() < _leak_until)
+            return Illuminance<Unit::lx>(_s.sky_lux * 0.5);
+        return Illuminance<Unit::lx>(std::max(0.0, _s.carrier_lux * (1.0 + 0.3 * _random.normal())));
+    }
+
+    std::optional<std::tuple<Latitude<Unit::rad>, Longitude<Unit::rad>>> read_gps()
+    {
+        advance(0.005);
+        if (dropout() || !_plant.released())
+            return std::nullopt;  // キャリアの中では受信できない
+        const auto [fix_north, fix_east] = _plant.gps_fix();
+        const double north = fix_north + _s.gps_noise * _random.normal();
+        const double east = fix_east + _s.gps_noise * _random.normal();
+        return std::make_tuple(Latitude<Unit::rad>(GoalLat + north / EarthRadius), Longitude<Unit::rad>(GoalLon + east / (EarthRadius * std::cos(GoalLat))));
+    }
+
+    //! @brief 機体の正面から反時計回りに測ったゴールの方向 (方位は真の向きにノイズを加えて作る)
+    double goal_direction(const Imu&, const GoalVector& to_goal)
+    {
+        const double compass = _plant.heading() + _s.compass_noise * _random.normal();
+        return -wrap(to_goal.bearing - compass);
+    }
+
+    GoalSight read_camera()
+    {
+        advance(0.05);
+        const Plant::GoalView view = _plant.goal_view();
+        if (_plant.upside_down() || view.distance > CameraRange)
+            return GoalSight::NotFound;
+        if (std::fabs(view.bearing) < 0.15)
+            return GoalSight::Center;
+        if (std::fabs(view.bearing) < 0.5)
+            return (view.bearing > 0) ? GoalSight::Right : GoalSight::Left;
+        return GoalSight::NotFound;
+    }
+
+    Length<Unit::m> read_sonar()
+    {
+        advance(0.03);
+        const double distance = _plant.goal_view().distance - ConeRadius;
+        return Length<Unit::m>(std::clamp(distance + _s.sonar_noise * _random.normal(), 0.02, 4.0));
+    }
+
+    //! @brief パラシュートは分離しているとする
+    bool parachute_tangled()
+        {return false;}
+
+    Actuator& motor()
+        {return _actuator;}
+
+    void play_landing()
+        {advance(8.0);}  // speaker.play_hogwarts()
+
+    void play_near_goal()
+        {advance(6.0);}  // speaker.play_starwars()
+
+    void goal() {}
+};
+
+}
+
+FlightScenario FlightScenario::random(uint64_t seed)
+{
+    Random rng(seed);
+    FlightScenario s;
+    PlantConfig& p = s.plant;
+    p.seed = mix_seed(seed);
+    p.climb_rate = rng.uniform(1.0, 4.0);
+    p.drop_height = rng.uniform(30, 120);
+    // 放出高度に着いてから2～5分で放出する (待機フェーズのwait_timeout(13分)より後に放出すると，必ず放出の前に落下フェーズに移ってしまう)
+    p.release_time = rng.uniform(2 * 60, 5 * 60) + p.drop_height / p.climb_rate;
+    p.vibration = rng.uniform(0, 3);
+    const double start = rng.uniform(20, 150);
+    const double start_dir = rng.uniform(0, 2 * PI);
+    p.start_north = start * std::cos(start_dir);
+    p.start_east = start * std::sin(start_dir);
+    p.mass = rng.uniform(0.7, 1.1);
+    p.chute_cda = rng.uniform(0.25, 0.6);
+    p.chute_delay = rng.uniform(0.3, 2.0);
+    const double wind = rng.uniform(0, 6);
+    const double wind_dir = rng.uniform(0, 2 * PI);
+    p.wind_north = wind * std::cos(wind_dir);
+    p.wind_east = wind * std::sin(wind_dir);
+    p.gust = rng.uniform(0, 2);
+    p.upside_down_chance = rng.uniform(0.1, 0.4);
+    p.righting_chance = rng.uniform(0.3, 0.9);
+    p.wheel_speed = rng.uniform(0.3, 0.6);
+    p.deadband = rng.uniform(0.05, 0.2);
+    p.sand_fraction = rng.uniform(0, 0.3);
+    p.sand_traction = rng.uniform(0.1, 0.5);
+    p.heading = rng.uniform(0, 2 * PI);
+    s.carrier_lux = rng.uniform(0, 800);
+    s.leak_rate = (rng.uniform() < 0.2) ? rng.uniform(0, 0.01) : 0.0;  // 2割はキャリアに隙間がある
+    s.sky_lux = rng.uniform(2000, 40000);
+    s.baro_noise = rng.uniform(0.2, 1.0);
+    s.accel_noise = rng.uniform(0.05, 0.4);
+    s.gyro_noise = rng.uniform(0.005, 0.05);
+    s.gps_noise = rng.uniform(0.5, 4.0);
+    s.compass_noise = rng.uniform(0.02, 0.3);
+    s.sonar_noise = rng.uniform(0.005, 0.05);
+    s.dropout = rng.uniform(0, 0.05);
+    return s;
+}
+
+FlightResult simulate_flight(const MissionParams& params, const FlightScenario& scenario, uint64_t seed, double time_limit)
+{
+    Flight flight(params, scenario, seed);
+    return flight.run(time_limit);
+}
+
+}
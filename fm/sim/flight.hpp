@@ -0,0 +1,75 @@
+#ifndef SC19_PICO_SIM_FLIGHT_HPP_
+#define SC19_PICO_SIM_FLIGHT_HPP_
+
+/**************************************************
+ * ミッション全体をPCでシミュレーションするためのコードです
+ * このファイルは，flight.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，1回分の飛行の条件(風，センサのノイズ，放出の時刻など)と，
+ * その条件でfm.cppと同じようにフェーズを進めるシミュレータが宣言されています．
+ * フェーズを進める処理はfm.cppと同じscライブラリのMissionLoop(mission_loop.hpp)をそのまま使うので，
+ * センサを読む順番，フェーズの移行の判定，高度の推定・方位制御・航法・スタックの検知はfm.cppと同じです．
+ * 機体の動きはplant.hppの物理モデルで計算し，センサの値はそこにノイズを加えて作ります．
+ * 時間は仮想の時計で進めるので，30分のミッションも数ミリ秒で終わります．
+ * ループの合間にランダムにリセットを起こし，Checkpointで保存したフェーズから再開できるかも試せます．
+**************************************************/
+
+//! @file flight.hpp
+//! @brief 1回分の飛行のシミュレーション
+
+#include <cstdint>
+
+#include "mission.hpp"
+#include "plant.hpp"
+
+namespace sc
+{
+
+//! @brief 1回分の飛行の条件 (乱数で決める)
+struct FlightScenario
+{
+    PlantConfig plant;  // 放出・降下・着地・走行の物理モデルの条件
+    double carrier_lux;  // キャリアの中の照度 (lx)
+    double leak_rate;  // キャリアの中に光が漏れて明るくなる頻度 (1/s)
+    double sky_lux;  // 放出後の照度 (lx)
+    double baro_noise;  // 気圧高度のノイズの標準偏差 (m)
+    double accel_noise;  // 加速度のノイズの標準偏差 (m/s²)
+    double gyro_noise;  // 角速度のノイズの標準偏差 (rad/s)
+    double gps_noise;  // GPSのノイズの標準偏差 (m)
+    double compass_noise;  // 方位のノイズの標準偏差 (rad)
+    double sonar_noise;  // 超音波センサのノイズの標準偏差 (m)
+    double dropout;  // センサの読み取りに失敗する確率
+    double reset_rate = 0;  // ウォッチドッグや電源の瞬断でリセットされる頻度 (1/s)  randomでは決めない
+    bool resume = true;  // リセット後にCheckpointで保存したフェーズから再開するか (falseなら待機フェーズからやり直す)
+
+    //! @brief 乱数で条件を決める
+    //! @param seed 乱数の種 (同じ種なら同じ条件になる)
+    static FlightScenario random(uint64_t seed);
+};
+
+//! @brief 1回分の飛行の結果
+struct FlightResult
+{
+    bool goal = false;  // ゴールしたか
+    double goal_time = -1;  // ゴールした時刻 (電源を入れてからの時間) (s)
+    double release_time = 0;  // 放出された時刻 (s)
+    double landing_time = 0;  // 着地した時刻 (s)
+    double fall_time = -1;  // 落下フェーズに移った時刻 (s)
+    double ldistance_time = -1;  // 遠距離フェーズに移った時刻 (s)
+    double sdistance_time = -1;  // 近距離フェーズに移った時刻 (s)
+    bool early_fall = false;  // 放出される前に落下フェーズに移ったか (誤判定)
+    bool early_ldistance = false;  // 着地する前に遠距離フェーズに移ったか (誤判定)
+    double final_distance = 0;  // 最後のゴールとの距離 (m)
+    int resets = 0;  // リセットされた回数
+};
+
+//! @brief fm.cppと同じMissionLoopでフェーズを進め，1回分の飛行をシミュレーションする
+//! @param params フェーズを移行する条件のしきい値
+//! @param scenario 飛行の条件
+//! @param seed センサのノイズの乱数の種
+//! @param time_limit これより長くかかったらゴールできなかったとみなす (s)
+FlightResult simulate_flight(const MissionParams& params, const FlightScenario& scenario, uint64_t seed, double time_limit = 45 * 60);
+
+}
+
+#endif  // SC19_PICO_SIM_FLIGHT_HPP_
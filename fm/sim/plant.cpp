@@ -0,0 +1,267 @@
+/**************************************************
+ * シミュレーションの物理モデルのコードです
+ * このファイルは，plant.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，パラシュートでの降下(重力，空気抵抗，風と突風)，着地の衝撃と転倒，
+ * 差動二輪の走行(モーターの一次遅れ，不感帯，砂地での空転)の計算が定義されています．
+**************************************************/
+
+//! @file plant.cpp
+//! @brief 降下と走行の物理モデル
+
+#include "plant.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sc
+{
+
+namespace
+{
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double RightingTime = 4.5;  // 反対向きで全力を出し続けると元に戻るかを試す時間 (MotorActuatorのランプ分だけ5秒より短い) (s)
+constexpr double SandCell = 3.0;  // 砂地かどうかを決める区画の大きさ (m)
+
+}
+
+/***** class Plant *****/
+
+Plant::Plant(const PlantConfig& config) :
+    _config(config), _random(config.seed),
+    _position{config.start_north, config.start_east, 0.0},
+    _cos(std::cos(config.heading)), _sin(std::sin(config.heading))
+{
+    _fix = {_position[0], _position[1]};
+}
+
+void Plant::set_duty(float left, float right)
+{
+    _left_duty = std::clamp(static_cast<double>(left), -1.0, 1.0);
+    _right_duty = std::clamp(static_cast<double>(right), -1.0, 1.0);
+}
+
+void Plant::advance(double dt)
+{
+    const double end = _t + dt;
+    while (_t < end)
+    {
+        if (!released())
+        {
+            // キャリアの中では機体は動かないので，放出の時刻まで一度に進める
+            _t = std::min(end, _config.release_time);
+            if (released())
+            {
+                _position[2] = _config.drop_height;
+                _velocity = {_config.wind_north, _config.wind_east, 0.0};  // キャリアは風に流されている
+            }
+            continue;
+        }
+        if (still())
+        {
+            // 止まっている間は何も変わらないので，時間だけ進める
+            _left_wheel = _right_wheel = _forward = _yaw_rate = _slip = _righting = 0;
+            _acceleration = {0.0, 0.0, 0.0};
+            _t = end;
+        } else {
+            const double h = std::min(Step, end - _t);
+            if (_landed)
+                step_ground(h);
+            else
+                step_air(h);
+            _t += h;
+        }
+        const long second = static_cast<long>(_t);
+        if (second != _fix_second)
+        {
+            _fix_second = second;
+            _fix = {_position[0], _position[1]};  // GPSは1秒ごとに位置を更新する
+        }
+    }
+}
+
+double Plant::altitude() const
+{
+    if (!released())
+    {
+        const double lift_time = _config.release_time - _config.drop_height / _config.climb_rate;  // 上昇を始める時刻
+        return std::clamp(_config.climb_rate * (_t - lift_time), 0.0, _config.drop_height);
+    }
+    return std::max(0.0, _position[2]);
+}
+
+double Plant::heading() const
+{
+    return std::atan2(_sin, _cos);
+}
+
+std::array<double, 3> Plant::specific_force()
+{
+    // 地面に対する加速度から重力を引いたもの (北，東，上)
+    std::array<double, 3> force{_acceleration[0], _acceleration[1], _acceleration[2] + Gravity};
+    double shake = 0;  // 振動の標準偏差 (m/s²)
+    if (!released())
+    {
+        force = {0.0, 0.0, Gravity};
+        const double height = altitude();
+        if (height > 0 && height < _config.drop_height)
+            shake = _config.vibration;  // 運ばれているときの振動
+    }
+    if (_landed && _t < _tumble_end)
+        shake += 3.0 * (_tumble_end - _t) / (_tumble_end - _landing_time);  // 着地の衝撃で転がっている
+    if (_landed)
+        shake += 0.3 * (std::fabs(_left_wheel) + std::fabs(_right_wheel)) / (2.0 * _config.wheel_speed) + 1.5 * _slip / _config.wheel_speed;  // 走行と空転による振動
+    if (shake > 0)
+    {
+        for (double& f : force)
+        {
+            f += shake * _random.normal();
+        }
+    }
+
+    // 機体の座標 (x:正面 y:左 z:上 の右手系) に直す  反対向きのときはx軸まわりに180°回っているので，yとzの向きが変わる
+    const double forward = force[0] * _cos + force[1] * _sin;
+    const double left = force[0] * _sin - force[1] * _cos;
+    if (_upside_down)
+        return {forward, -left, -force[2]};
+    return {forward, left, force[2]};
+}
+
+Plant::Imu Plant::imu()
+{
+    const std::array<double, 3> force = specific_force();
+    const double up = _upside_down ? 1.0 : -1.0;  // 重力加速度のz成分の向き (機体の座標はz:上なので，正しい向きなら負)
+    Imu imu;
+    imu.gravity = {0.0, 0.0, up * Gravity};
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        imu.linear[i] = -force[i] - imu.gravity[i];  // 全加速度 = -感じる力 なので，線形加速度 = -感じる力 - 重力加速度
+    }
+    return imu;
+}
+
+std::array<double, 3> Plant::angular_rate() const
+{
+    double tumble = 0;  // 転がっている角速度の大きさ (rad/s)
+    if (_landed && _t < _tumble_end)
+        tumble = _tumble_rate * (_tumble_end - _t) / (_tumble_end - _landing_time);
+    const double yaw = _upside_down ? -_yaw_rate : _yaw_rate;
+    return {tumble * std::sin(2.0 * Pi * 3.0 * _t), tumble * std::cos(2.0 * Pi * 2.3 * _t), yaw + tumble * std::sin(2.0 * Pi * 1.7 * _t)};
+}
+
+Plant::GoalView Plant::goal_view() const
+{
+    const double distance = std::hypot(_position[0], _position[1]);
+    double bearing = std::atan2(-_position[1], -_position[0]) - heading();  // 機体からゴールへの方位から，機体の正面の方位を引く
+    if (bearing > Pi)
+        bearing -= 2.0 * Pi;
+    else if (bearing < -Pi)
+        bearing += 2.0 * Pi;
+    return GoalView{distance, bearing};
+}
+
+bool Plant::on_sand() const
+{
+    const int64_t ix = static_cast<int64_t>(std::floor(_position[0] / SandCell));
+    const int64_t iy = static_cast<int64_t>(std::floor(_position[1] / SandCell));
+    const uint64_t hash = mix_seed(_config.seed ^ mix_seed(static_cast<uint64_t>(ix) * 0x9E3779B1ull + static_cast<uint64_t>(iy)));
+    return (hash >> 11) * 0x1.0p-53 < _config.sand_fraction;
+}
+
+bool Plant::still() const
+{
+    return _landed && _t >= _tumble_end && _left_duty == 0 && _right_duty == 0
+        && std::fabs(_left_wheel) < 1e-3 && std::fabs(_right_wheel) < 1e-3;
+}
+
+void Plant::step_air(double h)
+{
+    // パラシュートは放出のchute_delay秒後から開き始め，chute_open_time秒で開ききる
+    const double open = std::clamp((_t - _config.release_time - _config.chute_delay) / _config.chute_open_time, 0.0, 1.0);
+    const double cda = _config.body_cda + _config.chute_cda * open;
+
+    // 突風 (一次のガウス・マルコフ過程)
+    const double decay = h / _config.gust_time;
+    const double kick = _config.gust * std::sqrt(2.0 * decay);
+    for (double& gust : _gust)
+    {
+        gust += -gust * decay + kick * _random.normal();
+    }
+
+    // 空気に対する速度に比例した2乗の抗力と，重力
+    const double rel_n = _velocity[0] - (_config.wind_north + _gust[0]);
+    const double rel_e = _velocity[1] - (_config.wind_east + _gust[1]);
+    const double rel_u = _velocity[2];
+    const double k = 0.5 * AirDensity * cda * std::sqrt(rel_n * rel_n + rel_e * rel_e + rel_u * rel_u) / _config.mass;
+    _acceleration = {-k * rel_n, -k * rel_e, -k * rel_u - Gravity};
+
+    // 半陰的オイラー法
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        _velocity[i] += _acceleration[i] * h;
+        _position[i] += _velocity[i] * h;
+    }
+    if (_position[2] <= 0)
+        touch_down();
+}
+
+void Plant::touch_down()
+{
+    _landed = true;
+    _landing_time = _t;
+    _position[2] = 0;
+    const double horizontal = std::hypot(_velocity[0], _velocity[1]);
+    _impact_speed = std::sqrt(horizontal * horizontal + _velocity[2] * _velocity[2]);
+    // 横に流されているほど転びやすい
+    const double chance = std::clamp(_config.upside_down_chance + 0.08 * horizontal, 0.0, 0.9);
+    _upside_down = (_random.uniform() < chance);
+    _tumble_end = _t + 0.5 + 0.3 * _impact_speed;
+    _tumble_rate = 1.0 + 0.5 * _impact_speed;
+    _velocity = {0.0, 0.0, 0.0};
+    _acceleration = {0.0, 0.0, 0.0};
+}
+
+void Plant::step_ground(double h)
+{
+    // モーターは不感帯より小さいデューティ比では回らず，一次遅れで周速が追いつく
+    auto target = [&](double duty){return (std::fabs(duty) < _config.deadband) ? 0.0 : duty * _config.wheel_speed;};
+    const double alpha = std::min(1.0, h / _config.motor_time);
+    _left_wheel += (target(_left_duty) - _left_wheel) * alpha;
+    _right_wheel += (target(_right_duty) - _right_wheel) * alpha;
+
+    // 砂地では車輪の回転の一部しか進まず，反対向きでは車輪が浮いて進まない
+    const double traction = _upside_down ? 0.0 : (on_sand() ? _config.sand_traction : 1.0);
+    const double previous = _forward;
+    _forward = traction * 0.5 * (_left_wheel + _right_wheel);
+    _yaw_rate = traction * (_right_wheel - _left_wheel) / _config.track;
+    _slip = (1.0 - traction) * 0.5 * (std::fabs(_left_wheel) + std::fabs(_right_wheel));
+
+    // 方位の単位ベクトルを回す (三角関数を毎回呼ばないように，小さい角度の回転で近似して長さを直す)
+    const double angle = -_yaw_rate * h;  // 方位は時計回りが正
+    const double c = _cos - _sin * angle;
+    const double s = _sin + _cos * angle;
+    const double norm = 1.5 - 0.5 * (c * c + s * s);
+    _cos = c * norm;
+    _sin = s * norm;
+
+    _position[0] += _forward * _cos * h;
+    _position[1] += _forward * _sin * h;
+    const double accel = (_forward - previous) / h;
+    _acceleration = {accel * _cos, accel * _sin, 0.0};
+
+    // 反対向きのまま全力でじたばたし続けると，ある確率で元に戻る
+    if (_upside_down && _left_duty > 0.9 && _right_duty > 0.9)
+    {
+        _righting += h;
+        if (_righting >= RightingTime)
+        {
+            _righting = 0;
+            _upside_down = !(_random.uniform() < _config.righting_chance);
+        }
+    } else {
+        _righting = 0;
+    }
+}
+
+}
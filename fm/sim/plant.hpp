@@ -0,0 +1,194 @@
+#ifndef SC19_PICO_SIM_PLANT_HPP_
+#define SC19_PICO_SIM_PLANT_HPP_
+
+/**************************************************
+ * シミュレーションの物理モデルのコードです
+ * このファイルは，plant.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，キャリアからの放出，空気抵抗と風を受けるパラシュートでの降下，着地の衝撃と転倒，
+ * Motor1のPWMのデューティ比で動く差動二輪の走行(モーターの遅れ，不感帯，砂地での空転)を表すモデルが宣言されています．
+ * センサのシミュレーションに使うため，加速度・角速度・方位・GPSの位置・ゴールのコーンの見え方を返します．
+ *
+ * 1ms (1kHz) ごとに計算します．ただし，キャリアに入っている間と，着地後にモーターが止まっている間は
+ * 何も動かないので，細かく計算せずに時間だけ進めます．乱数は種から決まるので，同じ条件なら必ず同じ結果になります．
+**************************************************/
+
+//! @file plant.hpp
+//! @brief 降下と走行の物理モデル
+
+#include <array>
+#include <cstdint>
+
+#include "random.hpp"
+
+namespace sc
+{
+
+//! @brief 物理モデルの条件
+struct PlantConfig
+{
+    uint64_t seed = 1;  // 乱数の種 (突風，転倒，砂地の配置)
+
+    // キャリア
+    double release_time = 600;  // 電源を入れてから放出されるまでの時間 (s)
+    double climb_rate = 2;  // 放出の前にキャリアが上昇する速さ (m/s)
+    double drop_height = 60;  // 放出される高度 (m)
+    double vibration = 1;  // 運ばれているときの振動の標準偏差 (m/s²)
+    double start_north = 50, start_east = 0;  // 放出される地点 (ゴールからの位置) (m)
+
+    // 機体とパラシュート
+    double mass = 0.9;  // 機体の質量 (kg)
+    double body_cda = 0.02;  // 機体の抗力係数×面積 (m²)
+    double chute_cda = 0.4;  // パラシュートの抗力係数×面積 (m²)
+    double chute_delay = 1;  // 放出からパラシュートが開き始めるまでの時間 (s)
+    double chute_open_time = 0.8;  // パラシュートが開ききるまでの時間 (s)
+
+    // 風
+    double wind_north = 0, wind_east = 0;  // 平均の風 (m/s)
+    double gust = 1;  // 突風の標準偏差 (m/s)
+    double gust_time = 2;  // 突風が変わる時間の目安 (s)
+
+    // 着地
+    double upside_down_chance = 0.2;  // 水平に流されずに着地したときに反対向きになる確率
+    double righting_chance = 0.6;  // 反対向きで5秒間全力を出したときに元に戻る確率
+
+    // 走行
+    double wheel_speed = 0.5;  // デューティ比1のときの車輪の周速 (m/s)
+    double motor_time = 0.15;  // モーターの応答の時定数 (s)
+    double deadband = 0.12;  // これより小さいデューティ比では回らない
+    double track = 0.2;  // 左右の車輪の間隔 (m)
+    double sand_fraction = 0.1;  // 砂地の割合 (3m四方ごとに決める)
+    double sand_traction = 0.3;  // 砂地で車輪の回転のうち進む割合
+    double heading = 0;  // 着地したときの機体の正面の方位 (北から時計回り) (rad)
+};
+
+//! @brief 降下と走行の物理モデル
+class Plant
+{
+public:
+    static constexpr double Step = 0.001;  // 計算の間隔 (s)
+    static constexpr double Gravity = 9.80665;  // 重力加速度 (m/s²)
+    static constexpr double AirDensity = 1.2;  // 空気の密度 (kg/m³)
+
+    //! @brief 機体がゴールのコーンをどう見ているか
+    struct GoalView
+    {
+        double distance;  // コーンの中心までの水平距離 (m)
+        double bearing;  // 正面から時計回りに測ったコーンの方向 -π ~ +π (rad)
+    };
+
+    //! @brief 条件を指定して作成 (時刻0で電源を入れた状態)
+    explicit Plant(const PlantConfig& config);
+
+    //! @brief 左右のモーターのデューティ比 (Motor1::runに渡す値)
+    void set_duty(float left, float right);
+
+    //! @brief 時間を進める
+    //! @param dt 進める時間 (s)
+    void advance(double dt);
+
+    //! @brief 電源を入れてからの時間 (s)
+    double time() const
+        {return _t;}
+
+    //! @brief 放出されたか
+    bool released() const
+        {return _t >= _config.release_time;}
+
+    //! @brief 着地したか
+    bool landed() const
+        {return _landed;}
+
+    //! @brief 着地した時刻 (まだなら負) (s)
+    double landing_time() const
+        {return _landing_time;}
+
+    //! @brief 着地したときの速さ (m/s)
+    double impact_speed() const
+        {return _impact_speed;}
+
+    //! @brief 反対向きか
+    bool upside_down() const
+        {return _upside_down;}
+
+    //! @brief 地面からの高度 (m)
+    double altitude() const;
+
+    //! @brief ゴールからの位置 (北向き) (m)
+    double north() const
+        {return _position[0];}
+
+    //! @brief ゴールからの位置 (東向き) (m)
+    double east() const
+        {return _position[1];}
+
+    //! @brief 機体の正面の方位 (北から時計回り) -π ~ +π (rad)
+    double heading() const;
+
+    //! @brief 加速度センサが感じる力 (機体の座標  x:正面 y:左 z:上 の右手系) (m/s²)
+    //! @note 正しい向きで静止していれば(0, 0, +Gravity)，反対向きなら(0, 0, -Gravity)，自由落下なら0です (運ばれているときの振動と走行の振動も加わります)
+    std::array<double, 3> specific_force();
+
+    //! @brief BNO055が出力する線形加速度と重力加速度
+    struct Imu
+    {
+        std::array<double, 3> linear;  // 線形加速度 (m/s²)
+        std::array<double, 3> gravity;  // 重力加速度 (m/s²)
+    };
+
+    //! @brief BNO055の線形加速度と重力加速度 (specific_forceと同じ機体の座標)
+    //! @note BNO055の全加速度(線形加速度+重力加速度)は感じる力の反対向きです  重力加速度は正しい向きなら(0, 0, -Gravity)，反対向きなら(0, 0, +Gravity)で，
+    //!       静止していれば線形加速度は0，自由落下なら線形加速度は重力加速度の反対向きで全加速度が0になります
+    Imu imu();
+
+    //! @brief 角速度 (specific_forceと同じ機体の座標  z軸まわりは上から見て反時計回りが正) (rad/s)
+    std::array<double, 3> angular_rate() const;
+
+    //! @brief 最後にGPSが更新されたときの位置 (1秒ごとに更新)
+    //! @return 北向き，東向きの位置 (m)
+    std::array<double, 2> gps_fix() const
+        {return _fix;}
+
+    //! @brief ゴールのコーンの見え方
+    GoalView goal_view() const;
+
+    //! @brief 今いる場所が砂地か
+    bool on_sand() const;
+
+private:
+    const PlantConfig _config;
+    Random _random;
+
+    double _t = 0;  // 電源を入れてからの時間 (s)
+    std::array<double, 3> _position;  // ゴールからの位置 (北，東，上) (m)
+    std::array<double, 3> _velocity{};  // 速度 (北，東，上) (m/s)
+    std::array<double, 3> _acceleration{};  // 加速度 (北，東，上) (m/s²)
+    std::array<double, 2> _gust{};  // 突風 (北，東) (m/s)
+    bool _landed = false;
+    double _landing_time = -1;
+    double _impact_speed = 0;
+    double _tumble_end = 0;  // 着地の衝撃で転がり終わる時刻 (s)
+    double _tumble_rate = 0;  // 転がり始めの角速度 (rad/s)
+    bool _upside_down = false;
+
+    double _cos = 1, _sin = 0;  // 機体の正面の方位の単位ベクトル (北，東)
+    double _left_duty = 0, _right_duty = 0;  // デューティ比
+    double _left_wheel = 0, _right_wheel = 0;  // 車輪の周速 (m/s)
+    double _forward = 0;  // 前進の速さ (m/s)
+    double _yaw_rate = 0;  // 反時計回りの角速度 (rad/s)
+    double _slip = 0;  // 空転している周速 (m/s)
+    double _righting = 0;  // 反対向きで全力を出し続けている時間 (s)
+    std::array<double, 2> _fix{};  // GPSの位置 (m)
+    long _fix_second = -1;  // GPSの位置を更新した秒
+
+    //! @brief 動いていないので時間だけ進めてよいか
+    bool still() const;
+
+    void step_air(double h);
+    void step_ground(double h);
+    void touch_down();
+};
+
+}
+
+#endif  // SC19_PICO_SIM_PLANT_HPP_
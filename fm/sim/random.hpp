@@ -0,0 +1,92 @@
+#ifndef SC19_PICO_SIM_RANDOM_HPP_
+#define SC19_PICO_SIM_RANDOM_HPP_
+
+/**************************************************
+ * シミュレーションで使う乱数のコードです
+ *
+ * このファイルでは，物理モデルとセンサのノイズで使う速い乱数(xoshiro256+)が定義されています．
+ * std::mt19937_64とstd::normal_distributionでは，1回の飛行で数十万回引く乱数がシミュレーションの大半の時間を占めるため，
+ * こちらを使います．同じ種からは，どのPCでも同じ列が出ます．
+**************************************************/
+
+//! @file random.hpp
+//! @brief シミュレーション用の乱数
+
+#include <cmath>
+#include <cstdint>
+
+namespace sc
+{
+
+//! @brief 乱数の種を混ぜる (splitmix64)
+inline uint64_t mix_seed(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+//! @brief 速い乱数 (xoshiro256+)
+class Random
+{
+    uint64_t _s[4];
+    double _spare = 0;  // 極座標法で2つ目に作った正規乱数
+    bool _has_spare = false;
+
+    static uint64_t rotl(uint64_t x, int k)
+        {return (x << k) | (x >> (64 - k));}
+
+public:
+    explicit Random(uint64_t seed)
+    {
+        for (uint64_t& s : _s)
+        {
+            seed = mix_seed(seed);
+            s = seed;
+        }
+    }
+
+    //! @brief 0以上1未満の一様乱数
+    double uniform()
+    {
+        const uint64_t result = _s[0] + _s[3];
+        const uint64_t t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 45);
+        return (result >> 11) * 0x1.0p-53;
+    }
+
+    //! @brief low以上high未満の一様乱数
+    double uniform(double low, double high)
+        {return low + (high - low) * uniform();}
+
+    //! @brief 平均0，標準偏差1の正規乱数 (極座標法)
+    double normal()
+    {
+        if (_has_spare)
+        {
+            _has_spare = false;
+            return _spare;
+        }
+        double u, v, r;
+        do
+        {
+            u = 2.0 * uniform() - 1.0;
+            v = 2.0 * uniform() - 1.0;
+            r = u * u + v * v;
+        } while (r >= 1.0 || r == 0.0);
+        const double scale = std::sqrt(-2.0 * std::log(r) / r);
+        _spare = v * scale;
+        _has_spare = true;
+        return u * scale;
+    }
+};
+
+}
+
+#endif  // SC19_PICO_SIM_RANDOM_HPP_
@@ -0,0 +1,235 @@
+/**************************************************
+ * フェーズを移行する条件のしきい値を調整するためのシミュレータです
+ *
+ * 乱数で決めた条件(風，センサのノイズ，放出の時刻，着地の向きなど)の飛行を何千回もシミュレーションし，
+ * しきい値の組ごとに，ゴールできた割合・ゴールまでの時間・フェーズの誤判定の割合を表にします．
+ * 1回ずつの飛行は仮想の時計で独立に進むので，PCのすべてのコアで並列に実行します．
+ * しきい値の組が違っても，n回目の飛行の条件とノイズは同じなので，組どうしを公平に比べられます．
+ *
+ *     ./MISSION_SIM                                           今のしきい値で1000回
+ *     ./MISSION_SIM --runs=10000 deploy_lux=3000,4500,6000    照度のしきい値を3通り試す
+ *     ./MISSION_SIM near_goal=2,3,5 goal_distance=0.2,0.5     2×3=6通りの組を試す
+ *     ./MISSION_SIM --threads=1 --seed=7 --csv                1スレッド，種を指定，CSVで出力
+ *     ./MISSION_SIM --resets=6                                1時間に平均6回リセットして，保存したフェーズから再開する
+ *     ./MISSION_SIM --resets=6 --cold                         同じリセットで，待機フェーズからやり直す (比べるため)
+ * cmake -DSC_PROFILE=ONで作成すると，最後にMissionLoopのゾーンごとの処理時間(すべてのスレッドの合計)も表示します．
+**************************************************/
+
+//! @file sim.cpp
+//! @brief しきい値の組ごとのモンテカルロシミュレーション
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flight.hpp"
+#include "profiler.hpp"
+#include "random.hpp"
+
+namespace
+{
+
+//! @brief コマンドラインから変えられるしきい値
+struct Field
+{
+    const char* name;
+    float sc::MissionParams::* member;
+};
+
+constexpr Field Fields[] = {
+    {"wait_timeout", &sc::MissionParams::wait_timeout},
+    {"wait_error_timeout", &sc::MissionParams::wait_error_timeout},
+    {"wait_low_time", &sc::MissionParams::wait_low_time},
+    {"ground_altitude", &sc::MissionParams::ground_altitude},
+    {"deploy_lux", &sc::MissionParams::deploy_lux},
+    {"free_fall_accel", &sc::MissionParams::free_fall_accel},
+    {"release_drop", &sc::MissionParams::release_drop},
+    {"release_speed", &sc::MissionParams::release_speed},
+    {"fall_timeout", &sc::MissionParams::fall_timeout},
+    {"fall_error_timeout", &sc::MissionParams::fall_error_timeout},
+    {"landing_speed", &sc::MissionParams::landing_speed},
+    {"landing_still_time", &sc::MissionParams::landing_still_time},
+    {"still_accel", &sc::MissionParams::still_accel},
+    {"still_gyro", &sc::MissionParams::still_gyro},
+    {"upside_down_gravity", &sc::MissionParams::upside_down_gravity},
+    {"near_goal", &sc::MissionParams::near_goal},
+    {"goal_distance", &sc::MissionParams::goal_distance},
+};
+
+//! @brief しきい値の組
+struct ParamSet
+{
+    std::string label;  // 変えたしきい値 ("deploy_lux=3000 near_goal=2" など)
+    sc::MissionParams params;
+};
+
+//! @brief "name=v1,v2,..." を読み，今ある組それぞれに値の数だけ掛け合わせる
+bool expand(const std::string& arg, std::vector<ParamSet>& sets)
+{
+    const std::size_t equal = arg.find('=');
+    if (equal == std::string::npos)
+        return false;
+    const std::string name = arg.substr(0, equal);
+    const Field* field = std::find_if(std::begin(Fields), std::end(Fields), [&](const Field& f){return name == f.name;});
+    if (field == std::end(Fields))
+        return false;
+    std::vector<float> values;
+    std::size_t begin = equal + 1;
+    while (begin <= arg.size())
+    {
+        const std::size_t end = std::min(arg.find(',', begin), arg.size());
+        values.push_back(std::strtof(arg.substr(begin, end - begin).c_str(), nullptr));
+        begin = end + 1;
+    }
+    std::vector<ParamSet> expanded;
+    for (const ParamSet& set : sets)
+    {
+        for (const float value : values)
+        {
+            ParamSet next = set;
+            next.params.*(field->member) = value;
+            next.label += (next.label.empty() ? "" : " ") + name + "=" + std::to_string(value).erase(std::to_string(value).find_last_not_of('0') + 1);
+            if (next.label.back() == '.')
+                next.label.pop_back();
+            expanded.push_back(next);
+        }
+    }
+    sets = expanded;
+    return true;
+}
+
+//! @brief 小さい順に並べたときのq番目 (0 ~ 1) の値
+double percentile(std::vector<double>& values, double q)
+{
+    if (values.empty())
+        return -1;
+    const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::size_t runs = 1000;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    bool csv = false;
+    double resets = 0;  // 1時間あたりのリセットの回数
+    bool cold = false;  // リセット後に待機フェーズからやり直すか
+    std::vector<ParamSet> sets{ParamSet{"", sc::MissionParams()}};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.rfind("--runs=", 0) == 0)
+        {
+            runs = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threads = std::max<std::size_t>(1, std::strtoull(arg.c_str() + 10, nullptr, 10));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        } else if (arg == "--csv") {
+            csv = true;
+        } else if (arg.rfind("--resets=", 0) == 0) {
+            resets = std::strtod(arg.c_str() + 9, nullptr);
+        } else if (arg == "--cold") {
+            cold = true;
+        } else if (!expand(arg, sets)) {
+            std::fprintf(stderr, "usage: %s [--runs=N] [--threads=N] [--seed=N] [--csv] [--resets=N] [--cold] [name=v1,v2,...]...\nnames:", argv[0]);
+            for (const Field& field : Fields)
+            {
+                std::fprintf(stderr, " %s", field.name);
+            }
+            std::fprintf(stderr, "\n");
+            return 2;
+        }
+    }
+    if (sets.front().label.empty())
+    {
+        sets.front().label = "default";
+    }
+
+    // すべての組のすべての飛行を1つの列に並べ，空いたスレッドから順に取っていく
+    const std::size_t jobs = sets.size() * runs;
+    std::vector<sc::FlightResult> results(jobs);
+    std::atomic<std::size_t> next{0};
+    const auto begin = std::chrono::steady_clock::now();
+    auto worker = [&]()
+    {
+        for (std::size_t job = next++; job < jobs; job = next++)
+        {
+            const std::size_t run = job % runs;
+            sc::FlightScenario scenario = sc::FlightScenario::random(sc::mix_seed(seed * 0x100000000ull + run));
+            scenario.reset_rate = resets / 3600.0;
+            scenario.resume = !cold;
+            results[job] = sc::simulate_flight(sets[job / runs].params, scenario, sc::mix_seed(sc::mix_seed(seed * 0x100000000ull + run)));
+        }
+    };
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if (csv)
+    {
+        std::printf("set,runs,goal_rate,early_fall_rate,early_ldistance_rate,goal_time_mean,goal_time_p50,goal_time_p90,fall_delay_p50,final_distance_p50\n");
+    } else {
+        std::printf("%-40s %6s %7s %7s %7s %9s %9s %9s %9s %9s\n", "set", "runs", "goal%", "e_fall%", "e_ldis%", "t_mean[s]", "t_p50[s]", "t_p90[s]", "delay[s]", "miss[m]");
+    }
+    for (std::size_t i = 0; i < sets.size(); ++i)
+    {
+        std::size_t goals = 0, early_fall = 0, early_ldistance = 0;
+        std::vector<double> goal_times, fall_delays, misses;
+        for (std::size_t run = 0; run < runs; ++run)
+        {
+            const sc::FlightResult& result = results[i * runs + run];
+            goals += result.goal;
+            early_fall += result.early_fall;
+            early_ldistance += result.early_ldistance;
+            if (result.goal)
+                goal_times.push_back(result.goal_time);
+            else
+                misses.push_back(result.final_distance);
+            if (result.fall_time >= 0 && !result.early_fall)
+                fall_delays.push_back(result.fall_time - result.release_time);
+        }
+        double mean = 0;
+        for (const double time : goal_times)
+        {
+            mean += time / goal_times.size();
+        }
+        const double n = static_cast<double>(runs);
+        const char* format = csv ? "\"%s\",%zu,%.4f,%.4f,%.4f,%.1f,%.1f,%.1f,%.2f,%.2f\n" : "%-40s %6zu %7.1f %7.1f %7.1f %9.1f %9.1f %9.1f %9.2f %9.2f\n";
+        const double scale = csv ? 1.0 : 100.0;
+        std::printf(format, sets[i].label.c_str(), runs, scale * goals / n, scale * early_fall / n, scale * early_ldistance / n,
+            goal_times.empty() ? -1.0 : mean, percentile(goal_times, 0.5), percentile(goal_times, 0.9), percentile(fall_delays, 0.5), percentile(misses, 0.5));
+    }
+    if (resets > 0)
+    {
+        std::size_t total = 0;
+        for (const sc::FlightResult& result : results)
+        {
+            total += result.resets;
+        }
+        std::fprintf(stderr, "%zu resets injected (%.2f per flight, %s)\n", total, double(total) / jobs, cold ? "cold restart" : "resumed from checkpoint");
+    }
+    std::fprintf(stderr, "%zu flights in %.2fs on %zu thread(s) (%.0f flights/s)\n", jobs, wall, threads, jobs / wall);
+    // SC_PROFILEをONにしたときは，すべてのスレッドのMissionLoopのゾーンごとの処理時間を表示する (表と混ざらないよう標準エラー出力に出す)
+    sc::set_print = [](const std::string& message){std::fputs(message.c_str(), stderr);};
+    SC_PROFILE_PRINT();
+    return 0;
+}
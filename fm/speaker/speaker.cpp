@@ -4,6 +4,8 @@
 
 #include "speaker.hpp"
 
+#include <array>
+
 namespace sc 
 {
 
@@ -84,7 +86,7 @@ void Speaker::play_starwars(){
         }
 
         else{
-            static const uint32_t Raspberry_pi_clock = 125000000;
+            const uint32_t Raspberry_pi_clock = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数 (PowerManagerで下げていることがある)
             static double speaker_duty = 0.50;
 
             // メモ
@@ -92,7 +94,7 @@ void Speaker::play_starwars(){
             // 一回のカウントクロック(ラップ) = 62500
             // ラップ値 = 周期が始まってから再び0になるクロック数
             // 分周比n = nのクロック周期を1のクロック周期とみなし、出力周波数が1/nする
-            // picoのクロックは125000000Hz
+            // picoのクロックは125000000Hz (PowerManagerでクロックを下げているときは，clock_get_hzで実際の値を使う)
             // 1周期の秒数 = ((ラップ + 1) * 分周比) / 125000000
             // 出力周波数 = 125000000 / ((ラップ + 1) * 分周比)
             // ラップ  = (125000000 / (f * 分周比)) - 1
@@ -153,7 +155,7 @@ void Speaker::play_windows7(){
         
         double windows7_melody_now = *windows7_melody_now_itr;
 
-        static const uint32_t Raspberry_pi_clock = 125000000;
+        const uint32_t Raspberry_pi_clock = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数 (PowerManagerで下げていることがある)
         static double speaker_duty = 0.50;
 
         uint16_t speaker_pwm_wrap = (Raspberry_pi_clock / (windows7_melody_now * _speaker_pwm_clkdiv)) - 1;
@@ -221,7 +223,7 @@ void Speaker::play_hogwarts(){
         }
 
         else{
-            static const uint32_t Raspberry_pi_clock = 125000000;
+            const uint32_t Raspberry_pi_clock = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数 (PowerManagerで下げていることがある)
             static double speaker_duty = 0.50;
 
             uint16_t speaker_pwm_wrap = (Raspberry_pi_clock / (hogwarts_melody_now * _speaker_pwm_clkdiv)) - 1;
@@ -296,7 +298,7 @@ void Speaker::play_mario(){
         }
 
         else{
-            static const uint32_t Raspberry_pi_clock = 125000000;
+            const uint32_t Raspberry_pi_clock = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数 (PowerManagerで下げていることがある)
             static double speaker_duty = 0.50;
 
             uint16_t speaker_pwm_wrap = (Raspberry_pi_clock / (mario_melody_now * _speaker_pwm_clkdiv)) - 1;
@@ -330,4 +332,71 @@ void Speaker::play_mario(){
 
 }
 
+
+void Speaker::start_windows7(){
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    // play_windows7と同じ音と長さ (120bpmなので4分音符は0.5秒)
+    static const std::array<Note, 4> windows7_melody{
+        Note{493.883, 250000},  // B4
+        Note{659.255, 500000},  // E5
+        Note{761.672, 250000},  // F#5
+        Note{987.767, 500000}};  // B5
+
+    if (_playing)
+    {
+        cancel_alarm(_alarm);  // 鳴っている途中なら，最初からやり直す
+    }
+    _notes = windows7_melody.data();
+    _note_count = windows7_melody.size();
+    _note_index = 1;
+    _playing = true;
+    tone(_notes[0].frequency);  // 最初の音はここで鳴らし，次の音からタイマー割り込みで切り替える
+    _alarm = add_alarm_in_us(_notes[0].time_us, alarm_callback, this, true);
+    if (_alarm < 0)
+    {
+        _playing = false;
+        tone(0);
+throw std::runtime_error(f_err(__FILE__, __LINE__, "Failed to start the speaker timer"));  // スピーカー用のタイマーの開始に失敗しました
+    }
+}
+
+bool Speaker::playing() const{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    return _playing;
+}
+
+void SC_ISR_FUNC(Speaker::tone)(double frequency){
+    const uint32_t Raspberry_pi_clock = ::clock_get_hz(clk_sys);  // pico-SDKの関数  clk_sysの周波数 (PowerManagerで下げていることがある)
+    static const double speaker_duty = 0.50;
+
+    if (frequency <= 0)
+    {
+        pwm_set_gpio_level( _pin.gpio(), 0 );
+        return;
+    }
+    uint16_t speaker_pwm_wrap = (Raspberry_pi_clock / (frequency * _speaker_pwm_clkdiv)) - 1;
+    pwm_config_set_wrap( &_speaker_pwm_slice_config, speaker_pwm_wrap );
+    pwm_init( _speaker_pwm_slice_num, &_speaker_pwm_slice_config, true );
+    pwm_set_gpio_level( _pin.gpio(), ( speaker_pwm_wrap * speaker_duty ) );
+}
+
+int64_t SC_ISR_FUNC(Speaker::alarm_callback)(alarm_id_t id, void* user_data){
+    Speaker& speaker = *static_cast<Speaker*>(user_data);
+    if (speaker._note_index >= speaker._note_count)
+    {
+        // 演奏終了
+        speaker.tone(0);
+        speaker._playing = false;
+        return 0;  // 0を返すとタイマーが止まる
+    }
+    const Note& note = speaker._notes[speaker._note_index];
+    speaker._note_index = speaker._note_index + 1;
+    speaker.tone(note.frequency);
+    return note.time_us;  // 正の値を返すと，前回の予定の時刻からこの時間後にもう一度呼ばれる
+}
+
 }
\ No newline at end of file
@@ -21,12 +21,37 @@ class Speaker {
     pwm_config _speaker_pwm_slice_config;
     static constexpr double _speaker_pwm_clkdiv = 5.5;
 
+    //! @brief 1つの音
+    struct Note
+    {
+        double frequency;  // 周波数 (Hz)  0は休符
+        uint32_t time_us;  // 長さ (μs)
+    };
+    const Note* _notes = nullptr;  // 待機せずに鳴らしているメロディー
+    std::size_t _note_count = 0;  // メロディーの音の数
+    volatile std::size_t _note_index = 0;  // 次に鳴らす音
+    volatile bool _playing = false;  // 待機せずに鳴らしている途中か
+    alarm_id_t _alarm = 0;  // 次の音に切り替えるタイマー
+
+    //! @brief 指定した周波数で鳴らす (0なら止める)
+    void tone(double frequency);
+
+    //! @brief 次の音に切り替えるタイマー割り込みで呼ばれる関数
+    static int64_t alarm_callback(alarm_id_t id, void* user_data);
+
 public:
     Speaker(const Pin& pin);
     void play_starwars();
     void play_windows7();
     void play_hogwarts();
     void play_mario();
+
+    //! @brief Windows7の起動音を鳴らし始める (待機しない)
+    //! @note 音の切り替えはタイマー割り込みで行うので，鳴っている間もほかの処理を進められます
+    void start_windows7();
+
+    //! @brief start_windows7で鳴らし始めた音が，まだ鳴っているか
+    bool playing() const;
 };
 
 }
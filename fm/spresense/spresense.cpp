@@ -18,64 +18,52 @@ void Spresense::read()
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
-    _read_binary += _uart.read().data();
+    StaticBinary<UART::MaxInputLen> input_data;
+    _uart.read(input_data);
+    _read_binary.append(input_data.begin(), input_data.end());
     std::size_t index = 0;
+    SpresenseMessage message;
     while (index < _read_binary.size())
     {
-        int start_index = _read_binary.find(':', index);
-        int end_index = _read_binary.find('\n', start_index);
-        if (start_index<0 || end_index<0)
+        const std::size_t next_index = SpresenseMessage::parse(_read_binary, index, message);  // 解析はspresense_message.cppにある
+        if (next_index == std::string::npos)
     return;
-        std::string head = std::string(_read_binary.begin()+start_index, _read_binary.begin()+start_index+4);
-        double number = stod(std::string(_read_binary.begin()+start_index+4, _read_binary.begin()+end_index));
-        if (head == ":Lat")
+        if (message.head == SpresenseMessage::Head::Lat)
         {
-            if (number != 0.0)
+            if (message.number != 0.0)
             {
-                _lat = number;
+                _lat = message.number;
                 _lat_update = get_absolute_time();
             }
-        } else if (head == ":Lon")
+        } else if (message.head == SpresenseMessage::Head::Lon)
         {
-            if (number != 0.0)
+            if (message.number != 0.0)
             {
-                _lon = number;
+                _lon = message.number;
                 _lon_update = get_absolute_time();
             }
-        } else if (head == ":Cam")
+        } else if (message.head == SpresenseMessage::Head::Cam)
         {
-            if (Cam(int(number)) == Cam::Left || Cam(int(number)) == Cam::Center || Cam(int(number)) == Cam::Right || Cam(int(number)) == Cam::NotFound || Cam(int(number)) == Cam::Reset)
+            const Cam cam = Cam(int(message.number));
+            if (cam == Cam::Left || cam == Cam::Center || cam == Cam::Right || cam == Cam::NotFound || cam == Cam::Reset)
             {
-                _cam = Cam(int(number));
+                _cam = cam;
                 _cam_update = get_absolute_time();
             }
-        } else if (head == ":Tim")
+        } else if (message.head == SpresenseMessage::Head::Tim)
         {
-            std::tm new_time;
-            auto num_itr = _read_binary.begin()+start_index+4;
-            if ((end_index-start_index) == 19)
+            if (message.has_time && 2020 < (message.time.tm_year+1900) && (message.time.tm_year+1900) < 2050)
             {
-                new_time.tm_year = stoi(std::string(num_itr, num_itr+4)) - 1900;  // 1900からの経過年数
-                new_time.tm_mon = stoi(std::string(num_itr+4, num_itr+6)) - 1;  // 0 = 1月
-                new_time.tm_mday = stoi(std::string(num_itr+6, num_itr+8));  // 日
-                new_time.tm_hour = stoi(std::string(num_itr+8, num_itr+10));  // 時
-                new_time.tm_min = stoi(std::string(num_itr+10, num_itr+12));  // 分
-                new_time.tm_sec = stoi(std::string(num_itr+12, num_itr+14));  // 秒
-                if (2020 < (new_time.tm_year+1900) && (new_time.tm_year+1900) < 2050)
-                {
-                    _time = new_time;
-                    _time_update = get_absolute_time();
-                }
+                _time = message.time;
+                _time_update = get_absolute_time();
             }
         }
-        // 以下の資料を参考にしました
-        // https://qiita.com/grapefruit1030/items/900571bf10dea8740cd7
 
-        index = end_index + 1;
+        index = next_index;
     }
     if (_read_binary.size() > _max_size)
     {
-        _read_binary.replace(0, _read_binary.size() - _max_size, {});
+        _read_binary.erase(0, _read_binary.size() - _max_size);  // 古い受信を捨てる (replaceに{}を渡すとnullptrの文字列になる)
     }
 }
 
@@ -85,20 +73,37 @@ std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg> > Spresense::gps()
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
     #endif
+    return try_gps().value();  // 失敗したら例外を投げる
+}
+
+Result<std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg>>> Spresense::try_gps()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    SC_PROFILE_SCOPE("spresense_gps");  // 処理時間を計測
     if (absolute_time_diff_us(_lat_update, _start_time) == 0 || absolute_time_diff_us(_lon_update, _start_time) == 0)
         read();
     if (absolute_time_diff_us(_lat_update, get_absolute_time()) > 5*1000*1000 || absolute_time_diff_us(_lon_update, get_absolute_time()) > 5*1000*1000)
         read();
     if (absolute_time_diff_us(_lat_update, get_absolute_time()) > 10*1000*1000 || absolute_time_diff_us(_lon_update, get_absolute_time()) > 10*1000*1000 || absolute_time_diff_us(_lat_update, _start_time) == 0 || absolute_time_diff_us(_lon_update, _start_time) == 0)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "Latest GPS data not available"));  // 最新のGPSのデータがありません
+return Error(ErrorSource::Spresense, ErrorCode::NoData, __FILE__, __LINE__);  // 最新のGPSのデータがありません
     }
-    print("gps_read_data:%.7f,%.7f\n", _lat, _lon);
+    print(LogLevel::Data, LogModule::Spresense, "gps_read_data:%.7f,%.7f\n", _lat, _lon);
     return std::tuple(Latitude<Unit::deg>(_lat), Longitude<Unit::deg>(_lon));
 }
 
 
 Cam Spresense::camera()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    return try_camera().value();  // 失敗したら例外を投げる
+}
+
+Result<Cam> Spresense::try_camera()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -110,22 +115,30 @@ Cam Spresense::camera()
         read();
     if (absolute_time_diff_us(_cam_update, get_absolute_time()) > 1.5*1000*1000 || absolute_time_diff_us(_cam_update, _start_time) == 0)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "Latest camera data not available"));  // 最新のカメラのデータがありません
+return Error(ErrorSource::Spresense, ErrorCode::NoData, __FILE__, __LINE__);  // 最新のカメラのデータがありません
     }
     // print("camera_read_data:%d\n", int(_cam));
     switch (_cam)
     {
-        case Cam::Left : {print("camera:left\n"); break;}
-        case Cam::Center : {print("camera:center\n"); break;}
-        case Cam::Right : {print("camera:right\n"); break;}
-        case Cam::NotFound : {print("camera:not_found\n"); break;}
-        case Cam::Reset : {print("camera:reset\n"); break;}
+        case Cam::Left : {print(LogLevel::Data, LogModule::Spresense, "camera:left\n"); break;}
+        case Cam::Center : {print(LogLevel::Data, LogModule::Spresense, "camera:center\n"); break;}
+        case Cam::Right : {print(LogLevel::Data, LogModule::Spresense, "camera:right\n"); break;}
+        case Cam::NotFound : {print(LogLevel::Data, LogModule::Spresense, "camera:not_found\n"); break;}
+        case Cam::Reset : {print(LogLevel::Data, LogModule::Spresense, "camera:reset\n"); break;}
     }
     return _cam;
 }
 
 
 std::tm Spresense::time()
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    return try_time().value();  // 失敗したら例外を投げる
+}
+
+Result<std::tm> Spresense::try_time()
 {
     #ifndef NODEBUG
         std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
@@ -134,14 +147,14 @@ std::tm Spresense::time()
         read();
     if (absolute_time_diff_us(_time_update, _start_time) == 0)
     {
-throw std::runtime_error(f_err(__FILE__, __LINE__, "Latest time data not available"));  // 最新の時刻のデータがありません
+return Error(ErrorSource::Spresense, ErrorCode::NoData, __FILE__, __LINE__);  // 最新の時刻のデータがありません
     }
     time_t new_time = mktime(&_time) + absolute_time_diff_us(_time_update, get_absolute_time())/(1000*1000);
     _new_time = *gmtime(&new_time);
 
     std::string time_str(20, '\0');
     strftime(time_str.data(), 20, "%FT%TZ\n", &_new_time);
-    print("time_stamp:%s", time_str.c_str());
+    print(LogLevel::Data, LogModule::Spresense, "time_stamp:%s", time_str.c_str());
 
     return _new_time;
 }
@@ -3,6 +3,8 @@
 
 #include "sc.hpp"
 
+#include "spresense_message.hpp"
+
 #include <cstdlib>
 #include <ctime>
 #include <string>
@@ -67,10 +69,19 @@ public:
 
     std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg> > gps();
 
+    //! @brief 最新の緯度経度を返す (失敗しても例外を投げない)
+    Result<std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg>>> try_gps();
+
     Cam camera();
 
+    //! @brief 最新のカメラの結果を返す (失敗しても例外を投げない)
+    Result<Cam> try_camera();
+
     //! @brief 現在の世界協定時を返す
     std::tm time();
+
+    //! @brief 現在の世界協定時を返す (失敗しても例外を投げない)
+    Result<std::tm> try_time();
 };
 
 }
@@ -0,0 +1,56 @@
+/**************************************************
+ * Spresenseから受信する文字列に関するコードです
+ * このファイルは，spresense_message.hppに名前だけ書かれている関数の中身です
+ * 
+**************************************************/
+
+//! @file spresense_message.cpp
+//! @brief Spresenseから受信する文字列の解析
+
+#include "spresense_message.hpp"
+
+namespace sc
+{
+
+std::size_t SpresenseMessage::parse(const std::basic_string<uint8_t>& data, std::size_t index, SpresenseMessage& message)
+{
+    #ifndef NODEBUG
+        std::cout << "\t [ func " << __FILE__ << " : " << __LINE__ << " ] " << std::endl; 
+    #endif
+    int start_index = data.find(':', index);
+    int end_index = data.find('\n', start_index);
+    if (start_index<0 || end_index<0)
+return std::string::npos;
+    std::string head = std::string(data.begin()+start_index, data.begin()+start_index+4);
+    message.has_time = false;
+    if (head == ":Lat")
+    {
+        message.head = Head::Lat;
+    } else if (head == ":Lon") {
+        message.head = Head::Lon;
+    } else if (head == ":Cam") {
+        message.head = Head::Cam;
+    } else if (head == ":Tim") {
+        message.head = Head::Tim;
+    } else {
+        message.head = Head::Unknown;
+    }
+    message.number = stod(std::string(data.begin()+start_index+4, data.begin()+end_index));
+    if (message.head == Head::Tim && (end_index-start_index) == 19)
+    {
+        auto num_itr = data.begin()+start_index+4;
+        message.time.tm_year = stoi(std::string(num_itr, num_itr+4)) - 1900;  // 1900からの経過年数
+        message.time.tm_mon = stoi(std::string(num_itr+4, num_itr+6)) - 1;  // 0 = 1月
+        message.time.tm_mday = stoi(std::string(num_itr+6, num_itr+8));  // 日
+        message.time.tm_hour = stoi(std::string(num_itr+8, num_itr+10));  // 時
+        message.time.tm_min = stoi(std::string(num_itr+10, num_itr+12));  // 分
+        message.time.tm_sec = stoi(std::string(num_itr+12, num_itr+14));  // 秒
+        message.has_time = true;
+    }
+    // 以下の資料を参考にしました
+    // https://qiita.com/grapefruit1030/items/900571bf10dea8740cd7
+
+    return end_index + 1;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef SC19_PICO_SPRESENSE_MESSAGE_HPP_
+#define SC19_PICO_SPRESENSE_MESSAGE_HPP_
+
+/**************************************************
+ * Spresenseから受信する文字列に関するコードです
+ * このファイルは，spresense_message.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，Spresenseから受信した文字列(":Lat35.6812360\r\n"など)を1行ずつ取り出して解析する関数が宣言されています．
+ * UARTを使わないので，PC(ベンチマークなど)でもコンパイルできます．
+**************************************************/
+
+//! @file spresense_message.hpp
+//! @brief Spresenseから受信する文字列の解析
+
+#include "sc_basic.hpp"
+
+#include <ctime>
+#include <string>
+
+namespace sc
+{
+
+//! @brief Spresenseから受信した1行
+struct SpresenseMessage
+{
+    //! @brief 行の種類 (行の最初の4文字)
+    enum class Head
+    {
+        Lat,  // ":Lat" 緯度
+        Lon,  // ":Lon" 経度
+        Cam,  // ":Cam" カメラの結果
+        Tim,  // ":Tim" 時刻 (YYYYMMDDhhmmss)
+        Unknown  // それ以外
+    };
+
+    Head head = Head::Unknown;  // 行の種類
+    double number = 0.0;  // 4文字目以降を数値にしたもの (Timのときは使わない)
+    bool has_time = false;  // 時刻を読めたか (Timで，長さが正しいとき)
+    std::tm time = {};  // 受信した時刻 (has_timeのときだけ)
+
+    //! @brief dataのindex以降にある最初の1行を取り出して解析する
+    //! @note 数値にできないときは，std::stodと同じ例外を投げます
+    //! @param data 受信した文字列
+    //! @param index 探し始める位置
+    //! @param message 解析した結果を書き込む場所
+    //! @return 次の行を探し始める位置 (行が最後まで受信されていなければstd::string::npos)
+    static std::size_t parse(const std::basic_string<uint8_t>& data, std::size_t index, SpresenseMessage& message);
+};
+
+}
+
+#endif  // SC19_PICO_SPRESENSE_MESSAGE_HPP_
@@ -0,0 +1,1320 @@
+/**************************************************
+ * テストでpico-SDKの代わりに使うコードです
+ * このファイルは，fake_sdk.hppに名前だけ書かれている関数の中身です
+ *
+ * このファイルでは，仮想の時計，割り込み，GPIO，PWM，ADC，I2Cのレジスタとデバイス，SPIとUARTの送受信，リセットとフラッシュメモリのまねが定義されています．
+ * 割り込みは「割り込みの中で実行する関数」の列として持ち，有効なときにすぐ，無効なときは有効に戻したときに実行します．
+ * 時刻を決めて呼ぶ関数(schedule_at)は，仮想の時計を進めるときに繰り返しタイマーと時刻の順に呼びます．
+**************************************************/
+
+//! @file fake_sdk.cpp
+//! @brief テスト用のpico-SDKの代わり
+
+#include "fake_sdk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr std::size_t GpioNum = 48;  // GPIOの数 (余裕を持たせる)
+constexpr std::size_t IrqNum = 32;  // 割り込みの番号の数
+constexpr std::size_t I2CFifoDepth = 16;  // I2CのFIFOの段数
+constexpr std::size_t AdcNum = 5;  // ADCのチャンネルの数 (4は内蔵温度センサ)
+constexpr std::size_t DmaNum = 12;  // DMAのチャンネルの数
+constexpr int MaxIrqRepeat = 1000;  // 割り込みが解除されずに呼ばれ続けるときに止める回数
+
+//! @brief 繰り返しタイマー
+struct Timer
+{
+    repeating_timer_t* timer;
+    uint64_t next_us;  // 次に呼ぶ時刻 (μs)
+    bool queued;  // 割り込みが無効なので，呼ばれるのを待っている
+};
+
+//! @brief I2Cのデバイス
+struct I2CDevice
+{
+    uint8_t addr;  // スレーブアドレス
+    std::vector<uint8_t> memory;  // メモリ
+};
+
+//! @brief I2Cのバスとレジスタの状態
+struct I2CBus
+{
+    uint baudrate = 0;  // 通信速度 (Hz)
+    uint32_t tar = 0;  // 通信先のスレーブアドレス
+    bool enabled = false;  // I2Cが有効か
+    uint32_t intr_mask = 0;  // 割り込みのマスク
+    uint32_t rx_tl = 0;  // 受信のFIFOのしきい値 (これより多くたまったら割り込み)
+    bool aborted = false;  // 応答がなく，通信を中断した
+    std::deque<uint32_t> tx;  // 送信するコマンドのFIFO
+    std::deque<uint8_t> rx;  // 受信したデータのFIFO
+    bool in_transfer = false;  // STARTからSTOPまでの間か
+    bool addressed = false;  // 今の通信でメモリアドレスを受け取ったか
+    bool reading = false;  // 今の通信で受信を始めたか
+    uint8_t pointer = 0;  // デバイスのメモリアドレス
+    bool irq_queued = false;  // 割り込みが呼ばれるのを待っている
+    std::vector<I2CDevice> devices;
+    std::vector<std::pair<uint8_t, uint8_t>> async_reads;  // FIFOのコマンドで受信を始めた (スレーブアドレス，メモリアドレス)
+};
+
+//! @brief I2Cのレジスタの番号
+enum I2CRegisterId : uint
+{
+    RegCon, RegTar, RegDataCmd, RegIntrStat, RegIntrMask, RegRawIntrStat, RegRxTl, RegTxTl, RegClrIntr, RegClrTxAbrt, RegEnable, RegStatus, RegTxflr, RegRxflr, RegTxAbrtSource
+};
+
+//! @brief fakeの状態すべて
+struct State
+{
+    uint64_t now_us = 0;
+    bool interrupts_enabled = true;
+    bool in_irq = false;
+    uint32_t blocking_in_irq = 0;
+    std::deque<std::function<void()>> pending;  // 割り込みが無効な間に起きた割り込み
+    std::vector<Timer> timers;
+    std::multimap<uint64_t, std::function<void()>> scheduled;  // 時刻を決めて呼ぶ関数
+    std::array<irq_handler_t, IrqNum> irq_handlers{};
+    std::array<bool, IrqNum> irq_lines{};
+    std::array<bool, GpioNum> gpio_levels{};
+    std::array<uint32_t, GpioNum> gpio_irq_masks{};
+    gpio_irq_callback_t gpio_callback = nullptr;
+    std::array<uint16_t, GpioNum> pwm_levels{};
+    std::array<uint16_t, NUM_PWM_SLICES> pwm_wraps{};
+    std::vector<sc::fake::PwmEvent> pwm_trace;
+    std::array<I2CBus, 2> i2c;
+    std::function<void(uint, uint8_t, uint8_t)> i2c_read_hook;  // I2Cで受信を始める直前に呼ぶ関数
+    std::array<uint16_t, AdcNum> adc_values{};  // ADCの測定値
+    uint adc_input = 0;  // 測定するADCのチャンネル
+    std::function<void(uint)> adc_read_hook;  // ADCで測定する直前に呼ぶ関数
+    uint32_t dma_claimed = 0;  // 使用中のDMAのチャンネル (ビットごと)
+    std::array<dma_channel_hw_t, DmaNum> dma_hw{};  // DMAのチャンネルのレジスタ
+    std::array<std::deque<uint8_t>, 2> uart_rx;  // UARTで受信して，まだ読まれていないデータ
+    std::array<std::vector<uint8_t>, 2> uart_tx;  // UARTで送信したデータ
+    std::array<std::vector<uint8_t>, 2> spi_tx;  // SPIで送信したデータ
+    uint32_t flash_erases = 0;  // フラッシュメモリのセクタを消去した回数
+    uint32_t flash_writes_with_irq = 0;  // 割り込みを有効にしたまま消去・書き込みした回数
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+//! @brief フラッシュメモリの内容 (大きいので，reset()では作り直さずに消去だけする)
+std::vector<uint8_t>& flash()
+{
+    static std::vector<uint8_t> memory(PICO_FLASH_SIZE_BYTES, 0xFF);
+    return memory;
+}
+
+// __uninitialized_ramで置いた変数の範囲 (リンカが作る  そのような変数がなければnullptr)
+extern "C" uint8_t __start_sc_fake_noinit[] __attribute__((weak));
+extern "C" uint8_t __stop_sc_fake_noinit[] __attribute__((weak));
+
+void raise_i2c_irq(uint bus);
+
+//! @brief 割り込みとして関数を実行する (実行できないときは後に回す)
+void deliver(std::function<void()> function)
+{
+    State& s = state();
+    if (s.in_irq || !s.interrupts_enabled)
+    {
+        s.pending.push_back(std::move(function));
+        return;
+    }
+    s.in_irq = true;
+    function();
+    s.in_irq = false;
+    // 割り込みの中で起きた割り込みを続けて実行する
+    while (!s.pending.empty() && s.interrupts_enabled)
+    {
+        std::function<void()> next = std::move(s.pending.front());
+        s.pending.pop_front();
+        s.in_irq = true;
+        next();
+        s.in_irq = false;
+    }
+}
+
+//! @brief 割り込みの中での重い処理を数える
+void count_blocking()
+{
+    if (state().in_irq)
+        ++state().blocking_in_irq;
+}
+
+//! @brief 時刻がきたタイマーを1つ呼ぶ
+//! @return 呼んだ(か予約した)か
+bool fire_timer(uint64_t until_us)
+{
+    State& s = state();
+    auto due = s.timers.end();
+    for (auto it = s.timers.begin(); it != s.timers.end(); ++it)
+    {
+        if (!it->queued && it->next_us <= until_us && (due == s.timers.end() || it->next_us < due->next_us))
+            due = it;
+    }
+    if (due == s.timers.end())
+        return false;
+    s.now_us = std::max(s.now_us, due->next_us);
+    repeating_timer_t* timer = due->timer;
+    due->queued = true;
+    deliver([timer]()
+    {
+        State& s = state();
+        auto it = std::find_if(s.timers.begin(), s.timers.end(), [timer](const Timer& t){return t.timer == timer;});
+        if (it == s.timers.end())
+            return;  // 取り消された
+        const uint64_t scheduled_us = it->next_us;
+        const bool repeat = timer->callback(timer);
+        it = std::find_if(s.timers.begin(), s.timers.end(), [timer](const Timer& t){return t.timer == timer;});
+        if (it == s.timers.end())
+            return;
+        if (!repeat)
+        {
+            s.timers.erase(it);
+            return;
+        }
+        // 負の間隔は開始から開始まで，正の間隔は終わってから次の開始まで
+        it->next_us = (timer->delay_us < 0) ? scheduled_us + static_cast<uint64_t>(-timer->delay_us) : s.now_us + static_cast<uint64_t>(timer->delay_us);
+        it->queued = false;
+    });
+    return true;
+}
+
+/***** I2Cのモデル *****/
+
+uint bus_of(i2c_inst_t* i2c)
+{
+    return (i2c == &i2c1_inst) ? 1 : 0;
+}
+
+I2CDevice* find_device(uint bus, uint32_t addr)
+{
+    for (auto& device : state().i2c[bus].devices)
+    {
+        if (device.addr == addr)
+            return &device;
+    }
+    return nullptr;
+}
+
+uint32_t raw_intr(const I2CBus& b)
+{
+    uint32_t raw = 0;
+    if (b.rx.size() > b.rx_tl)
+        raw |= I2C_IC_INTR_STAT_R_RX_FULL_BITS;
+    if (b.aborted)
+        raw |= I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+    return raw;
+}
+
+bool irq_asserted(uint bus)
+{
+    const I2CBus& b = state().i2c[bus];
+    return (raw_intr(b) & b.intr_mask) != 0;
+}
+
+//! @brief 割り込みが起きている間，I2Cの割り込みを呼ぶ
+void raise_i2c_irq(uint bus)
+{
+    State& s = state();
+    const uint irq = bus ? I2C1_IRQ : I2C0_IRQ;
+    I2CBus& b = s.i2c[bus];
+    if (b.irq_queued || !irq_asserted(bus) || !s.irq_lines[irq] || s.irq_handlers[irq] == nullptr)
+        return;
+    b.irq_queued = true;
+    deliver([bus, irq]()
+    {
+        State& s = state();
+        for (int i = 0; i < MaxIrqRepeat && irq_asserted(bus) && s.irq_handlers[irq] != nullptr; ++i)
+            s.irq_handlers[irq]();
+        s.i2c[bus].irq_queued = false;
+    });
+}
+
+uint32_t read_register(uint bus, uint offset)
+{
+    I2CBus& b = state().i2c[bus];
+    switch (offset)
+    {
+        case RegTar:
+            return b.tar;
+        case RegDataCmd:
+        {
+            if (b.rx.empty())
+                return 0;
+            const uint8_t value = b.rx.front();
+            b.rx.pop_front();
+            return value;
+        }
+        case RegIntrStat:
+            return raw_intr(b) & b.intr_mask;
+        case RegIntrMask:
+            return b.intr_mask;
+        case RegRawIntrStat:
+            return raw_intr(b);
+        case RegRxTl:
+            return b.rx_tl;
+        case RegClrTxAbrt:
+            b.aborted = false;
+            return 0;
+        case RegEnable:
+            return b.enabled ? I2C_IC_ENABLE_ENABLE_BITS : 0;
+        case RegTxflr:
+            return static_cast<uint32_t>(b.tx.size());
+        case RegRxflr:
+            return static_cast<uint32_t>(b.rx.size());
+        default:
+            return 0;
+    }
+}
+
+void write_register(uint bus, uint offset, uint32_t value)
+{
+    I2CBus& b = state().i2c[bus];
+    switch (offset)
+    {
+        case RegTar:
+            b.tar = value & 0x3ff;
+            break;
+        case RegDataCmd:
+            if (b.enabled && b.tx.size() < I2CFifoDepth)
+                b.tx.push_back(value);
+            break;
+        case RegIntrMask:
+            b.intr_mask = value;
+            raise_i2c_irq(bus);
+            break;
+        case RegRxTl:
+            b.rx_tl = value;
+            break;
+        case RegEnable:
+            b.enabled = (value & I2C_IC_ENABLE_ENABLE_BITS) != 0;
+            if (!b.enabled)
+            {
+                // 無効にするとFIFOが空になり，通信も中断の状態も終わる
+                b.tx.clear();
+                b.rx.clear();
+                b.aborted = false;
+                b.in_transfer = false;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+//! @brief 送受信にかかる時間 (μs)  1バイトは9ビット
+uint64_t transfer_time_us(uint bus, std::size_t bytes)
+{
+    const uint baudrate = state().i2c[bus].baudrate ? state().i2c[bus].baudrate : 100000;
+    return (bytes + 1) * 9 * 1000000ull / baudrate;
+}
+
+i2c_hw_t I2CHw[2];
+
+//! @brief I2Cのレジスタに番号を付ける
+bool attach_registers()
+{
+    for (uint bus = 0; bus < 2; ++bus)
+    {
+        i2c_hw_t& hw = I2CHw[bus];
+        hw.con.attach(bus, RegCon);
+        hw.tar.attach(bus, RegTar);
+        hw.data_cmd.attach(bus, RegDataCmd);
+        hw.intr_stat.attach(bus, RegIntrStat);
+        hw.intr_mask.attach(bus, RegIntrMask);
+        hw.raw_intr_stat.attach(bus, RegRawIntrStat);
+        hw.rx_tl.attach(bus, RegRxTl);
+        hw.tx_tl.attach(bus, RegTxTl);
+        hw.clr_intr.attach(bus, RegClrIntr);
+        hw.clr_tx_abrt.attach(bus, RegClrTxAbrt);
+        hw.enable.attach(bus, RegEnable);
+        hw.status.attach(bus, RegStatus);
+        hw.txflr.attach(bus, RegTxflr);
+        hw.rxflr.attach(bus, RegRxflr);
+        hw.tx_abrt_source.attach(bus, RegTxAbrtSource);
+    }
+    return true;
+}
+
+const bool RegistersAttached = attach_registers();
+
+struct spi_dummy {};
+struct uart_dummy {};
+spi_dummy Spi[2];
+uart_dummy Uart[2];
+
+}
+
+/***** 時計 *****/
+
+uint64_t time_us_64()
+{
+    return state().now_us;
+}
+
+uint32_t time_us_32()
+{
+    return static_cast<uint32_t>(state().now_us);
+}
+
+timer_hw_t timer_hw_inst;
+
+namespace sc::fake
+{
+
+TimerRawRegister::operator uint32_t() const
+{
+    return static_cast<uint32_t>(_high ? state().now_us >> 32 : state().now_us);
+}
+
+}
+
+absolute_time_t get_absolute_time()
+{
+    return state().now_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return static_cast<uint32_t>(t / 1000);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us)
+{
+    return state().now_us + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+    return state().now_us + ms * 1000ull;
+}
+
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us)
+{
+    return t + us;
+}
+
+absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms)
+{
+    return t + ms * 1000ull;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return static_cast<int64_t>(to - from);
+}
+
+void sleep_us(uint64_t us)
+{
+    count_blocking();
+    sc::fake::advance_us(us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us(ms * 1000ull);
+}
+
+void sleep_until(absolute_time_t t)
+{
+    if (t > state().now_us)
+        sleep_us(t - state().now_us);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    sleep_us(us);
+}
+
+void busy_wait_us_32(uint32_t us)
+{
+    sleep_us(us);
+}
+
+void busy_wait_ms(uint32_t ms)
+{
+    sleep_us(ms * 1000ull);
+}
+
+void tight_loop_contents()
+{
+    sc::fake::advance_us(1);
+}
+
+bool stdio_init_all()
+{
+    return true;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out)
+{
+    if (delay_us == 0)
+        return false;
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->pool = nullptr;
+    out->alarm_id = static_cast<int32_t>(state().timers.size() + 1);
+    const uint64_t interval = static_cast<uint64_t>(delay_us < 0 ? -delay_us : delay_us);
+    state().timers.push_back(Timer{out, state().now_us + interval, false});
+    return true;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out)
+{
+    return add_repeating_timer_us(delay_ms * int64_t(1000), callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t* timer)
+{
+    auto& timers = state().timers;
+    const auto it = std::remove_if(timers.begin(), timers.end(), [timer](const Timer& t){return t.timer == timer;});
+    const bool found = (it != timers.end());
+    timers.erase(it, timers.end());
+    return found;
+}
+
+/***** 割り込み *****/
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    state().irq_handlers.at(num) = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t)
+{
+    irq_set_exclusive_handler(num, handler);  // 同じ割り込みを共有するものはまだないので，1つだけ持つ
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+    if (state().irq_handlers.at(num) == handler)
+        state().irq_handlers.at(num) = nullptr;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    state().irq_lines.at(num) = enabled;
+    if (enabled && (num == I2C0_IRQ || num == I2C1_IRQ))
+        raise_i2c_irq(num - I2C0_IRQ);
+}
+
+uint32_t save_and_disable_interrupts()
+{
+    const uint32_t status = state().interrupts_enabled ? 1 : 0;
+    state().interrupts_enabled = false;
+    return status;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    State& s = state();
+    s.interrupts_enabled = (status != 0);
+    if (!s.interrupts_enabled || s.in_irq || s.pending.empty())
+        return;
+    std::function<void()> next = std::move(s.pending.front());
+    s.pending.pop_front();
+    deliver(std::move(next));  // 残りもdeliverの中で続けて実行される
+}
+
+/***** GPIO *****/
+
+void gpio_init(uint gpio)
+{
+    state().gpio_levels.at(gpio) = false;
+}
+
+void gpio_set_dir(uint, bool)
+{
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    state().gpio_levels.at(gpio) = value;
+}
+
+bool gpio_get(uint gpio)
+{
+    return state().gpio_levels.at(gpio);
+}
+
+void gpio_pull_up(uint gpio)
+{
+    state().gpio_levels.at(gpio) = true;  // 何もつながっていなければHighになる
+}
+
+void gpio_pull_down(uint gpio)
+{
+    state().gpio_levels.at(gpio) = false;
+}
+
+void gpio_disable_pulls(uint)
+{
+}
+
+void gpio_set_function(uint, enum gpio_function)
+{
+    count_blocking();
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    state().gpio_callback = callback;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+    uint32_t& mask = state().gpio_irq_masks.at(gpio);
+    mask = enabled ? (mask | event_mask) : (mask & ~event_mask);
+}
+
+/***** I2C *****/
+
+i2c_inst_t i2c0_inst = {&I2CHw[0], false};
+i2c_inst_t i2c1_inst = {&I2CHw[1], false};
+
+namespace sc::fake
+{
+
+I2CRegister::operator uint32_t() const
+{
+    return read_register(_bus, _offset);
+}
+
+I2CRegister& I2CRegister::operator=(uint32_t value)
+{
+    write_register(_bus, _offset, value);
+    return *this;
+}
+
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate)
+{
+    I2CBus& b = state().i2c[bus_of(i2c)];
+    b.enabled = true;
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t* i2c)
+{
+    state().i2c[bus_of(i2c)].enabled = false;
+}
+
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate)
+{
+    count_blocking();
+    state().i2c[bus_of(i2c)].baudrate = baudrate;
+    return baudrate;
+}
+
+uint i2c_hw_index(i2c_inst_t* i2c)
+{
+    return bus_of(i2c);
+}
+
+i2c_hw_t* i2c_get_hw(i2c_inst_t* i2c)
+{
+    return i2c->hw;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop)
+{
+    return i2c_write_blocking_until(i2c, addr, src, len, nostop, UINT64_MAX);
+}
+
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop)
+{
+    return i2c_read_blocking_until(i2c, addr, dst, len, nostop, UINT64_MAX);
+}
+
+int i2c_write_blocking_until(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool, absolute_time_t)
+{
+    const uint bus = bus_of(i2c);
+    I2CDevice* device = find_device(bus, addr);
+    sleep_us(transfer_time_us(bus, device ? len : 0));
+    if (device == nullptr)
+        return PICO_ERROR_GENERIC;
+    if (len == 0 || device->memory.empty())
+        return static_cast<int>(len);
+    uint8_t& pointer = state().i2c[bus].pointer;
+    pointer = src[0];  // 最初のバイトはメモリアドレス
+    for (std::size_t i = 1; i < len; ++i)
+        device->memory[pointer++ % device->memory.size()] = src[i];
+    return static_cast<int>(len);
+}
+
+int i2c_read_blocking_until(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool, absolute_time_t)
+{
+    const uint bus = bus_of(i2c);
+    if (state().i2c_read_hook && find_device(bus, addr) != nullptr)
+        state().i2c_read_hook(bus, addr, state().i2c[bus].pointer);  // 受信するメモリをテストが書き換える
+    I2CDevice* device = find_device(bus, addr);
+    sleep_us(transfer_time_us(bus, device ? len : 0));
+    if (device == nullptr)
+        return PICO_ERROR_GENERIC;
+    uint8_t& pointer = state().i2c[bus].pointer;
+    for (std::size_t i = 0; i < len; ++i)
+        dst[i] = device->memory.empty() ? 0 : device->memory[pointer++ % device->memory.size()];
+    return static_cast<int>(len);
+}
+
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, uint timeout_us)
+{
+    return i2c_write_blocking_until(i2c, addr, src, len, nostop, make_timeout_time_us(timeout_us));
+}
+
+int i2c_read_timeout_us(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop, uint timeout_us)
+{
+    return i2c_read_blocking_until(i2c, addr, dst, len, nostop, make_timeout_time_us(timeout_us));
+}
+
+/***** SPI *****/
+
+spi_inst_t* const spi0 = reinterpret_cast<spi_inst_t*>(&Spi[0]);
+spi_inst_t* const spi1 = reinterpret_cast<spi_inst_t*>(&Spi[1]);
+
+uint spi_init(spi_inst_t*, uint baudrate)
+{
+    return baudrate;
+}
+
+void spi_set_format(spi_inst_t*, uint, spi_cpol_t, spi_cpha_t, spi_order_t)
+{
+}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len)
+{
+    std::vector<uint8_t>& output = state().spi_tx.at(spi == spi1 ? 1 : 0);
+    output.insert(output.end(), src, src + len);
+    return static_cast<int>(len);
+}
+
+int spi_read_blocking(spi_inst_t*, uint8_t repeated_tx_data, uint8_t* dst, size_t len)
+{
+    std::fill_n(dst, len, repeated_tx_data);  // 受信したデータの代わりに送信した値を返す
+    return static_cast<int>(len);
+}
+
+int spi_write_read_blocking(spi_inst_t*, const uint8_t* src, uint8_t* dst, size_t len)
+{
+    std::copy_n(src, len, dst);
+    return static_cast<int>(len);
+}
+
+/***** UART *****/
+
+uart_inst_t* const uart0 = reinterpret_cast<uart_inst_t*>(&Uart[0]);
+uart_inst_t* const uart1 = reinterpret_cast<uart_inst_t*>(&Uart[1]);
+
+uint uart_init(uart_inst_t*, uint baudrate)
+{
+    return baudrate;
+}
+
+void uart_deinit(uart_inst_t*)
+{
+}
+
+uint uart_set_baudrate(uart_inst_t*, uint baudrate)
+{
+    return baudrate;
+}
+
+void uart_set_hw_flow(uart_inst_t*, bool, bool)
+{
+}
+
+void uart_set_format(uart_inst_t*, uint, uint, uart_parity_t)
+{
+}
+
+void uart_set_fifo_enabled(uart_inst_t*, bool)
+{
+}
+
+void uart_set_irq_enables(uart_inst_t*, bool, bool)
+{
+}
+
+uint uart_get_index(uart_inst_t* uart)
+{
+    return (uart == uart1) ? 1 : 0;
+}
+
+bool uart_is_readable(uart_inst_t* uart)
+{
+    return !state().uart_rx.at(uart_get_index(uart)).empty();
+}
+
+char uart_getc(uart_inst_t* uart)
+{
+    std::deque<uint8_t>& input = state().uart_rx.at(uart_get_index(uart));
+    if (input.empty())
+        return 0;
+    const uint8_t byte = input.front();
+    input.pop_front();
+    return static_cast<char>(byte);
+}
+
+void uart_putc(uart_inst_t* uart, char c)
+{
+    state().uart_tx.at(uart_get_index(uart)).push_back(static_cast<uint8_t>(c));
+}
+
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len)
+{
+    std::vector<uint8_t>& output = state().uart_tx.at(uart_get_index(uart));
+    output.insert(output.end(), src, src + len);
+}
+
+void uart_read_blocking(uart_inst_t*, uint8_t* dst, size_t len)
+{
+    std::fill_n(dst, len, 0);
+}
+
+/***** ADC *****/
+
+adc_hw_t adc_hw_inst{};
+adc_hw_t* const adc_hw = &adc_hw_inst;
+
+void adc_init()
+{
+}
+
+void adc_gpio_init(uint)
+{
+}
+
+void adc_select_input(uint input)
+{
+    state().adc_input = input;
+}
+
+uint16_t adc_read()
+{
+    State& s = state();
+    if (s.adc_read_hook)
+        s.adc_read_hook(s.adc_input);  // 測定値をテストが決める
+    sleep_us(2);  // 1回の測定は96サイクル(48MHz)
+    return s.adc_values.at(s.adc_input);
+}
+
+void adc_set_temp_sensor_enabled(bool)
+{
+}
+
+void adc_set_round_robin(uint)
+{
+}
+
+void adc_fifo_setup(bool, bool, uint16_t, bool, bool)
+{
+}
+
+void adc_fifo_drain()
+{
+}
+
+void adc_set_clkdiv(float)
+{
+}
+
+void adc_run(bool)
+{
+}
+
+/***** DMA *****/
+
+int dma_claim_unused_channel(bool required)
+{
+    State& s = state();
+    for (uint channel = 0; channel < DmaNum; ++channel)
+    {
+        if ((s.dma_claimed & (1u << channel)) == 0)
+        {
+            s.dma_claimed |= (1u << channel);
+            return static_cast<int>(channel);
+        }
+    }
+    if (required)
+        throw std::runtime_error("fake: no free DMA channel");
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    state().dma_claimed &= ~(1u << channel);
+}
+
+dma_channel_config dma_channel_get_default_config(uint)
+{
+    return dma_channel_config{0};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config*, enum dma_channel_transfer_size)
+{
+}
+
+void channel_config_set_read_increment(dma_channel_config*, bool)
+{
+}
+
+void channel_config_set_write_increment(dma_channel_config*, bool)
+{
+}
+
+void channel_config_set_ring(dma_channel_config*, bool, uint)
+{
+}
+
+void channel_config_set_dreq(dma_channel_config*, uint)
+{
+}
+
+void dma_channel_configure(uint, const dma_channel_config*, volatile void*, const volatile void*, uint, bool)
+{
+    throw std::logic_error("fake: DMA transfers are not emulated");  // 転送はまねしない (AdcSamplerは初期化に失敗し，ADCはその場で測定する)
+}
+
+dma_channel_hw_t* dma_channel_hw_addr(uint channel)
+{
+    return &state().dma_hw.at(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool)
+{
+    state().dma_hw.at(channel).transfer_count = trans_count;
+}
+
+void dma_channel_abort(uint)
+{
+}
+
+void dma_channel_set_irq0_enabled(uint, bool)
+{
+}
+
+bool dma_channel_get_irq0_status(uint)
+{
+    return false;
+}
+
+void dma_channel_acknowledge_irq0(uint)
+{
+}
+
+/***** PWM *****/
+
+uint pwm_gpio_to_slice_num(uint gpio)
+{
+    return (gpio >> 1) & 7u;
+}
+
+uint pwm_gpio_to_channel(uint gpio)
+{
+    return gpio & 1u;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap)
+{
+    state().pwm_wraps.at(slice_num) = wrap;
+}
+
+void pwm_set_clkdiv(uint, float)
+{
+}
+
+void pwm_set_phase_correct(uint, bool)
+{
+}
+
+void pwm_set_output_polarity(uint, bool, bool)
+{
+}
+
+void pwm_set_enabled(uint, bool)
+{
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    State& s = state();
+    if (s.pwm_levels.at(gpio) == level)
+        return;
+    s.pwm_levels.at(gpio) = level;
+    s.pwm_trace.push_back(sc::fake::PwmEvent{s.now_us, gpio, level});
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level)
+{
+    pwm_set_gpio_level(slice_num * 2 + chan, level);
+}
+
+/***** ウォッチドッグ，リセットの理由 *****/
+
+watchdog_hw_t watchdog_hw_inst = {};
+vreg_and_chip_reset_hw_t vreg_and_chip_reset_hw_inst = {};
+
+void hw_set_bits(io_rw_32* addr, uint32_t mask)
+{
+    *addr = *addr | mask;
+}
+
+void hw_clear_bits(io_rw_32* addr, uint32_t mask)
+{
+    *addr = *addr & ~mask;
+}
+
+void watchdog_enable(uint32_t delay_ms, bool)
+{
+    watchdog_hw->load = delay_ms * 1000 * 2;  // RP2040-E1のため，pico-SDKは2倍の値を設定する
+    watchdog_hw->ctrl = watchdog_hw->ctrl | WATCHDOG_CTRL_ENABLE_BITS;
+}
+
+void watchdog_update()
+{
+    // 仮想の時計ではタイムアウトしない (テストからsc::fake::watchdog_resetでリセットする)
+}
+
+bool watchdog_caused_reboot()
+{
+    return (watchdog_hw->reason & (WATCHDOG_REASON_TIMER_BITS | WATCHDOG_REASON_FORCE_BITS)) != 0;
+}
+
+bool watchdog_enable_caused_reboot()
+{
+    return (watchdog_hw->reason & WATCHDOG_REASON_TIMER_BITS) != 0;
+}
+
+/***** フラッシュメモリ *****/
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    State& s = state();
+    if (flash_offs % FLASH_SECTOR_SIZE != 0 || count % FLASH_SECTOR_SIZE != 0 || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+    {
+        std::printf("    flash_range_erase(0x%x, %zu) is not aligned to sectors\n", static_cast<unsigned>(flash_offs), count);
+        return;
+    }
+    s.flash_erases += static_cast<uint32_t>(count / FLASH_SECTOR_SIZE);
+    s.flash_writes_with_irq += s.interrupts_enabled;
+    std::fill_n(flash().begin() + flash_offs, count, uint8_t(0xFF));
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count)
+{
+    State& s = state();
+    if (flash_offs % FLASH_PAGE_SIZE != 0 || count % FLASH_PAGE_SIZE != 0 || flash_offs + count > PICO_FLASH_SIZE_BYTES)
+    {
+        std::printf("    flash_range_program(0x%x, %zu) is not aligned to pages\n", static_cast<unsigned>(flash_offs), count);
+        return;
+    }
+    s.flash_writes_with_irq += s.interrupts_enabled;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        flash()[flash_offs + i] &= data[i];  // 書き込みでは1を0にしかできない
+    }
+}
+
+/***** テストから操作する関数 *****/
+
+namespace sc::fake
+{
+
+void reset()
+{
+    State& s = state();
+    s = State{};
+    std::fill(flash().begin(), flash().end(), uint8_t(0xFF));
+    const auto [ram, ram_size] = noinit_ram();
+    std::fill_n(ram, ram_size, uint8_t(0));
+    watchdog_hw_inst = watchdog_hw_t{};
+    vreg_and_chip_reset_hw_inst = vreg_and_chip_reset_hw_t{};
+    vreg_and_chip_reset_hw->chip_reset = VREG_AND_CHIP_RESET_CHIP_RESET_HAD_POR_BITS;
+    // 送信の記録でメモリを確保しないよう，先に確保しておく (メモリの確保を数えるテストのため)
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        s.uart_tx[i].reserve(1024);
+        s.spi_tx[i].reserve(1024);
+    }
+}
+
+void advance_us(uint64_t us)
+{
+    State& s = state();
+    const uint64_t target = s.now_us + us;
+    if (s.in_irq)
+    {
+        s.now_us = target;  // 割り込みの中ではほかの割り込みは起きない
+        return;
+    }
+    while (true)
+    {
+        // 繰り返しタイマーと時刻を決めた関数を，時刻の順に呼ぶ (同じ時刻ならタイマーが先)
+        if (!s.scheduled.empty() && s.scheduled.begin()->first <= target)
+        {
+            if (fire_timer(s.scheduled.begin()->first))
+                continue;
+            const auto it = s.scheduled.begin();
+            s.now_us = std::max(s.now_us, it->first);
+            const std::function<void()> function = std::move(it->second);
+            s.scheduled.erase(it);
+            function();
+            continue;
+        }
+        if (!fire_timer(target))
+            break;
+    }
+    s.now_us = std::max(s.now_us, target);
+}
+
+void schedule_at(uint64_t time_us, std::function<void()> function)
+{
+    state().scheduled.emplace(time_us, std::move(function));
+}
+
+bool in_irq()
+{
+    return state().in_irq;
+}
+
+uint32_t blocking_calls_in_irq()
+{
+    return state().blocking_in_irq;
+}
+
+void set_gpio(uint gpio, bool level)
+{
+    state().gpio_levels.at(gpio) = level;
+}
+
+void drive_gpio(uint gpio, bool level)
+{
+    State& s = state();
+    if (s.gpio_levels.at(gpio) == level)
+        return;
+    s.gpio_levels.at(gpio) = level;
+    const uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((s.gpio_irq_masks.at(gpio) & event) == 0 || s.gpio_callback == nullptr)
+        return;
+    deliver([gpio, event]()
+    {
+        if (state().gpio_callback != nullptr)
+            state().gpio_callback(gpio, event);
+    });
+}
+
+void add_i2c_device(uint bus, uint8_t addr, std::vector<uint8_t> memory)
+{
+    state().i2c.at(bus).devices.push_back(I2CDevice{addr, std::move(memory)});
+}
+
+std::vector<uint8_t>& i2c_memory(uint bus, uint8_t addr)
+{
+    I2CDevice* device = find_device(bus, addr);
+    if (device == nullptr)
+    {
+        static std::vector<uint8_t> none;
+        none.clear();
+        return none;
+    }
+    return device->memory;
+}
+
+std::size_t run_i2c(uint bus, std::size_t commands)
+{
+    I2CBus& b = state().i2c.at(bus);
+    std::size_t done = 0;
+    while (done < commands && !b.tx.empty() && !b.aborted)
+    {
+        const uint32_t command = b.tx.front();
+        b.tx.pop_front();
+        ++done;
+        if (!b.in_transfer)
+        {
+            // STARTを送り，スレーブアドレスに応答がなければ中断する
+            if (find_device(bus, b.tar) == nullptr)
+            {
+                b.aborted = true;
+                b.tx.clear();
+                break;
+            }
+            b.in_transfer = true;
+            b.addressed = false;
+            b.reading = false;
+        }
+        I2CDevice* device = find_device(bus, b.tar);
+        if (command & I2C_IC_DATA_CMD_CMD_BITS)
+        {
+            if (!b.reading)
+            {
+                b.async_reads.emplace_back(static_cast<uint8_t>(b.tar), b.pointer);
+                if (state().i2c_read_hook)
+                {
+                    state().i2c_read_hook(bus, static_cast<uint8_t>(b.tar), b.pointer);  // 受信するメモリをテストが書き換える
+                    device = find_device(bus, b.tar);
+                }
+            }
+            b.reading = true;
+            const uint8_t value = device->memory.empty() ? 0 : device->memory[b.pointer++ % device->memory.size()];
+            if (b.rx.size() < I2CFifoDepth)
+                b.rx.push_back(value);
+        }
+        else if (!b.addressed)
+        {
+            b.pointer = static_cast<uint8_t>(command);  // 最初のバイトはメモリアドレス
+            b.addressed = true;
+        }
+        else if (!device->memory.empty())
+        {
+            device->memory[b.pointer++ % device->memory.size()] = static_cast<uint8_t>(command);
+        }
+        if (command & I2C_IC_DATA_CMD_STOP_BITS)
+            b.in_transfer = false;
+    }
+    state().now_us += transfer_time_us(bus, done);
+    raise_i2c_irq(bus);
+    return done;
+}
+
+void set_i2c_read_hook(std::function<void(uint bus, uint8_t addr, uint8_t memory_addr)> hook)
+{
+    state().i2c_read_hook = std::move(hook);
+}
+
+const std::vector<std::pair<uint8_t, uint8_t>>& i2c_async_reads(uint bus)
+{
+    return state().i2c.at(bus).async_reads;
+}
+
+uint i2c_baudrate(uint bus)
+{
+    return state().i2c.at(bus).baudrate;
+}
+
+void set_adc(uint channel, uint16_t value)
+{
+    state().adc_values.at(channel) = value;
+}
+
+void set_adc_read_hook(std::function<void(uint channel)> hook)
+{
+    state().adc_read_hook = std::move(hook);
+}
+
+void receive_uart(uint bus, const std::vector<uint8_t>& data)
+{
+    State& s = state();
+    std::deque<uint8_t>& input = s.uart_rx.at(bus);
+    input.insert(input.end(), data.begin(), data.end());
+    const uint irq = UART0_IRQ + bus;
+    if (!s.irq_lines.at(irq) || s.irq_handlers.at(irq) == nullptr)
+        return;
+    deliver([irq]()
+    {
+        if (state().irq_handlers[irq] != nullptr)
+            state().irq_handlers[irq]();
+    });
+}
+
+const std::vector<uint8_t>& uart_output(uint bus)
+{
+    return state().uart_tx.at(bus);
+}
+
+const std::vector<uint8_t>& spi_output(uint bus)
+{
+    return state().spi_tx.at(bus);
+}
+
+const std::vector<PwmEvent>& pwm_trace()
+{
+    return state().pwm_trace;
+}
+
+uint16_t pwm_level(uint gpio)
+{
+    return state().pwm_levels.at(gpio);
+}
+
+uint16_t pwm_wrap(uint gpio)
+{
+    return state().pwm_wraps.at(pwm_gpio_to_slice_num(gpio));
+}
+
+void power_on_reset(bool keep_ram)
+{
+    if (!keep_ram)
+    {
+        // 電源が落ちている間に，RAMはでたらめな値になる
+        uint32_t seed = static_cast<uint32_t>(state().now_us) ^ 0x9E3779B9u;
+        const auto [ram, ram_size] = noinit_ram();
+        for (std::size_t i = 0; i < ram_size; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            ram[i] = static_cast<uint8_t>(seed >> 24);
+        }
+    }
+    watchdog_hw_inst = watchdog_hw_t{};
+    vreg_and_chip_reset_hw->chip_reset = VREG_AND_CHIP_RESET_CHIP_RESET_HAD_POR_BITS;
+}
+
+void watchdog_reset()
+{
+    // ウォッチドッグのレジスタとチップのリセットの理由は残り，reasonだけが変わる
+    watchdog_hw->ctrl = 0;
+    watchdog_hw->reason = WATCHDOG_REASON_TIMER_BITS;
+}
+
+void run_pin_reset()
+{
+    watchdog_hw_inst = watchdog_hw_t{};
+    vreg_and_chip_reset_hw->chip_reset = VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS;
+}
+
+std::pair<uint8_t*, std::size_t> noinit_ram()
+{
+    if (__start_sc_fake_noinit == nullptr)
+        return {nullptr, 0};
+    return {__start_sc_fake_noinit, static_cast<std::size_t>(__stop_sc_fake_noinit - __start_sc_fake_noinit)};
+}
+
+std::vector<uint8_t>& flash_memory()
+{
+    return flash();
+}
+
+uintptr_t xip_base()
+{
+    return reinterpret_cast<uintptr_t>(flash().data());
+}
+
+uint32_t flash_erase_count()
+{
+    return state().flash_erases;
+}
+
+uint32_t flash_writes_with_interrupts()
+{
+    return state().flash_writes_with_irq;
+}
+
+}
@@ -0,0 +1,456 @@
+#ifndef SC19_PICO_TEST_FAKE_SDK_HPP_
+#define SC19_PICO_TEST_FAKE_SDK_HPP_
+
+/**************************************************
+ * テストでpico-SDKの代わりに使うコードです
+ * このファイルは，fake_sdk.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，scライブラリが使うpico-SDKの関数と，その状態をテストから操作する関数が宣言されています．
+ *   時計 : time_us_64などは仮想の時計を返し，タイマーのレジスタ(timer_hw)も仮想の時計を読み，sleep_msなどは仮想の時計を進めます (繰り返しタイマーもその間に呼ばれます)
+ *   割り込み : save_and_disable_interruptsで無効にしている間に起きた割り込みは，restore_interruptsで有効に戻したときに呼ばれます
+ *   GPIO : ピンの状態をテストから決め，変化させると割り込みのコールバックが呼ばれます
+ *   I2C : DesignWareのI2Cのレジスタ(FIFO，割り込みの状態など)と，メモリを持つデバイスをまねします
+ *   PWM : 出力レベルを時刻付きで記録します
+ *   ADC : テストから決めた測定値を返します (DMAによる連続測定はまねしません)
+ *   SPI，UART : 送信したデータを記録し，UARTはテストから渡したデータを受信の割り込みで読ませます
+ *   リセット : ウォッチドッグのスクラッチレジスタ，リセットの理由，フラッシュメモリ，初期化されないRAMを持ち，
+ *              電源の入れ直し・ウォッチドッグ・RUNピンのリセットで，それぞれ何が残るかをまねします
+ * I2CとADCは読まれる直前に，決めた時刻にはピンの変化とUARTの受信を起こせるので，記録した入力(トレース)を流し込んで再生できます．
+ * pico-SDKのヘッダ(pico/stdlib.hやhardware/i2c.hなど)はすべてこのファイルを読み込むだけです．
+**************************************************/
+
+//! @file fake_sdk.hpp
+//! @brief テスト用のpico-SDKの代わり
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(name) name
+#define __time_critical_func(name) name
+#define __not_in_flash(group)
+#define __uninitialized_ram(group) __attribute__((section("sc_fake_noinit"))) group  // 電源の入れ直しだけでこわれるRAM (sc::fake::noinit_ram)
+
+typedef volatile uint32_t io_rw_32;
+
+/***** 時計 *****/
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64();
+uint32_t time_us_32();
+absolute_time_t get_absolute_time();
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t to_us_since_boot(absolute_time_t t);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+void busy_wait_ms(uint32_t ms);
+void tight_loop_contents();
+bool stdio_init_all();
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t* rt);
+struct repeating_timer
+{
+    int64_t delay_us;
+    void* pool;
+    int32_t alarm_id;
+    repeating_timer_callback_t callback;
+    void* user_data;
+};
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out);
+bool cancel_repeating_timer(repeating_timer_t* timer);
+
+namespace sc::fake
+{
+//! @brief タイマーの生の値のレジスタ1つ (読むと仮想の時計の上位か下位の32bitを返す)
+class TimerRawRegister
+{
+    bool _high;  // 上位の32bitか
+public:
+    explicit constexpr TimerRawRegister(bool high):
+        _high(high) {}
+    operator uint32_t() const;
+};
+}
+
+//! @brief タイマーのレジスタ (pico-SDKのtimer_hw_tと同じ名前で，読むものだけ)
+struct timer_hw_t
+{
+    sc::fake::TimerRawRegister timerawh{true}, timerawl{false};
+};
+extern timer_hw_t timer_hw_inst;
+#define timer_hw (&timer_hw_inst)
+
+/***** 割り込み *****/
+
+#define IO_IRQ_BANK0 13
+#define UART0_IRQ 20
+#define UART1_IRQ 21
+#define I2C0_IRQ 23
+#define I2C1_IRQ 24
+#define DMA_IRQ_0 11
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)();
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
+
+/***** GPIO *****/
+
+enum gpio_function {GPIO_FUNC_XIP = 0, GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5, GPIO_FUNC_NULL = 0x1f};
+enum gpio_irq_level {GPIO_IRQ_LEVEL_LOW = 0x1u, GPIO_IRQ_LEVEL_HIGH = 0x2u, GPIO_IRQ_EDGE_FALL = 0x4u, GPIO_IRQ_EDGE_RISE = 0x8u};
+#define GPIO_OUT 1
+#define GPIO_IN 0
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function function);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+
+/***** I2C *****/
+
+namespace sc::fake
+{
+//! @brief I2Cのレジスタ1つ (読み書きするとI2Cのモデルが動く)
+class I2CRegister
+{
+    uint _bus = 0;  // I2C0かI2C1か
+    uint _offset = 0;  // レジスタの番号
+public:
+    void attach(uint bus, uint offset)
+        {_bus = bus; _offset = offset;}
+    operator uint32_t() const;
+    I2CRegister& operator=(uint32_t value);
+    I2CRegister& operator=(const I2CRegister& other)
+        {return *this = static_cast<uint32_t>(other);}
+};
+}
+
+//! @brief I2Cのレジスタ (pico-SDKのi2c_hw_tと同じ名前で，I2CAsyncが使うものだけ)
+struct i2c_hw_t
+{
+    sc::fake::I2CRegister con, tar, data_cmd, intr_stat, intr_mask, raw_intr_stat, rx_tl, tx_tl, clr_intr, clr_tx_abrt, enable, status, txflr, rxflr, tx_abrt_source;
+};
+
+struct i2c_inst
+{
+    i2c_hw_t* hw;
+    bool restart_on_next;
+};
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_INTR_MASK_M_RX_FULL_BITS 0x00000004u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_STAT_R_RX_FULL_BITS 0x00000004u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_ENABLE_ENABLE_BITS 0x00000001u
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t* i2c);
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate);
+uint i2c_hw_index(i2c_inst_t* i2c);
+i2c_hw_t* i2c_get_hw(i2c_inst_t* i2c);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop);
+int i2c_write_blocking_until(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, absolute_time_t until);
+int i2c_read_blocking_until(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop, absolute_time_t until);
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop, uint timeout_us);
+
+/***** SPI *****/
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t* const spi0;
+extern spi_inst_t* const spi1;
+typedef enum {SPI_CPOL_0 = 0, SPI_CPOL_1 = 1} spi_cpol_t;
+typedef enum {SPI_CPHA_0 = 0, SPI_CPHA_1 = 1} spi_cpha_t;
+typedef enum {SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1} spi_order_t;
+uint spi_init(spi_inst_t* spi, uint baudrate);
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len);
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len);
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len);
+
+/***** UART *****/
+
+typedef struct uart_inst uart_inst_t;
+extern uart_inst_t* const uart0;
+extern uart_inst_t* const uart1;
+typedef enum {UART_PARITY_NONE, UART_PARITY_EVEN, UART_PARITY_ODD} uart_parity_t;
+uint uart_init(uart_inst_t* uart, uint baudrate);
+void uart_deinit(uart_inst_t* uart);
+uint uart_set_baudrate(uart_inst_t* uart, uint baudrate);
+void uart_set_hw_flow(uart_inst_t* uart, bool cts, bool rts);
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits, uart_parity_t parity);
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled);
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data, bool tx_needs_data);
+uint uart_get_index(uart_inst_t* uart);
+bool uart_is_readable(uart_inst_t* uart);
+char uart_getc(uart_inst_t* uart);
+void uart_putc(uart_inst_t* uart, char c);
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len);
+void uart_read_blocking(uart_inst_t* uart, uint8_t* dst, size_t len);
+
+/***** ADC *****/
+
+//! @brief ADCのレジスタ (pico-SDKのadc_hw_tと同じ名前で，AdcSamplerが使うものだけ)
+struct adc_hw_t
+{
+    io_rw_32 fifo;
+};
+extern adc_hw_t* const adc_hw;
+void adc_init();
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read();
+void adc_set_temp_sensor_enabled(bool enable);
+void adc_set_round_robin(uint input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_fifo_drain();
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+
+/***** DMA *****/
+
+// AdcSamplerをコンパイルするためだけのもの (転送はまねしないので，dma_channel_configureは例外を投げる)
+#define DREQ_ADC 36
+enum dma_channel_transfer_size {DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2};
+struct dma_channel_config
+{
+    uint32_t ctrl;
+};
+//! @brief DMAのチャンネルのレジスタ (pico-SDKのdma_channel_hw_tと同じ並び)
+struct dma_channel_hw_t
+{
+    io_rw_32 read_addr, write_addr, transfer_count, ctrl_trig;
+};
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits);
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, uint transfer_count, bool trigger);
+dma_channel_hw_t* dma_channel_hw_addr(uint channel);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_abort(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+
+/***** PWM *****/
+
+#define NUM_PWM_SLICES 8
+enum {PWM_CHAN_A = 0, PWM_CHAN_B = 1};
+uint pwm_gpio_to_slice_num(uint gpio);
+uint pwm_gpio_to_channel(uint gpio);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_phase_correct(uint slice_num, bool phase_correct);
+void pwm_set_output_polarity(uint slice_num, bool a, bool b);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+
+/***** ウォッチドッグ，リセットの理由 *****/
+
+//! @brief ウォッチドッグのレジスタ (pico-SDKのwatchdog_hw_tと同じ並び)
+struct watchdog_hw_t
+{
+    io_rw_32 ctrl, load, reason, scratch[8], tick;
+};
+extern watchdog_hw_t watchdog_hw_inst;
+#define watchdog_hw (&watchdog_hw_inst)
+
+#define WATCHDOG_CTRL_ENABLE_BITS 0x40000000u
+#define WATCHDOG_REASON_TIMER_BITS 0x00000001u
+#define WATCHDOG_REASON_FORCE_BITS 0x00000002u
+
+//! @brief 電源とチップのリセットのレジスタ (pico-SDKのvreg_and_chip_reset_hw_tと同じ並び)
+struct vreg_and_chip_reset_hw_t
+{
+    io_rw_32 vreg, bod, chip_reset;
+};
+extern vreg_and_chip_reset_hw_t vreg_and_chip_reset_hw_inst;
+#define vreg_and_chip_reset_hw (&vreg_and_chip_reset_hw_inst)
+
+#define VREG_AND_CHIP_RESET_CHIP_RESET_HAD_POR_BITS 0x00000100u
+#define VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS 0x00010000u
+#define VREG_AND_CHIP_RESET_CHIP_RESET_HAD_PSM_RESTART_BITS 0x00100000u
+
+void hw_set_bits(io_rw_32* addr, uint32_t mask);
+void hw_clear_bits(io_rw_32* addr, uint32_t mask);
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update();
+bool watchdog_caused_reboot();
+bool watchdog_enable_caused_reboot();
+
+/***** フラッシュメモリ *****/
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2u * 1024 * 1024)
+#define XIP_BASE (sc::fake::xip_base())  // 読み出すときのアドレス (fakeのフラッシュメモリの先頭)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+
+/***** テストから操作する関数 *****/
+
+namespace sc::fake
+{
+
+//! @brief すべての状態を初期化する (時刻0，割り込みは有効，デバイスなし)
+void reset();
+
+//! @brief 仮想の時計を進める (その間に時刻がきた繰り返しタイマーを割り込みとして呼ぶ)
+void advance_us(uint64_t us);
+
+//! @brief 仮想の時計がtime_usになったときに関数を呼ぶ (ピンの変化やUARTの受信を，決めた時刻に起こす)
+//! @note 割り込みの中ではなくadvance_usの中で呼ばれます (割り込みはdrive_gpioやreceive_uartが起こします)
+//! @param time_us 起動からの時間 (μs)  過ぎていれば，次に時計を進めたときに呼ぶ
+void schedule_at(uint64_t time_us, std::function<void()> function);
+
+//! @brief 今，割り込みの中か
+bool in_irq();
+
+//! @brief 割り込みの中で呼ばれた，待機やピンの機能の変更などの重い処理の数
+//! @note busy_wait_us，sleep_us，gpio_set_function，i2c_set_baudrate，i2c_initを数えます
+uint32_t blocking_calls_in_irq();
+
+//! @brief ピンの状態を決める (割り込みは起こさない)
+void set_gpio(uint gpio, bool level);
+
+//! @brief ピンの状態を変え，割り込みが有効なら立ち上がり/立ち下がりのコールバックを呼ぶ
+//! @note 割り込みを無効にしている間なら，restore_interruptsのときに呼ばれます
+void drive_gpio(uint gpio, bool level);
+
+//! @brief I2Cのデバイスを加える
+//! @param bus I2C0(0)かI2C1(1)か
+//! @param addr スレーブアドレス
+//! @param memory デバイスのメモリ (メモリアドレスの番地から読み書きされる)
+void add_i2c_device(uint bus, uint8_t addr, std::vector<uint8_t> memory);
+
+//! @brief I2Cのデバイスのメモリ
+std::vector<uint8_t>& i2c_memory(uint bus, uint8_t addr);
+
+//! @brief I2CのFIFOに詰められたコマンドを，最大でcommands個だけバスに送る
+//! @note 受信したデータがたまったり，応答がなくて中断したりすると，I2Cの割り込みが起きます
+//! @return 送ったコマンドの数
+std::size_t run_i2c(uint bus, std::size_t commands = SIZE_MAX);
+
+//! @brief I2Cのデバイスから受信を始める直前に呼ぶ関数を決める (受信されるメモリをそこで書き換えられる)
+//! @note 待機する受信(i2c_read_blocking)と，FIFOのコマンドによる受信(run_i2c)の両方で，1回の通信につき1回呼ばれます
+//! @param hook (バス，スレーブアドレス，メモリアドレス)を受け取る関数  空なら呼ばない
+void set_i2c_read_hook(std::function<void(uint bus, uint8_t addr, uint8_t memory_addr)> hook);
+
+//! @brief 割り込みで受信を始めた順の (スレーブアドレス，メモリアドレス)
+const std::vector<std::pair<uint8_t, uint8_t>>& i2c_async_reads(uint bus);
+
+//! @brief 今設定されているI2Cの通信速度 (Hz)
+uint i2c_baudrate(uint bus);
+
+//! @brief ADCの測定値を決める
+//! @param channel ADCのチャンネル (0～4)
+//! @param value 測定値 (12bit)
+void set_adc(uint channel, uint16_t value);
+
+//! @brief ADCで測定する直前に呼ぶ関数を決める (set_adcで測定値をそこで決められる)
+//! @param hook チャンネルを受け取る関数  空なら呼ばない
+void set_adc_read_hook(std::function<void(uint channel)> hook);
+
+//! @brief UARTでデータを受信する (受信の割り込みが有効なら，割り込みの中で読まれる)
+//! @param bus UART0(0)かUART1(1)か
+void receive_uart(uint bus, const std::vector<uint8_t>& data);
+
+//! @brief UARTで送信したデータ (reset()から順に)
+const std::vector<uint8_t>& uart_output(uint bus);
+
+//! @brief SPIで送信したデータ (reset()から順に，CSピンの区切りなし)
+const std::vector<uint8_t>& spi_output(uint bus);
+
+//! @brief PWMの出力レベルが変わった記録
+struct PwmEvent
+{
+    uint64_t time_us;  // 変わった時刻 (μs)
+    uint gpio;  // GPIO番号
+    uint16_t level;  // 出力レベル
+};
+
+//! @brief PWMの出力レベルが変わった記録 (時刻順)
+const std::vector<PwmEvent>& pwm_trace();
+
+//! @brief PWMの今の出力レベル
+uint16_t pwm_level(uint gpio);
+
+//! @brief PWMのwrap (出力レベルの最大値)
+uint16_t pwm_wrap(uint gpio);
+
+//! @brief 電源を入れ直す (ウォッチドッグのレジスタは0に，初期化されないRAMはでたらめな値になる)
+//! @param keep_ram 短い電圧低下(ブラウンアウト)のように，RAMが残るか
+//! @note RP2040では，内蔵のブラウンアウト検出によるリセットも電源を入れたときと同じHAD_PORになります
+void power_on_reset(bool keep_ram = false);
+
+//! @brief ウォッチドッグのタイムアウトでリセットする (RAMとスクラッチレジスタは残る)
+void watchdog_reset();
+
+//! @brief RUNピンでリセットする (RAMは残り，ウォッチドッグのレジスタは0になる)
+void run_pin_reset();
+
+//! @brief 初期化されないRAM (__uninitialized_ramで置いた変数すべて)
+//! @return 先頭とバイト数
+std::pair<uint8_t*, std::size_t> noinit_ram();
+
+//! @brief フラッシュメモリの内容 (PICO_FLASH_SIZE_BYTESバイト，消去すると0xFF)
+std::vector<uint8_t>& flash_memory();
+
+//! @brief XIP_BASEの値 (フラッシュメモリの内容の先頭のアドレス)
+uintptr_t xip_base();
+
+//! @brief フラッシュメモリのセクタを消去した回数
+uint32_t flash_erase_count();
+
+//! @brief 割り込みを有効にしたまま，フラッシュメモリを消去・書き込みした回数 (実機ではXIPの読み出しと衝突する)
+uint32_t flash_writes_with_interrupts();
+
+}
+
+#endif  // SC19_PICO_TEST_FAKE_SDK_HPP_
@@ -0,0 +1,7 @@
+#ifndef SC19_PICO_TEST_FAKE_HARDWARE_FLASH_H_
+#define SC19_PICO_TEST_FAKE_HARDWARE_FLASH_H_
+
+// テストではpico-SDKの代わりにfake_sdk.hppを使う
+#include "fake_sdk.hpp"
+
+#endif  // SC19_PICO_TEST_FAKE_HARDWARE_FLASH_H_
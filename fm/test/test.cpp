@@ -0,0 +1,101 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ * このファイルは，test.hppに名前だけ書かれている関数の中身と，テストを実行するmain関数です
+ *
+ * 登録したテストを順に実行し，確かめた条件が1つでも成り立たなければ終了コードを1にします (ctestで使う)．
+ *
+ *     ./TEST_NAVIGATION              すべて実行
+ *     ./TEST_NAVIGATION sphere       名前に"sphere"を含むものだけ実行
+**************************************************/
+
+//! @file test.cpp
+//! @brief テストの登録と実行
+
+#include "test.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "fake_sdk.hpp"
+#include "sc_basic.hpp"
+
+namespace sc::test
+{
+
+namespace
+{
+
+//! @brief 登録したテスト
+struct Entry
+{
+    const char* name;
+    Function function;
+};
+
+//! @brief 登録したテストの一覧 (静的変数の初期化順に依存しないよう，関数の中に置く)
+std::vector<Entry>& entries()
+{
+    static std::vector<Entry> list;
+    return list;
+}
+
+std::size_t Failures = 0;  // 実行中のテストで成り立たなかった条件の数
+
+}
+
+bool add(const char* name, Function function)
+{
+    entries().push_back(Entry{name, function});
+    return true;
+}
+
+void fail(const char* file, int line, const char* expression)
+{
+    ++Failures;
+    std::printf("%s:%d: check failed: %s\n", file, line, expression);
+}
+
+void check_near(double actual, double expected, double tolerance, const char* file, int line, const char* expression)
+{
+    if (std::fabs(actual - expected) <= tolerance)
+        return;
+    ++Failures;
+    std::printf("%s:%d: check failed: %s = %.9g (expected %.9g ± %.3g)\n", file, line, expression, actual, expected, tolerance);
+}
+
+void report(const char* name, double value)
+{
+    std::printf("    %s: %.6g\n", name, value);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filter = (argc > 1) ? argv[1] : "";
+    std::size_t run = 0, failed = 0;
+    for (const auto& entry : sc::test::entries())
+    {
+        if (std::strstr(entry.name, filter) == nullptr)
+            continue;
+        sc::fake::reset();  // 仮想の時計やI2Cの状態を初期化する
+        sc::Pin::Status.assign(sc::Pin::Status.size(), sc::PinStatus::NoUse);  // どのテストも同じピンを使えるようにする
+        sc::test::Failures = 0;
+        std::printf("[ RUN  ] %s\n", entry.name);
+        try
+        {
+            entry.function();
+        }
+        catch(const std::exception& e)
+        {
+            ++sc::test::Failures;
+            std::printf("unexpected exception: %s\n", e.what());
+        }
+        std::printf("[ %s ] %s\n", sc::test::Failures == 0 ? " OK " : "FAIL", entry.name);
+        ++run;
+        failed += (sc::test::Failures != 0);
+    }
+    std::printf("%zu test(s), %zu failed\n", run, failed);
+    return (failed == 0 && run > 0) ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#ifndef SC19_PICO_TEST_TEST_HPP_
+#define SC19_PICO_TEST_TEST_HPP_
+
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ * このファイルは，test.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，テストの登録と，結果を確かめるマクロが宣言されています．
+ * 書き方はbench.hppのベンチマークと同じで，テストの関数を定義してSC_TESTで登録します．
+ *
+ *     SC_TEST(example)
+ *     {
+ *         SC_CHECK(1 + 1 == 2);
+ *         SC_CHECK_NEAR(std::sqrt(2.0), 1.414, 0.001);
+ *     }
+ *
+ * pico-SDKの関数はfake/のもの(仮想の時計，GPIO，I2Cのレジスタなど)を使うので，ハードウェアがなくても実行できます．
+ * 各テストの前に，fakeの状態とピンの使用状況は初期化されます．
+**************************************************/
+
+//! @file test.hpp
+//! @brief テストの登録と結果の確認
+
+#include <cstdio>
+
+namespace sc::test
+{
+
+using Function = void (*)();  // テストの関数
+
+//! @brief テストを登録 (SC_TESTから呼ばれる)
+//! @param name テストの名前
+//! @param function テストの関数
+//! @return 常にtrue (静的変数の初期化で呼ぶため)
+bool add(const char* name, Function function);
+
+//! @brief 確かめた条件が成り立たなかったことを記録 (SC_CHECKから呼ばれる)
+void fail(const char* file, int line, const char* expression);
+
+//! @brief 2つの値が近いかを確かめる (SC_CHECK_NEARから呼ばれる)
+void check_near(double actual, double expected, double tolerance, const char* file, int line, const char* expression);
+
+//! @brief テストの結果として値を出力する (整定時間など，合否のほかに見ておきたい値)
+//! @param name 値の名前
+//! @param value 値
+void report(const char* name, double value);
+
+}
+
+#define SC_TEST_CONCAT_IMPL(a, b) a##b
+#define SC_TEST_CONCAT(a, b) SC_TEST_CONCAT_IMPL(a, b)
+
+//! @brief テストを定義して登録
+//! @param name テストの名前 (関数名になる)
+#define SC_TEST(name) \
+    static void name(); \
+    static const bool SC_TEST_CONCAT(sc_test_registered_, __LINE__) = ::sc::test::add(#name, name); \
+    static void name()
+
+//! @brief 条件が成り立つかを確かめる (成り立たなくてもテストは続ける)
+#define SC_CHECK(condition) \
+    ((condition) ? static_cast<void>(0) : ::sc::test::fail(__FILE__, __LINE__, #condition))
+
+//! @brief 値がexpected±toleranceの範囲にあるかを確かめる
+#define SC_CHECK_NEAR(actual, expected, tolerance) \
+    ::sc::test::check_near((actual), (expected), (tolerance), __FILE__, __LINE__, #actual)
+
+#endif  // SC19_PICO_TEST_TEST_HPP_
@@ -0,0 +1,165 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，BinaryViewとStaticBinaryを使った通信(i2c.hpp，spi.hpp，uart.hpp)のテストが定義されています．
+ * このテストのプログラム全体でoperator newを置き換えてメモリを確保した回数を数え，
+ * 送受信の関数を1回呼ぶ間に1回も確保しないことと，送受信したデータが正しいことを確かめます．
+ * 比べるために，Binaryを使う関数では確保した回数を出力します．
+**************************************************/
+
+//! @file test_binary_alloc.cpp
+//! @brief 動的メモリを使わない通信のテスト
+
+#include "test.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "binary.hpp"
+#include "fake_sdk.hpp"
+#include "i2c.hpp"
+#include "spi.hpp"
+#include "uart.hpp"
+
+namespace
+{
+
+std::size_t Allocations = 0;  // operator newが呼ばれた回数
+
+}
+
+// このプログラムのすべてのnewとdeleteをここで受ける
+void* operator new(std::size_t size)
+{
+    ++Allocations;
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint8_t DeviceAddr = 0x76;  // I2Cのデバイスのスレーブアドレス (BME280と同じ)
+
+//! @brief functionを実行する間にメモリを確保した回数
+template<typename Function>
+std::size_t allocations(Function&& function)
+{
+    const std::size_t before = Allocations;
+    function();
+    return Allocations - before;
+}
+
+SC_TEST(i2c_view_paths_do_not_allocate)
+{
+    std::vector<uint8_t> memory(256);
+    for (std::size_t i = 0; i < memory.size(); ++i)
+        memory[i] = static_cast<uint8_t>(i);
+    fake::add_i2c_device(0, DeviceAddr, memory);
+    const I2C i2c(SDA(4), SCL(5));
+    const SlaveAddr slave_addr(DeviceAddr);
+
+    StaticBinary<6> sample;
+    SC_CHECK(allocations([&]{i2c.read_memory(sample, slave_addr, 0x10);}) == 0);
+    SC_CHECK(sample.size() == 6 && sample[0] == 0x10 && sample[5] == 0x15);
+
+    const StaticBinary<3> config{0xA1, 0xA2, 0xA3};
+    SC_CHECK(allocations([&]{i2c.write_memory(config, slave_addr, 0x40);}) == 0);
+    SC_CHECK(fake::i2c_memory(0, DeviceAddr)[0x40] == 0xA1 && fake::i2c_memory(0, DeviceAddr)[0x42] == 0xA3);
+
+    const uint8_t pointer[] = {0x40};
+    StaticBinary<3> input;
+    SC_CHECK(allocations([&]{i2c.write(BinaryView(pointer, 1), slave_addr);}) == 0);
+    SC_CHECK(allocations([&]{i2c.read(input, slave_addr);}) == 0);
+    SC_CHECK(input[0] == 0xA1 && input[2] == 0xA3);
+
+    uint8_t raw[4];
+    SC_CHECK(allocations([&]{i2c.read_memory(raw, sizeof(raw), slave_addr, 0x20);}) == 0);
+    SC_CHECK(raw[0] == 0x20 && raw[3] == 0x23);
+
+    // MaxStackWriteバイトを超えると，メモリアドレスをつなげるために1回だけ確保する
+    StaticBinary<I2C::MaxStackWrite + 1> large;
+    SC_CHECK(allocations([&]{i2c.write_memory(large, slave_addr, 0x80);}) == 1);
+
+    // Binaryを使う関数は，受信したデータを入れるために確保する
+    const std::size_t binary = allocations([&]{Binary data = i2c.read_memory(6, slave_addr, 0x10);});
+    sc::test::report("allocations in read_memory returning Binary", binary);
+    SC_CHECK(binary > 0);
+}
+
+SC_TEST(spi_view_paths_do_not_allocate)
+{
+    const SPI spi(MISO(16), CS(17), SCK(18), MOSI(19));
+    const CS cs(17);
+
+    const StaticBinary<2> command{0x12, 0x34};
+    SC_CHECK(allocations([&]{spi.write_memory(command, cs, 0x75);}) == 0);
+    SC_CHECK(allocations([&]{spi.write(command, cs);}) == 0);
+    // 1回の通信で，メモリアドレス(書き込みは最上位ビットが0)とデータを続けて送る
+    const std::vector<uint8_t> expected = {0x75, 0x12, 0x34, 0x12, 0x34};
+    SC_CHECK(fake::spi_output(0) == expected);
+
+    StaticBinary<4> input;
+    SC_CHECK(allocations([&]{spi.read(input, cs);}) == 0);
+    SC_CHECK(input.size() == 4);
+    SC_CHECK(allocations([&]{spi.read_memory(input, cs, 0x50);}) == 0);
+    SC_CHECK(fake::spi_output(0).back() == 0xD0);  // 読み込みは最上位ビットが1
+
+    const std::size_t binary = allocations([&]{Binary data = spi.read_memory(4, cs, 0x50);});
+    sc::test::report("allocations in read_memory returning Binary", binary);
+    SC_CHECK(binary > 0);
+
+    // SPIに設定していないCSピンは使えない
+    bool thrown = false;
+    try
+    {
+        spi.write(command, CS(20));
+    }
+    catch(const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    SC_CHECK(thrown);
+}
+
+SC_TEST(uart_view_paths_do_not_allocate)
+{
+    const UART uart(TX(0), RX(1), Frequency<Unit::Hz>(115200));
+
+    const StaticBinary<5> message{'h', 'e', 'l', 'l', 'o'};
+    SC_CHECK(allocations([&]{uart.write(message);}) == 0);
+    SC_CHECK(fake::uart_output(0) == std::vector<uint8_t>({'h', 'e', 'l', 'l', 'o'}));
+
+    // 割り込みで受信したデータを，読み込むときに取り出す
+    fake::receive_uart(0, {'$', 'G', 'P', 'G', 'G', 'A'});
+    StaticBinary<4> input;
+    SC_CHECK(allocations([&]{uart.read(input);}) == 0);
+    SC_CHECK(input.size() == 4 && input[0] == '$' && input[3] == 'G');
+    SC_CHECK(allocations([&]{uart.read(input);}) == 0);  // 残りの2バイト
+    SC_CHECK(input.size() == 2 && input[0] == 'G' && input[1] == 'A');
+    SC_CHECK(allocations([&]{uart.read(input);}) == 0);  // 何も受信していない
+    SC_CHECK(input.size() == 0);
+
+    // Binaryはstd::basic_stringなので，短いデータなら確保しない (16バイト以上受信させる)
+    const char sentence[] = "$GPGGA,085120.307,3541.1493,N";
+    fake::receive_uart(0, std::vector<uint8_t>(sentence, sentence + sizeof(sentence) - 1));
+    const std::size_t binary = allocations([&]{Binary data = uart.read();});
+    sc::test::report("allocations in read returning Binary", binary);
+    SC_CHECK(binary > 0);
+}
+
+}
@@ -0,0 +1,261 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，リセット後にミッションを途中から再開する処理(checkpoint.hpp)のテストが定義されています．
+ * fake/のリセット(電源の入れ直し，ウォッチドッグ，RUNピン)で何が残るかをまねし，
+ * 初期化されないRAM，ウォッチドッグのスクラッチレジスタ，フラッシュメモリを1つずつ壊したり消したりして，
+ * どの記録から再開するか(または再開しないか)を確かめます．
+ * 特に，電源を入れたときに前回の飛行の古いフラッシュメモリの記録から再開しないことを確かめます．
+**************************************************/
+
+//! @file test_checkpoint.cpp
+//! @brief リセット後にミッションを途中から再開する処理のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+
+#include "checkpoint.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint32_t FlashOffset = 0x1EF000;  // Checkpointがフラッシュメモリに保存する位置
+
+//! @brief 遠距離フェーズの途中の状態
+MissionState ldistance(uint32_t elapsed_ms)
+{
+    MissionState state;
+    state.phase = 2;
+    state.elapsed_ms = elapsed_ms;
+    state.origin_pressure = 100812.5F;
+    state.origin_temperature = 23.25F;
+    state.has_fix = true;
+    state.latitude = 40.1425;
+    state.longitude = -119.1731;
+    return state;
+}
+
+//! @brief 初期化されないRAMの1バイトを壊す
+void corrupt_ram()
+{
+    const auto [ram, size] = fake::noinit_ram();
+    SC_CHECK(size >= 64);
+    if (size > 0)
+        ram[10] ^= 0x01;
+}
+
+//! @brief ウォッチドッグのスクラッチレジスタの1bitを壊す (CRCで分かる)
+void corrupt_scratch()
+{
+    watchdog_hw->scratch[1] = watchdog_hw->scratch[1] ^ 0x100;
+}
+
+//! @brief フラッシュメモリの記録の1bitを壊す
+void corrupt_flash()
+{
+    fake::flash_memory()[FlashOffset + 12] ^= 0x01;
+}
+
+//! @brief 保存されているのが空のセクタか
+bool flash_erased()
+{
+    const auto& flash = fake::flash_memory();
+    return std::all_of(flash.begin() + FlashOffset, flash.begin() + FlashOffset + FLASH_SECTOR_SIZE, [](uint8_t byte){return byte == 0xFF;});
+}
+
+//! @brief 遠距離フェーズに移ってから，1秒ごとにelapsed_ms(ms)まで保存する (フラッシュメモリには0,10,20,...秒に保存される)
+void fly(Checkpoint& checkpoint, uint32_t elapsed_ms)
+{
+    MissionState wait;
+    wait.origin_pressure = 100812.5F;
+    wait.origin_temperature = 23.25F;
+    checkpoint.store(wait);
+    for (uint32_t t = 0; t <= elapsed_ms; t += 1000)
+        checkpoint.store(ldistance(t));
+}
+
+SC_TEST(first_boot_has_nothing)
+{
+    Checkpoint checkpoint;
+    SC_CHECK(!checkpoint.restore());
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::None);
+    SC_CHECK(Checkpoint::reset_reason() == Checkpoint::ResetReason::PowerOn);
+}
+
+SC_TEST(ram_restores_everything)
+{
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+    }
+    fake::watchdog_reset();
+    Checkpoint checkpoint;
+    const auto restored = checkpoint.restore();
+    SC_CHECK(Checkpoint::reset_reason() == Checkpoint::ResetReason::Watchdog);
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::Ram);
+    SC_CHECK(restored && restored->phase == 2 && restored->elapsed_ms == 35000);
+    SC_CHECK(restored && restored->has_fix && restored->latitude == 40.1425 && restored->longitude == -119.1731);
+    SC_CHECK(restored && restored->origin_pressure == 100812.5F && restored->origin_temperature == 23.25F);
+    SC_CHECK(fake::flash_writes_with_interrupts() == 0);
+}
+
+SC_TEST(scratch_when_ram_is_corrupted)
+{
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+    }
+    fake::watchdog_reset();
+    corrupt_ram();
+    Checkpoint checkpoint;
+    const auto restored = checkpoint.restore();
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::Scratch);
+    // スクラッチレジスタにはフェーズ，時間，基準しかない (GPSの位置は失う)
+    SC_CHECK(restored && restored->phase == 2 && restored->elapsed_ms == 35000);
+    SC_CHECK(restored && restored->origin_pressure == 100812.5F && restored->origin_temperature == 23.25F);
+    SC_CHECK(restored && !restored->has_fix);
+}
+
+SC_TEST(flash_when_ram_and_scratch_are_corrupted)
+{
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+        SC_CHECK(fake::flash_erase_count() == 5);  // 待機フェーズの1回と，遠距離フェーズの0,10,20,30秒
+    }
+    fake::watchdog_reset();
+    corrupt_ram();
+    corrupt_scratch();
+    Checkpoint checkpoint;
+    const auto restored = checkpoint.restore();
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::Flash);
+    // フラッシュメモリに最後に保存したときの状態 (GPSの位置も残っている)
+    SC_CHECK(restored && restored->phase == 2 && restored->elapsed_ms == 30000);
+    SC_CHECK(restored && restored->has_fix && restored->latitude == 40.1425);
+}
+
+SC_TEST(all_layers_corrupted)
+{
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+    }
+    fake::watchdog_reset();
+    corrupt_ram();
+    corrupt_scratch();
+    corrupt_flash();
+    Checkpoint checkpoint;
+    SC_CHECK(!checkpoint.restore());
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::None);
+}
+
+SC_TEST(run_pin_clears_scratch_but_keeps_ram_and_flash)
+{
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 15000);
+    }
+    fake::run_pin_reset();
+    {
+        Checkpoint checkpoint;
+        const auto restored = checkpoint.restore();
+        SC_CHECK(Checkpoint::reset_reason() == Checkpoint::ResetReason::RunPin);
+        SC_CHECK(checkpoint.source() == Checkpoint::Source::Ram);
+        SC_CHECK(restored && restored->elapsed_ms == 15000);
+    }
+    // RAMが壊れていれば，スクラッチレジスタは消えているのでフラッシュメモリから
+    corrupt_ram();
+    Checkpoint checkpoint;
+    const auto restored = checkpoint.restore();
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::Flash);
+    SC_CHECK(restored && restored->elapsed_ms == 10000);
+}
+
+SC_TEST(power_on_discards_stale_flash)
+{
+    // 前回の飛行の途中で電源を切り，次に電源を入れたとき
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+    }
+    fake::power_on_reset();
+    const uint32_t erases = fake::flash_erase_count();
+    {
+        Checkpoint checkpoint;
+        SC_CHECK(!checkpoint.restore());
+        SC_CHECK(checkpoint.source() == Checkpoint::Source::None);
+        SC_CHECK(flash_erased());
+        SC_CHECK(fake::flash_erase_count() == erases + 1);
+    }
+    // 消したので，その後にウォッチドッグでリセットされても古い記録から再開しない
+    fake::watchdog_reset();
+    corrupt_ram();
+    Checkpoint checkpoint;
+    SC_CHECK(!checkpoint.restore());
+    SC_CHECK(fake::flash_erase_count() == erases + 1);  // 記録がなければ消去しない
+    SC_CHECK(fake::flash_writes_with_interrupts() == 0);
+}
+
+SC_TEST(brown_out_resumes_from_ram)
+{
+    // 短い電圧低下では，リセットの理由は電源を入れたときと同じだが，RAMが残る
+    {
+        Checkpoint checkpoint;
+        fly(checkpoint, 35000);
+    }
+    fake::power_on_reset(true);
+    Checkpoint checkpoint;
+    const auto restored = checkpoint.restore();
+    SC_CHECK(Checkpoint::reset_reason() == Checkpoint::ResetReason::PowerOn);
+    SC_CHECK(checkpoint.source() == Checkpoint::Source::Ram);
+    SC_CHECK(restored && restored->phase == 2 && restored->elapsed_ms == 35000);
+}
+
+SC_TEST(wait_phase_is_written_once_and_not_read_from_flash)
+{
+    {
+        Checkpoint checkpoint;
+        MissionState wait;
+        for (uint32_t t = 0; t < 60000; t += 1000)
+        {
+            wait.elapsed_ms = t;
+            checkpoint.store(wait);
+        }
+        SC_CHECK(fake::flash_erase_count() == 1);  // 前回の飛行の状態を上書きする1回だけ
+    }
+    // ウォッチドッグでもRAMから読めれば待機フェーズから再開する
+    fake::watchdog_reset();
+    {
+        Checkpoint checkpoint;
+        const auto restored = checkpoint.restore();
+        SC_CHECK(checkpoint.source() == Checkpoint::Source::Ram);
+        SC_CHECK(restored && restored->phase == 0 && restored->elapsed_ms == 59000);
+    }
+    // フラッシュメモリの待機フェーズは，電源を入れ直しただけのときと区別できないので読まない (消去もしない)
+    corrupt_ram();
+    corrupt_scratch();
+    const uint32_t erases = fake::flash_erase_count();
+    fake::power_on_reset();
+    Checkpoint checkpoint;
+    SC_CHECK(!checkpoint.restore());
+    SC_CHECK(fake::flash_erase_count() == erases);
+}
+
+SC_TEST(clear_removes_every_layer)
+{
+    Checkpoint checkpoint;
+    fly(checkpoint, 35000);
+    checkpoint.clear();
+    SC_CHECK(flash_erased());
+    for (std::size_t i = 0; i < 4; ++i)
+        SC_CHECK(watchdog_hw->scratch[i] == 0);
+    fake::watchdog_reset();
+    Checkpoint restarted;
+    SC_CHECK(!restarted.restore());
+    SC_CHECK(restarted.source() == Checkpoint::Source::None);
+}
+
+}
@@ -0,0 +1,169 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，GPIOピンの変化の割り込みによる記録(edge_input.hpp)のテストが定義されています．
+ * 仮想の時計を進めながらfake::drive_gpioでピンを動かし，チャタリングやノイズ(短いパルス)を混ぜて，
+ * debounceより短い変化は記録されないこと，本当の変化は1回だけ最初に変化した時刻で記録されること，
+ * 記録されるのは最後の変化からdebounceの時間が経った後であることを確かめます．
+**************************************************/
+
+//! @file test_edge_input.cpp
+//! @brief GPIOピンの変化の割り込みによる記録のテスト
+
+#include "test.hpp"
+
+#include <optional>
+
+#include "edge_input.hpp"
+#include "fake_sdk.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint InputPin = 15;  // 入力に使うピン
+constexpr uint64_t Debounce_us = 10 * 1000;  // EdgeInputの既定のdebounce (μs)
+
+//! @brief us後にピンを反転させる
+//! @return 反転した後の状態
+bool toggle_after(uint64_t us)
+{
+    fake::advance_us(us);
+    const bool level = !::gpio_get(InputPin);
+    fake::drive_gpio(InputPin, level);
+    return level;
+}
+
+//! @brief 再現できるよう，簡単な線形合同法で作る乱数 (0 ~ range-1)
+uint64_t random(uint32_t& seed, uint64_t range)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % range;
+}
+
+SC_TEST(short_pulses_are_ignored)
+{
+    EdgeInput input(Pin(InputPin), Pull::Down);
+    // debounceより短いパルスを，間隔を変えながら何度も入れる
+    uint32_t seed = 1;
+    for (int i = 0; i < 50; ++i)
+    {
+        toggle_after(Debounce_us + random(seed, 20 * 1000));
+        toggle_after(100 + random(seed, Debounce_us - 200));  // 0.1ms ~ 9.9ms
+    }
+    fake::advance_us(2 * Debounce_us);
+    SC_CHECK(input.available() == 0);
+    SC_CHECK(!input.last_edge());
+    SC_CHECK(input.read() == false);
+}
+
+SC_TEST(bouncing_change_is_recorded_once)
+{
+    EdgeInput input(Pin(InputPin), Pull::Down);
+    fake::advance_us(50 * 1000);
+    // 押したときに何回かはねてからHighに落ち着く
+    toggle_after(1000);
+    const uint64_t pressed_us = ::time_us_64();
+    for (const uint64_t gap : {300, 800, 200, 1500, 600, 2500, 3000})
+        toggle_after(gap);
+    SC_CHECK(toggle_after(700) == true);
+    // 最後の変化からdebounceが経つまでは確定しない
+    fake::advance_us(Debounce_us - 100);
+    SC_CHECK(input.available() == 0);
+    SC_CHECK(input.read() == false);
+    fake::advance_us(200);
+    SC_CHECK(input.available() == 1);
+    SC_CHECK(input.read() == true);
+    const std::optional<EdgeInput::Edge> edge = input.next_edge();
+    SC_CHECK(edge && edge->level == true);
+    SC_CHECK(edge && edge->time_us == pressed_us);  // はね始めた時刻で記録する
+    SC_CHECK(input.available() == 0);
+}
+
+SC_TEST(random_glitches_keep_only_real_changes)
+{
+    EdgeInput input(Pin(InputPin), Pull::Down);
+    uint32_t seed = 2024;
+    bool level = false;
+    std::size_t real = 0, glitches = 0;
+    for (int burst = 0; burst < 200; ++burst)
+    {
+        // 前の変化が落ち着いてから，debounceより短い間隔で何回か変化させる
+        const uint64_t toggles = 1 + random(seed, 6);
+        fake::advance_us(Debounce_us + 1000 + random(seed, 20 * 1000));
+        const uint64_t start_us = ::time_us_64();
+        level = toggle_after(0);
+        for (uint64_t i = 1; i < toggles; ++i)
+            level = toggle_after(50 + random(seed, Debounce_us - 100));
+        const bool changed = (toggles % 2 == 1);  // 奇数回なら状態が変わった，偶数回ならノイズ
+        (changed ? real : glitches) += 1;
+
+        // 最後の変化からdebounceが経つ直前までは確定しない
+        fake::advance_us(Debounce_us - 1);
+        SC_CHECK(input.available() == 0);
+        fake::advance_us(1);
+        const std::optional<EdgeInput::Edge> edge = input.next_edge();
+        SC_CHECK(edge.has_value() == changed);
+        if (edge)
+        {
+            SC_CHECK(edge->level == level);
+            SC_CHECK(edge->time_us == start_us);
+        }
+        SC_CHECK(input.read() == level);
+    }
+    sc::test::report("real changes", static_cast<double>(real));
+    sc::test::report("glitches", static_cast<double>(glitches));
+    SC_CHECK(real > 0 && glitches > 0);
+    SC_CHECK(input.overflow_count() == 0);
+}
+
+SC_TEST(wait_for_edge_settles_by_polling)
+{
+    // 変化の割り込みが来なくても，待っている間に時間が経てば確定する
+    EdgeInput input(Pin(InputPin), Pull::Down);
+    fake::advance_us(50 * 1000);
+    toggle_after(0);
+    const uint64_t rise_us = ::time_us_64();
+    toggle_after(2000);
+    toggle_after(3000);  // はねてHighに落ち着く
+    const uint64_t last_us = ::time_us_64();
+    const Result<EdgeInput::Edge> fall = input.wait_for_edge(Time<Unit::s>(0.1), EdgeInput::Trigger::Fall);
+    SC_CHECK(!fall && fall.error().code() == ErrorCode::Timeout);  // 立ち上がりは取り出して捨てる
+    SC_CHECK(input.last_edge() && input.last_edge()->time_us == rise_us);
+    SC_CHECK(::time_us_64() >= last_us + Debounce_us);
+
+    toggle_after(1000);
+    const uint64_t released_us = ::time_us_64();
+    const Result<EdgeInput::Edge> released = input.wait_for_edge(Time<Unit::s>(0.1), EdgeInput::Trigger::Fall);
+    SC_CHECK(released && released->level == false && released->time_us == released_us);
+    // 返るのは，最後の変化からdebounceが経ったとき
+    sc::test::report("wait_for_edge returned after (us)", static_cast<double>(::time_us_64() - released_us));
+    SC_CHECK(::time_us_64() - released_us >= Debounce_us && ::time_us_64() - released_us <= Debounce_us + 10);
+}
+
+SC_TEST(zero_debounce_records_every_change)
+{
+    EdgeInput input(Pin(InputPin), Pull::Down, Time<Unit::s>(0.0));
+    for (int i = 0; i < 6; ++i)
+        toggle_after(50);
+    SC_CHECK(input.available() == 6);
+    for (int i = 0; i < 6; ++i)
+    {
+        const std::optional<EdgeInput::Edge> edge = input.next_edge();
+        SC_CHECK(edge && edge->level == (i % 2 == 0));
+    }
+}
+
+SC_TEST(overflow_drops_oldest)
+{
+    EdgeInput input(Pin(InputPin), Pull::Down, Time<Unit::s>(0.0));
+    for (std::size_t i = 0; i < EdgeInput::QueueSize + 3; ++i)
+        toggle_after(100);
+    SC_CHECK(input.available() == EdgeInput::QueueSize);
+    SC_CHECK(input.overflow_count() == 3);
+    const std::optional<EdgeInput::Edge> oldest = input.next_edge();
+    SC_CHECK(oldest && oldest->level == false);  // 4回目の変化 (立ち下がり) から残っている
+}
+
+}
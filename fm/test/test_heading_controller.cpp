@@ -0,0 +1,135 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，方位制御(heading_controller.hpp)のテストが定義されています．
+ * シミュレータの物理モデル(sim/plant.hpp)の差動二輪を着地させてから，目標の方位を段階的に変え，
+ * fm.cppと同じ100msごとの制御で向きを変えたときの整定時間とオーバーシュートを確かめます．
+ * MotorActuatorのランプ(4/s)は制御器の出力の変化率の制限(3/s)より速いので，出力はそのまま物理モデルに渡します．
+**************************************************/
+
+//! @file test_heading_controller.cpp
+//! @brief 方位制御のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "heading_controller.hpp"
+#include "plant.hpp"
+#include "unit.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr double ControlPeriod = 0.1;  // 制御周期 (fm.cppと同じ) (s)
+constexpr double Tolerance = 5 * PI / 180;  // 整定したとみなす方位の誤差 (rad)
+
+//! @brief 方位の誤差から整定時間とオーバーシュートを求めた結果
+struct StepResponse
+{
+    double settling_time;  // 誤差がTolerance以内に入り，そのまま出なくなった時刻 (s)  整定しなければ負
+    double overshoot;  // 目標を反対側に越えた最大の角度 (rad)
+    double final_error;  // 最後の誤差の大きさ (rad)
+    double distance;  // 走った距離 (m)
+};
+
+//! @brief 風や砂地，転倒のない平らな地面に着地させた物理モデルの条件
+PlantConfig flat_ground(double heading, double sand_fraction = 0.0)
+{
+    PlantConfig config;
+    config.seed = 7;
+    config.release_time = 0;
+    config.drop_height = 2;
+    config.gust = 0;
+    config.upside_down_chance = 0;
+    config.sand_fraction = sand_fraction;
+    config.heading = heading;
+    return config;
+}
+
+//! @brief 着地して転がり終わるまで進める
+void land(Plant& plant)
+{
+    while (!plant.landed())
+        plant.advance(0.1);
+    plant.advance(5.0);
+}
+
+//! @brief 目標の方位をstepだけ変えて，duration秒間制御する
+StepResponse step_response(double step, double duration, double sand_fraction = 0.0, float speed = 1.0F)
+{
+    Plant plant(flat_ground(0.3, sand_fraction));
+    land(plant);
+    const double target = plant.heading() + step;  // 北から時計回り
+    const double north = plant.north(), east = plant.east();
+    HeadingController controller;
+    StepResponse response{-1.0, 0.0, 0.0, 0.0};
+    for (double t = 0; t < duration; t += ControlPeriod)
+    {
+        // 機体の正面から反時計回りに測った目標の方向 (flight.cppと同じ)
+        const double error = -std::remainder(target - plant.heading(), 2 * PI);
+        if (std::fabs(error) > Tolerance)
+            response.settling_time = -1.0;
+        else if (response.settling_time < 0)
+            response.settling_time = t;
+        if (error * step > 0)  // 目標を越えると，誤差の符号が最初(-step)と反対になる
+            response.overshoot = std::max(response.overshoot, std::fabs(error));
+        response.final_error = std::fabs(error);
+        const auto [left, right] = controller.update(dimension::rad(error), dimension::rad_s(plant.angular_rate()[2]), Time<Unit::s>(ControlPeriod), speed);
+        plant.set_duty(left, right);
+        plant.advance(ControlPeriod);
+    }
+    response.distance = std::hypot(plant.north() - north, plant.east() - east);
+    return response;
+}
+
+//! @brief 結果を出力する
+void report(const char* label, const StepResponse& response)
+{
+    std::printf("    %s: settling %.1f s, overshoot %.1f deg, final error %.2f deg, distance %.1f m\n", label, response.settling_time, response.overshoot * 180 / PI, response.final_error * 180 / PI, response.distance);
+}
+
+SC_TEST(heading_step_converges)
+{
+    for (double degrees : {30.0, -30.0, 90.0, -90.0, 150.0, -150.0})
+    {
+        const StepResponse response = step_response(degrees * PI / 180, 20.0);
+        char label[32];
+        std::snprintf(label, sizeof(label), "step %+.0f deg", degrees);
+        report(label, response);
+        SC_CHECK(response.settling_time >= 0);  // 20秒以内に整定する
+        SC_CHECK(response.settling_time < 7.0);  // 150°でも6秒ほど
+        SC_CHECK(response.overshoot < 15 * PI / 180);
+        SC_CHECK(response.final_error < 2 * PI / 180);
+    }
+}
+
+SC_TEST(heading_step_converges_on_sand)
+{
+    // 砂地では車輪の回転の一部しか進まないので遅くなるが，発散はしない
+    const StepResponse response = step_response(90 * PI / 180, 30.0, 1.0);
+    report("step +90 deg on sand", response);
+    SC_CHECK(response.settling_time >= 0);
+    SC_CHECK(response.overshoot < 25 * PI / 180);
+}
+
+SC_TEST(heading_holds_while_driving)
+{
+    // 目標の方位のまま走り続けても，誤差は許容範囲から出ない
+    const StepResponse response = step_response(0.0, 20.0);
+    report("hold", response);
+    SC_CHECK(response.settling_time == 0);
+    SC_CHECK(response.distance > 5.0);  // 回るだけでなく前に進んでいる
+}
+
+SC_TEST(wrap_angle_range)
+{
+    SC_CHECK_NEAR(HeadingController::wrap_angle(2.5 * PI), PI / 2, 1e-5);
+    SC_CHECK_NEAR(HeadingController::wrap_angle(-PI / 2 - 4 * PI), -PI / 2, 1e-5);
+    SC_CHECK_NEAR(HeadingController::wrap_angle(0.25F), 0.25, 1e-6);
+}
+
+}
@@ -0,0 +1,240 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，I2Cの割り込みによる受信(i2c_async.hpp)のテストが定義されています．
+ * fake/のDesignWareのI2Cのレジスタのまね(FIFO，割り込みの状態，応答しないデバイスでの中断)を使い，
+ * 予約した順に受信すること，時間内に終わらないときのタイムアウト，応答がないときの中断と失敗を確かめます．
+ * また，バスの回復や速度の変更は割り込みの中では行わず，update()で行ってから次の受信を始めることを確かめます．
+**************************************************/
+
+//! @file test_i2c_async.cpp
+//! @brief I2Cの割り込みによる受信のテスト
+
+#include "test.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "fake_sdk.hpp"
+#include "i2c.hpp"
+#include "i2c_async.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint SdaPin = 4, SclPin = 5;  // I2C0
+constexpr uint8_t Bno055 = 0x28, Bme280 = 0x76, Missing = 0x50;  // スレーブアドレス (Missingには何もつながっていない)
+
+//! @brief テストで使うI2C0 (I2Cは1つのプログラムで1回しかセットアップできないので，すべてのテストで使い回す)
+I2C& bus()
+{
+    static I2C i2c{SDA(SdaPin), SCL(SclPin)};
+    return i2c;
+}
+
+//! @brief デバイスをつなぎ，バスを待機中(SDAとSCLがHigh)にする
+const I2C& setup_bus()
+{
+    std::vector<uint8_t> bno(0x80), bme(0x100);
+    for (std::size_t i = 0; i < bno.size(); ++i)
+        bno[i] = static_cast<uint8_t>(i);
+    for (std::size_t i = 0; i < bme.size(); ++i)
+        bme[i] = static_cast<uint8_t>(0xFF - i);
+    fake::add_i2c_device(0, Bno055, bno);
+    fake::add_i2c_device(0, Bme280, bme);
+    fake::set_gpio(SdaPin, true);
+    fake::set_gpio(SclPin, true);
+    const I2C& i2c = bus();
+    i2c.reset_stats();
+    return i2c;
+}
+
+//! @brief 受信が終わった順番を記録するコールバック
+struct Finished
+{
+    std::vector<std::pair<const I2CAsync::Transfer*, I2CAsync::Status>> order;
+
+    static void callback(I2CAsync::Transfer& transfer, void* context)
+    {
+        static_cast<Finished*>(context)->order.emplace_back(&transfer, transfer.status());
+    }
+};
+
+//! @brief I2Cのコマンドをcommands個ずつ進めながら，すべての受信が終わるまで待つ
+void run(I2CAsync& async, std::size_t commands = 4)
+{
+    for (int i = 0; i < 1000 && async.busy(); ++i)
+    {
+        fake::run_i2c(0, commands);
+        async.update();
+    }
+}
+
+SC_TEST(transfers_run_in_queue_order)
+{
+    const I2C& i2c = setup_bus();
+    I2CAsync async(i2c);
+    Finished finished;
+    I2CAsync::Transfer euler, pressure, calibration;
+    StaticBinary<6> euler_data;
+    StaticBinary<8> pressure_data;
+    StaticBinary<22> calibration_data;  // FIFOの段数(16)より多いので，割り込みで詰め直す
+    SC_CHECK(async.read_memory(euler, euler_data, Bno055, 0x1A, Finished::callback, &finished).has_value());
+    SC_CHECK(async.read_memory(pressure, pressure_data, Bme280, 0xF7, Finished::callback, &finished).has_value());
+    SC_CHECK(async.read_memory(calibration, calibration_data, Bno055, 0x55, Finished::callback, &finished).has_value());
+    SC_CHECK(euler.status() == I2CAsync::Status::Running);  // 1つ目はすぐに始まる
+    SC_CHECK(pressure.status() == I2CAsync::Status::Queued);
+    SC_CHECK(async.busy());
+
+    run(async);
+    SC_CHECK(!async.busy());
+    // 予約した順に受信を始め，予約した順に終わる
+    const std::vector<std::pair<uint8_t, uint8_t>> expected_reads = {{Bno055, 0x1A}, {Bme280, 0xF7}, {Bno055, 0x55}};
+    SC_CHECK(fake::i2c_async_reads(0) == expected_reads);
+    SC_CHECK(finished.order.size() == 3);
+    if (finished.order.size() == 3)
+    {
+        SC_CHECK(finished.order[0].first == &euler && finished.order[1].first == &pressure && finished.order[2].first == &calibration);
+        for (const auto& [transfer, status] : finished.order)
+            SC_CHECK(status == I2CAsync::Status::Done);  // コールバックの中では，もう終わっている
+    }
+    SC_CHECK(euler.result().has_value() && pressure.result().has_value() && calibration.result().has_value());
+    SC_CHECK(euler.size() == 6 && euler_data[0] == 0x1A && euler_data[5] == 0x1F);
+    SC_CHECK(pressure.size() == 8 && pressure_data[0] == 0xFF - 0xF7 && pressure_data[7] == 0xFF - 0xFE);
+    SC_CHECK(calibration.size() == 22 && calibration_data[0] == 0x55 && calibration_data[21] == 0x6A);
+    SC_CHECK(i2c.device_stats(Bno055).transfers == 2 && i2c.device_stats(Bno055).nacks == 0);
+}
+
+SC_TEST(queue_full_and_requeue_are_busy)
+{
+    const I2C& i2c = setup_bus();
+    I2CAsync async(i2c);
+    std::array<I2CAsync::Transfer, I2CAsync::MaxTransfers + 2> transfers;
+    std::array<uint8_t, 2> data{};
+    std::size_t accepted = 0;
+    for (I2CAsync::Transfer& transfer : transfers)
+    {
+        const Result<void> result = async.read_memory(transfer, data.data(), data.size(), Bno055, 0x00);
+        if (result)
+            ++accepted;
+        else
+            SC_CHECK(result.error().code() == ErrorCode::Busy);
+    }
+    SC_CHECK(accepted == I2CAsync::MaxTransfers + 1);  // 受信中の1つと，順番待ちのMaxTransfers個
+    // 終わっていない予約は，もう一度予約できない
+    const Result<void> again = async.read_memory(transfers[0], data.data(), data.size(), Bno055, 0x00);
+    SC_CHECK(!again && again.error().code() == ErrorCode::Busy);
+    run(async);
+    SC_CHECK(transfers[0].status() == I2CAsync::Status::Done);
+    SC_CHECK(transfers.back().status() == I2CAsync::Status::Idle);  // 予約できなかったものは何も変わらない
+}
+
+SC_TEST(stalled_transfer_times_out)
+{
+    const I2C& i2c = setup_bus();
+    I2CAsync async(i2c, Time<Unit::s>(0.1));
+    Finished finished;
+    I2CAsync::Transfer stalled, next;
+    StaticBinary<6> stalled_data, next_data;
+    SC_CHECK(async.read_memory(stalled, stalled_data, Bno055, 0x1A, Finished::callback, &finished).has_value());
+    SC_CHECK(async.read_memory(next, next_data, Bme280, 0xF7, Finished::callback, &finished).has_value());
+
+    // バスが止まっている (コマンドが送られない) 間は，期限まで受信中のまま
+    fake::advance_us(50 * 1000);
+    async.update();
+    SC_CHECK(stalled.status() == I2CAsync::Status::Running);
+    fake::advance_us(60 * 1000);
+    async.update();
+    SC_CHECK(stalled.status() == I2CAsync::Status::TimedOut);
+    SC_CHECK(stalled.finished());
+    const Result<void> result = stalled.result();
+    SC_CHECK(!result && result.error().code() == ErrorCode::Timeout);
+    SC_CHECK(i2c.device_stats(Bno055).timeouts == 1);
+    // 次の予約は，タイムアウトした後から始まり，時間内に終わる
+    SC_CHECK(next.status() == I2CAsync::Status::Running);
+    run(async);
+    SC_CHECK(next.status() == I2CAsync::Status::Done);
+    SC_CHECK(next_data[0] == 0xFF - 0xF7);
+    SC_CHECK(finished.order.size() == 2 && finished.order[0].second == I2CAsync::Status::TimedOut);
+}
+
+SC_TEST(nack_aborts_and_fails)
+{
+    const I2C& i2c = setup_bus();
+    I2CAsync async(i2c);
+    Finished finished;
+    I2CAsync::Transfer missing, next;
+    StaticBinary<4> missing_data, next_data;
+    SC_CHECK(async.read_memory(missing, missing_data, Missing, 0x00, Finished::callback, &finished).has_value());
+    SC_CHECK(async.read_memory(next, next_data, Bno055, 0x08, Finished::callback, &finished).has_value());
+
+    // 応答がないとI2Cが中断し(TX_ABRT)，割り込みでfinish(Failed)になる
+    fake::run_i2c(0, 1);
+    SC_CHECK(missing.status() == I2CAsync::Status::Failed);
+    SC_CHECK(missing.size() == 0);
+    const Result<void> result = missing.result();
+    SC_CHECK(!result && result.error().code() == ErrorCode::BusFailed);
+    SC_CHECK(i2c.device_stats(Missing).nacks == 1);
+    SC_CHECK(finished.order.size() == 1 && finished.order[0].first == &missing);
+
+    // 中断が解除され，次の予約は通常どおり受信できる
+    SC_CHECK(next.status() == I2CAsync::Status::Running);
+    run(async);
+    SC_CHECK(next.status() == I2CAsync::Status::Done);
+    SC_CHECK(next_data[0] == 0x08 && next_data[3] == 0x0B);
+    SC_CHECK(fake::i2c_async_reads(0).size() == 1);  // 応答がなかった方は受信を始めていない
+}
+
+// 速度の段階がテストの間で残るので，最後に実行する
+SC_TEST(recovery_and_step_down_run_outside_irq)
+{
+    const I2C& i2c = setup_bus();
+    bus().set_frequency(Frequency<Unit::Hz>(400000));  // 速度の段階と失敗の割合を数え直す
+    I2CAsync async(i2c);
+    std::array<I2CAsync::Transfer, I2C::ErrorThreshold> missing;
+    std::array<uint8_t, 2> missing_data{};
+    I2CAsync::Transfer next;
+    StaticBinary<4> next_data;
+    fake::set_gpio(SdaPin, false);  // デバイスがSDAをLowにしたまま止まっている
+    for (I2CAsync::Transfer& transfer : missing)
+        SC_CHECK(async.read_memory(transfer, missing_data.data(), missing_data.size(), Missing, 0x00).has_value());
+    SC_CHECK(async.read_memory(next, next_data, Bno055, 0x08).has_value());
+
+    // 失敗した後，バスの回復が必要なので割り込みでは次の受信を始めない
+    fake::run_i2c(0, 1);
+    SC_CHECK(missing[0].status() == I2CAsync::Status::Failed);
+    SC_CHECK(missing[1].status() == I2CAsync::Status::Queued);
+    SC_CHECK(async.busy());
+    // update()の中でバスを回復してから始める
+    fake::set_gpio(SdaPin, true);
+    async.update();
+    SC_CHECK(missing[1].status() == I2CAsync::Status::Running);
+    fake::set_gpio(SdaPin, true);  // fake/では回復中のgpio_putがピンの状態を変えるので，解放された状態に戻す
+
+    // 回復が必要なければ，割り込みの中で次の受信を始める
+    fake::run_i2c(0, 1);
+    SC_CHECK(missing[2].status() == I2CAsync::Status::Running);
+    fake::run_i2c(0, 1);
+    SC_CHECK(missing[3].status() == I2CAsync::Status::Running);
+    // ErrorThreshold回失敗すると速度を下げるが，それも割り込みの中では行わない
+    fake::run_i2c(0, 1);
+    SC_CHECK(missing[3].status() == I2CAsync::Status::Failed);
+    SC_CHECK(next.status() == I2CAsync::Status::Queued);
+    SC_CHECK(double(i2c.frequency()) == 400000);
+    async.update();
+    SC_CHECK(double(i2c.frequency()) == 100000);
+    SC_CHECK(fake::i2c_baudrate(0) == 100000);
+    SC_CHECK(next.status() == I2CAsync::Status::Running);
+    run(async);
+    SC_CHECK(next.status() == I2CAsync::Status::Done);
+    SC_CHECK(next_data[0] == 0x08 && next_data[3] == 0x0B);
+
+    // 割り込みの中では，待機もピンの機能の変更も速度の変更もしていない
+    sc::test::report("blocking calls in I2C interrupt", fake::blocking_calls_in_irq());
+    SC_CHECK(fake::blocking_calls_in_irq() == 0);
+}
+
+}
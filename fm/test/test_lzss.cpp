@@ -0,0 +1,234 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，ログの圧縮と展開(lzss.hpp)のテストが定義されています．
+ * いろいろなデータをLzssEncoderで圧縮し，出力されたブロックをLzssDecoderで展開して，元に戻ることを確かめます．
+ * 特に，一定のブロック数ごとに新しい圧縮を始めるところ(restart)と，finishの後に続けて圧縮するところで，
+ * 途中のブロックから読み始めても展開できることを確かめます．
+**************************************************/
+
+//! @file test_lzss.cpp
+//! @brief ログの圧縮と展開のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "lzss.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+using Block = std::array<uint8_t, LzssBlockSize>;
+
+//! @brief 再現できるよう，簡単な線形合同法で作る乱数
+uint32_t random(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+//! @brief 出力されたブロックをすべて残すエンコーダ
+struct Recorder
+{
+    std::vector<Block> blocks;
+    LzssEncoder encoder;
+
+    explicit Recorder(std::size_t restart_blocks = 16, std::size_t max_chain = 8):
+        encoder([this](const uint8_t* data)
+        {
+            Block block;
+            std::copy(data, data + LzssBlockSize, block.begin());
+            blocks.push_back(block);
+        }, restart_blocks, max_chain) {}
+};
+
+//! @brief first番目からのブロックを展開する
+std::string decode(const std::vector<Block>& blocks, std::size_t first = 0)
+{
+    LzssDecoder decoder;
+    std::string output;
+    for (std::size_t i = first; i < blocks.size(); ++i)
+    {
+        decoder.decode_block(blocks[i].data(), output);
+    }
+    return output;
+}
+
+//! @brief 圧縮して展開すると元に戻るか
+bool round_trip(const std::string& text, std::size_t chunk = 0)
+{
+    Recorder recorder;
+    if (chunk == 0)
+    {
+        recorder.encoder.write(text);
+    } else {
+        for (std::size_t i = 0; i < text.size(); i += chunk)
+        {
+            recorder.encoder.write(text.substr(i, chunk));
+        }
+    }
+    recorder.encoder.finish();
+    const std::string output = decode(recorder.blocks);
+    if (output != text)
+        std::printf("    size %zu (chunk %zu) : decoded %zu bytes\n", text.size(), chunk, output.size());
+    return output == text && recorder.encoder.input_bytes() == text.size();
+}
+
+//! @brief fm.cppが出力するような，同じ形の行のくり返し
+std::string log_lines(std::size_t lines, uint32_t seed)
+{
+    std::string text;
+    char line[96];
+    for (std::size_t i = 0; i < lines; ++i)
+    {
+        std::snprintf(line, sizeof(line), "pres:%u.%02u\nhumi:%u.%02u\nfiltered_altitude:%d.%03u,vertical_speed:%d\n",
+            100000 + random(seed) % 2000, random(seed) % 100, 40 + random(seed) % 20, random(seed) % 100,
+            int(random(seed) % 60) - 5, random(seed) % 1000, int(random(seed) % 7) - 3);
+        text += line;
+    }
+    return text;
+}
+
+SC_TEST(short_inputs)
+{
+    SC_CHECK(round_trip(""));
+    SC_CHECK(round_trip("a"));
+    SC_CHECK(round_trip("ab"));
+    SC_CHECK(round_trip("abc"));
+    SC_CHECK(round_trip("abcabc"));
+    SC_CHECK(round_trip("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"));  // 重なった一致
+
+    // 何も書かずにfinishしてもブロックは出力しない
+    Recorder recorder;
+    recorder.encoder.finish();
+    recorder.encoder.finish();
+    SC_CHECK(recorder.blocks.empty());
+}
+
+SC_TEST(log_lines_compress_and_round_trip)
+{
+    const std::string text = log_lines(400, 47);
+    SC_CHECK(round_trip(text));
+    SC_CHECK(round_trip(text, 1));  // 1バイトずつ
+    SC_CHECK(round_trip(text, 37));  // 行の途中で区切る
+
+    Recorder recorder;
+    recorder.encoder.write(text);
+    recorder.encoder.finish();
+    const double ratio = double(recorder.encoder.output_bytes()) / double(text.size());
+    sc::test::report("compressed ratio of log lines", ratio);
+    SC_CHECK(ratio < 0.6);
+}
+
+SC_TEST(random_bytes_round_trip)
+{
+    // 縮まないデータ (一致がほとんどない) と，短い一致がウィンドウの全体に散らばるデータ
+    uint32_t seed = 47;
+    std::string noise;
+    for (int i = 0; i < 10000; ++i)
+        noise += static_cast<char>(random(seed));
+    SC_CHECK(round_trip(noise));
+    SC_CHECK(round_trip(noise, 250));
+
+    std::string pattern;
+    for (int i = 0; i < 5000; ++i)
+        pattern += static_cast<char>('a' + random(seed) % 3);
+    SC_CHECK(round_trip(pattern));
+
+    // 位置を下位16bitで持っているので，64KBを超えても正しく一致を探せるか
+    SC_CHECK(round_trip(log_lines(2000, 3), 61));
+}
+
+SC_TEST(restart_starts_a_decodable_stream)
+{
+    // 2ブロックごとに新しい圧縮を始める
+    const std::string text = log_lines(600, 5);
+    Recorder recorder(2);
+    for (std::size_t i = 0; i < text.size(); i += 100)
+        recorder.encoder.write(text.substr(i, 100));
+    recorder.encoder.finish();
+    SC_CHECK(decode(recorder.blocks) == text);
+
+    // 2ブロックを出力したwriteの終わりで新しい圧縮を始めるので，続きのブロックはfinishで出す半端なものを含めて2個まで
+    std::size_t starts = 0, run = 0;
+    bool short_runs = true;
+    for (const Block& block : recorder.blocks)
+    {
+        if (block[0] == LzssBlockStart)
+        {
+            ++starts;
+            run = 0;
+        } else {
+            SC_CHECK(block[0] == LzssBlockContinue);
+            short_runs = short_runs && (++run <= 2);
+        }
+        SC_CHECK(block[1] <= LzssPayloadSize);
+    }
+    sc::test::report("blocks", double(recorder.blocks.size()));
+    SC_CHECK(starts > 3 && short_runs);
+
+    // リングバッファの古いブロックが上書きされたときと同じく，途中から読み始める
+    // 始まりのブロックより前の続きのブロックは読み飛ばし，そこからは元のデータの終わりまで一致する
+    for (std::size_t first = 1; first < recorder.blocks.size(); ++first)
+    {
+        const std::string tail = decode(recorder.blocks, first);
+        SC_CHECK(tail.size() <= text.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0);
+        if (recorder.blocks[first][0] == LzssBlockStart)
+            SC_CHECK(!tail.empty());
+    }
+}
+
+SC_TEST(write_after_finish_starts_a_new_stream)
+{
+    // finishごとに新しい圧縮になり，前の圧縮の文字列を参照しない
+    const std::string first = log_lines(50, 1), second = log_lines(50, 1), third = "tail";
+    Recorder recorder(0);  // ブロック数では区切らない
+    recorder.encoder.write(first);
+    recorder.encoder.finish();
+    const std::size_t first_blocks = recorder.blocks.size();
+    recorder.encoder.write(second);
+    recorder.encoder.finish();
+    const std::size_t second_blocks = recorder.blocks.size();
+    recorder.encoder.write(third);
+    recorder.encoder.finish();
+
+    SC_CHECK(recorder.blocks[0][0] == LzssBlockStart);
+    SC_CHECK(recorder.blocks[first_blocks][0] == LzssBlockStart);
+    SC_CHECK(recorder.blocks[second_blocks][0] == LzssBlockStart);
+    SC_CHECK(decode(recorder.blocks) == first + second + third);
+    SC_CHECK(decode(recorder.blocks, first_blocks) == second + third);  // 同じ内容でも，前の圧縮がなくても展開できる
+    SC_CHECK(decode(recorder.blocks, second_blocks) == third);
+    SC_CHECK(recorder.encoder.input_bytes() == first.size() + second.size() + third.size());
+}
+
+SC_TEST(decoder_skips_foreign_blocks)
+{
+    const std::string text = log_lines(100, 9);
+    Recorder recorder(0);
+    recorder.encoder.write(text);
+    recorder.encoder.finish();
+    SC_CHECK(recorder.blocks.size() >= 2);
+
+    // 消去されたページ(0xFF)をはさむと，そこで途切れて次の始まりのブロックまで読み飛ばす
+    Block erased;
+    erased.fill(0xFF);
+    SC_CHECK(!LzssDecoder::is_block(erased.data()));
+    LzssDecoder decoder;
+    std::string output;
+    SC_CHECK(decoder.decode_block(recorder.blocks[0].data(), output));
+    SC_CHECK(!decoder.decode_block(erased.data(), output));
+    SC_CHECK(!decoder.decode_block(recorder.blocks[1].data(), output));  // 始まりがないので展開しない
+    output.clear();
+    for (const Block& block : recorder.blocks)
+        SC_CHECK(decoder.decode_block(block.data(), output));
+    SC_CHECK(output == text);
+}
+
+}
@@ -0,0 +1,351 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，ミッションのフェーズを進める処理(mission_loop.hpp)のテストが定義されています．
+ * fm.cppとfm/simのシミュレータは同じMissionLoopを使うので，ここで確かめた順番と条件はどちらにも当てはまります．
+ * センサの値を台本のように決めておくIoを使い，仮想の時計で進めながら，
+ * センサを読む順番，モーターへの指令，フェーズを移行するときの処理を記録して確かめます．
+**************************************************/
+
+//! @file test_mission_loop.cpp
+//! @brief ミッションのフェーズを進める処理のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "mission_loop.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr double GoalLat = 0.5;  // ゴールの緯度 (rad)
+constexpr double GoalLon = 2.0;  // ゴールの経度 (rad)
+constexpr double EarthRadius = 6'378'137.0;  // 地球の半径 (m)
+constexpr uint64_t ReadCost = 10 * 1000;  // センサを1回読むのにかかる時間 (μs)
+
+using Imu = std::tuple<Acceleration<Unit::m_s2>, Acceleration<Unit::m_s2>, MagneticFluxDensity<Unit::T>, AngularVelocity<Unit::rad_s>>;
+
+//! @brief BNO055の測定値 (地磁気は使わないので0)
+Imu imu(double linear_z, double gravity_z, double gyro_z = 0.0)
+{
+    return Imu(
+        Acceleration<Unit::m_s2>(dimension::m_s2(0), dimension::m_s2(0), dimension::m_s2(linear_z)),
+        Acceleration<Unit::m_s2>(dimension::m_s2(0), dimension::m_s2(0), dimension::m_s2(gravity_z)),
+        MagneticFluxDensity<Unit::T>(dimension::T(0), dimension::T(0), dimension::T(0)),
+        AngularVelocity<Unit::rad_s>(dimension::rad_s(0), dimension::rad_s(0), dimension::rad_s(gyro_z)));
+}
+
+//! @brief MotorActuatorの代わりに指令を記録する
+struct ScriptMotor
+{
+    std::vector<std::string>& log;
+    bool is_busy = false;
+    float left = 0.0F, right = 0.0F;
+
+    void record(const char* name, float l, float r, double time = 0.0)
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%s %.1f %.1f %.1f", name, double(l), double(r), time);
+        log.push_back(text);
+    }
+    void run(float l, float r)
+        {record("run", l, r); left = l; right = r;}
+    void run_now(float l, float r)
+        {record("run_now", l, r); left = l; right = r;}
+    void run_for(float l, float r, Time<Unit::s> time)
+        {record("run_for", l, r, double(time)); is_busy = true;}
+    void stop()
+        {record("stop", 0.0F, 0.0F); left = right = 0.0F;}
+    bool busy() const
+        {return is_busy;}
+    std::tuple<float, float> output() const
+        {return {left, right};}
+};
+
+//! @brief 台本で決めた値を返すセンサ (読んだ順番と時刻を記録する)
+struct ScriptIo
+{
+    std::vector<std::string> log;  // センサを読んだ順番，モーターへの指令，フェーズの移行
+    uint64_t time_us = 0;  // 仮想の時計 (μs)
+    std::optional<Altitude<Unit::m>> altitude = Altitude<Unit::m>(0.0);
+    double lux = 0.0;
+    std::optional<Imu> bno = imu(0.0, -9.8);  // 正しい向きで静止
+    bool request_fails = false;
+    std::optional<std::tuple<Latitude<Unit::rad>, Longitude<Unit::rad>>> gps;
+    GoalSight camera = GoalSight::NotFound;
+    double sonar = 1.0;
+    bool tangled = false;
+    int goals = 0;
+    ScriptMotor motor_{log};
+
+    explicit ScriptIo(uint64_t start_us = 0):
+        time_us(start_us)
+    {
+    }
+
+    //! @brief ゴールから北にnorth(m)の位置をGPSの値にする
+    void gps_north(double north)
+        {gps.emplace(Latitude<Unit::rad>(GoalLat + north / EarthRadius), Longitude<Unit::rad>(GoalLon));}  // 測定値の型は代入できないので作り直す
+
+    //! @brief ログにnameが含まれる位置 (なければ-1)
+    int find(const std::string& name) const
+    {
+        const auto it = std::find(log.begin(), log.end(), name);
+        return (it == log.end()) ? -1 : int(it - log.begin());
+    }
+
+    uint64_t now_us() const
+        {return time_us;}
+    void sleep_until_us(uint64_t t)
+        {time_us = std::max(time_us, t);}
+    void set_leds(bool, bool) {}
+    template<typename... Args>
+    void event(const char* format, Args...)
+        {log.push_back(std::string("event ") + format);}
+    template<typename... Args>
+    void data(const char*, Args...) {}
+    void report_exception(const std::exception& e)
+        {log.push_back(std::string("exception ") + e.what());}
+
+    std::optional<Altitude<Unit::m>> read_altitude()
+        {time_us += ReadCost; log.push_back("altitude"); return altitude;}
+    Illuminance<Unit::lx> read_lux()
+        {time_us += ReadCost; log.push_back("lux"); return Illuminance<Unit::lx>(lux);}
+    std::optional<Imu> read_imu()
+        {time_us += ReadCost; log.push_back("imu"); return bno;}
+    bool request_imu()
+        {log.push_back("request_imu"); return !request_fails;}
+    std::optional<Imu> collect_imu()
+        {time_us += ReadCost; log.push_back("collect_imu"); return bno;}
+    std::optional<std::tuple<Latitude<Unit::rad>, Longitude<Unit::rad>>> read_gps()
+        {time_us += ReadCost; log.push_back("gps"); return gps;}
+    double goal_direction(const Imu&, const GoalVector&)
+        {return 0.0;}
+    GoalSight read_camera()
+        {time_us += ReadCost; log.push_back("camera"); return camera;}
+    Length<Unit::m> read_sonar()
+        {time_us += ReadCost; log.push_back("sonar"); return Length<Unit::m>(sonar);}
+    bool parachute_tangled()
+        {return tangled;}
+    ScriptMotor& motor()
+        {return motor_;}
+    void play_landing()
+        {time_us += 8 * 1000 * 1000; log.push_back("play_landing");}
+    void play_near_goal()
+        {time_us += 6 * 1000 * 1000; log.push_back("play_near_goal");}
+    void goal()
+        {++goals; log.push_back("goal");}
+};
+
+//! @brief 1つのテストで使うものをまとめる
+struct Fixture
+{
+    ScriptIo io;
+    const Mission mission;
+    const LocalNavigator navigator{Latitude<Unit::rad>(GoalLat), Longitude<Unit::rad>(GoalLon)};
+    MissionLoop<ScriptIo> loop;
+
+    //! @brief 開始からelapsed_us(μs)経ったところから始める
+    explicit Fixture(Phase phase, uint64_t elapsed_us = 0):
+        io(elapsed_us), loop(io, mission, navigator, phase, 0)
+    {
+    }
+
+    //! @brief fm.cppと同じく，ループの表示などにかかる時間を足してから1回分進める
+    bool step()
+    {
+        io.time_us += 30 * 1000;
+        return loop.step();
+    }
+};
+
+SC_TEST(wait_shifts_on_light_and_confirmed_free_fall)
+{
+    Fixture f(Phase::Wait);
+    f.step();
+    SC_CHECK(f.loop.phase() == Phase::Wait);  // 暗いまま
+
+    f.io.lux = 10000;
+    f.io.bno.emplace(imu(0.0, -9.8));  // 明るくなっても，落ちていなければ移らない
+    f.step();
+    SC_CHECK(f.loop.phase() == Phase::Wait);
+
+    f.io.bno.emplace(imu(9.6, -9.8));  // 全加速度がほぼ0 (自由落下)
+    f.io.log.clear();
+    const uint64_t before = f.io.time_us;
+    f.step();
+    SC_CHECK(f.loop.phase() == Phase::Fall);
+    // 100ms待ってから，気圧高度，照度，BNO055の順に読み，0.5秒後にもう一度確かめる
+    SC_CHECK(f.io.find("altitude") == 0 && f.io.find("lux") == 1 && f.io.find("imu") == 2);
+    SC_CHECK(f.io.time_us - before >= 30000 + 100000 + 500000);
+    SC_CHECK(f.io.find("event Shifts to the falling phase under condition 4\n") == 3);
+}
+
+SC_TEST(wait_times_out_and_low_altitude_shifts)
+{
+    {
+        Fixture f(Phase::Wait, 13 * 60 * 1000 * 1000ULL + 1);  // 開始から13分
+        f.step();
+        SC_CHECK(f.loop.phase() == Phase::Fall);
+        SC_CHECK(f.io.find("altitude") < 0);  // センサを読まずに移る
+    }
+    {
+        Fixture f(Phase::Wait, 7 * 60 * 1000 * 1000ULL + 1);  // 開始から7分で，高度が低い
+        f.step();
+        SC_CHECK(f.loop.phase() == Phase::Fall);
+        SC_CHECK(f.io.find("event Shifts to the falling phase under condition 3\n") >= 0);
+        SC_CHECK(f.io.find("lux") < 0);  // 条件3で移ったら照度は読まない
+    }
+}
+
+SC_TEST(fall_lands_then_rights_itself)
+{
+    Fixture f(Phase::Fall);
+    f.io.bno.emplace(imu(0.0, 9.8));  // 反対向きで静止
+    int steps = 0;
+    while (f.loop.phase() == Phase::Fall && steps < 200)
+    {
+        f.step();
+        ++steps;
+    }
+    SC_CHECK(f.loop.phase() == Phase::Ldistance);
+    sc::test::report("steps to land", steps);
+    // 曲を鳴らしてから，もう一度BNO055を読み，反対向きならじたばたする
+    const int landing = f.io.find("play_landing");
+    SC_CHECK(landing > 0);
+    SC_CHECK(landing + 1 < int(f.io.log.size()) && f.io.log[landing + 1] == "imu");
+    SC_CHECK(f.io.find("run_for 1.0 1.0 5.0") == landing + 2);
+
+    // 遠距離フェーズでは，じたばたが終わってから向きを確かめ直す
+    f.io.log.clear();
+    f.step();
+    SC_CHECK(f.io.find("run_for 1.0 1.0 5.0") < 0);  // 動作中は制御しない
+    f.io.motor_.is_busy = false;
+    f.io.bno.emplace(imu(0.0, -9.8));
+    f.io.gps_north(50);
+    f.step();
+    SC_CHECK(f.io.find("run_for 1.0 1.0 5.0") < 0);
+    SC_CHECK(f.io.log.back().rfind("run ", 0) == 0);  // 正しい向きなら方位制御を始める
+}
+
+SC_TEST(fall_error_timeout_shifts_without_sensors)
+{
+    Fixture f(Phase::Fall);
+    f.io.altitude.reset();  // BME280が読めない
+    int steps = 0;
+    while (f.loop.phase() == Phase::Fall && steps < 10000)
+    {
+        f.io.time_us += 1000 * 1000;
+        f.step();
+        ++steps;
+    }
+    SC_CHECK(f.loop.phase() == Phase::Ldistance);
+    SC_CHECK(f.io.find("event Shifts to the long distance phase under condition %d\n") >= 0);
+    sc::test::report("steps to time out", steps);
+    SC_CHECK_NEAR(f.io.time_us * micro - 8.0, 181.0, 1.5);  // エラーが3分続いたら (最初のループと判定するループの約1秒ずつ遅れる．移ったあとの曲の8秒は除く)
+}
+
+SC_TEST(ldistance_reads_gps_while_imu_is_in_flight)
+{
+    Fixture f(Phase::Ldistance);
+    f.io.gps_north(50);
+    f.step();  // 再開したときは向きを確かめる
+    f.io.log.clear();
+    f.step();
+    // BNO055の受信を予約し，待っている間にGPSを読む
+    SC_CHECK(f.io.find("request_imu") == 0);
+    SC_CHECK(f.io.find("gps") == 1);
+    SC_CHECK(f.io.find("collect_imu") == 2);
+    SC_CHECK(f.io.log.size() == 4 && f.io.log[3].rfind("run ", 0) == 0);
+
+    // 動作中はGPSを読んでも制御しない
+    f.io.motor_.is_busy = true;
+    f.io.log.clear();
+    f.step();
+    SC_CHECK(f.io.log == std::vector<std::string>({"request_imu", "gps", "collect_imu"}));
+
+    // BNO055の予約に失敗したら，GPSを読まずに左右に少しずつ動く (動作中なら予約しない)
+    f.io.motor_.is_busy = false;
+    f.io.request_fails = true;
+    f.io.log.clear();
+    f.step();
+    SC_CHECK(f.io.find("gps") < 0);
+    SC_CHECK(f.io.find("run_for 0.0 1.0 0.4") == 1);
+    SC_CHECK(f.io.log.size() == 5);
+}
+
+SC_TEST(ldistance_keeps_a_100ms_control_period)
+{
+    Fixture f(Phase::Ldistance);
+    f.io.gps_north(50);
+    f.step();
+    std::vector<uint64_t> times;
+    for (int i = 0; i < 5; ++i)
+    {
+        f.step();
+        times.push_back(f.io.time_us);
+    }
+    for (std::size_t i = 1; i < times.size(); ++i)
+        SC_CHECK(times[i] - times[i - 1] == 100 * 1000);
+}
+
+SC_TEST(ldistance_near_goal_shifts_to_sdistance)
+{
+    Fixture f(Phase::Ldistance);
+    f.io.gps_north(50);
+    f.step();
+    f.io.gps_north(2);
+    f.io.log.clear();
+    f.step();
+    SC_CHECK(f.loop.phase() == Phase::Sdistance);
+    const int stop = f.io.find("stop 0.0 0.0 0.0");
+    SC_CHECK(stop > 0);
+    SC_CHECK(f.io.find("play_near_goal") > stop);
+}
+
+SC_TEST(sdistance_turns_toward_the_cone_and_goals)
+{
+    Fixture f(Phase::Sdistance);
+    f.io.camera = GoalSight::Right;
+    SC_CHECK(!f.step());
+    SC_CHECK(f.io.log.back() == "run_now 1.0 0.0 0.0");
+    f.io.camera = GoalSight::Left;
+    SC_CHECK(!f.step());
+    SC_CHECK(f.io.log.back() == "run_now 0.0 1.0 0.0");
+    f.io.camera = GoalSight::NotFound;
+    SC_CHECK(!f.step());
+    SC_CHECK(f.io.log.back() == "run_now 0.0 0.0 0.0");
+
+    // 真ん中に見えても，遠ければ出力はそのまま
+    f.io.camera = GoalSight::Center;
+    f.io.log.clear();
+    SC_CHECK(!f.step());
+    SC_CHECK(f.io.log == std::vector<std::string>({"camera", "sonar"}));
+    f.io.sonar = 0.1;
+    SC_CHECK(f.step());
+    SC_CHECK(f.io.goals == 1);
+}
+
+SC_TEST(stuck_triggers_escape)
+{
+    Fixture f(Phase::Ldistance);
+    f.io.gps_north(50);  // 全力で走っているのに，位置も向きも変わらない
+    bool escaped = false;
+    for (int i = 0; i < 300 && !escaped; ++i)
+    {
+        f.step();
+        escaped = (f.io.find("event stuck:%s%s\n") >= 0);
+    }
+    SC_CHECK(escaped);
+    SC_CHECK(f.io.motor_.is_busy);  // 脱出動作を予約した
+}
+
+}
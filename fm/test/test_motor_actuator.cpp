@@ -0,0 +1,202 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，モーターの動作の予約とランプ制御(motor_actuator.hpp)のテストが定義されています．
+ * 仮想の時計を進めると繰り返しタイマーの割り込みが呼ばれるので，PWMの出力レベルの変化を時刻付きで記録し，
+ * ランプの傾き，予約した動作の時間，run_nowですぐに出力が変わることを確かめます．
+ * また，割り込みの中で使う例外を投げない出力(Motor2::drive)が範囲外の値を丸め，PWMが使えないときはhas_faultに残ることを確かめます．
+**************************************************/
+
+//! @file test_motor_actuator.cpp
+//! @brief モーターの動作の予約とランプ制御のテスト
+
+#include "test.hpp"
+
+#include <cmath>
+
+#include "fake_sdk.hpp"
+#include "motor.hpp"
+#include "motor_actuator.hpp"
+#include "pwm.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint LeftIn1 = 11, LeftIn2 = 10, RightIn1 = 20, RightIn2 = 21;  // fm.cppと同じピン
+constexpr double Tick = 0.01;  // MotorActuatorの更新周期 (s)
+constexpr double RampRate = 4.0;  // MotorActuatorの1秒あたりの出力の変化の最大値
+
+//! @brief fm.cppと同じ左右のモーター
+struct Motors
+{
+    PWM left_in1{LeftIn1}, left_in2{LeftIn2}, right_in1{RightIn1}, right_in2{RightIn2};
+    Motor1 left{left_in1, left_in2};
+    Motor1 right{right_in1, right_in2};
+    Motor2 motor{left, right};
+};
+
+//! @brief PWMの出力レベルをデューティ比にする
+double duty(uint gpio)
+{
+    return static_cast<double>(fake::pwm_level(gpio)) / fake::pwm_wrap(gpio);
+}
+
+//! @brief 仮想の時計をseconds秒進める
+void advance(double seconds)
+{
+    fake::advance_us(static_cast<uint64_t>(seconds * 1e6));
+}
+
+//! @brief gpioの出力が，ある時刻以降に初めてthreshold以上(falling=trueなら以下)になった時刻 (s)  なければ負
+double first_time(uint gpio, double threshold, bool falling = false, double from = 0.0)
+{
+    const double wrap = fake::pwm_wrap(gpio);
+    for (const fake::PwmEvent& event : fake::pwm_trace())
+    {
+        const double time = event.time_us * 1e-6;
+        if (event.gpio != gpio || time < from)
+            continue;
+        if (falling ? (event.level <= threshold * wrap) : (event.level >= threshold * wrap))
+            return time;
+    }
+    return -1.0;
+}
+
+SC_TEST(ramp_slope)
+{
+    Motors motors;
+    MotorActuator actuator(motors.motor);
+    actuator.run(1.0F, 0.0F);
+    advance(0.1);
+    // 0.1秒ではランプの途中 (0.4)
+    sc::test::report("left duty after 0.1 s of run()", duty(LeftIn1));
+    SC_CHECK_NEAR(duty(LeftIn1), RampRate * 0.1, 0.01);
+    advance(0.4);
+    SC_CHECK_NEAR(duty(LeftIn1), 1.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 0.0, 1e-3);
+
+    // 1周期ごとの変化はランプの傾き×周期以下で，単調に増える
+    const double max_step = RampRate * Tick * fake::pwm_wrap(LeftIn1) + 1;
+    double previous = 0;
+    std::size_t steps = 0;
+    for (const fake::PwmEvent& event : fake::pwm_trace())
+    {
+        if (event.gpio != LeftIn1)
+            continue;
+        SC_CHECK(event.level >= previous);
+        SC_CHECK(event.level - previous <= max_step);
+        previous = event.level;
+        ++steps;
+    }
+    SC_CHECK(steps == static_cast<std::size_t>(1.0 / (RampRate * Tick)));  // 25回で全力になる
+    sc::test::report("time to full duty (s)", first_time(LeftIn1, 0.999));
+    SC_CHECK_NEAR(first_time(LeftIn1, 0.999), 1.0 / RampRate, Tick + 1e-6);
+}
+
+SC_TEST(timed_commands)
+{
+    Motors motors;
+    MotorActuator actuator(motors.motor);
+    actuator.run_for(0.5F, 0.5F, Time<Unit::s>(0.5));
+    actuator.run_for(-0.5F, 0.5F, Time<Unit::s>(0.5));
+    SC_CHECK(actuator.busy());
+    advance(0.45);
+    SC_CHECK_NEAR(duty(LeftIn1), 0.5, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 0.5, 1e-3);
+    advance(0.5);
+    // 1つ目の動作が0.5秒(+最初の周期)で終わり，左は逆回転に向けて下がり始める
+    const double switched = first_time(LeftIn1, 0.49, true, 0.25);  // ランプの途中を除く
+    sc::test::report("first command ended at (s)", switched);
+    SC_CHECK(switched > 0.5 - 1e-6 && switched <= 0.5 + 2 * Tick + 1e-6);
+    SC_CHECK_NEAR(duty(LeftIn2), 0.5, 1e-3);  // 逆回転はIN2に出る
+    SC_CHECK_NEAR(duty(LeftIn1), 0.0, 1e-3);
+    advance(0.5);
+    // すべて終わると，runで指定した出力(停止)に戻る
+    SC_CHECK(!actuator.busy());
+    SC_CHECK_NEAR(duty(LeftIn2), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 0.0, 1e-3);
+    const double stopped = first_time(RightIn1, 0.0, true);
+    sc::test::report("output back to 0 at (s)", stopped);
+    SC_CHECK(stopped > 1.0 && stopped <= 1.0 + 2 * Tick + 0.5 / RampRate + 1e-6);
+}
+
+SC_TEST(run_now_is_immediate)
+{
+    Motors motors;
+    MotorActuator actuator(motors.motor);
+    advance(0.05);
+    const double start = ::time_us_64() * 1e-6;
+    actuator.run_now(1.0F, 0.0F);  // fm.cppのSdistanceの旋回
+    SC_CHECK_NEAR(duty(LeftIn1), 1.0, 1e-3);  // タイマーを待たずに全力になる
+    advance(0.1);
+    SC_CHECK_NEAR(duty(LeftIn1), 1.0, 1e-3);
+    SC_CHECK(first_time(LeftIn1, 0.999) == start);
+    actuator.run_now(0.0F, 1.0F);
+    SC_CHECK_NEAR(duty(LeftIn1), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 1.0, 1e-3);
+    advance(0.1);
+    actuator.run_now(0.0F, 0.0F);
+    SC_CHECK_NEAR(duty(RightIn1), 0.0, 1e-3);
+    // タイマー割り込みはrun_nowの出力を書き換えない (変化はrun_nowを呼んだ時刻だけ)
+    for (const fake::PwmEvent& event : fake::pwm_trace())
+    {
+        const double time = event.time_us * 1e-6;
+        SC_CHECK(std::fabs(time - start) < 1e-9 || std::fabs(time - start - 0.1) < 1e-9 || std::fabs(time - start - 0.2) < 1e-9);
+    }
+    SC_CHECK(!actuator.busy());
+    SC_CHECK(std::get<0>(actuator.output()) == 0.0F);
+}
+
+SC_TEST(run_now_cancels_queue)
+{
+    Motors motors;
+    MotorActuator actuator(motors.motor);
+    actuator.run_for(1.0F, 1.0F, Time<Unit::s>(5.0));
+    advance(1.0);
+    actuator.run_now(0.0F, 0.0F);
+    SC_CHECK(!actuator.busy());
+    advance(1.0);
+    SC_CHECK_NEAR(duty(LeftIn1), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 0.0, 1e-3);
+    bool thrown = false;
+    try
+    {
+        actuator.run_now(1.5F, 0.0F);
+    }
+    catch(const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    SC_CHECK(thrown);
+}
+
+SC_TEST(drive_clamps_without_throwing)
+{
+    Motors motors;
+    SC_CHECK(motors.motor.drive(1.5F, -2.0F));
+    SC_CHECK_NEAR(duty(LeftIn1), 1.0, 1e-3);
+    SC_CHECK_NEAR(duty(LeftIn2), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn2), 1.0, 1e-3);
+    SC_CHECK(motors.motor.drive(std::nanf(""), -0.25F));  // NaNは止める
+    SC_CHECK_NEAR(duty(LeftIn1), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(LeftIn2), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn2), 0.25, 1e-3);
+}
+
+SC_TEST(pwm_failure_is_a_fault_not_an_exception)
+{
+    // 割り込みの中では例外を投げず，出力できたモーターだけを動かして記録を残す
+    Motors motors;
+    MotorActuator actuator(motors.motor);
+    motors.left_in1.save = false;
+    actuator.run(1.0F, 1.0F);
+    advance(0.5);
+    SC_CHECK(actuator.has_fault());
+    SC_CHECK_NEAR(duty(LeftIn1), 0.0, 1e-3);
+    SC_CHECK_NEAR(duty(RightIn1), 1.0, 1e-3);
+}
+
+}
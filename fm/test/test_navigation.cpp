@@ -0,0 +1,108 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，航法計算(navigation.hpp)のテストが定義されています．
+ * ゴールの周りに，大円に沿って決めた距離と方位だけ離れた点を置き，
+ * LocalNavigatorの距離と方位が，distance_sphereと置いたときの方位にどれだけ近いかを確かめます．
+**************************************************/
+
+//! @file test_navigation.cpp
+//! @brief 航法計算のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "navigation.hpp"
+#include "unit.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr double GoalLat = 40.142 * PI / 180;  // ゴールの緯度 (rad)  能代の射場あたり
+constexpr double GoalLon = 139.987 * PI / 180;  // ゴールの経度 (rad)
+constexpr double SphereRadius = 6371.0e3;  // distance_sphereの球の半径 (m)
+
+//! @brief ゴールから方位bearingにdistanceだけ離れた点 (大円に沿って動かす)
+//! @return 緯度，経度 (rad)
+std::pair<double, double> offset(double distance, double bearing)
+{
+    const double angle = distance / SphereRadius;
+    const double lat = std::asin(std::sin(GoalLat) * std::cos(angle) + std::cos(GoalLat) * std::sin(angle) * std::cos(bearing));
+    const double lon = GoalLon + std::atan2(std::sin(bearing) * std::sin(angle) * std::cos(GoalLat), std::cos(angle) - std::sin(GoalLat) * std::sin(lat));
+    return {lat, lon};
+}
+
+//! @brief 方位の差 (-π ~ π)
+double angle_diff(double a, double b)
+{
+    return std::remainder(a - b, 2 * PI);
+}
+
+SC_TEST(distance_sphere_same_point)
+{
+    // 同じ点では0 (NaNにならない)
+    SC_CHECK_NEAR(distance_sphere(GoalLon, GoalLat, GoalLon, GoalLat), 0.0, 1e-6);
+    SC_CHECK_NEAR(distance_sphere(0.1, 0.2, 0.1, 0.2), 0.0, 1e-6);
+}
+
+SC_TEST(distance_sphere_matches_offset)
+{
+    for (double distance : {1.0, 10.0, 100.0, 500.0, 5000.0})
+    {
+        const auto [lat, lon] = offset(distance, 1.0);
+        SC_CHECK_NEAR(distance_sphere(GoalLon, GoalLat, lon, lat), distance, distance * 1e-6 + 1e-3);
+    }
+}
+
+SC_TEST(local_navigator_vs_sphere)
+{
+    const LocalNavigator navigator{Latitude<Unit::rad>(GoalLat), Longitude<Unit::rad>(GoalLon)};
+    double max_relative = 0, max_absolute = 0, max_bearing = 0;
+    for (double distance : {1.0, 5.0, 20.0, 50.0, 100.0, 200.0, 500.0})
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            const double bearing_from_goal = 2 * PI * i / 16;
+            const auto [lat, lon] = offset(distance, bearing_from_goal);
+            const GoalVector goal = navigator.to_goal(Latitude<Unit::rad>(lat), Longitude<Unit::rad>(lon));
+            const double sphere = distance_sphere(GoalLon, GoalLat, lon, lat);
+            const double relative = std::fabs(goal.distance - sphere) / sphere;
+            max_relative = std::max(max_relative, relative);
+            max_absolute = std::max(max_absolute, std::fabs(goal.distance - sphere));
+            // 現在地からゴールへの方位は，ゴールから現在地への方位の反対
+            const double bearing_error = std::fabs(angle_diff(goal.bearing, bearing_from_goal + PI));
+            max_bearing = std::max(max_bearing, bearing_error);
+            SC_CHECK(relative < 0.003);  // 楕円体の曲率半径と球の半径の違いは0.3%より小さい
+            SC_CHECK(bearing_error < 0.01);  // 0.6°以内
+            SC_CHECK(goal.bearing >= 0.0F && goal.bearing < static_cast<float>(2 * PI));
+        }
+    }
+    sc::test::report("max relative distance error", max_relative);
+    sc::test::report("max absolute distance error (m)", max_absolute);
+    sc::test::report("max bearing error (rad)", max_bearing);
+}
+
+SC_TEST(local_navigator_components)
+{
+    const LocalNavigator navigator{Latitude<Unit::rad>(GoalLat), Longitude<Unit::rad>(GoalLon)};
+    // ゴールの真南100mにいるときは，北に100m，方位0
+    const auto [south_lat, south_lon] = offset(100.0, PI);
+    const GoalVector north = navigator.to_goal(Latitude<Unit::rad>(south_lat), Longitude<Unit::rad>(south_lon));
+    SC_CHECK_NEAR(north.north, 100.0, 0.5);
+    SC_CHECK_NEAR(north.east, 0.0, 0.01);
+    SC_CHECK(north.bearing < 0.001F || north.bearing > static_cast<float>(2 * PI) - 0.001F);
+    // ゴールの真西100mにいるときは，東に100m，方位π/2
+    const auto [west_lat, west_lon] = offset(100.0, 1.5 * PI);
+    const GoalVector east = navigator.to_goal(Latitude<Unit::rad>(west_lat), Longitude<Unit::rad>(west_lon));
+    SC_CHECK_NEAR(east.east, 100.0, 0.5);
+    SC_CHECK_NEAR(east.bearing, PI / 2, 0.001);
+    // ゴールにいるときは距離0
+    const GoalVector here = navigator.to_goal(Latitude<Unit::rad>(GoalLat), Longitude<Unit::rad>(GoalLon));
+    SC_CHECK_NEAR(here.distance, 0.0, 1e-3);
+}
+
+}
@@ -0,0 +1,156 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，シミュレータの物理モデル(sim/plant.hpp)が作るBNO055の加速度のテストが定義されています．
+ * 放出直後の自由落下，パラシュートでの降下，着地して静止した状態(正しい向きと反対向き)で，
+ * 線形加速度と重力加速度をscライブラリのMissionとAltitudeFilterに渡したときに，
+ * 自由落下の判定と鉛直加速度(上向きが正)が物理的に正しくなることを確かめます．
+ * また，気圧の高度と合わせて推定した高度から，放出後の降下と着地をMissionが判定できることを確かめます．
+**************************************************/
+
+//! @file test_plant.cpp
+//! @brief シミュレータの物理モデルのBNO055の加速度のテスト
+
+#include "test.hpp"
+
+#include <cmath>
+#include <utility>
+
+#include "altitude_filter.hpp"
+#include "mission.hpp"
+#include "plant.hpp"
+#include "unit.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+//! @brief 時刻10sに60mで放出し，2秒後にパラシュートが開き始める物理モデルの条件
+PlantConfig drop(uint64_t seed = 3)
+{
+    PlantConfig config;
+    config.seed = seed;
+    config.release_time = 10;
+    config.climb_rate = 10;
+    config.drop_height = 60;
+    config.vibration = 0;
+    config.chute_delay = 2;
+    config.gust = 0;
+    return config;
+}
+
+Acceleration<Unit::m_s2> accel(const std::array<double, 3>& v)
+    {return Acceleration<Unit::m_s2>(dimension::m_s2(v[0]), dimension::m_s2(v[1]), dimension::m_s2(v[2]));}
+
+//! @brief 物理モデルのBNO055の線形加速度と重力加速度
+std::pair<Acceleration<Unit::m_s2>, Acceleration<Unit::m_s2>> read_bno(Plant& plant)
+{
+    const Plant::Imu imu = plant.imu();
+    return {accel(imu.linear), accel(imu.gravity)};
+}
+
+//! @brief 着地して転がり終わるまで進める
+void land(Plant& plant)
+{
+    while (!plant.landed())
+        plant.advance(0.1);
+    plant.advance(5.0);
+}
+
+SC_TEST(free_fall_reads_zero_total_and_minus_g)
+{
+    Plant plant(drop());
+    const Mission mission;
+    plant.advance(10.5);  // 放出から0.5秒 (パラシュートはまだ開いていない)
+    SC_CHECK(plant.released() && !plant.landed());
+    const auto [line_acce, gravity] = read_bno(plant);
+    SC_CHECK(mission.is_free_fall(line_acce, gravity));
+    const double vertical = double(AltitudeFilter::vertical_acceleration(line_acce, gravity));
+    sc::test::report("vertical acceleration in free fall (m/s2)", vertical);
+    SC_CHECK_NEAR(vertical, -Plant::Gravity, 0.5);  // 機体の空気抵抗の分だけ小さい
+
+    // 高度の推定も，鉛直加速度を積分して下向きに速くなる (速くなるほど空気抵抗が大きくなる)
+    AltitudeFilter filter;
+    filter.reset(Altitude<Unit::m>(plant.altitude()));
+    for (int i = 0; i < 50; ++i)
+    {
+        plant.advance(0.01);
+        const auto [line, g] = read_bno(plant);
+        filter.predict(AltitudeFilter::vertical_acceleration(line, g), Time<Unit::s>(0.01));
+    }
+    sc::test::report("predicted vertical speed after 0.5 s (m/s)", double(filter.vertical_speed()));
+    SC_CHECK_NEAR(double(filter.vertical_speed()), -0.5 * Plant::Gravity, 0.6);
+    SC_CHECK(filter.is_descending(dimension::m_s(2.0)));
+}
+
+SC_TEST(parachute_descent_is_not_free_fall)
+{
+    Plant plant(drop());
+    const Mission mission;
+    plant.advance(18.0);  // パラシュートが開いて，一定の速さで降りている
+    SC_CHECK(!plant.landed());
+    const auto [line_acce, gravity] = read_bno(plant);
+    SC_CHECK(!mission.is_free_fall(line_acce, gravity));
+    SC_CHECK_NEAR(double(AltitudeFilter::vertical_acceleration(line_acce, gravity)), 0.0, 0.3);
+}
+
+SC_TEST(filter_detects_drop_and_landing)
+{
+    // 自由落下を見逃しても，推定高度が最高点から下がっていれば放出されたと分かる
+    Plant plant(drop());
+    const Mission mission;
+    AltitudeFilter filter;
+    filter.reset(Altitude<Unit::m>(plant.altitude()));
+    double dropping_at = -1, landed_at = -1, touchdown = -1;
+    for (int i = 0; i < 6000 && landed_at < 0; ++i)
+    {
+        plant.advance(0.01);
+        const auto [line, g] = read_bno(plant);
+        filter.predict(AltitudeFilter::vertical_acceleration(line, g), Time<Unit::s>(0.01));
+        if (i % 10 == 0)
+            filter.update(Altitude<Unit::m>(plant.altitude()));
+        if (touchdown < 0 && plant.landed())
+            touchdown = plant.time();
+        if (dropping_at < 0 && mission.is_dropping(filter))
+            dropping_at = plant.time();
+        if (dropping_at >= 0 && mission.is_landed(filter))
+            landed_at = plant.time();
+    }
+    sc::test::report("dropping detected after release (s)", dropping_at - 10);
+    sc::test::report("landing detected after touchdown (s)", landed_at - touchdown);
+    SC_CHECK(dropping_at > 10 && dropping_at < 13);
+    SC_CHECK(touchdown > 0 && landed_at > 0);
+    // 着地の判定は，降下が止まってから少なくともlanding_still_timeだけ遅れる
+    SC_CHECK(landed_at - touchdown >= MissionParams{}.landing_still_time - 0.5);
+    SC_CHECK(landed_at - touchdown < 10);
+}
+
+SC_TEST(resting_reads_zero_linear_acceleration)
+{
+    const Mission mission;
+    // キャリアの中で地面に置かれている
+    {
+        Plant plant(drop());
+        const auto [line_acce, gravity] = read_bno(plant);
+        SC_CHECK_NEAR(double(line_acce.magnitude()), 0.0, 1e-9);
+        SC_CHECK_NEAR(double(gravity.z()), -Plant::Gravity, 1e-9);
+        SC_CHECK(!mission.is_free_fall(line_acce, gravity));
+    }
+    // 着地して止まっている (正しい向きと反対向きの両方を，種を変えて探す)
+    bool upright = false, upside_down = false;
+    for (uint64_t seed = 1; seed < 100 && !(upright && upside_down); ++seed)
+    {
+        Plant plant(drop(seed));
+        land(plant);
+        const auto [line_acce, gravity] = read_bno(plant);
+        SC_CHECK_NEAR(double(line_acce.magnitude()), 0.0, 1e-9);
+        SC_CHECK(mission.is_stationary(line_acce, AngularVelocity<Unit::rad_s>(dimension::rad_s(0), dimension::rad_s(0), dimension::rad_s(0))));
+        SC_CHECK(mission.is_upside_down(gravity) == plant.upside_down());
+        SC_CHECK_NEAR(double(gravity.z()), plant.upside_down() ? Plant::Gravity : -Plant::Gravity, 1e-9);
+        (plant.upside_down() ? upside_down : upright) = true;
+    }
+    SC_CHECK(upright && upside_down);
+}
+
+}
@@ -0,0 +1,89 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，処理時間の計測(profiler.hpp)のテストが定義されています．
+ * シミュレータと同じく複数のスレッドから同じゾーンを登録して記録し，回数・合計・ヒストグラムが欠けないことを確かめます．
+**************************************************/
+
+//! @file test_profiler.cpp
+//! @brief 処理時間の計測のテスト
+
+#include "test.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "profiler.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr std::size_t ThreadNum = 8;
+constexpr uint32_t AddNum = 20000;  // 1つのスレッドで記録する回数
+
+//! @brief ヒストグラムの合計
+uint64_t histogram_sum(const Profiler::Zone& zone)
+{
+    uint64_t sum = 0;
+    for (const uint32_t count : zone.histogram)
+    {
+        sum += count;
+    }
+    return sum;
+}
+
+SC_TEST(zone_records_every_duration)
+{
+    Profiler::Zone& zone = Profiler::zone("test_single");
+    Profiler::reset();
+    for (uint32_t duration_us : {0u, 1u, 3u, 1000u})
+    {
+        zone.add(duration_us);
+    }
+    SC_CHECK(zone.count == 4);
+    SC_CHECK(zone.total_us == 1004);
+    SC_CHECK(zone.max_us == 1000);
+    SC_CHECK(zone.histogram[0] == 1 && zone.histogram[1] == 1 && zone.histogram[2] == 1 && zone.histogram[10] == 1);
+    SC_CHECK(zone.percentile_us(50) == 1);
+    SC_CHECK(&Profiler::zone("test_single") == &zone);  // 同じ名前なら同じゾーン
+}
+
+SC_TEST(threads_share_zones_without_losing_records)
+{
+    // どのスレッドも同じ名前を登録するので，登録と記録が同時に起きる
+    const char* const names[] = {"test_thread_a", "test_thread_b"};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < ThreadNum; ++t)
+    {
+        threads.emplace_back([&names, t]()
+        {
+            for (uint32_t i = 0; i < AddNum; ++i)
+            {
+                Profiler::zone(names[(t + i) % 2]).add(t + 1);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const Profiler::Zone& a = Profiler::zone(names[0]);
+    const Profiler::Zone& b = Profiler::zone(names[1]);
+    SC_CHECK(&a != &b);
+    SC_CHECK(a.count + b.count == ThreadNum * AddNum);
+    SC_CHECK(a.count == b.count);
+    SC_CHECK(histogram_sum(a) == a.count);
+    SC_CHECK(histogram_sum(b) == b.count);
+    uint64_t total_us = 0;  // 各スレッドは(番号+1)μsをAddNum回記録した
+    for (std::size_t t = 0; t < ThreadNum; ++t)
+    {
+        total_us += (t + 1) * AddNum;
+    }
+    SC_CHECK(a.total_us + b.total_us == total_us);
+    SC_CHECK(a.max_us == ThreadNum && b.max_us == ThreadNum);
+}
+
+}
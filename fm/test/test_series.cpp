@@ -0,0 +1,252 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，センサの測定値の差分の記録(series.hpp)のテストが定義されています．
+ * 測定値をSeriesEncoderで記録し，出力されたバイト列をSeriesDecoderで元に戻して，
+ * 時刻がそのまま，値が丸めの単位の半分以内で戻ることを確かめます．
+ * 特に，ブロックの区切り(測定の回数とバイト数の上限)，途中でのflush，値や時刻が大きく飛ぶとき，
+ * 壊れたブロックや途中で切れたブロックを読み飛ばして次のブロックから元に戻せることを確かめます．
+**************************************************/
+
+//! @file test_series.cpp
+//! @brief センサの測定値の差分の記録のテスト
+
+#include "test.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "series.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+//! @brief 再現できるよう，簡単な線形合同法で作る乱数
+uint32_t random(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+//! @brief 出力されたバイト列とブロックの大きさをすべて残す
+struct Recorder
+{
+    std::vector<uint8_t> bytes;
+    std::vector<std::size_t> block_sizes;
+
+    SeriesEncoder::Sink sink()
+    {
+        return [this](const uint8_t* data, std::size_t size)
+        {
+            bytes.insert(bytes.end(), data, data + size);
+            block_sizes.push_back(size);
+        };
+    }
+
+    //! @brief first番目のブロックからを元に戻す
+    std::vector<SeriesSample> decode(std::size_t first = 0) const
+    {
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < first; ++i)
+            offset += block_sizes[i];
+        SeriesDecoder decoder;
+        std::vector<SeriesSample> samples;
+        decoder.decode(bytes.data() + offset, bytes.size() - offset, samples);
+        return samples;
+    }
+};
+
+//! @brief 記録した時刻と値
+struct Input
+{
+    uint32_t time_ms;
+    std::vector<float> values;
+};
+
+//! @brief 元に戻した測定値が，記録したものと丸めの単位の半分以内で同じか
+bool same_samples(const std::vector<Input>& inputs, std::size_t first, const std::vector<SeriesSample>& samples, const std::vector<double>& units, SeriesStream stream)
+{
+    if (samples.size() != inputs.size() - first)
+    {
+        std::printf("    %zu samples decoded, %zu expected\n", samples.size(), inputs.size() - first);
+        return false;
+    }
+    for (std::size_t n = 0; n < samples.size(); ++n)
+    {
+        const Input& input = inputs[first + n];
+        if (samples[n].stream != stream || samples[n].time_ms != input.time_ms || samples[n].values.size() != units.size())
+            return false;
+        for (std::size_t i = 0; i < units.size(); ++i)
+        {
+            if (std::abs(samples[n].values[i] - double(input.values[i])) > units[i] * 0.5 + std::abs(double(input.values[i])) * 1e-6)
+            {
+                std::printf("    sample %zu channel %zu : %f -> %f\n", first + n, i, double(input.values[i]), samples[n].values[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//! @brief BME280のように，ゆっくり変わる3チャンネルの測定値
+std::vector<Input> bme_inputs(std::size_t count, uint32_t seed)
+{
+    std::vector<Input> inputs;
+    float pressure = 101325, humidity = 45, temperature = 24;
+    uint32_t time = 1000;
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        time += 90 + random(seed) % 30;
+        pressure += float(int(random(seed) % 201) - 100) * 0.1f;
+        humidity += float(int(random(seed) % 21) - 10) * 0.01f;
+        temperature += float(int(random(seed) % 11) - 5) * 0.01f;
+        inputs.push_back({time, {pressure, humidity, temperature}});
+    }
+    return inputs;
+}
+
+SC_TEST(round_trip_within_rounding)
+{
+    const std::vector<Input> inputs = bme_inputs(200, 48);
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::BME280, {0, -2, -2}, 32, recorder.sink());
+    for (const Input& input : inputs)
+        encoder.add(input.time_ms, input.values.data());
+    encoder.flush();
+    SC_CHECK(encoder.samples() == inputs.size());
+    SC_CHECK(encoder.output_bytes() == recorder.bytes.size());
+    SC_CHECK(recorder.block_sizes.size() == 7);  // 32回ずつ6ブロックと，flushで出した8回分
+    SC_CHECK(same_samples(inputs, 0, recorder.decode(), {1, 0.01, 0.01}, SeriesStream::BME280));
+
+    const double per_sample = double(recorder.bytes.size()) / double(inputs.size());
+    sc::test::report("bytes per sample (3 channels)", per_sample);
+    SC_CHECK(per_sample < 8);
+}
+
+SC_TEST(every_block_is_a_keyframe)
+{
+    // どのブロックからでも，前のブロックなしで元に戻せる (リングバッファで古いブロックが消えたとき)
+    const std::vector<Input> inputs = bme_inputs(100, 7);
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::BME280, {0, -2, -2}, 10, recorder.sink());
+    for (const Input& input : inputs)
+        encoder.add(input.time_ms, input.values.data());
+    SC_CHECK(recorder.block_sizes.size() == 10);  // ちょうどいっぱいになったブロックは，flushを待たずに出力する
+    encoder.flush();
+    SC_CHECK(recorder.block_sizes.size() == 10);  // 出力するものがなければ何もしない
+    for (std::size_t first = 0; first < recorder.block_sizes.size(); ++first)
+        SC_CHECK(same_samples(inputs, first * 10, recorder.decode(first), {1, 0.01, 0.01}, SeriesStream::BME280));
+}
+
+SC_TEST(flush_and_continue)
+{
+    // 途中でflushしても，続きは新しいブロック(キーフレーム)から始まる
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::Lux, {0}, 32, recorder.sink());
+    encoder.flush();
+    SC_CHECK(recorder.bytes.empty());
+    std::vector<Input> inputs;
+    for (uint32_t n = 0; n < 7; ++n)
+    {
+        inputs.push_back({n * 100, {float(n * 1000)}});
+        encoder.add(inputs.back().time_ms, {inputs.back().values[0]});
+        if (n == 0 || n == 3)
+            encoder.flush();
+    }
+    encoder.flush();
+    SC_CHECK(recorder.block_sizes.size() == 3);  // 1回，3回，3回
+    SC_CHECK(same_samples(inputs, 0, recorder.decode(), {1}, SeriesStream::Lux));
+    SC_CHECK(same_samples(inputs, 1, recorder.decode(1), {1}, SeriesStream::Lux));
+    SC_CHECK(same_samples(inputs, 4, recorder.decode(2), {1}, SeriesStream::Lux));
+
+    // 値が足りないときは0を記録する
+    Recorder padded;
+    SeriesEncoder short_encoder(SeriesStream::BME280, {0, 0, 0}, 4, padded.sink());
+    short_encoder.add(5, {7.0f});
+    short_encoder.flush();
+    const std::vector<SeriesSample> samples = padded.decode();
+    SC_CHECK(samples.size() == 1 && samples[0].values == std::vector<double>({7, 0, 0}));
+}
+
+SC_TEST(large_jumps_and_saturation)
+{
+    // 差がint32_tを超えても(一周して)元に戻り，時刻のuint32_tの一周も元に戻る
+    const float max = 2.0e9f, min = -2.0e9f;
+    std::vector<Input> inputs = {
+        {std::numeric_limits<uint32_t>::max() - 50, {max, 0, -1.5f}},
+        {std::numeric_limits<uint32_t>::max() - 1, {min, 1, 1.5f}},
+        {10, {max, -1, 0}},
+        {20, {0, 123456.75f, -123456.75f}},
+    };
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::BNO055, {0, -2, -2}, 8, recorder.sink());
+    for (const Input& input : inputs)
+        encoder.add(input.time_ms, input.values.data());
+    // 範囲外は端に，NaNは0に丸める
+    encoder.add(30, {1.0e20f, std::nanf(""), -1.0e20f});
+    encoder.flush();
+    const std::vector<SeriesSample> samples = recorder.decode();
+    SC_CHECK(same_samples(inputs, 0, std::vector<SeriesSample>(samples.begin(), samples.end() - 1), {1, 0.01, 0.01}, SeriesStream::BNO055));
+    SC_CHECK(samples.size() == 5);
+    SC_CHECK(samples.back().values[0] == double(std::numeric_limits<int32_t>::max()));
+    SC_CHECK(samples.back().values[1] == 0);
+    SC_CHECK_NEAR(samples.back().values[2], std::numeric_limits<int32_t>::min() * 0.01, 1e-6);
+}
+
+SC_TEST(body_size_limit_splits_blocks)
+{
+    // 16チャンネルの大きく変わる値は，測定の回数より先に本体のバイト数の上限でブロックを区切る
+    std::vector<Input> inputs;
+    uint32_t seed = 16;
+    std::initializer_list<int8_t> exponents = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::BNO055, exponents, 255, recorder.sink());
+    for (uint32_t n = 0; n < 100; ++n)
+    {
+        Input input{n * 10, std::vector<float>(16)};
+        for (float& value : input.values)
+            value = float(int32_t(random(seed)) >> 8);
+        encoder.add(input.time_ms, input.values.data());
+        inputs.push_back(input);
+    }
+    encoder.flush();
+    sc::test::report("blocks", double(recorder.block_sizes.size()));
+    SC_CHECK(recorder.block_sizes.size() > 2);
+    for (std::size_t size : recorder.block_sizes)
+        SC_CHECK(size <= 3 + SeriesEncoder::MaxBodySize + 1);
+    SC_CHECK(same_samples(inputs, 0, recorder.decode(), std::vector<double>(16, 1), SeriesStream::BNO055));
+}
+
+SC_TEST(corrupted_blocks_are_skipped)
+{
+    const std::vector<Input> inputs = bme_inputs(40, 9);
+    Recorder recorder;
+    SeriesEncoder encoder(SeriesStream::BME280, {0, -2, -2}, 10, recorder.sink());
+    for (const Input& input : inputs)
+        encoder.add(input.time_ms, input.values.data());
+    SC_CHECK(recorder.block_sizes.size() == 4);
+
+    // 2番目のブロックの本体を1バイト壊し，先頭に目印と同じバイトを含むごみを置き，最後のブロックを途中で切る
+    std::vector<uint8_t> bytes = {0x00, SeriesSync, 0x05, SeriesSync};
+    const std::size_t second = bytes.size() + recorder.block_sizes[0];
+    bytes.insert(bytes.end(), recorder.bytes.begin(), recorder.bytes.end() - 5);
+    bytes[second + 10] ^= 0x40;
+
+    SeriesDecoder decoder;
+    std::vector<SeriesSample> samples;
+    const std::size_t blocks = decoder.decode(bytes.data(), bytes.size(), samples);
+    SC_CHECK(blocks == 2);  // 1番目と3番目だけ
+    SC_CHECK(decoder.skipped_bytes() >= 4 + recorder.block_sizes[1]);
+    SC_CHECK(samples.size() == 20);
+    if (samples.size() == 20)
+    {
+        SC_CHECK(same_samples(std::vector<Input>(inputs.begin(), inputs.begin() + 10), 0, std::vector<SeriesSample>(samples.begin(), samples.begin() + 10), {1, 0.01, 0.01}, SeriesStream::BME280));
+        SC_CHECK(same_samples(std::vector<Input>(inputs.begin() + 20, inputs.begin() + 30), 0, std::vector<SeriesSample>(samples.begin() + 10, samples.end()), {1, 0.01, 0.01}, SeriesStream::BME280));
+    }
+}
+
+}
@@ -0,0 +1,193 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，スタックの検知(stuck_detector.hpp)のテストが定義されています．
+ * 「何秒間，どの指令で，どれだけ振動・回転・移動したか」を並べた台本から，fm.cppと同じ100msごとのサンプルを作って再生し，
+ * 走っているとき，引っかかったとき，空転したとき，その場で回っているときの判定と，検知までの時間を確かめます．
+**************************************************/
+
+//! @file test_stuck_detector.cpp
+//! @brief スタックの検知のテスト
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "stuck_detector.hpp"
+#include "unit.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr double SamplePeriod = 0.1;  // サンプルの間隔 (fm.cppの制御周期) (s)
+constexpr std::size_t Window = 80;  // 既定の窓のサンプル数 (8秒)
+
+//! @brief 台本の1区間
+struct Segment
+{
+    double duration;  // 続ける時間 (s)
+    float left, right;  // モーターの出力
+    double vibration;  // 線形加速度の振幅 (m/s²)
+    double yaw_rate;  // ヨー角速度 (rad/s)
+    double speed;  // 北向きに進む速さ (m/s)
+    double gps_noise = 0.0;  // GPSの位置のばらつき (m)
+};
+
+//! @brief 台本を再生した結果
+struct Replay
+{
+    std::vector<StuckDetector::Status> statuses;  // サンプルごとの判定
+
+    //! @brief 時刻from以降で，初めてstatusになったサンプルの時刻 (s)  なければ負
+    double first(StuckDetector::Status status, double from = 0.0) const
+    {
+        for (std::size_t i = static_cast<std::size_t>(from / SamplePeriod); i < statuses.size(); ++i)
+        {
+            if (statuses[i] == status)
+                return i * SamplePeriod;
+        }
+        return -1.0;
+    }
+
+    //! @brief 時刻fromからtoまでにstatusになったサンプルの数
+    std::size_t count(StuckDetector::Status status, double from, double to) const
+    {
+        std::size_t n = 0;
+        for (std::size_t i = static_cast<std::size_t>(from / SamplePeriod); i < statuses.size() && i * SamplePeriod < to; ++i)
+            n += (statuses[i] == status);
+        return n;
+    }
+};
+
+//! @brief 台本を再生する
+Replay replay(StuckDetector& detector, const std::vector<Segment>& script)
+{
+    Replay result;
+    double north = 0.0;
+    uint32_t noise = 12345;  // 再現できるよう，簡単な線形合同法で揺らす
+    auto uniform = [&noise]()
+    {
+        noise = noise * 1664525u + 1013904223u;
+        return (noise >> 8) * (1.0 / (1u << 24)) * 2.0 - 1.0;  // -1 ~ +1
+    };
+    for (const Segment& segment : script)
+    {
+        const std::size_t samples = static_cast<std::size_t>(std::lround(segment.duration / SamplePeriod));
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            north += segment.speed * SamplePeriod;
+            const double a = segment.vibration * (i % 2 ? 1.0 : -1.0);  // 振動は符号が交互に変わる
+            const Acceleration<Unit::m_s2> accel(dimension::m_s2(a), dimension::m_s2(0.5 * a), dimension::m_s2(0.0));
+            const double yaw = segment.yaw_rate * (1.0 + 0.1 * uniform());
+            const float gps_north = static_cast<float>(north + segment.gps_noise * uniform());
+            const float gps_east = static_cast<float>(segment.gps_noise * uniform());
+            result.statuses.push_back(detector.update(segment.left, segment.right, accel, dimension::rad_s(yaw), gps_north, gps_east));
+        }
+    }
+    return result;
+}
+
+using Status = StuckDetector::Status;
+
+SC_TEST(free_running_is_moving)
+{
+    // 0.4m/sで走り続け，ときどき曲がる
+    StuckDetector detector;
+    const Replay result = replay(detector, {
+        {20, 1.0F, 1.0F, 0.8, 0.02, 0.4},
+        {5, 0.6F, 1.0F, 0.8, 0.4, 0.3},
+        {20, 1.0F, 1.0F, 0.8, 0.02, 0.4, 0.5},
+    });
+    SC_CHECK(result.count(Status::Stuck, 0, 45) == 0);
+    SC_CHECK(result.count(Status::Slip, 0, 45) == 0);
+}
+
+SC_TEST(stuck_is_detected_after_window)
+{
+    // 10秒走ってから引っかかる (振動も回転も移動もない)
+    StuckDetector detector;
+    const Replay result = replay(detector, {
+        {10, 1.0F, 1.0F, 0.8, 0.02, 0.4},
+        {15, 1.0F, 1.0F, 0.05, 0.01, 0.0, 0.3},
+    });
+    SC_CHECK(result.count(Status::Stuck, 0, 10) == 0);
+    SC_CHECK(result.count(Status::Slip, 0, 10) == 0);
+    // 窓の中の移動が1m未満になれば検知する (0.4m/sなので，止まってから窓(8秒)のうち2.5秒分だけ走行が残る)
+    const double stuck = result.first(Status::Stuck, 10);
+    const double slip = result.first(Status::Slip, 10);
+    const double detected = (slip >= 0) ? std::min(slip, stuck) : stuck;
+    sc::test::report("stopped moving detected after (s)", detected - 10);
+    sc::test::report("classified as stuck after (s)", stuck - 10);
+    SC_CHECK(detected > 10 && detected - 10 <= Window * SamplePeriod);
+    // 窓に残った走行が1m前後の間はGPSのばらつきで判定が揺れるが，それより後は検知し続ける
+    SC_CHECK(result.count(Status::Moving, 10 + Window * SamplePeriod - 1.0 / 0.4 + 1.0, 25) == 0);
+    // 窓に走行中の振動が残っている間はSlipと判定されることがあるが，窓が引っかかった後のサンプルだけになればStuck
+    SC_CHECK(stuck > 0 && stuck - 10 <= Window * SamplePeriod);
+    SC_CHECK(result.count(Status::Stuck, 10 + Window * SamplePeriod, 25) == static_cast<std::size_t>(std::lround((15 - Window * SamplePeriod) / SamplePeriod)));
+}
+
+SC_TEST(slip_is_detected)
+{
+    // 砂地で車輪が空転する (振動はあるが，回転も移動もない)
+    StuckDetector detector;
+    const Replay result = replay(detector, {
+        {5, 1.0F, 1.0F, 0.8, 0.02, 0.4},
+        {15, 1.0F, 1.0F, 1.5, 0.03, 0.02, 0.3},
+    });
+    const double detected = result.first(Status::Slip, 5);
+    sc::test::report("slip detected after (s)", detected - 5);
+    SC_CHECK(detected > 5 && detected - 5 <= Window * SamplePeriod + 1e-9);
+    SC_CHECK(result.count(Status::Stuck, 0, 20) == 0);
+}
+
+SC_TEST(turning_in_place_is_moving)
+{
+    // その場で回っているときは移動しないが，回転しているので動いている
+    StuckDetector detector;
+    const Replay result = replay(detector, {
+        {20, -0.8F, 0.8F, 0.4, 0.8, 0.0},
+    });
+    SC_CHECK(result.count(Status::Moving, 0, 20) == result.statuses.size());
+}
+
+SC_TEST(idle_is_not_judged)
+{
+    // 指令を出していないときは，動いていなくても判定しない
+    StuckDetector detector;
+    const Replay result = replay(detector, {
+        {20, 0.0F, 0.0F, 0.0, 0.0, 0.0},
+        {20, 0.1F, 0.1F, 0.0, 0.0, 0.0},
+    });
+    SC_CHECK(result.count(Status::Moving, 0, 40) == result.statuses.size());
+}
+
+SC_TEST(reset_restarts_window)
+{
+    // 脱出動作のあとにresetすると，窓が埋まるまで判定しない
+    StuckDetector detector;
+    const std::vector<Segment> stuck = {{12, 1.0F, 1.0F, 0.05, 0.0, 0.0}};
+    const Replay before = replay(detector, stuck);
+    SC_CHECK_NEAR(before.first(Status::Stuck), (Window - 1) * SamplePeriod, 1e-9);
+    detector.reset();
+    const Replay after = replay(detector, stuck);
+    SC_CHECK_NEAR(after.first(Status::Stuck), (Window - 1) * SamplePeriod, 1e-9);
+}
+
+SC_TEST(escape_steps)
+{
+    StuckDetector detector;
+    const auto [steps, size] = detector.escape(false);
+    SC_CHECK(size == 3);
+    SC_CHECK(steps[0].left < 0 && steps[0].right < 0);  // まず下がる
+    const auto [tangled, tangled_size] = detector.escape(true);
+    SC_CHECK(tangled_size == 5);
+    // 多すぎる動作は切り捨てる
+    detector.set_escape({{1, 1, 1}, {1, 1, 1}, {1, 1, 1}, {1, 1, 1}, {1, 1, 1}, {1, 1, 1}, {1, 1, 1}});
+    SC_CHECK(detector.escape(false).second == StuckDetector::MaxSteps);
+}
+
+}
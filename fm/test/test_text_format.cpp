@@ -0,0 +1,111 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，printf形式の高速なフォーマット(text_format.hpp)のテストが定義されています．
+ * 同じフォーマット文字列と引数をsnprintfにも渡し，書き込まれた文字列と返り値が同じになることを確かめます．
+ * 特に，負の整数を%x %u %oにしたときや，長さの指定(hh h l ll z)で切り詰めるときに，snprintfと同じ桁数になることを確かめます．
+**************************************************/
+
+//! @file test_text_format.cpp
+//! @brief printf形式の高速なフォーマットのテスト
+
+#include "test.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "text_format.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+//! @brief format_toとsnprintfで同じ文字列と長さになるか
+//! @note 引数の型はsnprintfに合わせて渡すこと
+template<typename... Args>
+bool same_as_snprintf(const char* format, Args... args)
+{
+    char expected[128], actual[128];
+    const int expected_length = std::snprintf(expected, sizeof(expected), format, args...);
+    const std::size_t actual_length = format_to(actual, sizeof(actual), format, args...);
+    const bool same = (static_cast<int>(actual_length) == expected_length) && (std::strcmp(expected, actual) == 0);
+    if (!same)
+        std::printf("    \"%s\" : snprintf \"%s\", format_to \"%s\"\n", format, expected, actual);
+    return same;
+}
+
+//! @brief 再現できるよう，簡単な線形合同法で作る乱数
+uint32_t random(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+SC_TEST(negative_int_keeps_its_width)
+{
+    // intの-1は32bitの2の補数 (64bitに広げない)
+    SC_CHECK(same_as_snprintf("%x", -1));
+    SC_CHECK(same_as_snprintf("%X", -2));
+    SC_CHECK(same_as_snprintf("%u", -1));
+    SC_CHECK(same_as_snprintf("%o", -1));
+    SC_CHECK(same_as_snprintf("%#010x", -255));
+    SC_CHECK(same_as_snprintf("%d %i", -2147483647 - 1, 2147483647));
+    SC_CHECK(same_as_snprintf("%lx %llu", -1L, -1LL));
+    SC_CHECK(same_as_snprintf("%x", static_cast<unsigned>(0xDEADBEEF)));
+    // 型が小さい引数は，snprintfと同じくintに広げてから長さの指定で切り詰める
+    SC_CHECK(same_as_snprintf("%x %d", static_cast<int>(static_cast<int8_t>(-1)), static_cast<int>(static_cast<int16_t>(-300))));
+}
+
+SC_TEST(length_modifiers_truncate)
+{
+    SC_CHECK(same_as_snprintf("%hhx", -1));
+    SC_CHECK(same_as_snprintf("%hx", -1));
+    SC_CHECK(same_as_snprintf("%hhd", 200));
+    SC_CHECK(same_as_snprintf("%hd", 40000));
+    SC_CHECK(same_as_snprintf("%hhu %hu", 511, 70000));
+    SC_CHECK(same_as_snprintf("%hho", -1));
+    SC_CHECK(same_as_snprintf("%zu %zx", static_cast<std::size_t>(-1), static_cast<std::size_t>(12345)));
+    SC_CHECK(same_as_snprintf("%lld %llx", static_cast<long long>(INT64_MIN), static_cast<long long>(-1)));
+    SC_CHECK(same_as_snprintf("%ld", static_cast<long>(-123456789)));
+}
+
+SC_TEST(small_types_without_modifier)
+{
+    // 長さの指定がなければ，渡された型をsnprintfと同じくintに広げたバイト数で切り詰める
+    char text[32];
+    format_to(text, sizeof(text), "%x %hx %u", static_cast<int8_t>(-1), static_cast<int16_t>(-1), static_cast<int8_t>(-2));
+    SC_CHECK(std::string(text) == "ffffffff ffff 4294967294");
+    format_to(text, sizeof(text), "%d %d", static_cast<uint8_t>(0xFF), static_cast<uint32_t>(0xFFFFFFFF));
+    SC_CHECK(std::string(text) == "255 -1");
+    format_to(text, sizeof(text), "%x", static_cast<int64_t>(-1));
+    SC_CHECK(std::string(text) == "ffffffffffffffff");
+}
+
+SC_TEST(random_integers_match_snprintf)
+{
+    const char* const formats[] = {
+        "%d", "%i", "%u", "%x", "%X", "%o", "%+d", "% d", "%08x", "%-8u|", "%#x", "%#o", "%.5d", "%.0u",
+        "%hhd", "%hhu", "%hhx", "%hd", "%hu", "%hX", "%ho", "%*d", "%-*x|",
+    };
+    uint32_t seed = 50;
+    std::size_t mismatches = 0, checked = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        // 0付近と端の値が多く出るように，ビット数もばらつかせる
+        const int bits = 1 + static_cast<int>(random(seed) % 32);
+        const int value = static_cast<int>(static_cast<int64_t>(random(seed) >> (32 - bits)) - (int64_t{1} << (bits - 1)));
+        for (const char* format : formats)
+        {
+            const bool star = std::strchr(format, '*') != nullptr;
+            const bool same = star ? same_as_snprintf(format, static_cast<int>(random(seed) % 12), value) : same_as_snprintf(format, value);
+            mismatches += !same;
+            ++checked;
+        }
+    }
+    sc::test::report("checked", static_cast<double>(checked));
+    SC_CHECK(mismatches == 0);
+}
+
+}
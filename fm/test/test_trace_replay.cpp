@@ -0,0 +1,318 @@
+/**************************************************
+ * scライブラリの動作をPCで確かめるためのコードです
+ *
+ * このファイルでは，トレースの再生(trace/replay_flight.hpp)のテストが定義されています．
+ * fake/のセンサ(BME280，BNO055，照度，GPS，カメラ，パラシュートの分離)で台本どおりに飛行させてトレースを記録し，
+ * 記録をTraceFeederでfakeに流し込んで，fm.cppと同じドライバとMissionLoopでもう一度ミッションを行います．
+ * 何度再生してもフェーズの移行とモーターへの指令が同じになることと，記録したときと同じになることを確かめます．
+ *
+ * ドライバが使うI2CやUARTは1つのプロセスで1回しか初期化できないので，記録と再生はそれぞれfork()した子プロセスで行います．
+**************************************************/
+
+//! @file test_trace_replay.cpp
+//! @brief トレースの再生のテスト
+
+#include "test.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "fake_sdk.hpp"
+#include "log.hpp"
+#include "replay_flight.hpp"
+#include "trace.hpp"
+#include "trace_reader.hpp"
+#include "bme280/bme280_compensation.hpp"
+
+namespace
+{
+
+using namespace sc;
+
+constexpr uint Bus = 1;  // BME280とBNO055のI2C (SDA(6)とSCL(7))
+constexpr uint8_t Bme280 = 0x76, Bno055 = 0x28;  // スレーブアドレス
+constexpr uint SpresenseUart = 1;  // SpresenseのUART (TX(4)とRX(5))
+constexpr uint ParaSeparatePin = 17;  // パラシュート分離の検知用ピン
+constexpr uint64_t FlightEnd_us = 75'000'000;  // 記録と再生を終える時刻 (起動からの時間)
+constexpr double GoalLatitude = 30.37427937, GoalLongitude = 130.95994488;  // fm.cppと同じゴール
+constexpr double MetersPerDegree = 111'000;  // 緯度1度の長さ (m)  テストの台本にはおおよそで十分
+
+//! @brief 子プロセスで関数を実行し，返した文字列を受け取る
+std::string run_in_child(const std::function<std::string()>& function)
+{
+    int fds[2];
+    if (::pipe(fds) != 0)
+        return {};
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        ::close(fds[0]);
+        std::string output;
+        try
+        {
+            output = function();
+        }
+        catch(const std::exception& e)
+        {
+            output = std::string("exception:") + e.what();
+        }
+        std::size_t written = 0;
+        while (written < output.size())
+        {
+            const ssize_t n = ::write(fds[1], output.data() + written, output.size() - written);
+            if (n <= 0)
+                break;
+            written += std::size_t(n);
+        }
+        ::close(fds[1]);
+        ::_exit(0);  // 親のテストの後始末(静的変数のデストラクタ)は行わない
+    }
+    ::close(fds[1]);
+    std::string output;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, std::size_t(n));
+    }
+    ::close(fds[0]);
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    SC_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return output;
+}
+
+//! @brief ミッションの記録を1行ごとにつなげる
+std::string join(const ReplayResult& result)
+{
+    std::string text;
+    for (const std::string& line : result.log)
+    {
+        text += line + "\n";
+    }
+    return text + format_str("end %d %d\n", int(result.phase), int(result.goal));
+}
+
+//! @brief ドライバのエラーなどを表示しない (記録したミッションの結果だけを比べる)
+void silence()
+{
+    set_print = [](const std::string&){};
+    Log::add_sink(LogLevel::Off, [](const std::string&){});
+}
+
+
+/***** 台本どおりに動くfakeのセンサ *****/
+
+//! @brief 2バイトの値を下位バイトから書き込む
+void put16(std::vector<uint8_t>& memory, std::size_t index, int value)
+{
+    memory[index] = static_cast<uint8_t>(value & 0xFF);
+    memory[index + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+//! @brief BME280の補正値 (BME280のドライバで受信できなかったときの値と同じ)
+BME280Compensation bme_compensation()
+{
+    BME280Compensation c;
+    c.dig_T1 = 28129; c.dig_T2 = 26436; c.dig_T3 = 50;
+    c.dig_P1 = 38299; c.dig_P2 = -10600; c.dig_P3 = 3024; c.dig_P4 = 10670; c.dig_P5 = -305; c.dig_P6 = -7; c.dig_P7 = 9900; c.dig_P8 = -10230; c.dig_P9 = 4285;
+    c.dig_H1 = 75; c.dig_H2 = 369; c.dig_H3 = 0; c.dig_H4 = 302; c.dig_H5 = 480; c.dig_H6 = -103;
+    return c;
+}
+
+//! @brief BME280のメモリ (チップID，補正値，測定中でない状態)
+std::vector<uint8_t> bme_memory()
+{
+    const BME280Compensation c = bme_compensation();
+    std::vector<uint8_t> memory(256, 0);
+    memory[0xD0] = 0x60;  // チップID
+    const int calibration[12] = {c.dig_T1, c.dig_T2, c.dig_T3, c.dig_P1, c.dig_P2, c.dig_P3, c.dig_P4, c.dig_P5, c.dig_P6, c.dig_P7, c.dig_P8, c.dig_P9};
+    for (std::size_t i = 0; i < 12; ++i)
+    {
+        put16(memory, 0x88 + 2*i, calibration[i]);
+    }
+    memory[0xA1] = c.dig_H1;
+    // 湿度の補正値は，ドライバが読むとおりの位置に置く
+    put16(memory, 0xE1, c.dig_H2);
+    memory[0xE3] = c.dig_H3;
+    memory[0xE4] = static_cast<uint8_t>(c.dig_H4 >> 4);
+    memory[0xE5] = static_cast<uint8_t>(c.dig_H4 & 0x0F);
+    memory[0xE6] = static_cast<uint8_t>((c.dig_H5 & 0x0F) << 4);
+    memory[0xE7] = static_cast<uint8_t>(c.dig_H5 >> 4);
+    memory[0xE8] = static_cast<uint8_t>(c.dig_H6);
+    return memory;
+}
+
+//! @brief 補正した値がtargetになる測定値を二分探索で求める
+//! @param bits 測定値のビット数
+//! @param increasing 測定値が大きいほど補正した値が大きいか
+int32_t find_raw(const std::function<int64_t(int32_t)>& compensate, int64_t target, int bits, bool increasing)
+{
+    int32_t low = 0, high = (1 << bits) - 1;
+    while (low < high)
+    {
+        const int32_t middle = (low + high) / 2;
+        if ((compensate(middle) < target) == increasing)
+        {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+//! @brief 地上で静止したBME280の測定値 (毎回少しずつ変えて，同じ値が続いたときの初期化をさせない)
+struct BmeModel
+{
+    int32_t raw_t, raw_p, raw_h;
+    uint32_t reads = 0;
+
+    BmeModel()
+    {
+        BME280Compensation c = bme_compensation();
+        raw_t = find_raw([&](int32_t raw){return c.temperature(raw);}, 2500, 20, true);  // 25°C
+        c.temperature(raw_t);
+        raw_p = find_raw([&](int32_t raw){return c.pressure(raw);}, 101325, 20, false);  // 1013.25hPa
+        raw_h = find_raw([&](int32_t raw){return c.humidity(raw);}, 50 * 1024, 16, true);  // 50%
+    }
+
+    void write(std::vector<uint8_t>& memory)
+    {
+        const int32_t noise = int32_t((reads++ * 7) % 11) * 16;
+        const int32_t p = raw_p + noise, t = raw_t + noise, h = raw_h + noise;
+        memory[0xF7] = static_cast<uint8_t>(p >> 12);
+        memory[0xF8] = static_cast<uint8_t>(p >> 4);
+        memory[0xF9] = static_cast<uint8_t>(p << 4);
+        memory[0xFA] = static_cast<uint8_t>(t >> 12);
+        memory[0xFB] = static_cast<uint8_t>(t >> 4);
+        memory[0xFC] = static_cast<uint8_t>(t << 4);
+        memory[0xFD] = static_cast<uint8_t>(h >> 8);
+        memory[0xFE] = static_cast<uint8_t>(h);
+    }
+};
+
+//! @brief BNO055の測定値 (15～22秒は自由落下，それ以外は静止)
+void write_bno(std::vector<uint8_t>& memory, uint32_t reads)
+{
+    const double t = double(::time_us_64()) * 1e-6;
+    const bool free_fall = (15 <= t && t < 22);
+    const int noise = int(reads % 3) - 1;  // 0.01m/s²などの最小の桁
+    put16(memory, 0x0E, 30 * 16 + noise);  // 地磁気 (1/16μT)  x軸が北を向いている
+    put16(memory, 0x10, noise);
+    put16(memory, 0x12, -40 * 16);
+    put16(memory, 0x14, noise);  // 角速度 (1/900rad/s)
+    put16(memory, 0x16, 0);
+    put16(memory, 0x18, 0);
+    put16(memory, 0x28, noise);  // 線形加速度 (0.01m/s²)
+    put16(memory, 0x2A, 0);
+    put16(memory, 0x2C, free_fall ? 980 : 0);
+    put16(memory, 0x2E, 0);  // 重力加速度 (0.01m/s²)
+    put16(memory, 0x30, 0);
+    put16(memory, 0x32, -980);
+}
+
+//! @brief GPSとカメラの結果をSpresenseのUARTで受信させる
+void schedule_spresense()
+{
+    // 40秒までは20m南で止まっていて，55秒までにゴールの1m手前まで北へ進む
+    for (uint64_t t_s = 1; t_s * 1'000'000 < FlightEnd_us; ++t_s)
+    {
+        const double south_m = (t_s < 40) ? 20.0 : std::max(1.0, 20.0 - (t_s - 40) * 1.5);
+        const std::string text = format_str(":Lat%.8f\n:Lon%.8f\n", GoalLatitude - south_m / MetersPerDegree, GoalLongitude);
+        fake::schedule_at(t_s * 1'000'000, [text](){fake::receive_uart(SpresenseUart, std::vector<uint8_t>(text.begin(), text.end()));});
+    }
+    // 近距離フェーズでは，ゴールが左，右の順に見える
+    for (uint64_t t_ms = 50'000; t_ms * 1000 < FlightEnd_us; t_ms += 500)
+    {
+        const std::string text = (t_ms < 66'000) ? ":Cam1\n" : ":Cam3\n";
+        fake::schedule_at(t_ms * 1000, [text](){fake::receive_uart(SpresenseUart, std::vector<uint8_t>(text.begin(), text.end()));});
+    }
+}
+
+//! @brief 台本どおりに動くfakeのセンサで飛行し，ミッションの記録とトレースを返す (子プロセスで呼ぶ)
+std::string record_flight()
+{
+    silence();
+    BmeModel bme;
+    uint32_t bno_reads = 0;
+    fake::add_i2c_device(Bus, Bme280, bme_memory());
+    std::vector<uint8_t> bno(256, 0);
+    bno[0x00] = 0xA0;  // チップID
+    fake::add_i2c_device(Bus, Bno055, bno);
+    fake::set_i2c_read_hook([&](uint bus, uint8_t addr, uint8_t memory_addr)
+    {
+        if (addr == Bme280 && memory_addr == 0xF7)
+        {
+            bme.write(fake::i2c_memory(bus, addr));
+        } else if (addr == Bno055 && memory_addr == 0x0E) {
+            write_bno(fake::i2c_memory(bus, addr), bno_reads++);
+        }
+    });
+    // 照度はキャリアの中では暗く，15秒で放出されて明るくなる
+    fake::set_adc_read_hook([](uint channel){fake::set_adc(channel, (::time_us_64() < 15'000'000) ? 100 : 700);});
+    // パラシュートは14秒で分離する (それまではLow)
+    fake::schedule_at(1'000'000, [](){fake::drive_gpio(ParaSeparatePin, false);});
+    fake::schedule_at(14'000'000, [](){fake::drive_gpio(ParaSeparatePin, true);});
+    schedule_spresense();
+
+    std::vector<uint8_t> trace;
+    TraceRecorder::start([&](const uint8_t* data, std::size_t size){trace.insert(trace.end(), data, data + size);});
+    const ReplayResult result = run_flight(FlightEnd_us);
+    TraceRecorder::stop();
+    fake::set_i2c_read_hook(nullptr);
+    fake::set_adc_read_hook(nullptr);
+    return join(result) + std::string(1, '\0') + std::string(trace.begin(), trace.end());
+}
+
+//! @brief トレースを再生し，ミッションの記録を返す (子プロセスで呼ぶ)
+std::string replay_flight(const std::string& trace)
+{
+    silence();
+    TraceReader reader;
+    reader.parse(reinterpret_cast<const uint8_t*>(trace.data()), trace.size());
+    TraceFeeder feeder(reader.events());
+    return join(run_flight(FlightEnd_us));
+}
+
+SC_TEST(replay_is_deterministic_and_matches_the_recorded_flight)
+{
+    const std::string recorded = run_in_child(record_flight);
+    const std::size_t separator = recorded.find('\0');
+    SC_CHECK(separator != std::string::npos);
+    if (separator == std::string::npos)
+        return;
+    const std::string recorded_log = recorded.substr(0, separator);
+    const std::string trace = recorded.substr(separator + 1);
+    SC_CHECK(!trace.empty());
+
+    // 台本どおりに，落下・遠距離・近距離フェーズへ移り，近距離フェーズでは左右に曲がる
+    SC_CHECK(recorded_log.find(" phase 1\n") != std::string::npos);
+    SC_CHECK(recorded_log.find(" phase 2\n") != std::string::npos);
+    SC_CHECK(recorded_log.find(" phase 3\n") != std::string::npos);
+    SC_CHECK(recorded_log.find(" run_now 0.00 1.00\n") != std::string::npos);
+    SC_CHECK(recorded_log.find(" run_now 1.00 0.00\n") != std::string::npos);
+
+    // 何度再生しても，フェーズの移行とモーターへの指令(時刻を含む)は同じ
+    const std::string first = run_in_child([&](){return replay_flight(trace);});
+    const std::string second = run_in_child([&](){return replay_flight(trace);});
+    SC_CHECK(!first.empty());
+    SC_CHECK(first == second);
+
+    // 入力はすべて記録から受け取るので，記録したときとも同じになる
+    SC_CHECK(first == recorded_log);
+    if (first != recorded_log)
+    {
+        std::printf("recorded:\n%s\nreplayed:\n%s\n", recorded_log.c_str(), first.c_str());
+    }
+    test::report("lines", double(std::count(first.begin(), first.end(), '\n')));
+    test::report("trace_bytes", double(trace.size()));
+}
+
+}
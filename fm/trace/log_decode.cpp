@@ -0,0 +1,105 @@
+/**************************************************
+ * 圧縮したログを読める形にするためのコードです
+ *
+ * LzssEncoderで圧縮したブロック(256バイト)が並んだファイルを読み込み，元の文字列を表示します．
+ *   SDカードのlog_....lzs                 : 書き込んだ順にブロックが並んでいる
+ *   フラッシュメモリのログの領域を読み出したもの : 一周したときは，消去されたページの後ろから古い順になる
+ *     picotool save -r 0x101F0000 0x10200000 flash.bin
+ * --statsを付けると，ブロックの数と圧縮率を標準エラー出力に表示します．
+ *
+ *     ./LOG_DECODE log_0101_1200.lzs > log.txt
+ *     ./LOG_DECODE flash.bin --stats > log.txt
+**************************************************/
+
+//! @file log_decode.cpp
+//! @brief 圧縮したログの展開
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lzss.hpp"
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    bool stats = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--stats")
+        {
+            stats = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s log.lzs|flash.bin [--stats]\n", argv[0]);
+        return 2;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return 2;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const std::size_t block_num = data.size() / sc::LzssBlockSize;
+    const auto block = [&](std::size_t index) {return data.data() + (index % block_num) * sc::LzssBlockSize;};
+
+    // 消去されたブロックがあれば，その後ろが一番古い (フラッシュメモリのリングバッファ)
+    std::size_t oldest = 0;
+    while (oldest < block_num && block(oldest)[0] != 0xFF)
+    {
+        ++oldest;
+    }
+    while (oldest < block_num && block(oldest)[0] == 0xFF)
+    {
+        ++oldest;
+    }
+    if (oldest == block_num)
+    {
+        oldest = 0;  // 消去されたブロックがない (SDカードのファイル)
+    }
+
+    sc::LzssDecoder decoder;
+    std::string text;
+    std::size_t decoded = 0, skipped = 0, streams = 0, output = 0;
+    for (std::size_t i = 0; i < block_num; ++i)
+    {
+        const uint8_t* current = block(oldest + i);
+        if (current[0] == 0xFF)
+        {
+            decoder.reset();
+            continue;
+        }
+        text.clear();
+        if (decoder.decode_block(current, text))
+        {
+            ++decoded;
+            streams += (current[0] == sc::LzssBlockStart);
+            std::fwrite(text.data(), 1, text.size(), stdout);
+            output += text.size();
+        } else {
+            ++skipped;  // 圧縮のブロックでないか，始まりのブロックが上書きされている
+        }
+    }
+
+    if (stats)
+    {
+        std::fprintf(stderr, "blocks: %zu decoded, %zu skipped, %zu streams\n", decoded, skipped, streams);
+        if (decoded > 0)
+        {
+            std::fprintf(stderr, "ratio : %zu bytes -> %zu bytes (%.2fx)\n", output, decoded * sc::LzssBlockSize, double(output) / double(decoded * sc::LzssBlockSize));
+        }
+    }
+    if (data.size() % sc::LzssBlockSize != 0)
+    {
+        std::fprintf(stderr, "%zu bytes at the end were ignored (not a whole block)\n", data.size() % sc::LzssBlockSize);  // 最後のブロックが途中までしかありません
+    }
+    return 0;
+}
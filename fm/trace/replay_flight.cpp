@@ -0,0 +1,429 @@
+/**************************************************
+ * 飛行中の入力の記録(トレース)を，fm.cppと同じドライバとMissionLoopでPCで再生するためのコードです
+ * このファイルは，replay_flight.hppに名前だけ書かれている関数の中身です
+ *
+ * fm.cppのsetupとloopのうち，フェーズを進めるのに関わる部分(センサの起動，標高の基準，MissionLoop，トレースの目印)だけを同じ順番で行います．
+ * SDカード・フラッシュメモリ・TWELITE・スピーカー・クロックの切り替えは使わず，曲は同じ長さだけ待ちます．
+**************************************************/
+
+//! @file replay_flight.cpp
+//! @brief トレースの再生によるミッションの再現
+
+#include "replay_flight.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <tuple>
+
+#include "fake_sdk.hpp"
+#include "sc.hpp"
+
+#include "bme280/bme280.hpp"
+#include "bno055/BNO055_BBM.hpp"
+#include "hcsr04/hcsr04.hpp"
+#include "njl5513r/njl5513r.hpp"
+#include "spresense/spresense.hpp"
+
+namespace sc
+{
+
+/***** class TraceFeeder *****/
+
+TraceFeeder::TraceFeeder(const std::vector<TraceEvent>& events) :
+    _player(events)
+{
+    for (const TraceEvent& event : events)
+    {
+        _end_us = std::max(_end_us, event.time_us);
+        if (event.type == TraceType::I2CMemory || event.type == TraceType::I2CRead)
+        {
+            // 記録にはバスの番号がないので，どちらのバスでも応答させる (メモリアドレスは8bitなので256バイト)
+            for (uint bus = 0; bus < 2; ++bus)
+            {
+                if (fake::i2c_memory(bus, event.id).empty())
+                {
+                    fake::add_i2c_device(bus, event.id, std::vector<uint8_t>(256, 0));
+                }
+            }
+        } else if (event.type == TraceType::UART) {
+            // 受信したデータは，記録の時刻(ドライバが読んだ時刻)にまとめて受信させる
+            const uint bus = event.id;
+            const std::vector<uint8_t> data = event.data;
+            fake::schedule_at(event.time_us, [bus, data](){fake::receive_uart(bus, data);});
+        } else if (event.type == TraceType::GPIO && !event.data.empty()) {
+            const uint gpio = event.id;
+            const bool level = (event.data[0] != 0);
+            fake::schedule_at(event.time_us, [gpio, level](){fake::drive_gpio(gpio, level);});
+        }
+    }
+    fake::set_i2c_read_hook([this](uint bus, uint8_t addr, uint8_t memory_addr){feed_i2c(bus, addr, memory_addr);});
+    fake::set_adc_read_hook([this](uint channel){feed_adc(channel);});
+}
+
+TraceFeeder::~TraceFeeder()
+{
+    fake::set_i2c_read_hook(nullptr);
+    fake::set_adc_read_hook(nullptr);
+}
+
+void TraceFeeder::feed_i2c(uint bus, uint8_t addr, uint8_t memory_addr)
+{
+    const std::optional<TraceEvent> event = _player.next(TraceType::I2CMemory, addr, memory_addr);
+    if (!event)
+        return;  // 記録が終わったら，最後に受信したデータをくり返す
+    std::vector<uint8_t>& memory = fake::i2c_memory(bus, addr);
+    for (std::size_t i = 0; i < event->data.size(); ++i)
+    {
+        memory[(memory_addr + i) % memory.size()] = event->data[i];
+    }
+    catch_up();
+}
+
+void TraceFeeder::feed_adc(uint channel)
+{
+    const std::optional<TraceEvent> event = _player.next(TraceType::ADC, static_cast<uint8_t>(channel));
+    if (!event || event->data.size() != 2)
+        return;
+    fake::set_adc(channel, static_cast<uint16_t>(event->data[0] | (event->data[1] << 8)));
+    catch_up();
+}
+
+void TraceFeeder::catch_up()
+{
+    // PCでは計算に時間がかからないので，飛行中に計算していた分だけ時計を進める
+    const uint64_t now_us = ::time_us_64();
+    if (_player.now() > now_us)
+    {
+        fake::advance_us(_player.now() - now_us);
+    }
+}
+
+
+/***** ミッションの再現 *****/
+
+namespace
+{
+
+constexpr uint BmeBnoBus = 1;  // BME280とBNO055のI2C (fm.cppと同じSDA(6)とSCL(7)はI2C1)
+constexpr uint64_t LandingSong_us = 8'000'000;  // 着地したときの曲の長さ (fm/simと同じ)
+constexpr uint64_t NearGoalSong_us = 6'000'000;  // ゴールに近づいたときの曲の長さ
+constexpr double GoalLatitude = 30.37427937;  // ゴールの緯度 (deg)  fm.cppと同じ
+constexpr double GoalLongitude = 130.95994488;  // ゴールの経度 (deg)
+
+//! @brief 起動からの時間 (s)
+double now_s()
+    {return double(::time_us_64()) * 1e-6;}
+
+//! @brief MotorActuatorへの指令を記録してから渡すクラス (MissionLoopのmotor())
+class LoggedMotor
+{
+    MotorActuator& _actuator;
+    std::vector<std::string>& _log;
+
+public:
+    LoggedMotor(MotorActuator& actuator, std::vector<std::string>& log) :
+        _actuator(actuator), _log(log) {}
+
+    void run(float left, float right)
+    {
+        _log.push_back(format_str("%.3f run %.2f %.2f", now_s(), double(left), double(right)));
+        _actuator.run(left, right);
+    }
+
+    void run_now(float left, float right)
+    {
+        _log.push_back(format_str("%.3f run_now %.2f %.2f", now_s(), double(left), double(right)));
+        _actuator.run_now(left, right);
+    }
+
+    void run_for(float left, float right, Time<Unit::s> time)
+    {
+        _log.push_back(format_str("%.3f run_for %.2f %.2f %.2f", now_s(), double(left), double(right), double(time)));
+        _actuator.run_for(left, right, time);
+    }
+
+    void stop()
+    {
+        _log.push_back(format_str("%.3f stop", now_s()));
+        _actuator.stop();
+    }
+
+    bool busy() const
+        {return _actuator.busy();}
+
+    std::tuple<float, float> output() const
+        {return _actuator.output();}
+};
+
+//! @brief fm.cppと同じピンとドライバで，MissionLoopを動かすクラス
+class ReplayFlight
+{
+    friend class MissionLoop<ReplayFlight>;
+    using Imu = std::tuple<Acceleration<Unit::m_s2>, Acceleration<Unit::m_s2>, MagneticFluxDensity<Unit::T>, AngularVelocity<Unit::rad_s>>;  // BNO055の測定値
+
+    // fm.cppと同じピン
+    UART _uart_spresense{TX(4), RX(5), 31250_hz};
+    I2C _i2c_bme_bno{SDA(6), SCL(7)};
+    LED _led_green{Pin(8)};
+    PWM _left_in1{Pin(11)}, _left_in2{Pin(10)};
+    Motor1 _motor_left{_left_in1, _left_in2};
+    EdgeInput _para_separate{Pin(17), Pull::Up};
+    HCSR04 _hcsr04{Pin(28), Pin(19)};
+    PWM _right_in1{Pin(20)}, _right_in2{Pin(21)};
+    Motor1 _motor_right{_right_in1, _right_in2};
+    LED _led_pico{Pin(25)};
+    LED _led_red{Pin(27)};
+    ADC _lux_adc{Pin(26)};
+    NJL5513R _njl5513r{_lux_adc, _led_red, _led_green};
+    BME280 _bme280{_i2c_bme_bno};
+    BNO055 _bno055{_i2c_bme_bno};
+    I2CAsync _i2c_async{_i2c_bme_bno};
+    Motor2 _motor{_motor_left, _motor_right};
+    MotorActuator _motor_actuator{_motor};
+    Spresense _spresense{_uart_spresense};
+
+    std::vector<std::string> _log;  // フェーズの移行とモーターへの指令
+    LoggedMotor _logged_motor{_motor_actuator, _log};
+    const Mission _mission;
+    const LocalNavigator _navigator{Latitude<Unit::deg>(GoalLatitude), Longitude<Unit::deg>(GoalLongitude)};
+    std::optional<MissionLoop<ReplayFlight>> _loop;
+
+public:
+    //! @brief fm.cppのsetupと同じく，センサの起動を待って標高の基準を決める
+    ReplayFlight()
+    {
+        // BME280とBNO055の起動を並行して待つ
+        bool bme_ready = false, bno_ready = false;
+        while (!(bme_ready && bno_ready))
+        {
+            try {bme_ready = bme_ready || _bme280.poll_init();} catch(const std::exception& e){report_exception(e); bme_ready = true;}
+            try {bno_ready = bno_ready || _bno055.poll_init();} catch(const std::exception& e){report_exception(e); bno_ready = true;}
+            ::sleep_us(200);
+        }
+
+        // 標高の基準となる気圧を設定 (最初の測定は誤差が大きいので捨てる)
+        try
+        {
+            try {_bme280.read();} catch(...) {}
+            const auto b0 = _bme280.read();
+            Altitude<Unit::m>::set_origin(std::get<0>(b0), std::get<2>(b0));
+        }
+        catch(const std::exception& e) {report_exception(e);}
+
+        _loop.emplace(*this, _mission, _navigator, Phase::Wait, ::time_us_64());
+    }
+
+    ReplayResult run(uint64_t until_us)
+    {
+        ReplayResult result;
+        Phase traced_phase = _loop->phase();  // 前回トレースに目印を付けたときのフェーズ
+        TraceRecorder::marker(format_str("fase:%d", int(traced_phase)));
+        _log.push_back(format_str("%.3f phase %d", now_s(), int(traced_phase)));
+        while (::time_us_64() < until_us && !result.goal)
+        {
+            // fm.cppのループと同じく，フェーズが変わっていたらトレースに目印を付け，ためてある記録を書き込む
+            try
+            {
+                if (_loop->phase() != traced_phase)
+                {
+                    traced_phase = _loop->phase();
+                    TraceRecorder::marker(format_str("fase:%d", int(traced_phase)));
+                }
+                TraceRecorder::flush();
+                static_cast<void>(_spresense.try_time());  // fm.cppと同じくUARTを読む (GPSとカメラの結果もここで受け取る)
+                while (_para_separate.next_edge())
+                {
+                }
+
+                const Phase before = _loop->phase();
+                result.goal = _loop->step();
+                if (_loop->phase() != before)
+                {
+                    _log.push_back(format_str("%.3f phase %d", now_s(), int(_loop->phase())));
+                }
+            }
+            catch(const std::exception& e){report_exception(e);}
+        }
+        TraceRecorder::flush();
+        result.log = _log;
+        result.phase = _loop->phase();
+        return result;
+    }
+
+private:
+    /***** MissionLoopに渡すセンサとモーター (fm.cppのFmIoと同じ) *****/
+
+    uint64_t now_us() const
+        {return ::time_us_64();}
+
+    void sleep_until_us(uint64_t time_us) const
+    {
+        const uint64_t now = ::time_us_64();
+        if (time_us > now)
+        {
+            ::sleep_us(time_us - now);
+        }
+    }
+
+    void set_leds(bool red, bool green)
+    {
+        if (red) {_led_red.on();} else {_led_red.off();}
+        if (green) {_led_green.on();} else {_led_green.off();}
+    }
+
+    //! @brief フェーズの移行などは，指令と一緒に記録する
+    template<typename... Args>
+    void event(const char* format, Args... args)
+    {
+        std::string text = format_str(format, args...);
+        while (!text.empty() && text.back() == '\n')
+        {
+            text.pop_back();
+        }
+        _log.push_back(format_str("%.3f event ", now_s()) + text);
+    }
+
+    template<typename... Args>
+    void data(const char*, Args...) {}
+
+    void report_error(const Error& error)
+    {
+        print(LogLevel::Error, LogModule::Main, f_err(error.file(), error.line(), "%s: %s", to_str(error.source()), to_str(error.code())));
+        _led_pico.off();
+    }
+
+    void report_exception(const std::exception& e)
+    {
+        print(LogLevel::Error, LogModule::Main, e.what());
+        _led_pico.off();
+    }
+
+    std::optional<Altitude<Unit::m>> read_altitude()
+    {
+        const auto bme_result = _bme280.try_read();
+        if (!bme_result)
+        {
+            report_error(bme_result.error());
+            return std::nullopt;
+        }
+        return Altitude<Unit::m>(std::get<0>(*bme_result), std::get<2>(*bme_result));
+    }
+
+    Illuminance<Unit::lx> read_lux()
+        {return _njl5513r.read();}
+
+    std::optional<Imu> read_imu()
+    {
+        auto bno_result = _bno055.try_read();
+        if (!bno_result)
+        {
+            report_error(bno_result.error());
+            return std::nullopt;
+        }
+        return *bno_result;
+    }
+
+    bool request_imu()
+    {
+        const Result<void> bno_request = _bno055.request(_i2c_async);
+        if (!bno_request)
+        {
+            report_error(bno_request.error());
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<Imu> collect_imu()
+    {
+        // fakeのI2Cはひとりでには進まないので，実機で割り込みによる受信が進む代わりに，ここでバスを動かす
+        while (!_bno055.ready())
+        {
+            if (fake::run_i2c(BmeBnoBus) == 0)
+            {
+                _i2c_async.update();  // 割り込みの中で始められなかった予約を始め，タイムアウトを確かめる
+                fake::advance_us(10);
+            }
+        }
+        auto bno_result = _bno055.try_collect();
+        if (!bno_result)
+        {
+            report_error(bno_result.error());
+            return std::nullopt;
+        }
+        return *bno_result;
+    }
+
+    std::optional<std::tuple<Latitude<Unit::deg>, Longitude<Unit::deg>>> read_gps()
+    {
+        auto gps_result = _spresense.try_gps();
+        if (!gps_result)
+        {
+            report_error(gps_result.error());
+            return std::nullopt;
+        }
+        return *gps_result;
+    }
+
+    //! @brief 機体の正面から反時計回りに測ったゴールの方向 (rad)  fm.cppのFmIo::goal_directionと同じ計算 (表示はしない)
+    double goal_direction(const Imu& bno_data, const GoalVector& to_goal)
+    {
+        const MagneticFluxDensity<Unit::T> magnetic = std::get<2>(bno_data);
+        double north_angle = std::atan2(double(magnetic.y()), double(magnetic.x()));  // 北がBNO055の座標軸で何度回転した位置にあるか [0, 2π)
+        if (north_angle < 0)
+        {
+            north_angle += 2 * PI;
+        }
+        // 北がx軸，西がy軸のゴールへのベクトルを，機体のxyを基底とした座標に時計回りに回転する
+        const double north = to_goal.north;
+        const double west = -to_goal.east;
+        const double x = north * std::cos(north_angle) + west * std::sin(north_angle);
+        const double y = west * std::cos(north_angle) - north * std::sin(north_angle);
+        double direction = std::atan2(y, x);
+        if (direction < 0)
+        {
+            direction += 2 * PI;
+        }
+        return direction;
+    }
+
+    GoalSight read_camera()
+    {
+        switch (_spresense.camera())
+        {
+            case Cam::Center: return GoalSight::Center;
+            case Cam::Right: return GoalSight::Right;
+            case Cam::Left: return GoalSight::Left;
+            default: return GoalSight::NotFound;
+        }
+    }
+
+    Length<Unit::m> read_sonar()
+        {return _hcsr04.read();}
+
+    bool parachute_tangled()
+        {return _para_separate.read() == false;}
+
+    LoggedMotor& motor()
+        {return _logged_motor;}
+
+    void play_landing()
+        {::sleep_us(LandingSong_us);}
+
+    void play_near_goal()
+        {::sleep_us(NearGoalSong_us);}
+
+    void goal()
+        {_log.push_back(format_str("%.3f goal", now_s()));}
+};
+
+}
+
+ReplayResult run_flight(uint64_t until_us)
+{
+    ReplayFlight flight;
+    return flight.run(until_us);
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef SC19_PICO_TRACE_REPLAY_FLIGHT_HPP_
+#define SC19_PICO_TRACE_REPLAY_FLIGHT_HPP_
+
+/**************************************************
+ * 飛行中の入力の記録(トレース)を，fm.cppと同じドライバとMissionLoopでPCで再生するためのコードです
+ * このファイルは，replay_flight.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，記録をテスト用のpico-SDKの代わり(test/fake)に流し込むクラスと，
+ * fm.cppと同じピン・ドライバ(BME280，BNO055，NJL5513R，Spresense，HCSR04，MotorActuator)でMissionLoopを動かす関数が宣言されています．
+ *   I2C・ADC : ドライバが受信するたびに，同じデバイスとメモリアドレス(チャンネル)の次の記録をfakeのデバイスに書き込んでから読ませる
+ *   UART・GPIO : 記録の時刻になったら，fakeのUARTで受信させ，ピンを変化させる
+ *   時刻 : I2CとADCの記録を取り出すたびに，fakeの仮想の時計を記録の時刻まで進める (飛行中より進んでいるときはそのまま)
+ * 入力はすべてfakeを通り，ドライバの変換(補正の計算や中央値)もfm.cppと同じなので，
+ * 再生したフェーズの移行とモーターへの指令は，同じ記録なら何度再生しても同じになります．
+ * fakeを使うので，pico-SDKのホストビルドではなくtest/CMakeLists.txtで作成します．
+**************************************************/
+
+//! @file replay_flight.hpp
+//! @brief トレースの再生によるミッションの再現
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mission_loop.hpp"
+#include "trace_player.hpp"
+
+namespace sc
+{
+
+//! @brief 記録をfakeのI2C・ADC・UART・GPIOに流し込むクラス
+//! @note run_flightより先に作成し，再生が終わるまで残しておくこと (ドライバの初期化の受信から記録を使う)
+class TraceFeeder
+{
+public:
+    //! @brief fakeに記録を流し込む準備をする
+    //! @param events TraceReaderで読み込んだ記録 (再生が終わるまで残しておくこと)
+    explicit TraceFeeder(const std::vector<TraceEvent>& events);
+
+    //! @brief fakeから記録を外す
+    ~TraceFeeder();
+
+    TraceFeeder(const TraceFeeder&) = delete;
+    TraceFeeder& operator=(const TraceFeeder&) = delete;
+
+    //! @brief 記録の最後の時刻 (起動からの時間(μs))
+    uint64_t end_us() const
+        {return _end_us;}
+
+private:
+    //! @brief I2Cのデバイスから受信する直前に，次の記録をデバイスのメモリに書き込む
+    void feed_i2c(uint bus, uint8_t addr, uint8_t memory_addr);
+
+    //! @brief ADCで測定する直前に，次の記録を測定値にする
+    void feed_adc(uint channel);
+
+    //! @brief fakeの仮想の時計を，取り出した記録の時刻まで進める
+    void catch_up();
+
+    TracePlayer _player;
+    uint64_t _end_us = 0;
+};
+
+//! @brief 再生したミッションの結果
+struct ReplayResult
+{
+    std::vector<std::string> log;  // フェーズの移行とモーターへの指令 (1行に1つ，"時刻[s] 内容")
+    Phase phase = Phase::Wait;  // 最後のフェーズ
+    bool goal = false;  // ゴールしたか
+};
+
+//! @brief fm.cppと同じピン・ドライバ・MissionLoopで，fakeのセンサを読んでミッションを進める
+//! @note センサの値はfakeのデバイスから読むので，先にTraceFeederを作るか，テストでfakeのデバイスを用意しておくこと
+//!       ドライバが使うI2CやUARTは1つのプロセスで1回しか初期化できないので，1つのプロセスで1回だけ呼べます
+//! @param until_us 起動からこの時間(μs)が経つか，ゴールしたら終える
+ReplayResult run_flight(uint64_t until_us);
+
+}
+
+#endif  // SC19_PICO_TRACE_REPLAY_FLIGHT_HPP_
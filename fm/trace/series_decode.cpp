@@ -0,0 +1,89 @@
+/**************************************************
+ * 差分で記録したセンサの測定値を読める形にするためのコードです
+ *
+ * SeriesEncoderが出力したブロックが並んだファイル(SDカードのseries_....bin)を読み込み，
+ * 1回の測定を1行のCSV (センサ,時刻(ms),値...) にして表示します．
+ * --stream=BNO055のようにセンサの名前を付けると，そのセンサだけを表示します．
+ * --statsを付けると，センサごとの測定の回数と，1回あたりのバイト数を標準エラー出力に表示します．
+ *
+ *     ./SERIES_DECODE series_0101_1200.bin > series.csv
+ *     ./SERIES_DECODE series_0101_1200.bin --stream=BME280 --stats > bme.csv
+**************************************************/
+
+//! @file series_decode.cpp
+//! @brief 差分で記録したセンサの測定値の展開
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "series.hpp"
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    std::string stream_name;
+    bool stats = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--stats")
+        {
+            stats = true;
+        } else if (arg.rfind("--stream=", 0) == 0) {
+            stream_name = arg.substr(9);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s series.bin [--stream=NAME] [--stats]\n", argv[0]);
+        return 2;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return 2;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    sc::SeriesDecoder decoder;
+    std::vector<sc::SeriesSample> samples;
+    const std::size_t blocks = decoder.decode(data.data(), data.size(), samples);
+
+    std::map<std::string, std::size_t> counts;  // センサごとの測定の回数
+    std::size_t values = 0;
+    for (const auto& sample : samples)
+    {
+        const std::string name = sc::to_str(sample.stream);
+        ++counts[name];
+        values += sample.values.size();
+        if (!stream_name.empty() && name != stream_name)
+            continue;
+        std::printf("%s,%lu", name.c_str(), static_cast<unsigned long>(sample.time_ms));
+        for (const double value : sample.values)
+        {
+            std::printf(",%.10g", value);
+        }
+        std::printf("\n");
+    }
+
+    if (stats)
+    {
+        std::fprintf(stderr, "blocks : %zu decoded, %zu bytes skipped\n", blocks, decoder.skipped_bytes());
+        for (const auto& [name, count] : counts)
+        {
+            std::fprintf(stderr, "%-7s: %zu samples\n", name.c_str(), count);
+        }
+        if (!samples.empty())
+        {
+            std::fprintf(stderr, "size   : %zu bytes, %.2f bytes/sample, %.2f bytes/value\n", data.size(), double(data.size()) / double(samples.size()), double(data.size()) / double(values));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**************************************************
+ * 飛行中の入力の記録(トレース)を読める形にするためのコードです
+ *
+ * SDカードのtrace_....binを読み込み，1つの記録を1行のCSVにして表示します．
+ * --summaryを付けると，入力の種類ごとの数と，TracePlayerで最後まで再生するのにかかった時間を表示します．
+ *
+ *     ./TRACE_DECODE trace_0101_1200.bin > trace.csv    CSVにする
+ *     ./TRACE_DECODE trace_0101_1200.bin --summary      種類ごとの数と再生の速さ
+**************************************************/
+
+//! @file trace_decode.cpp
+//! @brief トレースの表示
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "trace_player.hpp"
+#include "trace_reader.hpp"
+
+namespace
+{
+
+//! @brief 1つの記録をCSVの1行で表示
+void print_csv(const sc::TraceEvent& event)
+{
+    std::printf("%llu,%s,0x%02X,0x%02X,%zu,", static_cast<unsigned long long>(event.time_us), sc::to_str(event.type), event.id, event.sub, event.data.size());
+    if (event.type == sc::TraceType::Marker)
+    {
+        std::printf("%s\n", event.text().c_str());
+        return;
+    }
+    if (event.type == sc::TraceType::ADC && event.data.size() == 2)
+    {
+        std::printf("%u\n", unsigned(event.data[0] | (event.data[1] << 8)));
+        return;
+    }
+    for (const uint8_t byte : event.data)
+    {
+        std::printf("%02X", byte);
+    }
+    std::printf("\n");
+}
+
+//! @brief 種類ごとの数を表示し，すべての記録をTracePlayerで取り出す時間を測る
+void print_summary(const std::vector<sc::TraceEvent>& events)
+{
+    std::map<std::tuple<sc::TraceType, uint8_t, uint8_t>, std::size_t> counts;
+    for (const sc::TraceEvent& event : events)
+    {
+        ++counts[std::make_tuple(event.type, event.id, event.sub)];
+    }
+    std::printf("%-8s %6s %6s %10s\n", "type", "id", "sub", "count");
+    for (const auto& [key, count] : counts)
+    {
+        std::printf("%-8s   0x%02X   0x%02X %10zu\n", sc::to_str(std::get<0>(key)), std::get<1>(key), std::get<2>(key), count);
+    }
+
+    // 飛行中と同じように，種類ごとに次の記録を取り出して最後まで再生する
+    const auto begin = std::chrono::steady_clock::now();
+    sc::TracePlayer player(events);
+    std::size_t replayed = 0;
+    for (const sc::TraceEvent& event : events)
+    {
+        if (event.type == sc::TraceType::GPIO || event.type == sc::TraceType::Marker)
+        {
+            player.advance_to(event.time_us);
+            while (player.next_async())
+            {
+                ++replayed;
+            }
+        } else if (player.next(event.type, event.id, event.sub)) {
+            ++replayed;
+        }
+    }
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    const double trace_s = events.empty() ? 0.0 : (events.back().time_us - events.front().time_us) * 1e-6;
+    std::printf("events:%zu,replayed:%zu,trace:%.3fs,replay:%.6fs,speed:%.0fx\n", events.size(), replayed, trace_s, wall_s, (wall_s > 0) ? trace_s / wall_s : 0.0);
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    bool summary = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--summary")
+        {
+            summary = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s trace.bin [--summary]\n", argv[0]);
+        return 2;
+    }
+
+    sc::TraceReader reader;
+    if (!reader.load(path))
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return 2;
+    }
+    if (reader.skipped() > 0)
+    {
+        std::fprintf(stderr, "Skipped %zu broken byte(s)\n", reader.skipped());  // 壊れていた部分を読み飛ばしました
+    }
+
+    if (summary)
+    {
+        print_summary(reader.events());
+    } else {
+        std::printf("time_us,type,id,sub,size,data\n");
+        for (const sc::TraceEvent& event : reader.events())
+        {
+            print_csv(event);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef SC19_PICO_TRACE_PLAYER_HPP_
+#define SC19_PICO_TRACE_PLAYER_HPP_
+
+/**************************************************
+ * 飛行中の入力の記録(トレース)をPCで再生するためのコードです
+ *
+ * このファイルでは，読み込んだ記録を飛行中と同じ順番で取り出すクラスが定義されています．
+ * PC用のドライバ(I2C・UART・ADC・GPIOの代わり)は，受信するたびにnext()で同じ種類の次の記録を受け取り，
+ * 時刻を聞かれたらnow()を返すようにすると，飛行中と同じ入力でfm.cppの判断をもう一度行えます．
+ * 時刻は記録から進めるだけなので，待ち時間なしで実際よりずっと速く再生できます．
+**************************************************/
+
+//! @file trace_player.hpp
+//! @brief トレースの再生
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "trace_reader.hpp"
+
+namespace sc
+{
+
+//! @brief 記録を飛行中と同じ順番で取り出すクラス
+class TracePlayer
+{
+public:
+    //! @brief 記録から再生を準備
+    //! @param events TraceReaderで読み込んだ記録 (再生が終わるまで残しておくこと)
+    explicit TracePlayer(const std::vector<TraceEvent>& events) :
+        _events(events)
+    {
+        if (!_events.empty())
+        {
+            _now_us = _events.front().time_us;
+        }
+    }
+
+    //! @brief 同じ種類の次の記録を取り出し，仮想の時刻をその記録の時刻まで進める
+    //! @param type 入力の種類
+    //! @param id I2Cのスレーブアドレス，UARTの番号，ADCのチャンネル，GPIOの番号
+    //! @param sub I2Cのメモリアドレス (それ以外は0)
+    //! @return 記録 (もう残っていなければnullopt)
+    std::optional<TraceEvent> next(TraceType type, uint8_t id, uint8_t sub = 0)
+    {
+        std::size_t& cursor = _cursors[std::make_tuple(type, id, sub)];
+        while (cursor < _events.size())
+        {
+            const TraceEvent& event = _events[cursor++];
+            if (event.type == type && event.id == id && event.sub == sub)
+            {
+                advance_to(event.time_us);
+                return event;
+            }
+        }
+        return std::nullopt;
+    }
+
+    //! @brief 仮想の時刻までに起きたピンの変化とMarkerを取り出す
+    //! @return 記録 (時刻までに起きたものがなければnullopt)
+    std::optional<TraceEvent> next_async()
+    {
+        while (_async_cursor < _events.size())
+        {
+            const TraceEvent& event = _events[_async_cursor];
+            if (event.time_us > _now_us)
+                return std::nullopt;
+            ++_async_cursor;
+            if (event.type == TraceType::GPIO || event.type == TraceType::Marker)
+                return event;
+        }
+        return std::nullopt;
+    }
+
+    //! @brief 仮想の時刻を進める (sleepなどの代わり)
+    //! @param time_us 起動からの時間 (μs)  今より前なら何もしない
+    void advance_to(uint64_t time_us)
+    {
+        if (time_us > _now_us)
+        {
+            _now_us = time_us;
+        }
+    }
+
+    //! @brief 仮想の時刻 (起動からの時間(μs))
+    uint64_t now() const
+        {return _now_us;}
+
+    //! @brief 記録の最後の時刻を過ぎたか
+    bool finished() const
+        {return _events.empty() || _now_us >= _events.back().time_us;}
+
+private:
+    const std::vector<TraceEvent>& _events;  // 再生する記録
+    std::map<std::tuple<TraceType, uint8_t, uint8_t>, std::size_t> _cursors;  // 種類ごとの次に探し始める位置
+    std::size_t _async_cursor = 0;  // 次に取り出すピンの変化の位置
+    uint64_t _now_us = 0;  // 仮想の時刻
+};
+
+}
+
+#endif  // SC19_PICO_TRACE_PLAYER_HPP_
@@ -0,0 +1,104 @@
+#ifndef SC19_PICO_TRACE_READER_HPP_
+#define SC19_PICO_TRACE_READER_HPP_
+
+/**************************************************
+ * 飛行中の入力の記録(トレース)をPCで読み込むためのコードです
+ *
+ * このファイルでは，TraceRecorderがSDカードに書き込んだバイナリ(trace_....bin)を読み込み，
+ * 1つずつの記録に分けるクラスが定義されています．
+ * 記録の時刻は下位32bitしか残っていないので，読み込むときに繋げて起動からの時間(μs)に戻します．
+ * 途中で壊れた部分があっても，次のTraceSyncを探して読み進めます．
+**************************************************/
+
+//! @file trace_reader.hpp
+//! @brief トレースの読み込み
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "trace_format.hpp"
+
+namespace sc
+{
+
+//! @brief 1つの記録
+struct TraceEvent
+{
+    TraceType type;  // 入力の種類
+    uint8_t id;  // I2Cのスレーブアドレス，UARTの番号，ADCのチャンネル，GPIOの番号
+    uint8_t sub;  // I2Cのメモリアドレス (それ以外は0)
+    uint64_t time_us;  // 起動からの時間 (μs)
+    std::vector<uint8_t> data;  // 受信したデータ
+
+    //! @brief Markerの文字列
+    std::string text() const
+        {return std::string(data.begin(), data.end());}
+};
+
+//! @brief トレースのファイルを読み込むクラス
+class TraceReader
+{
+public:
+    //! @brief ファイルを読み込む
+    //! @param path トレースのファイル (SDカードのtrace_....bin)
+    //! @return 読み込めたか
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        parse(bytes.data(), bytes.size());
+        return true;
+    }
+
+    //! @brief メモリ上のバイト列を読み込む
+    void parse(const uint8_t* bytes, std::size_t size)
+    {
+        uint64_t upper = 0;  // 時刻の上位32bit
+        uint32_t previous = 0;  // 前の記録の時刻の下位32bit
+        std::size_t pos = 0;
+        while (pos + TraceHeaderSize <= size)
+        {
+            const uint8_t* header = bytes + pos;
+            const std::size_t data_size = header[4];
+            if (header[0] != TraceSync || header[1] < uint8_t(TraceType::I2CRead) || header[1] > uint8_t(TraceType::Marker)
+             || pos + TraceHeaderSize + data_size > size)
+            {
+                // 壊れているので，1バイトずつずらして次の記録の先頭を探す
+                ++pos;
+                ++_skipped;
+                continue;
+            }
+            const uint32_t low = uint32_t(header[5]) | (uint32_t(header[6]) << 8) | (uint32_t(header[7]) << 16) | (uint32_t(header[8]) << 24);
+            if (!_events.empty() && low < previous && previous - low > 0x80000000u)
+            {
+                upper += 0x100000000ull;  // 下位32bitが1周した
+            }
+            previous = low;
+            const uint8_t* data = header + TraceHeaderSize;
+            _events.push_back(TraceEvent{TraceType(header[1]), header[2], header[3], upper | low, std::vector<uint8_t>(data, data + data_size)});
+            pos += TraceHeaderSize + data_size;
+        }
+        _skipped += size - pos;  // 最後の途中で切れた記録
+    }
+
+    //! @brief 読み込んだ記録 (記録した順)
+    const std::vector<TraceEvent>& events() const
+        {return _events;}
+
+    //! @brief 壊れていて読み飛ばしたバイト数
+    std::size_t skipped() const
+        {return _skipped;}
+
+private:
+    std::vector<TraceEvent> _events;  // 読み込んだ記録
+    std::size_t _skipped = 0;  // 読み飛ばしたバイト数
+};
+
+}
+
+#endif  // SC19_PICO_TRACE_READER_HPP_
@@ -0,0 +1,68 @@
+/**************************************************
+ * 飛行中の入力の記録(トレース)から，ミッションをPCでもう一度行うためのコードです
+ *
+ * SDカードのtrace_....binを読み込み，fm.cppと同じドライバとMissionLoopにtest/fakeを通して流し込み，
+ * フェーズの移行とモーターへの指令を1行ずつ表示します (同じ記録なら何度実行しても同じ表示になります)．
+ *
+ *     ./TRACE_REPLAY trace_0101_1200.bin                    記録の最後まで再生する
+ *     ./TRACE_REPLAY trace_0101_1200.bin --until=120        起動から120秒まで再生する
+**************************************************/
+
+//! @file trace_replay.cpp
+//! @brief トレースの再生によるミッションの再現
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "fake_sdk.hpp"
+#include "log.hpp"
+#include "replay_flight.hpp"
+#include "sc_basic.hpp"
+#include "trace_reader.hpp"
+
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    double until_s = -1;  // 負なら記録の最後まで
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.rfind("--until=", 0) == 0)
+        {
+            until_s = std::atof(arg.c_str() + 8);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr)
+    {
+        std::fprintf(stderr, "usage: %s trace.bin [--until=seconds]\n", argv[0]);
+        return 2;
+    }
+
+    sc::TraceReader reader;
+    if (!reader.load(path))
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);  // ファイルを開けません
+        return 2;
+    }
+    if (reader.skipped() > 0)
+    {
+        std::fprintf(stderr, "Skipped %zu broken byte(s)\n", reader.skipped());  // 壊れていた部分を読み飛ばしました
+    }
+
+    sc::fake::reset();
+    sc::set_print = [](const std::string&){};  // ドライバの表示は出さず，結果だけを表示する
+    sc::Log::add_sink(sc::LogLevel::Error, [](const std::string& message){std::fputs(message.c_str(), stderr);});  // エラーだけは標準エラー出力に出す
+    sc::TraceFeeder feeder(reader.events());
+    const uint64_t until_us = (until_s < 0) ? feeder.end_us() : uint64_t(until_s * 1e6);
+    const sc::ReplayResult result = sc::run_flight(until_us);
+    for (const std::string& line : result.log)
+    {
+        std::printf("%s\n", line.c_str());
+    }
+    std::printf("end phase:%d%s\n", int(result.phase), result.goal ? ",goal" : "");
+    return 0;
+}
@@ -3,6 +3,8 @@
 
 #include "sc.hpp"
 
+#include "twelite_frame.hpp"
+
 #include <algorithm>
 
 namespace sc 
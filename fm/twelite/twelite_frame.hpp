@@ -0,0 +1,43 @@
+#ifndef SC19_PICO_TWELITE_FRAME_HPP_
+#define SC19_PICO_TWELITE_FRAME_HPP_
+
+/**************************************************
+ * TWELITEの「超簡単！標準アプリ」の書式に関するコードです
+ * このファイルは，twelite_frame.cppに書かれている関数の一覧です
+ *
+ * このファイルでは，送信するデータを「超簡単！標準アプリ」の書式(:で始まる16進数の文字列)に変換する関数と，
+ * 受信した文字列からデータを取り出す関数が宣言されています．
+ * UARTを使わないので，PC(ベンチマークなど)でもコンパイルできます．
+**************************************************/
+
+//! @file twelite_frame.hpp
+//! @brief TWELITEの「超簡単！標準アプリ」の書式の変換
+
+#include "sc_basic.hpp"
+
+#include <string>
+
+#include "binary.hpp"
+
+namespace sc
+{
+
+//! @brief TWELITEの「超簡単！標準アプリ」の書式の変換
+struct TweliteFrame
+{
+    //! @brief 送信するデータを書式に変換する (80バイトごとに1行にする)
+    //! @param device_id 送信先のデバイスID (親機は0x00)
+    //! @param binary 送信するデータ
+    //! @return UARTで出力する文字列 (1行ずつ":"で始まり"\r\n"で終わる)
+    static std::string encode(uint8_t device_id, const Binary& binary);
+
+    //! @brief 受信した文字列からデータを取り出す
+    //! @note チェックサムは未実装
+    //! @param read_binary UARTで受信した文字列
+    //! @return 取り出したデータ (書式が違う行があれば，その前までのもの)
+    static Binary decode(const Binary& read_binary);
+};
+
+}
+
+#endif  // SC19_PICO_TWELITE_FRAME_HPP_